@@ -0,0 +1,14 @@
+
+message("")
+cmessage( WARNING "Defining benchmarks...")
+
+if( NOT WITH_BENCHMARKS )
+  cmessage( STATUS "Micro-benchmarks disabled (WITH_BENCHMARKS=OFF). Skipping...")
+else()
+  find_package( benchmark QUIET )
+  if( benchmark_FOUND )
+    add_subdirectory( ${CMAKE_SOURCE_DIR}/tests/Benchmarks )
+  else()
+    cmessage( WARNING "google-benchmark is not available. Skipping gundamBenchmarks...")
+  endif()
+endif()
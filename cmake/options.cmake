@@ -27,7 +27,8 @@ option( CXX_MARCH_FLAG "Enable cpu architecture specific optimisations." OFF )
 option( CMAKE_CXX_EXTENSIONS "Enable GNU extensions to C++ language (-std=gnu++14)." OFF )
 option( DISABLE_MANUAL_LOG_HEADER "Don't rely on the manually set logger user header string." ON )
 option( DISABLE_GOOGLE_TESTS "Don't build Google tests." OFF )
-option( ENABLE_ZLIB "Use ZLib hash for cache invalidation." OFF )
+option( WITH_BENCHMARKS "Build the gundamBenchmarks micro-benchmarks (requires google-benchmark)." OFF )
+option( WITH_FLOAT_WEIGHTS "Store the event weights and the cached dial responses in single precision." OFF )
 
 
 # Reading options
@@ -76,6 +77,10 @@ else()
   cmessage( STATUS "Cache manager is disabled. Use -D WITH_CACHE_MANAGER=ON if needed." )
 endif()
 
+if( WITH_FLOAT_WEIGHTS )
+  cmessage( STATUS "-D WITH_FLOAT_WEIGHTS=ON: event weights and dial responses are stored as float..." )
+  add_definitions( -D GUNDAM_FLOAT_WEIGHTS )
+endif( WITH_FLOAT_WEIGHTS )
 
 if( WITH_DOXYGEN )
   cmessage( STATUS "-D WITH_DOXYGEN=ON: enabling doxygen build..." )
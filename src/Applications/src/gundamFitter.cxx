@@ -74,6 +74,7 @@ int main(int argc, char** argv){
   clParser.addOption("scanParameters", {"--scan"}, "Enable parameter scan before and after the fit (can provide nSteps)", 1, true);
   clParser.addOption("scanLine", {"--scan-line"}, "Provide par injector files: start and end point or only end point (start will be prefit)", 2, true);
   clParser.addOption("toyFit", {"--toy"}, "Run a toy fit (optional arg to provide toy index)", 1, true);
+  clParser.addOption("nbToys", {"--nb-toys"}, "Run N toy fits in the same job, loading the events only once (--toy provides the first toy index)", 1);
   clParser.addOption("enablePca", {"--pca", "--enable-pca"}, "Enable principle component analysis for eigen decomposed parameter sets", 2, true);
 
   clParser.addDummyOption("Runtime/debug options");
@@ -215,6 +216,7 @@ int main(int argc, char** argv){
         {"kickMc", "KickMc"},
         {"lightOutputMode", "Light"},
         {"toyFit", "ToyFit"},
+        {"nbToys", "NbToys"},
         {"injectToyParameters", "InjToyPar"},
         {"dry-run", "DryRun"},
         {"appendix", ""},
@@ -306,7 +308,7 @@ int main(int argc, char** argv){
   }
 
   // --toy <iToy>
-  if( clParser.isOptionTriggered("toyFit") ){
+  if( clParser.isOptionTriggered("toyFit") or clParser.isOptionTriggered("nbToys") ){
     fitter.getLikelihoodInterface().getDataSetManager().getPropagator().setThrowAsimovToyParameters(true);
     fitter.getLikelihoodInterface().getDataSetManager().getPropagator().setIThrow(clParser.getOptionVal("toyFit", -1));
   }
@@ -412,6 +414,7 @@ int main(int argc, char** argv){
   // --------------------------
   // Run the fitter:
   // --------------------------
-  fitter.fit();
+  if( clParser.isOptionTriggered("nbToys") ){ fitter.runToyFits( clParser.getOptionVal<int>("nbToys") ); }
+  else{ fitter.fit(); }
 
 }
@@ -16,7 +16,11 @@ namespace Cache {
 
 // Do a definition here to "trick" nvcc which doesn't like the type to be
 // typedef'ed
+#ifdef GUNDAM_FLOAT_WEIGHTS
+#define WEIGHT_BUFFER_FLOAT float
+#else
 #define WEIGHT_BUFFER_FLOAT double
+#endif
 
 /// A base class for the weight calculators.  This holds the pointer to the
 /// weights being accumulated, the input parameter values, and the name of the
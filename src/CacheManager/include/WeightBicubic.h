@@ -3,6 +3,7 @@
 
 #include "CacheWeights.h"
 #include "WeightBase.h"
+#include "DialDataView.h"
 
 #include "hemi/array.h"
 
@@ -93,7 +94,7 @@ public:
 
     /// Add athe data for the spline.
     void AddData(int resultIndex, int parIndex1, int parIndex2,
-                 const std::vector<double>& splineData);
+                 const DialDataView& splineData);
 };
 
 // An MIT Style License
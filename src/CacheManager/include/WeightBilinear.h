@@ -3,6 +3,7 @@
 
 #include "CacheWeights.h"
 #include "WeightBase.h"
+#include "DialDataView.h"
 
 #include "hemi/array.h"
 
@@ -90,7 +91,7 @@ public:
 
     /// Add the data for the spline.
     void AddData(int resultIndex, int parIndex1, int parIndex2,
-                 const std::vector<double>& splineData);
+                 const DialDataView& splineData);
 
 };
 
@@ -3,6 +3,7 @@
 
 #include "CacheWeights.h"
 #include "WeightBase.h"
+#include "DialDataView.h"
 
 #include "hemi/array.h"
 
@@ -101,7 +102,7 @@ public:
     std::size_t GetSplineSpaceUsed() const {return fSplineSpaceUsed;}
 
     /// Add athe data for the spline.
-    void AddSpline(int resultIndex, int parIndex, const std::vector<double>& splineData);
+    void AddSpline(int resultIndex, int parIndex, const DialDataView& splineData);
 
     // Get the index of the parameter for the spline at sIndex.
     int GetSplineParameterIndex(int sIndex);
@@ -3,6 +3,7 @@
 
 #include "CacheWeights.h"
 #include "WeightBase.h"
+#include "DialDataView.h"
 
 #include "hemi/array.h"
 
@@ -87,7 +88,7 @@ public:
 
     /// Add athe data for the graph.
     void AddGraph(int resultIndex, int parIndex,
-                  const std::vector<double>& graphData);
+                  const DialDataView& graphData);
 
     // Get the index of the parameter for the graph at sIndex.
     int GetGraphParameterIndex(int sIndex);
@@ -3,6 +3,7 @@
 
 #include "CacheWeights.h"
 #include "WeightBase.h"
+#include "DialDataView.h"
 
 #include "hemi/array.h"
 
@@ -110,7 +111,7 @@ public:
 
     /// Add a spline for the dial.  This may modify the dial if debugging is
     /// enabled.  This uses ReserveSpline and SetSplineKnot.
-    void AddSpline(int resultIndex, int parIndex, const std::vector<double>& dial);
+    void AddSpline(int resultIndex, int parIndex, const DialDataView& dial);
 
     // Get the index of the parameter for the spline at sIndex.
     int GetSplineParameterIndex(int sIndex);
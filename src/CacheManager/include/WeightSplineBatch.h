@@ -0,0 +1,71 @@
+#ifndef WeightSplineBatch_h_seen
+#define WeightSplineBatch_h_seen
+// Apply the spline weights on the host using the vectorized batch functions
+// from CalculateSplineBatch.h.  This is only used when the kernels are not
+// compiled for a GPU.  The splines are split among the host threads (see
+// hemi/host_threads.h), and each thread evaluates its splines by blocks of
+// CALCULATE_SPLINE_BATCH_SIZE.  The parameter values are gathered before the
+// block is evaluated, and the results are then multiplied into the weights
+// (atomically since several splines can apply to the same event).
+
+#include "CacheAtomicMult.h"
+#include "CalculateSplineBatch.h"
+
+#include <hemi/host_threads.h>
+
+#include <algorithm>
+
+namespace {
+    // The BatchFunction is one of the Calculate*SplineBatch functions.  Its
+    // overload for the knot type (see WEIGHT_BUFFER_FLOAT) is picked by the
+    // conversion to the function pointer.  The other arguments are the same
+    // as for the HEMISplinesKernel.
+    typedef void (*BatchFunction)(int n, const double* x,
+                                  double lowerBound, double upperBound,
+                                  const WEIGHT_BUFFER_FLOAT* data,
+                                  const int* index,
+                                  double* results);
+    void ApplySplineBatch(BatchFunction batchFunction,
+                          double* results,
+                          const double* params,
+                          const double* lowerClamp,
+                          const double* upperClamp,
+                          const WEIGHT_BUFFER_FLOAT* knots,
+                          const int* rIndex,
+                          const short* pIndex,
+                          const int* sIndex,
+                          const int NP) {
+        hemi::host::ThreadPool::Get().Run([&](){
+            // Each thread gets a contiguous range of splines.
+            const int threads = hemi::host::threadCount();
+            const int thread = hemi::host::threadIndex();
+            const int chunk = (NP + threads - 1)/threads;
+            const int begin = std::min(NP, thread*chunk);
+            const int end = std::min(NP, begin+chunk);
+
+            double x[CALCULATE_SPLINE_BATCH_SIZE];
+            double v[CALCULATE_SPLINE_BATCH_SIZE];
+            for (int i0 = begin; i0 < end; i0 += CALCULATE_SPLINE_BATCH_SIZE) {
+                const int n = std::min(end-i0, CALCULATE_SPLINE_BATCH_SIZE);
+                for (int k = 0; k < n; ++k) x[k] = params[pIndex[i0+k]];
+                // The clamps are applied below since they depend on the
+                // parameter.
+                batchFunction(n, x, -1E20, 1E20, knots, &sIndex[i0], v);
+                for (int k = 0; k < n; ++k) {
+                    const int i = i0+k;
+                    double w = v[k];
+                    if (w < lowerClamp[pIndex[i]]) w = lowerClamp[pIndex[i]];
+                    if (w > upperClamp[pIndex[i]]) w = upperClamp[pIndex[i]];
+                    CacheAtomicMult(&results[rIndex[i]], w);
+                }
+            }
+        });
+    }
+}
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:4
+// compile-command:"$(git rev-parse --show-toplevel)/cmake/gundam-build.sh"
+// End:
+#endif
@@ -19,6 +19,10 @@
 
 #include "hemi.h"
 
+#ifndef HEMI_DEV_CODE
+#include "host_threads.h"
+#endif
+
 namespace hemi
 {
 	HEMI_DEV_CALLABLE_INLINE
@@ -26,7 +30,7 @@ namespace hemi
     #ifdef HEMI_DEV_CODE
     	return threadIdx.x + blockIdx.x * blockDim.x;
     #else
-    	return 0;
+    	return hemi::host::threadIndex();
     #endif
     }
 
@@ -36,7 +40,7 @@ namespace hemi
     #ifdef HEMI_DEV_CODE
     	return blockDim.x * gridDim.x;
     #else
-    	return 1;
+    	return hemi::host::threadCount();
     #endif
     }
 
@@ -31,8 +31,20 @@ namespace hemi {
 	template <typename T>
 	HEMI_DEV_CALLABLE_INLINE
 	step_range<T> grid_stride_range(T begin, T end) {
+	#ifdef HEMI_DEV_CODE
 	    begin += hemi::globalThreadIndex();
 	    return range(begin, end).step(hemi::globalThreadCount());
+	#else
+	    // Host threads take contiguous chunks of the range so they are not
+	    // writing in the same cache lines.
+	    const T threads = static_cast<T>(hemi::globalThreadCount());
+	    const T chunk = (end - begin + threads - 1) / threads;
+	    T first = begin + chunk * static_cast<T>(hemi::globalThreadIndex());
+	    if (first > end) first = end;
+	    T last = first + chunk;
+	    if (last > end) last = end;
+	    return range(first, last).step(1);
+	#endif
 	}
 	
 }
@@ -0,0 +1,145 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Host multi-threading for the "Hemi" kernels (GUNDAM extension)
+//
+// When the kernels are not compiled for a GPU, hemi::launch runs the kernel
+// on every thread of a small persistent pool.  Each host thread sees its own
+// globalThreadIndex() and globalThreadCount(), so the grid_stride_range
+// loops inside the kernels are split among the threads exactly like they
+// would be split among the GPU threads.  The kernels must then only rely on
+// atomic operations when different indices write to the same address (as
+// they already do for the GPU).
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hemi {
+namespace host {
+
+    /// The index of the host thread running a kernel.  This is thread local.
+    inline unsigned int& threadIndex() {
+        static thread_local unsigned int index = 0;
+        return index;
+    }
+
+    /// The number of host threads running a kernel.  This is thread local.
+    inline unsigned int& threadCount() {
+        static thread_local unsigned int count = 1;
+        return count;
+    }
+
+    /// A persistent pool of threads used to run the kernels on the host.
+    /// The calling thread takes part of the work, so a pool of N threads
+    /// only starts N-1 workers.  By default, there are no workers and the
+    /// kernels are run in the calling thread.
+    class ThreadPool {
+    public:
+        static ThreadPool& Get() {
+            static ThreadPool pool;
+            return pool;
+        }
+
+        ~ThreadPool() { StopWorkers(); }
+
+        /// Set the number of threads used to run the kernels (including the
+        /// calling thread).
+        void SetThreads(unsigned int threads) {
+            if (threads < 1) threads = 1;
+            if (threads == GetThreads()) return;
+            StopWorkers();
+            fStop = false;
+            for (unsigned int i = 1; i < threads; ++i) {
+                fWorkers.emplace_back([this, i](){ WorkerLoop(i); });
+            }
+        }
+
+        /// The number of threads used to run the kernels.
+        unsigned int GetThreads() const {
+            return static_cast<unsigned int>(fWorkers.size()) + 1;
+        }
+
+        /// Run the job on every thread of the pool and wait until they are
+        /// all done.
+        void Run(const std::function<void()>& job) {
+            if (fWorkers.empty()) {
+                job();
+                return;
+            }
+            // Only one kernel can be running on the pool at a time.
+            std::lock_guard<std::mutex> runLock(fRunMutex);
+            {
+                std::lock_guard<std::mutex> lock(fMutex);
+                fJob = &job;
+                fThreadCount = GetThreads();
+                fPending = fThreadCount - 1;
+                ++fGeneration;
+            }
+            fStartCondition.notify_all();
+
+            // The calling thread is the thread zero.
+            threadIndex() = 0;
+            threadCount() = GetThreads();
+            job();
+            threadCount() = 1;
+
+            std::unique_lock<std::mutex> lock(fMutex);
+            fDoneCondition.wait(lock, [this](){ return fPending == 0; });
+            fJob = nullptr;
+        }
+
+    private:
+        ThreadPool() = default;
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        void WorkerLoop(unsigned int index) {
+            unsigned long generation = 0;
+            threadIndex() = index;
+            while (true) {
+                std::unique_lock<std::mutex> lock(fMutex);
+                fStartCondition.wait(lock, [this, &generation](){
+                    return fStop || fGeneration != generation;
+                });
+                if (fStop) return;
+                generation = fGeneration;
+                const std::function<void()>* job = fJob;
+                threadCount() = fThreadCount;
+                lock.unlock();
+
+                (*job)();
+
+                lock.lock();
+                if (--fPending == 0) fDoneCondition.notify_one();
+            }
+        }
+
+        void StopWorkers() {
+            {
+                std::lock_guard<std::mutex> lock(fMutex);
+                fStop = true;
+            }
+            fStartCondition.notify_all();
+            for (std::thread& worker : fWorkers) worker.join();
+            fWorkers.clear();
+        }
+
+        std::vector<std::thread> fWorkers;
+        std::mutex fMutex;
+        std::mutex fRunMutex;
+        std::condition_variable fStartCondition;
+        std::condition_variable fDoneCondition;
+        const std::function<void()>* fJob{nullptr};
+        unsigned long fGeneration{0};
+        unsigned int fThreadCount{1};
+        unsigned int fPending{0};
+        bool fStop{false};
+    };
+
+}
+}
@@ -15,6 +15,7 @@
 #pragma once
 
 #include "kernel.h"
+#include "host_threads.h"
 
 #ifdef HEMI_CUDA_COMPILER
 #include "configure.h"
@@ -32,7 +33,7 @@ void launch(Function f, Arguments... args)
     launch(p, f, args...);
 #else
     HEMI_LAUNCH_OUTPUT("Host launch (no GPU used)");
-    Kernel(f, args...);
+    host::ThreadPool::Get().Run([&](){ Kernel(f, args...); });
 #endif
 }
 
@@ -62,7 +63,7 @@ void launch(const ExecutionPolicy &policy, Function f, Arguments... args)
 void launch(const ExecutionPolicy&, Function f, Arguments... args)
 {
     HEMI_LAUNCH_OUTPUT("Host launch (no GPU used)");
-    Kernel(f, args...);
+    host::ThreadPool::Get().Run([&](){ Kernel(f, args...); });
 }
 #endif
 
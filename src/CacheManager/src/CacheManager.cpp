@@ -36,6 +36,8 @@
 #include "Shift.h"
 #include "Tabulated.h"
 
+#include <hemi/host_threads.h>
+
 #include <memory>
 #include <set>
 
@@ -201,12 +203,13 @@ bool Cache::Manager::Build(SampleSet& sampleList,
 
     int dialErrorCount = 0;     // This should *stay* zero.
     std::map<std::string, int> useCount;
-    for (EventDialCache::CacheEntry& elem : eventDials.getCache()) {
+    for (std::size_t iEntry = 0; iEntry < eventDials.getNbEntries(); ++iEntry) {
+        EventDialCache::CacheEntry elem = eventDials.getEntry(iEntry);
         if (elem.event->getIndices().bin < 0) {
             LogThrow("Caching event that isn't used");
         }
         ++config.events;
-        for( auto& dialResponseCache : elem.dialResponseCacheList) {
+        for (DialInterface& dialInterface : elem.dialInterfaceList) {
             // This is depending behavior that is not guarranteed, but which
             // is probably valid because of the particular usage.
             // Specifically, it depends on the vector of Parameter objects
@@ -215,13 +218,13 @@ bool Cache::Manager::Build(SampleSet& sampleList,
             // usage is forced do to an API change.
             // Make sure all of the used parameters are in the parameter
             // map.
-            for (std::size_t i = 0; i < dialResponseCache.dialInterface.getInputBufferRef()->getBufferSize(); ++i) {
-                const Parameter* fp = &(dialResponseCache.dialInterface.getInputBufferRef()->getParameter(i));
+            for (std::size_t i = 0; i < dialInterface.getInputBufferRef()->getBufferSize(); ++i) {
+                const Parameter* fp = &(dialInterface.getInputBufferRef()->getParameter(i));
                 usedParameters.insert(fp);
                 ++useCount[fp->getFullTitle()];
             }
 
-            DialBase* dial = dialResponseCache.dialInterface.getDialBaseRef();
+            DialBase* dial = dialInterface.getDialBaseRef();
             std::string dialType = dial->getDialTypeName();
             if (dialType.find("Norm") == 0) {
                 ++config.norms;
@@ -398,6 +401,13 @@ bool Cache::Manager::Build(SampleSet& sampleList,
         if (!Cache::Manager::HasCUDA()) {
             LogInfo << "    GPU Not enabled with Cache::Manager"
                       << std::endl;
+#ifdef HEMI_CUDA_DISABLE
+            // Without a GPU, the kernels are shared among the host threads.
+            LogInfo << "    Kernels run on " << GundamGlobals::getNumberOfThreads()
+                    << " host threads" << std::endl;
+            hemi::host::ThreadPool::Get().SetThreads(
+                GundamGlobals::getNumberOfThreads());
+#endif
         }
         try {
             fSingleton = new Manager(config);
@@ -452,7 +462,8 @@ bool Cache::Manager::Update(SampleSet& sampleList,
     int usedResults = 0;
 
     // Add the dials in the EventDialCache to the internal cache.
-    for (EventDialCache::CacheEntry& elem : eventDials.getCache()) {
+    for (std::size_t iEntry = 0; iEntry < eventDials.getNbEntries(); ++iEntry) {
+        EventDialCache::CacheEntry elem = eventDials.getEntry(iEntry);
         // Skip events that are not in a bin.
         if (elem.event->getIndices().bin < 0) continue;
         Event& event = *elem.event;
@@ -479,9 +490,9 @@ bool Cache::Manager::Update(SampleSet& sampleList,
 
         int dialErrorCount = 0;
         // Add each dial for the event to the GPU caches.
-        for( auto& dialElem : elem.dialResponseCacheList ){
+        for (DialInterface& dialInterface : elem.dialInterfaceList) {
             DialInputBuffer* dialInputs
-                = dialElem.dialInterface.getInputBufferRef();
+                = dialInterface.getInputBufferRef();
 
             // Make sure all of the used parameters are in the parameter
             // map.
@@ -489,7 +500,7 @@ bool Cache::Manager::Update(SampleSet& sampleList,
                 // Find the index (or allocate a new one) for the dial
                 // parameter.
                 const Parameter* fp
-                    = &(dialElem.dialInterface.getInputBufferRef()
+                    = &(dialInterface.getInputBufferRef()
                         ->getParameter(i));
                 auto parMapIt = Cache::Manager::ParameterMap.find(fp);
                 if (parMapIt == Cache::Manager::ParameterMap.end()) {
@@ -515,7 +526,7 @@ bool Cache::Manager::Update(SampleSet& sampleList,
             for (std::size_t i = 0; i < dialInputs->getBufferSize(); ++i) {
                 const Parameter* fp = &(dialInputs->getParameter(i));
                 const DialResponseSupervisor* resp
-                    = dialElem.dialInterface.getResponseSupervisorRef();
+                    = dialInterface.getResponseSupervisorRef();
                 int parIndex = Cache::Manager::ParameterMap[fp];
                 double minResponse = 0.0;
                 if (std::isfinite(resp->getMinResponse())) {
@@ -530,7 +541,7 @@ bool Cache::Manager::Update(SampleSet& sampleList,
 
             // Add the dial information to the appropriate caches
             int dialUsed = 0;
-            const DialBase* baseDial = dialElem.dialInterface.getDialBaseRef();
+            const DialBase* baseDial = dialInterface.getDialBaseRef();
             const Norm* normDial = dynamic_cast<const Norm*>(baseDial);
             if (normDial) {
                 ++dialUsed;
@@ -81,7 +81,7 @@ Cache::Weight::Bicubic::~Bicubic() {}
 
 void Cache::Weight::Bicubic::AddData(int resIndex,
                                      int par1Index, int par2Index,
-                                     const std::vector<double>& splineData) {
+                                     const DialDataView& splineData) {
     if (resIndex < 0) {
         LogError << "Invalid result index"
                << std::endl;
@@ -143,6 +143,8 @@ void Cache::Weight::Bicubic::AddData(int resIndex,
     }
 }
 
+// The data is read from the buffers with the weight precision.
+#define DEVICE_FLOATING_POINT WEIGHT_BUFFER_FLOAT
 #include "CalculateBicubicSpline.h"
 #include "CacheAtomicMult.h"
 
@@ -81,7 +81,7 @@ Cache::Weight::Bilinear::~Bilinear() {}
 
 void Cache::Weight::Bilinear::AddData(int resIndex,
                                         int par1Index, int par2Index,
-                                        const std::vector<double>& data) {
+                                        const DialDataView& data) {
     if (resIndex < 0) {
         LogError << "Invalid result index"
                << std::endl;
@@ -143,6 +143,8 @@ void Cache::Weight::Bilinear::AddData(int resIndex,
     }
 }
 
+// The data is read from the buffers with the weight precision.
+#define DEVICE_FLOATING_POINT WEIGHT_BUFFER_FLOAT
 #include "CalculateBilinearInterpolation.h"
 #include "CacheAtomicMult.h"
 
@@ -95,7 +95,7 @@ int Cache::Weight::CompactSpline::FindPoints(const TSpline3* s) {
 
 void Cache::Weight::CompactSpline::AddSpline(int resIndex,
                                              int parIndex,
-                                             const std::vector<double>& splineData) {
+                                             const DialDataView& splineData) {
     if (resIndex < 0) {
         LogError << "Invalid result index"
                << std::endl;
@@ -243,7 +243,12 @@ double Cache::Weight::CompactSpline::GetSplineKnot(int sIndex, int knot) {
 }
 
 #include "CacheAtomicMult.h"
+// The data is read from the buffers with the weight precision.
+#define DEVICE_FLOATING_POINT WEIGHT_BUFFER_FLOAT
 #include "CalculateCompactSpline.h"
+#ifndef HEMI_CUDA_COMPILER
+#include "WeightSplineBatch.h"
+#endif
 
 // Define CACHE_DEBUG to get lots of output from the host
 #undef CACHE_DEBUG
@@ -302,6 +307,19 @@ void Cache::Weight::CompactSpline::Reset() {
 bool Cache::Weight::CompactSpline::Apply() {
     if (GetSplinesUsed() < 1) return false;
 
+#ifndef HEMI_CUDA_COMPILER
+    // Without a GPU, evaluate the splines with the vectorized loops.
+    ApplySplineBatch(CalculateCompactSplineBatch,
+                     fWeights.writeOnlyPtr(),
+                     fParameters.readOnlyPtr(),
+                     fLowerClamp.readOnlyPtr(),
+                     fUpperClamp.readOnlyPtr(),
+                     fSplineSpace->readOnlyPtr(),
+                     fSplineResult->readOnlyPtr(),
+                     fSplineParameter->readOnlyPtr(),
+                     fSplineIndex->readOnlyPtr(),
+                     GetSplinesUsed());
+#else
     HEMISplinesKernel splinesKernel;
     hemi::launch(splinesKernel,
                  fWeights.writeOnlyPtr(),
@@ -314,6 +332,7 @@ bool Cache::Weight::CompactSpline::Apply() {
                  fSplineIndex->readOnlyPtr(),
                  GetSplinesUsed()
         );
+#endif
 
     return true;
 }
@@ -95,7 +95,7 @@ int Cache::Weight::GeneralSpline::FindPoints(const TSpline3* s) {
 }
 
 void Cache::Weight::GeneralSpline::AddSpline(int resIndex, int parIndex,
-                                             const std::vector<double>& splineData) {
+                                             const DialDataView& splineData) {
     if (resIndex < 0) {
         LogError << "Invalid result index"
                << std::endl;
@@ -240,7 +240,12 @@ double Cache::Weight::GeneralSpline::GetSplineKnotPlace(int sIndex, int knot) {
 #undef CACHE_DEBUG
 #define PRINT_STEP 3
 
+// The data is read from the buffers with the weight precision.
+#define DEVICE_FLOATING_POINT WEIGHT_BUFFER_FLOAT
 #include "CalculateGeneralSpline.h"
+#ifndef HEMI_CUDA_COMPILER
+#include "WeightSplineBatch.h"
+#endif
 #include "CacheAtomicMult.h"
 
 namespace {
@@ -319,6 +324,19 @@ void Cache::Weight::GeneralSpline::Reset() {
 bool Cache::Weight::GeneralSpline::Apply() {
     if (GetSplinesUsed() < 1) return false;
 
+#ifndef HEMI_CUDA_COMPILER
+    // Without a GPU, evaluate the splines with the vectorized loops.
+    ApplySplineBatch(CalculateGeneralSplineBatch,
+                     fWeights.writeOnlyPtr(),
+                     fParameters.readOnlyPtr(),
+                     fLowerClamp.readOnlyPtr(),
+                     fUpperClamp.readOnlyPtr(),
+                     fSplineSpace->readOnlyPtr(),
+                     fSplineResult->readOnlyPtr(),
+                     fSplineParameter->readOnlyPtr(),
+                     fSplineIndex->readOnlyPtr(),
+                     GetSplinesUsed());
+#else
     HEMISplinesKernel splinesKernel;
     hemi::launch(splinesKernel,
                  fWeights.writeOnlyPtr(),
@@ -331,6 +349,7 @@ bool Cache::Weight::GeneralSpline::Apply() {
                  fSplineIndex->readOnlyPtr(),
                  GetSplinesUsed()
         );
+#endif
 
     return true;
 }
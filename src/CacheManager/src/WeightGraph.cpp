@@ -81,7 +81,7 @@ Cache::Weight::Graph::Graph(
 Cache::Weight::Graph::~Graph() {}
 
 void Cache::Weight::Graph::AddGraph(int resIndex, int parIndex,
-                                             const std::vector<double>& graphData) {
+                                             const DialDataView& graphData) {
     if (resIndex < 0) {
         LogError << "Invalid result index"
                << std::endl;
@@ -256,6 +256,8 @@ double Cache::Weight::Graph::GetGraphKnotPlace(int sIndex, int knot) {
     return fGraphSpace->hostPtr()[spaceIndex+2+2*knot+1];
 }
 
+// The data is read from the buffers with the weight precision.
+#define DEVICE_FLOATING_POINT WEIGHT_BUFFER_FLOAT
 #include "CalculateGraph.h"
 #include "CacheAtomicMult.h"
 
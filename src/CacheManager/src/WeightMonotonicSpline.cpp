@@ -95,7 +95,7 @@ int Cache::Weight::MonotonicSpline::FindPoints(const TSpline3* s) {
 
 void Cache::Weight::MonotonicSpline::AddSpline(int resIndex,
                                                int parIndex,
-                                               const std::vector<double>& splineData) {
+                                               const DialDataView& splineData) {
     if (resIndex < 0) {
         LogError << "Invalid result index"
                << std::endl;
@@ -276,7 +276,12 @@ double Cache::Weight::MonotonicSpline::GetSplineKnot(int sIndex, int knot) {
 }
 
 #include "CacheAtomicMult.h"
+// The data is read from the buffers with the weight precision.
+#define DEVICE_FLOATING_POINT WEIGHT_BUFFER_FLOAT
 #include "CalculateMonotonicSpline.h"
+#ifndef HEMI_CUDA_COMPILER
+#include "WeightSplineBatch.h"
+#endif
 
 // Define CACHE_DEBUG to get lots of output from the host
 #undef CACHE_DEBUG
@@ -333,6 +338,19 @@ void Cache::Weight::MonotonicSpline::Reset() {
 bool Cache::Weight::MonotonicSpline::Apply() {
     if (GetSplinesUsed() < 1) return false;
 
+#ifndef HEMI_CUDA_COMPILER
+    // Without a GPU, evaluate the splines with the vectorized loops.
+    ApplySplineBatch(CalculateMonotonicSplineBatch,
+                     fWeights.writeOnlyPtr(),
+                     fParameters.readOnlyPtr(),
+                     fLowerClamp.readOnlyPtr(),
+                     fUpperClamp.readOnlyPtr(),
+                     fSplineSpace->readOnlyPtr(),
+                     fSplineResult->readOnlyPtr(),
+                     fSplineParameter->readOnlyPtr(),
+                     fSplineIndex->readOnlyPtr(),
+                     GetSplinesUsed());
+#else
     HEMISplinesKernel splinesKernel;
     hemi::launch(splinesKernel,
                  fWeights.writeOnlyPtr(),
@@ -345,6 +363,7 @@ bool Cache::Weight::MonotonicSpline::Apply() {
                  fSplineIndex->readOnlyPtr(),
                  GetSplinesUsed()
         );
+#endif
 
     return true;
 }
@@ -95,7 +95,7 @@ int Cache::Weight::UniformSpline::FindPoints(const TSpline3* s) {
 }
 
 void Cache::Weight::UniformSpline::AddSpline(int resIndex, int parIndex,
-                                             const std::vector<double>& splineData) {
+                                             const DialDataView& splineData) {
     if (resIndex < 0) {
         LogError << "Invalid result index"
                << std::endl;
@@ -267,7 +267,12 @@ double Cache::Weight::UniformSpline::GetSplineKnotSlope(int sIndex, int knot) {
 }
 
 #include "CacheAtomicMult.h"
+// The data is read from the buffers with the weight precision.
+#define DEVICE_FLOATING_POINT WEIGHT_BUFFER_FLOAT
 #include "CalculateUniformSpline.h"
+#ifndef HEMI_CUDA_COMPILER
+#include "WeightSplineBatch.h"
+#endif
 
 // Define CACHE_DEBUG to get lots of output from the host
 #undef CACHE_DEBUG
@@ -339,6 +344,19 @@ void Cache::Weight::UniformSpline::Reset() {
 bool Cache::Weight::UniformSpline::Apply() {
     if (GetSplinesUsed() < 1) return false;
 
+#ifndef HEMI_CUDA_COMPILER
+    // Without a GPU, evaluate the splines with the vectorized loops.
+    ApplySplineBatch(CalculateUniformSplineBatch,
+                     fWeights.writeOnlyPtr(),
+                     fParameters.readOnlyPtr(),
+                     fLowerClamp.readOnlyPtr(),
+                     fUpperClamp.readOnlyPtr(),
+                     fSplineSpace->readOnlyPtr(),
+                     fSplineResult->readOnlyPtr(),
+                     fSplineParameter->readOnlyPtr(),
+                     fSplineIndex->readOnlyPtr(),
+                     GetSplinesUsed());
+#else
     HEMISplinesKernel splinesKernel;
     hemi::launch(splinesKernel,
                  fWeights.writeOnlyPtr(),
@@ -351,6 +369,7 @@ bool Cache::Weight::UniformSpline::Apply() {
                  fSplineIndex->readOnlyPtr(),
                  GetSplinesUsed()
         );
+#endif
 
     return true;
 }
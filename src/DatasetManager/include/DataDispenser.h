@@ -7,6 +7,7 @@
 
 #include "EventVarTransformLib.h"
 #include "DataDispenserUtils.h"
+#include "LoadingProfiler.h"
 
 #include "Propagator.h"
 #include "JsonBaseClass.h"
@@ -40,6 +41,7 @@ public:
   // const getters
   [[nodiscard]] const DatasetDefinition* getOwner() const{ return _owner_; }
   [[nodiscard]] const DataDispenserParameters &getParameters() const{ return _parameters_; }
+  [[nodiscard]] const LoadingProfiler &getLoadingProfiler() const{ return _profiler_; }
 
   // non-const getters
   DataDispenserParameters &getParameters(){ return _parameters_; }
@@ -57,8 +59,16 @@ protected:
   void fetchRequestedLeaves();
   void preAllocateMemory();
   void readAndFill();
+  void reserveThreadFillRanges(int nThreads_);
+  void compactThreadFillRanges();
   void loadFromHistContent();
 
+  // event cache
+  void buildEventCacheKey();
+  void prepareEventCacheRecording(const std::vector<const GenericToolbox::LeafForm*>& leafFormStorageList_);
+  bool loadFromEventCache();
+  void writeEventCache();
+
   // utils
   std::unique_ptr<TChain> openChain(bool verbose_ = false);
 
@@ -74,6 +84,7 @@ private:
   // internals
   DatasetDefinition* _owner_{nullptr};
   DataDispenserCache _cache_;
+  LoadingProfiler _profiler_;
 
   GenericToolbox::ParallelWorker _threadPool_{};
 
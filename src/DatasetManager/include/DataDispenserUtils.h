@@ -29,6 +29,7 @@ struct DataDispenserParameters{
   std::vector<std::string> additionalVarsStorage{};
   std::vector<std::string> dummyVariablesList;
   size_t debugNbMaxEventsToLoad{0};
+  std::string eventCacheDir{};
 
   JsonType fromHistContent{};
   JsonType overridePropagatorConfig{};
@@ -63,6 +64,26 @@ struct DataDispenserCache{
   };
   std::vector<ThreadSelectionResult> threadSelectionResults;
 
+  // Slots reserved for each loading thread: the events of a thread go in
+  // its own range of each sample and of the indexed dial cache, so no lock
+  // is needed. The ranges follow the TChain entry order.
+  struct ThreadFillRange{
+    std::vector<size_t> sampleEventBegin{}; // first event slot in each sample
+    std::vector<size_t> sampleNbEvents{};   // number of events filled in each sample
+    size_t cacheEntryBegin{0};              // first indexed dial cache entry
+    size_t nbCacheEntries{0};               // number of cache entries filled
+  };
+  std::vector<ThreadFillRange> threadFillRangeList;
+  size_t debugNbEventsLoaded{0}; // only used with debugNbMaxEventsToLoad
+
+  // Event cache (see EventCacheFile.h)
+  uint64_t eventCacheKey{0};
+  std::string eventCacheFilePath{}; // empty if the cache is not used
+  std::vector<std::string> varsStorageLeafTypeList{};
+  std::vector<size_t> sampleEventOffsetList{}; // first event of this dispenser in each sample
+  size_t dialCacheFillIndexBegin{0};
+  std::vector<std::vector<std::string>> dialInitializerList{}; // dialInitializerList[iCollection][iDialSlot] = serialized TObject
+
   void clear();
   void addVarRequestedForIndexing(const std::string& varName_);
   void addVarRequestedForStorage(const std::string& varName_);
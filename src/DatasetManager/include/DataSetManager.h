@@ -33,13 +33,24 @@ public:
   EventTreeWriter& getTreeWriter(){ return _treeWriter_; }
   std::vector<DatasetDefinition>& getDataSetList(){ return _dataSetList_; }
 
+  // core
+  /// Generate a new toy data set from the loaded model without reloading the
+  /// events: the parameters are thrown (or injected), the MC events are
+  /// reweighted and copied into the data histograms, then the statistical
+  /// errors are thrown.  The parameters are left at the thrown values.
+  void throwToyData();
+  /// Write the loading profiles of the dispensers that have been loaded
+  void writeLoadingProfiles(TDirectory* saveDir_);
+
 protected:
   void load();
   void loadPropagator(bool isModel_);
+  void throwStatErrors();
 
 private:
   // internals
   bool _reloadModelRequested_{false};
+  bool _isDataLoadedFromModel_{false};
 
   Propagator _propagator_{};
   EventTreeWriter _treeWriter_{};
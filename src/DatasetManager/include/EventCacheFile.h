@@ -0,0 +1,100 @@
+//
+// On-disk cache of the events loaded by a DataDispenser.
+//
+
+#ifndef GUNDAM_EVENT_CACHE_FILE_H
+#define GUNDAM_EVENT_CACHE_FILE_H
+
+#include "TObject.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+
+
+/// The event cache file is a versioned sequence of columns: one contiguous
+/// array per event property (entry, bin, base weight, each stored variable,
+/// dial indices...). Every column starts on an 8 bytes boundary so the reader
+/// can hand out pointers into the memory-mapped file without any copy.
+namespace EventCacheFile{
+
+  /// Bumped every time the layout written by DataDispenser changes
+  constexpr uint32_t formatVersion{1};
+
+  /// 64-bit FNV-1a: stable from one run (and one platform) to another
+  uint64_t hashString(const std::string& str_, uint64_t seed_ = 14695981039346656037ULL);
+
+  /// Hash of the path, size and modification time of a file
+  uint64_t hashFileMetadata(const std::string& filePath_, uint64_t seed_);
+
+  /// ROOT objects (dial initializers) are kept with their streamer
+  std::string serializeObject(const TObject* object_);
+  std::unique_ptr<TObject> deserializeObject(const char* data_, size_t size_);
+
+
+  class Writer{
+
+  public:
+    /// The content goes to a temporary file which is only moved to
+    /// filePath_ by close(): a crashed job never leaves a truncated cache.
+    explicit Writer(const std::string& filePath_);
+    ~Writer();
+
+    void writeHeader(uint64_t key_);
+    void writeRaw(const void* data_, size_t nBytes_);
+    void writeColumn(const void* data_, size_t nBytes_);
+    void writeString(const std::string& str_);
+
+    template<typename T> void write(const T& value_){ writeRaw(&value_, sizeof(T)); }
+    template<typename T> void writeColumn(const std::vector<T>& column_){
+      write(uint64_t(column_.size()));
+      writeColumn(column_.data(), column_.size()*sizeof(T));
+    }
+
+    void close();
+
+  private:
+    std::string _filePath_{};
+    std::string _tmpFilePath_{};
+    std::ofstream _stream_{};
+    size_t _nBytesWritten_{0};
+
+  };
+
+
+  class Reader{
+
+  public:
+    /// Map the file in memory. isOpen() is false if the file does not exist
+    /// or if its header does not match the format version and key_.
+    Reader(const std::string& filePath_, uint64_t key_);
+    ~Reader();
+
+    [[nodiscard]] bool isOpen() const{ return _data_ != nullptr; }
+
+    const char* readRaw(size_t nBytes_);
+    const char* readColumn(size_t nBytes_);
+    std::string readString();
+
+    template<typename T> T read(){ T out; std::memcpy(&out, readRaw(sizeof(T)), sizeof(T)); return out; }
+    template<typename T> const T* readColumn(uint64_t& size_){
+      size_ = read<uint64_t>();
+      return reinterpret_cast<const T*>(readColumn(size_*sizeof(T)));
+    }
+
+  private:
+    void unmap();
+
+    const char* _data_{nullptr};
+    size_t _size_{0};
+    size_t _cursor_{0};
+
+  };
+
+}
+
+
+#endif //GUNDAM_EVENT_CACHE_FILE_H
@@ -7,6 +7,7 @@
 
 #include "Event.h"
 #include "JsonBaseClass.h"
+#include "CompiledFormula.h"
 
 #include "TFormula.h"
 
@@ -32,6 +33,11 @@ public:
   const std::string &getOutputVariableName() const { return _outputVariableName_; }
   const std::vector<std::string>& fetchRequestedVars() const;
 
+  /// Look up the inputs of the compiled formulas in varNameList_, the
+  /// variables of the events that will be given to eval().  Without it, the
+  /// inputs are looked up by name for each event.
+  void buildInputIndexDict(const std::vector<std::string>& varNameList_);
+
   double eval(const Event& event_);
   void storeCachedOutput( Event& event_) const;
   void storeOutput( double output_, Event& storeEvent_) const;
@@ -58,6 +64,9 @@ protected:
   // Internals
   bool _useCache_{true};
   std::vector<TFormula> _inputFormulaList_;
+  std::vector<CompiledFormula> _compiledInputFormulaList_; // empty if one of the formulas can't be compiled
+  std::vector<std::string> _inputIndexDictVarNameList_{}; // variables the dicts refer to
+  std::vector<std::vector<int>> _inputIndexDictList_{}; // [iFormula][iVar] index in _inputIndexDictVarNameList_
 
   // CACHES / not parallelisable
   double _outputCache_{};
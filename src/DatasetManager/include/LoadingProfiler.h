@@ -0,0 +1,116 @@
+//
+// Per-stage timers and counters of the DataDispenser loading.
+//
+
+#ifndef GUNDAM_LOADING_PROFILER_H
+#define GUNDAM_LOADING_PROFILER_H
+
+#include "TDirectory.h"
+
+#include <array>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+
+/// Breakdown of the time spent by DataDispenser::load().  Each loading
+/// thread accumulates in its own ThreadProfile (no lock, no shared cache
+/// line), the profiles are summed once the threads are done.  The serial
+/// stages are accumulated in the profile of the thread 0.
+class LoadingProfiler{
+
+public:
+  enum Stage{
+    EventSelection = 0, // reading the entries and evaluating the selection cuts
+    DiskRead,           // TChain::GetEntry while filling
+    NominalWeight,
+    LeafCopy,           // leaves -> event variables
+    VarTransform,
+    BinLookup,          // sample bins
+    DialIndexing,       // apply conditions and dial bins
+    DialCreation,       // event-by-event dials (DialBaseFactory::makeDial)
+    LockWait,
+    MemoryAllocation,   // DataDispenser::preAllocateMemory
+    Compaction,         // compaction of the thread ranges and shrinking of the event lists
+    EventCache,         // reading or writing the event cache
+    nbStages
+  };
+  static const char* getStageName(Stage stage_);
+
+  struct StageCounters{
+    double cpuTime{0}; // seconds, summed over the threads
+    uint64_t nbCalls{0};
+    uint64_t nbBytes{0};
+    uint64_t nbAllocations{0}; // objects allocated on the heap (dials...)
+
+    StageCounters& operator+=(const StageCounters& other_);
+  };
+
+  struct ThreadProfile{
+    std::array<StageCounters, nbStages> stageList{};
+    char padding[64]{}; // the threads don't share a cache line
+  };
+
+  /// Time a stage until the end of the scope
+  class ScopedTimer{
+
+  public:
+    ScopedTimer(ThreadProfile& profile_, Stage stage_) :
+        _counters_(profile_.stageList[stage_]), _start_(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer(){
+      _counters_.cpuTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - _start_).count();
+      _counters_.nbCalls++;
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+  private:
+    StageCounters& _counters_;
+    std::chrono::steady_clock::time_point _start_;
+
+  };
+
+public:
+  /// Forget everything and start the wall clock
+  void reset(const std::string& title_);
+  /// Make sure there is one profile per thread (the existing ones are kept)
+  void setNbThreads(int nbThreads_);
+  /// Sum the thread profiles and stop the wall clock
+  void finalize();
+
+  // const getters
+  [[nodiscard]] bool isFinalized() const{ return _isFinalized_; }
+  [[nodiscard]] const std::string& getTitle() const{ return _title_; }
+  [[nodiscard]] double getWallTime() const{ return _wallTime_; }
+  [[nodiscard]] const StageCounters& getStage(Stage stage_) const{ return _totalList_[stage_]; }
+
+  // mutable getters
+  ThreadProfile& getThreadProfile(int iThread_){ return _threadProfileList_[iThread_ < 0 ? 0 : iThread_]; }
+
+  // misc
+  void setNbLoadedEvents(uint64_t nbLoadedEvents_){ _nbLoadedEvents_ = nbLoadedEvents_; }
+  void setMemoryIncrease(int64_t nbBytes_){ _memoryIncrease_ = nbBytes_; }
+
+  [[nodiscard]] std::string getSummary() const;
+
+  /// Write the TTree "loadingProfile" with one entry per profiler and per
+  /// stage, tagged with the GUNDAM version so runs can be compared
+  static void writeToDirectory(TDirectory* saveDir_, const std::vector<const LoadingProfiler*>& profilerList_);
+
+private:
+  bool _isFinalized_{false};
+  std::string _title_{};
+  double _wallTime_{0};
+  uint64_t _nbLoadedEvents_{0};
+  int64_t _memoryIncrease_{0};
+  std::chrono::steady_clock::time_point _start_{};
+
+  std::vector<ThreadProfile> _threadProfileList_{1};
+  std::array<StageCounters, nbStages> _totalList_{};
+
+};
+
+
+#endif //GUNDAM_LOADING_PROFILER_H
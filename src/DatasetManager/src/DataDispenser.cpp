@@ -5,9 +5,11 @@
 
 #include "DataDispenser.h"
 #include "DatasetDefinition.h"
+#include "EventCacheFile.h"
 
 #include "EventVarTransform.h"
 #include "GundamGlobals.h"
+#include "GundamUtils.h"
 #include "GenericToolbox.Json.h"
 #include "ConfigUtils.h"
 
@@ -23,9 +25,11 @@
 #include "TTreeFormulaManager.h"
 #include "TChainElement.h"
 #include "TClonesArray.h"
+#include "TLeaf.h"
 #include "TChain.h"
 #include "THn.h"
 
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <sstream>
@@ -60,6 +64,7 @@ void DataDispenser::readConfigImpl(){
   _parameters_.nominalWeightFormulaStr = GenericToolbox::Json::buildFormula(_config_, "nominalWeightFormula", "*", _parameters_.nominalWeightFormulaStr);
 
   _parameters_.debugNbMaxEventsToLoad = GenericToolbox::Json::fetchValue(_config_, "debugNbMaxEventsToLoad", _parameters_.debugNbMaxEventsToLoad);
+  _parameters_.eventCacheDir = GenericToolbox::Json::fetchValue(_config_, "eventCacheDir", _parameters_.eventCacheDir);
 
   _parameters_.variableDict.clear();
   for( auto& entry : GenericToolbox::Json::fetchValue(_config_, {{"variableDict"}, {"overrideLeafDict"}}, JsonType()) ){
@@ -106,11 +111,44 @@ void DataDispenser::load(Propagator& propagator_){
   }
 
   this->parseStringParameters();
+
+  _profiler_.reset( getTitle() );
+  auto memoryBefore{int64_t(GenericToolbox::getProcessMemoryUsage())};
+  auto finalizeProfile = [&]{
+    _profiler_.finalize();
+    _profiler_.setNbLoadedEvents( _cache_.totalNbEvents );
+    _profiler_.setMemoryIncrease( int64_t(GenericToolbox::getProcessMemoryUsage()) - memoryBefore );
+    LogInfo << _profiler_.getSummary() << std::endl;
+  };
+
+  if( not _parameters_.eventCacheDir.empty() ){
+    this->buildEventCacheKey();
+    bool isLoaded;
+    {
+      LoadingProfiler::ScopedTimer timer(_profiler_.getThreadProfile(0), LoadingProfiler::EventCache);
+      isLoaded = this->loadFromEventCache();
+    }
+    if( isLoaded ){
+      finalizeProfile();
+      LogWarning << "Loaded " << getTitle() << " from the event cache" << std::endl;
+      return;
+    }
+  }
+
   this->doEventSelection();
   this->fetchRequestedLeaves();
-  this->preAllocateMemory();
+  {
+    LoadingProfiler::ScopedTimer timer(_profiler_.getThreadProfile(0), LoadingProfiler::MemoryAllocation);
+    this->preAllocateMemory();
+  }
   this->readAndFill();
 
+  if( not _cache_.eventCacheFilePath.empty() ){
+    LoadingProfiler::ScopedTimer timer(_profiler_.getThreadProfile(0), LoadingProfiler::EventCache);
+    this->writeEventCache();
+  }
+
+  finalizeProfile();
   LogWarning << "Loaded " << getTitle() << std::endl;
 }
 std::string DataDispenser::getTitle(){
@@ -210,6 +248,7 @@ void DataDispenser::doEventSelection(){
   // how meaning buffers?
   int nThreads{GundamGlobals::getNumberOfThreads()};
   if( _owner_->isDevSingleThreadEventSelection() ) { nThreads = 1; }
+  _profiler_.setNbThreads( nThreads );
 
   Long64_t nEntries{0};
   {
@@ -395,6 +434,13 @@ void DataDispenser::fetchRequestedLeaves(){
     }
   }
 
+  // the transformations used for indexing are evaluated on events holding
+  // the indexing variables: their inputs can be looked up once for all
+  for( auto& varTransform : _cache_.eventVarTransformList ){
+    if( not GenericToolbox::doesElementIsInVector(varTransform.getOutputVariableName(), _cache_.varsRequestedForIndexing) ){ continue; }
+    varTransform.buildInputIndexDict( _cache_.varsRequestedForIndexing );
+  }
+
 }
 void DataDispenser::preAllocateMemory(){
   LogInfo << "Pre-allocating memory..." << std::endl;
@@ -449,6 +495,9 @@ void DataDispenser::preAllocateMemory(){
     _cache_.sampleEventListPtrToFill[iSample] = &container->getEventList();
     _cache_.sampleIndexOffsetList[iSample] = _cache_.sampleEventListPtrToFill[iSample]->size();
     container->reserveEventMemory(_owner_->getDataSetIndex(), _cache_.sampleNbOfEvents[iSample], eventPlaceholder);
+    if( _parameters_.useMcContainer and _cache_.propagatorPtr->isKeepDoubleBaseWeights() ){
+      container->getDoubleBaseWeightList().resize( container->getEventList().size(), 0 );
+    }
   }
 
   LogInfo << "Filling var index cache for bin edges..." << std::endl;
@@ -504,6 +553,8 @@ void DataDispenser::preAllocateMemory(){
       _cache_.propagatorPtr->getEventDialCache().allocateCacheEntries(_cache_.totalNbEvents, 0);
     }
   }
+
+  if( not _cache_.eventCacheFilePath.empty() ){ this->prepareEventCacheRecording( leafFormToVarList ); }
 }
 void DataDispenser::readAndFill(){
   LogWarning << "Reading dataset and loading..." << std::endl;
@@ -518,14 +569,20 @@ void DataDispenser::readAndFill(){
   LogWarning << "Loading and indexing..." << std::endl;
   if(not _owner_->isDevSingleThreadEventLoaderAndIndexer() and GundamGlobals::getNumberOfThreads() > 1 ){
     ROOT::EnableThreadSafety(); // EXTREMELY IMPORTANT
+    _profiler_.setNbThreads( GundamGlobals::getNumberOfThreads() );
+    this->reserveThreadFillRanges( GundamGlobals::getNumberOfThreads() );
     _threadPool_.addJob(__METHOD_NAME__, [&](int iThread_){ this->fillFunction(iThread_); });
     _threadPool_.runJob(__METHOD_NAME__);
     _threadPool_.removeJob(__METHOD_NAME__);
   }
   else{
+    this->reserveThreadFillRanges( 1 );
     this->fillFunction(-1); // for better debug breakdown
   }
 
+  LoadingProfiler::ScopedTimer compactionTimer(_profiler_.getThreadProfile(0), LoadingProfiler::Compaction);
+  this->compactThreadFillRanges();
+
   LogInfo << "Shrinking lists..." << std::endl;
   for( size_t iSample = 0 ; iSample < _cache_.samplesToFillList.size() ; iSample++ ){
     auto* container = &_cache_.samplesToFillList[iSample]->getDataContainer();
@@ -534,6 +591,96 @@ void DataDispenser::readAndFill(){
   }
 
 }
+void DataDispenser::reserveThreadFillRanges(int nThreads_){
+  // Each thread reads a contiguous range of entries (see fillFunction). The
+  // selection tells how many of them can end up in each sample, which is the
+  // number of slots reserved for the thread.
+  size_t nSamples{_cache_.samplesToFillList.size()};
+  Long64_t nEntries{Long64_t(_cache_.eventIsInSamplesList.size())};
+
+  _cache_.threadFillRangeList.clear();
+  _cache_.threadFillRangeList.resize(nThreads_);
+
+  std::vector<size_t> sampleEventBegin{_cache_.sampleIndexOffsetList};
+  size_t cacheEntryBegin{0};
+  if( _parameters_.useMcContainer ){
+    cacheEntryBegin = _cache_.propagatorPtr->getEventDialCache().getFillIndex();
+    _cache_.debugNbEventsLoaded = cacheEntryBegin;
+  }
+
+  for( int iThread = 0 ; iThread < nThreads_ ; iThread++ ){
+    auto& fillRange = _cache_.threadFillRangeList[iThread];
+    fillRange.sampleEventBegin = sampleEventBegin;
+    fillRange.sampleNbEvents.resize(nSamples, 0);
+    fillRange.cacheEntryBegin = cacheEntryBegin;
+
+    auto bounds = GenericToolbox::ParallelWorker::getThreadBoundIndices( iThread, nThreads_, nEntries );
+    for( Long64_t iEntry = bounds.beginIndex ; iEntry < bounds.endIndex ; iEntry++ ){
+      for( size_t iSample = 0 ; iSample < nSamples ; iSample++ ){
+        if( not _cache_.eventIsInSamplesList[iEntry][iSample] ){ continue; }
+        sampleEventBegin[iSample]++;
+        cacheEntryBegin++;
+      }
+    }
+  }
+
+  if( _parameters_.useMcContainer ){
+    auto& eventDialCache = _cache_.propagatorPtr->getEventDialCache();
+    eventDialCache.reserveCacheEntries( cacheEntryBegin - eventDialCache.getFillIndex() );
+  }
+}
+void DataDispenser::compactThreadFillRanges(){
+  // Events rejected while filling (no bin, null weight) leave holes at the
+  // end of the thread ranges: move the events down so they are contiguous and
+  // in the entry order, whatever the number of threads.
+  size_t nSamples{_cache_.samplesToFillList.size()};
+  std::vector<std::vector<size_t>> eventShiftList(_cache_.threadFillRangeList.size(), std::vector<size_t>(nSamples, 0));
+
+  for( size_t iSample = 0 ; iSample < nSamples ; iSample++ ){
+    auto& eventList = *_cache_.sampleEventListPtrToFill[iSample];
+    std::vector<double> noDoubleBaseWeightList{};
+    auto& doubleBaseWeightList = _parameters_.useMcContainer ?
+        _cache_.samplesToFillList[iSample]->getMcContainer().getDoubleBaseWeightList() : noDoubleBaseWeightList;
+    size_t writeIndex{_cache_.sampleIndexOffsetList[iSample]};
+    for( size_t iThread = 0 ; iThread < _cache_.threadFillRangeList.size() ; iThread++ ){
+      auto& fillRange = _cache_.threadFillRangeList[iThread];
+      size_t readIndex{fillRange.sampleEventBegin[iSample]};
+      eventShiftList[iThread][iSample] = readIndex - writeIndex;
+      if( readIndex != writeIndex ){
+        std::move(
+            eventList.begin() + long(readIndex),
+            eventList.begin() + long(readIndex + fillRange.sampleNbEvents[iSample]),
+            eventList.begin() + long(writeIndex)
+        );
+        if( not doubleBaseWeightList.empty() ){
+          std::move(
+              doubleBaseWeightList.begin() + long(readIndex),
+              doubleBaseWeightList.begin() + long(readIndex + fillRange.sampleNbEvents[iSample]),
+              doubleBaseWeightList.begin() + long(writeIndex)
+          );
+        }
+      }
+      writeIndex += fillRange.sampleNbEvents[iSample];
+    }
+    _cache_.sampleIndexOffsetList[iSample] = writeIndex;
+  }
+
+  if( not _parameters_.useMcContainer ){ return; }
+
+  // the unused cache entries are skipped by EventDialCache::buildReferenceCache
+  std::vector<size_t> sampleSlotList(_cache_.propagatorPtr->getSampleSet().getSampleList().size(), 0);
+  for( size_t iSample = 0 ; iSample < nSamples ; iSample++ ){
+    sampleSlotList[_cache_.samplesToFillList[iSample]->getIndex()] = iSample;
+  }
+  auto& eventDialCache = _cache_.propagatorPtr->getEventDialCache();
+  for( size_t iThread = 0 ; iThread < _cache_.threadFillRangeList.size() ; iThread++ ){
+    auto& fillRange = _cache_.threadFillRangeList[iThread];
+    for( size_t iEntry = 0 ; iEntry < fillRange.nbCacheEntries ; iEntry++ ){
+      auto* entry = eventDialCache.getCacheEntryPtr(fillRange.cacheEntryBegin + iEntry);
+      entry->event.eventIndex -= eventShiftList[iThread][sampleSlotList[entry->event.sampleIndex]];
+    }
+  }
+}
 void DataDispenser::loadFromHistContent(){
   LogWarning << "Creating dummy PhysicsEvent entries for loading hist content" << std::endl;
 
@@ -633,6 +780,361 @@ void DataDispenser::loadFromHistContent(){
   fHist->Close();
 }
 
+void DataDispenser::buildEventCacheKey(){
+  // Everything that can change the loaded events enters the key: the config of
+  // this dispenser (after the <I_TOY> substitutions), the propagator config
+  // (samples, binning, dials) and the metadata of the input files.
+  // Note: the content of external files (binning, splines) is not hashed.
+  uint64_t key{EventCacheFile::hashString(GundamUtils::getVersionFullStr())};
+  key = EventCacheFile::hashString(_config_.dump(), key);
+  key = EventCacheFile::hashString(_cache_.propagatorPtr->getConfig().dump(), key);
+  key = EventCacheFile::hashString(getTitle() + ":" + std::to_string(_owner_->getDataSetIndex()), key);
+  key = EventCacheFile::hashString(std::to_string(_parameters_.useMcContainer), key);
+  key = EventCacheFile::hashString(_parameters_.dialIndexFormula, key);
+  key = EventCacheFile::hashString(_parameters_.nominalWeightFormulaStr, key);
+  key = EventCacheFile::hashString(_parameters_.selectionCutFormulaStr, key);
+  for( auto& entry : _parameters_.variableDict ){
+    key = EventCacheFile::hashString(entry.first + "=" + entry.second, key);
+  }
+  for( auto* samplePtr : _cache_.samplesToFillList ){
+    key = EventCacheFile::hashString(samplePtr->getName() + ":" + samplePtr->getSelectionCutsStr(), key);
+  }
+  for( const auto& file : _parameters_.filePathList ){
+    key = EventCacheFile::hashFileMetadata(GenericToolbox::expandEnvironmentVariables(file), key);
+  }
+  _cache_.eventCacheKey = key;
+
+  // a new key gives a new file: an outdated cache is never picked up
+  std::string fileName{getTitle()};
+  GenericToolbox::replaceSubstringInsideInputString(fileName, "/", "_");
+  std::stringstream ss;
+  ss << fileName << "_" << std::hex << key << ".gundamcache";
+  _cache_.eventCacheFilePath = GenericToolbox::joinPath(
+      GenericToolbox::expandEnvironmentVariables(_parameters_.eventCacheDir), ss.str()
+  );
+}
+void DataDispenser::prepareEventCacheRecording(const std::vector<const GenericToolbox::LeafForm*>& leafFormStorageList_){
+
+  for( auto* leafForm : leafFormStorageList_ ){
+    if( leafForm->isPointerLeaf() ){
+      LogAlert << "Event cache disabled: stored variable \"" << leafForm->getPrimaryExprStr() << "\" is not a plain type." << std::endl;
+      _cache_.eventCacheFilePath.clear();
+      return;
+    }
+    _cache_.varsStorageLeafTypeList.emplace_back( leafForm->getLeafTypeName() );
+  }
+
+  _cache_.sampleEventOffsetList = _cache_.sampleIndexOffsetList;
+
+  if( not _parameters_.useMcContainer ){ return; }
+
+  _cache_.dialCacheFillIndexBegin = _cache_.propagatorPtr->getEventDialCache().getFillIndex();
+
+  // event-by-event dials are rebuilt from their initializer (TGraph, TSpline3...)
+  _cache_.dialInitializerList.resize( _cache_.propagatorPtr->getDialCollectionList().size() );
+  for( auto* dialCollection : _cache_.dialCollectionsRefList ){
+    if( not dialCollection->isEventByEvent() ){ continue; }
+    if( dialCollection->getGlobalDialType() == "Tabulated" ){
+      // those are made out of the indexing variables which are not stored
+      LogAlert << "Event cache disabled: " << dialCollection->getTitle() << " is a tabulated dial." << std::endl;
+      _cache_.eventCacheFilePath.clear();
+      _cache_.dialInitializerList.clear();
+      return;
+    }
+    _cache_.dialInitializerList[dialCollection->getIndex()].resize( dialCollection->getDialBaseList().size() );
+  }
+}
+bool DataDispenser::loadFromEventCache(){
+
+  EventCacheFile::Reader reader(_cache_.eventCacheFilePath, _cache_.eventCacheKey);
+  if( not reader.isOpen() ){
+    LogInfo << "Event cache will be written to: " << _cache_.eventCacheFilePath << std::endl;
+    return false;
+  }
+
+  LogWarning << "Reading event cache: " << _cache_.eventCacheFilePath << std::endl;
+
+  // still needed for the variable names and the dial collections
+  this->fetchRequestedLeaves();
+
+  Event eventPlaceholder;
+  eventPlaceholder.getIndices().dataset = _owner_->getDataSetIndex();
+  eventPlaceholder.getVariables().setVarNameList( std::make_shared<std::vector<std::string>>(_cache_.varsRequestedForStorage) );
+
+  auto nVars = reader.read<uint64_t>();
+  LogThrowIf(nVars != _cache_.varsRequestedForStorage.size(), "Event cache doesn't have the requested variables.");
+  for( size_t iVar = 0 ; iVar < nVars ; iVar++ ){
+    auto varName = reader.readString();
+    LogThrowIf(varName != _cache_.varsRequestedForStorage[iVar], "Unexpected variable in the event cache: " << varName);
+    eventPlaceholder.getVariables().setVarType( iVar, GenericToolbox::leafToAnyType( reader.readString() ) );
+  }
+
+  auto nSamples = reader.read<uint64_t>();
+  LogThrowIf(nSamples != _cache_.samplesToFillList.size(), "Event cache doesn't have the requested samples.");
+  _cache_.sampleNbOfEvents.resize(nSamples, 0);
+  _cache_.sampleEventOffsetList.resize(nSamples, 0);
+  for( size_t iSample = 0 ; iSample < nSamples ; iSample++ ){
+    auto* samplePtr = _cache_.samplesToFillList[iSample];
+    LogThrowIf(reader.readString() != samplePtr->getName(), "Unexpected sample in the event cache.");
+
+    uint64_t nEvents{0};
+    const auto* entryColumn = reader.readColumn<Long64_t>(nEvents);
+    const auto* binColumn = reader.readColumn<int>(nEvents);
+    const auto* baseWeightColumn = reader.readColumn<double>(nEvents);
+
+    std::vector<uint64_t> varSizeList(nVars);
+    std::vector<const char*> varColumnList(nVars);
+    for( size_t iVar = 0 ; iVar < nVars ; iVar++ ){
+      varSizeList[iVar] = reader.read<uint64_t>();
+      varColumnList[iVar] = reader.readColumn( nEvents*varSizeList[iVar] );
+    }
+
+    auto* container = &samplePtr->getDataContainer();
+    if(_parameters_.useMcContainer) container = &samplePtr->getMcContainer();
+
+    _cache_.sampleNbOfEvents[iSample] = nEvents;
+    _cache_.sampleEventOffsetList[iSample] = container->getEventList().size();
+    _cache_.totalNbEvents += nEvents;
+    container->reserveEventMemory(_owner_->getDataSetIndex(), nEvents, eventPlaceholder);
+
+    // the base weights are stored as double in the event cache
+    if( _parameters_.useMcContainer and _cache_.propagatorPtr->isKeepDoubleBaseWeights() ){
+      auto& doubleBaseWeightList = container->getDoubleBaseWeightList();
+      doubleBaseWeightList.resize( container->getEventList().size(), 0 );
+      std::copy( baseWeightColumn, baseWeightColumn + nEvents, doubleBaseWeightList.begin() + long(_cache_.sampleEventOffsetList[iSample]) );
+    }
+
+    auto* eventList = &container->getEventList()[_cache_.sampleEventOffsetList[iSample]];
+    auto fillEventsFct = [&](int iThread_){
+      int nThreads = GundamGlobals::getNumberOfThreads();
+      if( iThread_ == -1 ){ iThread_ = 0; nThreads = 1; }
+      auto bounds = GenericToolbox::ParallelWorker::getThreadBoundIndices( iThread_, nThreads, nEvents );
+      for( auto iEvent = bounds.beginIndex ; iEvent < bounds.endIndex ; iEvent++ ){
+        auto& event = eventList[iEvent];
+        event.getIndices().entry = entryColumn[iEvent];
+        event.getIndices().sample = samplePtr->getIndex();
+        event.getIndices().bin = binColumn[iEvent];
+        event.getWeights().base = baseWeightColumn[iEvent];
+        event.getWeights().resetCurrentWeight();
+        for( size_t iVar = 0 ; iVar < nVars ; iVar++ ){
+          event.getVariables().getVariable(iVar).setRawData(
+              varColumnList[iVar] + iEvent*varSizeList[iVar], varSizeList[iVar]
+          );
+        }
+      }
+    };
+    _threadPool_.addJob(__METHOD_NAME__, fillEventsFct);
+    _threadPool_.runJob(__METHOD_NAME__);
+    _threadPool_.removeJob(__METHOD_NAME__);
+
+    LogInfo << samplePtr->getName() << ": " << nEvents << " events loaded." << std::endl;
+  }
+
+  if( not _parameters_.useMcContainer ){ return true; }
+
+  uint64_t nEntries{0};
+  uint64_t nDialOffsets{0}; // nEntries+1
+  uint64_t nDials{0};
+  const auto* sampleSlotColumn = reader.readColumn<uint32_t>(nEntries);
+  const auto* eventIndexColumn = reader.readColumn<uint64_t>(nEntries);
+  const auto* dialOffsetColumn = reader.readColumn<uint64_t>(nDialOffsets);
+  const auto* collectionIndexColumn = reader.readColumn<uint32_t>(nDials);
+  const auto* interfaceIndexColumn = reader.readColumn<uint64_t>(nDials);
+
+  // rebuild the event-by-event dials: the interface index refers to the
+  // initializer in the cache and is translated to the dial slot
+  ROOT::EnableThreadSafety(); // the initializers are read in parallel
+  auto& dialCollectionList = _cache_.propagatorPtr->getDialCollectionList();
+  std::vector<std::vector<size_t>> dialSlotList(dialCollectionList.size());
+  auto nEventByEventCollections = reader.read<uint64_t>();
+  for( size_t iEbe = 0 ; iEbe < nEventByEventCollections ; iEbe++ ){
+    auto& dialCollection = dialCollectionList[reader.read<uint32_t>()];
+    uint64_t nOffsets{0};
+    uint64_t nBytes{0};
+    const auto* offsetColumn = reader.readColumn<uint64_t>(nOffsets);
+    const auto* dataColumn = reader.readColumn<char>(nBytes);
+
+    size_t nObjects{nOffsets - 1};
+    LogInfo << dialCollection.getTitle() << ": rebuilding " << nObjects << " "
+            << dialCollection.getGlobalDialType() << " dials" << std::endl;
+    dialCollection.getDialBaseList().resize( dialCollection.getDialBaseList().size() + nObjects );
+    auto& slotList = dialSlotList[dialCollection.getIndex()];
+    slotList.resize(nObjects);
+
+    auto buildDialsFct = [&](int iThread_){
+      int nThreads = GundamGlobals::getNumberOfThreads();
+      if( iThread_ == -1 ){ iThread_ = 0; nThreads = 1; }
+      auto bounds = GenericToolbox::ParallelWorker::getThreadBoundIndices( iThread_, nThreads, nObjects );
+      DialBaseFactory factory{};
+      factory.setDialArena( &dialCollection.getDialArena() );
+      for( auto iObject = bounds.beginIndex ; iObject < bounds.endIndex ; iObject++ ){
+        auto initializer = EventCacheFile::deserializeObject(
+            dataColumn + offsetColumn[iObject], offsetColumn[iObject+1] - offsetColumn[iObject]
+        );
+        // built in the arena of the collection, which keeps the ownership
+        DialBase* dialBase{
+            factory.makeDial(
+                dialCollection.getTitle(),
+                dialCollection.getGlobalDialType(),
+                dialCollection.getGlobalDialSubType(),
+                initializer.get(),
+                false
+            )
+        };
+        LogThrowIf(dialBase == nullptr, "Could not rebuild dial from the event cache for " << dialCollection.getTitle());
+        size_t freeSlotDial = dialCollection.getNextDialFreeSlot();
+        dialBase->setAllowExtrapolation(dialCollection.isAllowDialExtrapolation());
+        dialCollection.setEventByEventDial(freeSlotDial, dialBase);
+        slotList[iObject] = freeSlotDial;
+      }
+    };
+    _threadPool_.addJob(__METHOD_NAME__, buildDialsFct);
+    _threadPool_.runJob(__METHOD_NAME__);
+    _threadPool_.removeJob(__METHOD_NAME__);
+  }
+
+  LogInfo << "Creating " << nEntries << " event cache slots." << std::endl;
+  auto& eventDialCache = _cache_.propagatorPtr->getEventDialCache();
+  eventDialCache.allocateCacheEntries(nEntries, _cache_.dialCollectionsRefList.size());
+  for( size_t iEntry = 0 ; iEntry < nEntries ; iEntry++ ){
+    auto* eventDialCacheEntry = eventDialCache.fetchNextCacheEntry();
+    auto iSample = sampleSlotColumn[iEntry];
+    eventDialCacheEntry->event.sampleIndex = std::size_t(_cache_.samplesToFillList[iSample]->getIndex());
+    eventDialCacheEntry->event.eventIndex = _cache_.sampleEventOffsetList[iSample] + eventIndexColumn[iEntry];
+
+    auto* dialEntryPtr = &eventDialCacheEntry->dials[0];
+    for( auto iDial = dialOffsetColumn[iEntry] ; iDial < dialOffsetColumn[iEntry+1] ; iDial++ ){
+      dialEntryPtr->collectionIndex = collectionIndexColumn[iDial];
+      dialEntryPtr->interfaceIndex = interfaceIndexColumn[iDial];
+      if( dialCollectionList[collectionIndexColumn[iDial]].isEventByEvent() ){
+        dialEntryPtr->interfaceIndex = dialSlotList[collectionIndexColumn[iDial]][interfaceIndexColumn[iDial]];
+      }
+      dialEntryPtr++;
+    }
+  }
+
+  return true;
+}
+void DataDispenser::writeEventCache(){
+  LogInfo << "Writing event cache: " << _cache_.eventCacheFilePath << std::endl;
+
+  std::string cacheDir{GenericToolbox::getFolderPath(_cache_.eventCacheFilePath)};
+  if( not cacheDir.empty() and not GenericToolbox::isDir(cacheDir) ){ GenericToolbox::mkdir(cacheDir); }
+
+  EventCacheFile::Writer writer(_cache_.eventCacheFilePath);
+  writer.writeHeader(_cache_.eventCacheKey);
+
+  // layout of the stored variables
+  writer.write(uint64_t(_cache_.varsRequestedForStorage.size()));
+  for( size_t iVar = 0 ; iVar < _cache_.varsRequestedForStorage.size() ; iVar++ ){
+    writer.writeString(_cache_.varsRequestedForStorage[iVar]);
+    writer.writeString(_cache_.varsStorageLeafTypeList[iVar]);
+  }
+
+  // one set of columns per sample
+  writer.write(uint64_t(_cache_.samplesToFillList.size()));
+  for( size_t iSample = 0 ; iSample < _cache_.samplesToFillList.size() ; iSample++ ){
+    writer.writeString(_cache_.samplesToFillList[iSample]->getName());
+
+    const auto& eventList = *_cache_.sampleEventListPtrToFill[iSample];
+    size_t eventOffset{_cache_.sampleEventOffsetList[iSample]};
+    size_t nEvents{_cache_.sampleIndexOffsetList[iSample] - eventOffset};
+
+    std::vector<Long64_t> entryColumn(nEvents);
+    std::vector<int> binColumn(nEvents);
+    std::vector<double> baseWeightColumn(nEvents);
+    const auto& container = _cache_.samplesToFillList[iSample]->getMcContainer();
+    for( size_t iEvent = 0 ; iEvent < nEvents ; iEvent++ ){
+      const auto& event = eventList[eventOffset + iEvent];
+      entryColumn[iEvent] = event.getIndices().entry;
+      binColumn[iEvent] = event.getIndices().bin;
+      baseWeightColumn[iEvent] = _parameters_.useMcContainer ? container.getDoubleBaseWeight(event) : double(event.getWeights().base);
+    }
+    writer.writeColumn(entryColumn);
+    writer.writeColumn(binColumn);
+    writer.writeColumn(baseWeightColumn);
+
+    std::vector<char> varColumn;
+    for( size_t iVar = 0 ; iVar < _cache_.varsRequestedForStorage.size() ; iVar++ ){
+      size_t varSize{0};
+      if( nEvents != 0 ){ varSize = eventList[eventOffset].getVariables().getVariable(iVar).getRawDataSize(); }
+      varColumn.resize(nEvents*varSize);
+      for( size_t iEvent = 0 ; iEvent < nEvents ; iEvent++ ){
+        memcpy(
+            &varColumn[iEvent*varSize],
+            eventList[eventOffset + iEvent].getVariables().getVariable(iVar).getRawDataPtr(),
+            varSize
+        );
+      }
+      writer.write(uint64_t(varSize));
+      writer.writeColumn(varColumn.data(), varColumn.size());
+    }
+  }
+
+  if( _parameters_.useMcContainer ){
+    const auto& dialCollectionList = _cache_.propagatorPtr->getDialCollectionList();
+    const auto& indexedCache = _cache_.propagatorPtr->getEventDialCache().getIndexedCache();
+    size_t endIndex{_cache_.propagatorPtr->getEventDialCache().getFillIndex()};
+
+    std::vector<uint32_t> sampleSlotColumn;
+    std::vector<uint64_t> eventIndexColumn;
+    std::vector<uint64_t> dialOffsetColumn{0};
+    std::vector<uint32_t> collectionIndexColumn;
+    std::vector<uint64_t> interfaceIndexColumn;
+
+    // the event-by-event dials are referred to by the index of their initializer
+    std::vector<std::vector<uint64_t>> initializerOffsetList(dialCollectionList.size(), std::vector<uint64_t>{0});
+    std::vector<std::string> initializerDataList(dialCollectionList.size());
+
+    for( size_t iEntry = _cache_.dialCacheFillIndexBegin ; iEntry < endIndex ; iEntry++ ){
+      const auto& entry = indexedCache[iEntry];
+      if( entry.event.sampleIndex == std::size_t(-1) ){ continue; } // rejected while filling
+
+      size_t iSample{0};
+      while( size_t(_cache_.samplesToFillList[iSample]->getIndex()) != entry.event.sampleIndex ){ iSample++; }
+      sampleSlotColumn.emplace_back(iSample);
+      eventIndexColumn.emplace_back(entry.event.eventIndex - _cache_.sampleEventOffsetList[iSample]);
+
+      for( const auto& dial : entry.dials ){
+        if( dial.collectionIndex == std::size_t(-1) ){ break; } // filled from the front
+        collectionIndexColumn.emplace_back(dial.collectionIndex);
+        if( not dialCollectionList[dial.collectionIndex].isEventByEvent() ){
+          interfaceIndexColumn.emplace_back(dial.interfaceIndex);
+          continue;
+        }
+        auto& offsetList = initializerOffsetList[dial.collectionIndex];
+        interfaceIndexColumn.emplace_back(offsetList.size() - 1);
+        initializerDataList[dial.collectionIndex] += _cache_.dialInitializerList[dial.collectionIndex][dial.interfaceIndex];
+        offsetList.emplace_back(initializerDataList[dial.collectionIndex].size());
+      }
+      dialOffsetColumn.emplace_back(collectionIndexColumn.size());
+    }
+
+    writer.writeColumn(sampleSlotColumn);
+    writer.writeColumn(eventIndexColumn);
+    writer.writeColumn(dialOffsetColumn);
+    writer.writeColumn(collectionIndexColumn);
+    writer.writeColumn(interfaceIndexColumn);
+
+    std::vector<uint32_t> eventByEventList;
+    for( auto* dialCollection : _cache_.dialCollectionsRefList ){
+      if( dialCollection->isEventByEvent() ){ eventByEventList.emplace_back(dialCollection->getIndex()); }
+    }
+    writer.write(uint64_t(eventByEventList.size()));
+    for( auto iCollection : eventByEventList ){
+      writer.write(iCollection);
+      writer.writeColumn(initializerOffsetList[iCollection]);
+      writer.write(uint64_t(initializerDataList[iCollection].size()));
+      writer.writeColumn(initializerDataList[iCollection].data(), initializerDataList[iCollection].size());
+    }
+  }
+
+  writer.close();
+
+  // the initializers are not needed anymore
+  _cache_.dialInitializerList.clear();
+}
+
 std::unique_ptr<TChain> DataDispenser::openChain(bool verbose_){
   LogInfoIf(verbose_) << "Opening ROOT files containing events..." << std::endl;
 
@@ -655,6 +1157,9 @@ void DataDispenser::eventSelectionFunction(int iThread_){
   int nThreads{GundamGlobals::getNumberOfThreads()};
   if( iThread_ == -1 ){ iThread_ = 0; nThreads = 1; }
 
+  auto& profile = _profiler_.getThreadProfile(iThread_);
+  LoadingProfiler::ScopedTimer selectionTimer(profile, LoadingProfiler::EventSelection);
+
   // Opening ROOT file...
   auto treeChain{this->openChain(false)};
 
@@ -663,11 +1168,64 @@ void DataDispenser::eventSelectionFunction(int iThread_){
 
   LogInfoIf(iThread_ == 0) << "Defining selection formulas..." << std::endl;
 
+  // The cuts only using scalar numerical leaves are compiled: these leaves
+  // are read in columns and the cuts are evaluated over batches of entries.
+  // The other ones are evaluated entry by entry with TTreeFormula.
+  struct SelectionCut{
+    std::string expression{};
+    int leafFormIndex{-1};
+    CompiledFormula compiledFormula{};
+    std::vector<int> columnIndexList{}; // [formula variable]
+    std::vector<double> resultList{}; // [entry of the batch]
+  };
+  std::vector<SelectionCut> selectionCutList;
+  selectionCutList.reserve( 1 + _cache_.samplesToFillList.size() );
+  std::vector<int> columnLeafFormIndexList;
+  std::vector<std::string> columnLeafNameList;
+
+  auto isScalarNumericalLeaf = [&](const std::string& leafName_){
+    static const std::vector<std::string> numericalTypeList{
+        "Double_t", "Float_t", "Int_t", "UInt_t", "Short_t", "UShort_t",
+        "Long64_t", "ULong64_t", "Long_t", "ULong_t", "UChar_t", "Bool_t"
+    };
+    auto* leaf = treeChain->GetLeaf( leafName_.c_str() );
+    if( leaf == nullptr or leaf->InheritsFrom("TLeafElement") ){ return false; }
+    if( leaf->GetLeafCount() != nullptr or leaf->GetLenStatic() != 1 ){ return false; }
+    return GenericToolbox::doesElementIsInVector( std::string(leaf->GetTypeName()), numericalTypeList );
+  };
+  auto defineSelectionCut = [&](const std::string& expression_){
+    selectionCutList.emplace_back();
+    auto& selectionCut = selectionCutList.back();
+    selectionCut.expression = expression_;
+
+    if( selectionCut.compiledFormula.compile( expression_, CompiledFormula::Syntax::TTreeFormula ) ){
+      auto& leafNameList = selectionCut.compiledFormula.getVariableNameList();
+      if( not std::all_of(leafNameList.begin(), leafNameList.end(), isScalarNumericalLeaf) ){ selectionCut.compiledFormula = CompiledFormula(); }
+    }
+
+    if( not selectionCut.compiledFormula.isValid() ){
+      selectionCut.leafFormIndex = lCollection.addLeafExpression( expression_ );
+    }
+    else{
+      for( auto& leafName : selectionCut.compiledFormula.getVariableNameList() ){
+        int columnIndex{GenericToolbox::findElementIndex(leafName, columnLeafNameList)};
+        if( columnIndex == -1 ){
+          columnIndex = int(columnLeafNameList.size());
+          columnLeafNameList.emplace_back( leafName );
+          columnLeafFormIndexList.emplace_back( lCollection.addLeafExpression(leafName) );
+        }
+        selectionCut.columnIndexList.emplace_back( columnIndex );
+      }
+    }
+    LogDebugIf(iThread_ == 0) << "Selection cut: " << selectionCut.compiledFormula.getSummary() << std::endl;
+    return int(selectionCutList.size()) - 1;
+  };
+
   // global cut
-  int selectionCutLeafFormIndex{-1};
+  int globalCutIndex{-1};
   if( not _parameters_.selectionCutFormulaStr.empty() ){
     LogInfoIf(iThread_ == 0) << "Global selection cut: \"" << _parameters_.selectionCutFormulaStr << "\"" << std::endl;
-    selectionCutLeafFormIndex = lCollection.addLeafExpression( _parameters_.selectionCutFormulaStr );
+    globalCutIndex = defineSelectionCut( _parameters_.selectionCutFormulaStr );
   }
 
   // sample cuts
@@ -692,11 +1250,16 @@ void DataDispenser::eventSelectionFunction(int iThread_){
 
     if( selectionCut.empty() ){ continue; }
 
-    sampleCutList.back().cutIndex = lCollection.addLeafExpression( selectionCut );
+    sampleCutList.back().cutIndex = defineSelectionCut( selectionCut );
   }
 
   lCollection.initialize();
 
+  LogInfoIf(iThread_ == 0) << std::count_if(
+      selectionCutList.begin(), selectionCutList.end(),
+      [](const SelectionCut& cut_){ return cut_.compiledFormula.isValid(); }
+  ) << "/" << selectionCutList.size() << " selection cuts compiled." << std::endl;
+
   GenericToolbox::VariableMonitor readSpeed("bytes");
 
   // Multi-thread index splitting
@@ -708,79 +1271,141 @@ void DataDispenser::eventSelectionFunction(int iThread_){
   // Load the branches
   treeChain->LoadTree( bounds.beginIndex );
 
+  const Long64_t batchSize{256};
+  std::vector<std::vector<double>> columnList( columnLeafFormIndexList.size(), std::vector<double>(batchSize) );
+  std::vector<const double*> formulaColumnList;
+  for( auto& selectionCut : selectionCutList ){ selectionCut.resultList.resize(batchSize); }
+
+  // If some sample cuts can't be compiled, they are evaluated while reading
+  // the entries.  The global cut is then evaluated entry by entry too, so
+  // these sample cuts are skipped for the rejected entries.
+  bool isGlobalCutPerEntry{false};
+  std::vector<double> globalCutInputList;
+  if( globalCutIndex != -1 ){
+    isGlobalCutPerEntry = std::any_of(
+        selectionCutList.begin(), selectionCutList.end(),
+        [](const SelectionCut& cut_){ return not cut_.compiledFormula.isValid(); }
+    );
+    globalCutInputList.resize( selectionCutList[globalCutIndex].columnIndexList.size() );
+  }
+
   // for each event, which sample is active?
   std::string progressTitle = "Performing event selection on " + this->getTitle() + "...";
   std::stringstream ssProgressTitle;
   TFile *lastFilePtr{nullptr};
 
-  for ( Long64_t iEntry = bounds.beginIndex ; iEntry < bounds.endIndex ; iEntry++ ) {
-    if( iThread_ == 0 ){
-      readSpeed.addQuantity(treeChain->GetEntry(iEntry)*nThreads);
-      if (GenericToolbox::showProgressBar(iGlobal, nEvents)) {
-        ssProgressTitle.str("");
-
-        ssProgressTitle << LogInfo.getPrefixString() << "Read from disk: "
-                        << GenericToolbox::padString(GenericToolbox::parseSizeUnits(readSpeed.getTotalAccumulated()), 8) << " ("
-                        << GenericToolbox::padString(GenericToolbox::parseSizeUnits(readSpeed.evalTotalGrowthRate()), 8) << "/s)";
-
-        int cpuPercent = int(GenericToolbox::getCpuUsageByProcess());
-        ssProgressTitle << " / CPU efficiency: " << GenericToolbox::padString(std::to_string(cpuPercent/nThreads), 3,' ')
-                        << "%" << std::endl;
+  for( Long64_t iBatchBegin = bounds.beginIndex ; iBatchBegin < bounds.endIndex ; iBatchBegin += batchSize ){
+    Long64_t nBatchEntries{std::min(batchSize, Long64_t(bounds.endIndex - iBatchBegin))};
+
+    // read the entries: fill the columns and evaluate the cuts that are not compiled
+    for( Long64_t iBatchEntry = 0 ; iBatchEntry < nBatchEntries ; iBatchEntry++ ){
+      Long64_t iEntry{iBatchBegin + iBatchEntry};
+      Int_t nBytes;
+      if( iThread_ == 0 ){
+        nBytes = treeChain->GetEntry(iEntry);
+        readSpeed.addQuantity(nBytes*nThreads);
+        if (GenericToolbox::showProgressBar(iGlobal, nEvents)) {
+          ssProgressTitle.str("");
+
+          ssProgressTitle << LogInfo.getPrefixString() << "Read from disk: "
+                          << GenericToolbox::padString(GenericToolbox::parseSizeUnits(readSpeed.getTotalAccumulated()), 8) << " ("
+                          << GenericToolbox::padString(GenericToolbox::parseSizeUnits(readSpeed.evalTotalGrowthRate()), 8) << "/s)";
+
+          int cpuPercent = int(GenericToolbox::getCpuUsageByProcess());
+          ssProgressTitle << " / CPU efficiency: " << GenericToolbox::padString(std::to_string(cpuPercent/nThreads), 3,' ')
+                          << "%" << std::endl;
+
+          ssProgressTitle << LogInfo.getPrefixString() << progressTitle;
+          GenericToolbox::displayProgressBar(iGlobal, nEvents, ssProgressTitle.str());
+        }
+        iGlobal += nThreads;
+      }
+      else{
+        nBytes = treeChain->GetEntry(iEntry);
+      }
+      profile.stageList[LoadingProfiler::EventSelection].nbBytes += nBytes;
 
-        ssProgressTitle << LogInfo.getPrefixString() << progressTitle;
-        GenericToolbox::displayProgressBar(iGlobal, nEvents, ssProgressTitle.str());
+      for( size_t iColumn = 0 ; iColumn < columnList.size() ; iColumn++ ){
+        columnList[iColumn][iBatchEntry] = lCollection.getLeafFormList()[columnLeafFormIndexList[iColumn]].evalAsDouble();
       }
-      iGlobal += nThreads;
-    }
-    else{
-      treeChain->GetEntry(iEntry);
-    }
 
-    if ( selectionCutLeafFormIndex != -1 ){
-      if( lCollection.getLeafFormList()[selectionCutLeafFormIndex].evalAsDouble() == 0 ){
-        for (size_t iSample = 0; iSample < _cache_.samplesToFillList.size(); iSample++) {
-          _cache_.threadSelectionResults[iThread_].eventIsInSamplesList[iEntry][iSample] = false;
+      // the global cut is evaluated first: the sample cuts are not needed if it fails
+      bool isRejected{false};
+      if( isGlobalCutPerEntry ){
+        auto& globalCut = selectionCutList[globalCutIndex];
+        if( globalCut.compiledFormula.isValid() ){
+          for( size_t iVar = 0 ; iVar < globalCut.columnIndexList.size() ; iVar++ ){
+            globalCutInputList[iVar] = columnList[globalCut.columnIndexList[iVar]][iBatchEntry];
+          }
+          globalCut.resultList[iBatchEntry] = globalCut.compiledFormula.eval( globalCutInputList.data() );
         }
-        if (GundamGlobals::getVerboseLevel() == VerboseLevel::INLOOP_TRACE) {
-          LogTrace << "Event #" << treeChain->GetFileNumber() << ":" << treeChain->GetReadEntry()
-                   << " rejected because of " << _parameters_.selectionCutFormulaStr << std::endl;
+        else{
+          globalCut.resultList[iBatchEntry] = lCollection.getLeafFormList()[globalCut.leafFormIndex].evalAsDouble();
         }
-        continue;
+        isRejected = ( globalCut.resultList[iBatchEntry] == 0 );
+      }
+      for( int iCut = 0 ; iCut < int(selectionCutList.size()) ; iCut++ ){
+        auto& selectionCut = selectionCutList[iCut];
+        if( iCut == globalCutIndex or selectionCut.compiledFormula.isValid() ){ continue; }
+        selectionCut.resultList[iBatchEntry] = isRejected ? 0 : lCollection.getLeafFormList()[selectionCut.leafFormIndex].evalAsDouble();
       }
     }
 
-    for( auto& sampleCut : sampleCutList ){
+    // evaluate the compiled cuts over the whole batch
+    for( int iCut = 0 ; iCut < int(selectionCutList.size()) ; iCut++ ){
+      auto& selectionCut = selectionCutList[iCut];
+      if( not selectionCut.compiledFormula.isValid() ){ continue; }
+      if( iCut == globalCutIndex and isGlobalCutPerEntry ){ continue; }
+      formulaColumnList.clear();
+      for( int columnIndex : selectionCut.columnIndexList ){ formulaColumnList.emplace_back( columnList[columnIndex].data() ); }
+      selectionCut.compiledFormula.evalBatch( formulaColumnList, size_t(nBatchEntries), selectionCut.resultList.data() );
+    }
 
-      // no cut?
-      if( sampleCut.cutIndex == -1 ){
-        _cache_.threadSelectionResults[iThread_].eventIsInSamplesList[iEntry][sampleCut.sampleIndex] = true;
-        _cache_.threadSelectionResults[iThread_].sampleNbOfEvents[sampleCut.sampleIndex]++;
-        if (GundamGlobals::getVerboseLevel() == VerboseLevel::INLOOP_TRACE) {
-          LogDebug << "Event #" << treeChain->GetFileNumber() << ":" << treeChain->GetReadEntry()
-                   << " included as sample " << sampleCut.sampleIndex << " (NO SELECTION CUT)" << std::endl;
+    for( Long64_t iBatchEntry = 0 ; iBatchEntry < nBatchEntries ; iBatchEntry++ ){
+      Long64_t iEntry{iBatchBegin + iBatchEntry};
+
+      if ( globalCutIndex != -1 ){
+        if( selectionCutList[globalCutIndex].resultList[iBatchEntry] == 0 ){
+          for (size_t iSample = 0; iSample < _cache_.samplesToFillList.size(); iSample++) {
+            _cache_.threadSelectionResults[iThread_].eventIsInSamplesList[iEntry][iSample] = false;
+          }
+          if (GundamGlobals::getVerboseLevel() == VerboseLevel::INLOOP_TRACE) {
+            LogTrace << "Event #" << iEntry << " rejected because of " << _parameters_.selectionCutFormulaStr << std::endl;
+          }
+          continue;
         }
       }
-        // pass cut?
-      else if( lCollection.getLeafFormList()[sampleCut.cutIndex].evalAsDouble() != 0 ){
-        _cache_.threadSelectionResults[iThread_].eventIsInSamplesList[iEntry][sampleCut.sampleIndex] = true;
-        _cache_.threadSelectionResults[iThread_].sampleNbOfEvents[sampleCut.sampleIndex]++;
-        if (GundamGlobals::getVerboseLevel() == VerboseLevel::INLOOP_TRACE) {
-          LogDebug << "Event #" << treeChain->GetFileNumber() << ":" << treeChain->GetReadEntry()
-                   << " included as sample " << sampleCut.sampleIndex << " because of "
-                   << lCollection.getLeafFormList()[sampleCut.cutIndex].getSummary() << std::endl;
+
+      for( auto& sampleCut : sampleCutList ){
+
+        // no cut?
+        if( sampleCut.cutIndex == -1 ){
+          _cache_.threadSelectionResults[iThread_].eventIsInSamplesList[iEntry][sampleCut.sampleIndex] = true;
+          _cache_.threadSelectionResults[iThread_].sampleNbOfEvents[sampleCut.sampleIndex]++;
+          if (GundamGlobals::getVerboseLevel() == VerboseLevel::INLOOP_TRACE) {
+            LogDebug << "Event #" << iEntry << " included as sample " << sampleCut.sampleIndex << " (NO SELECTION CUT)" << std::endl;
+          }
         }
-      }
-        // don't pass cut?
-      else {
-        if (GundamGlobals::getVerboseLevel() == VerboseLevel::INLOOP_TRACE) {
-          LogTrace << "Event #" << treeChain->GetFileNumber() << ":" << treeChain->GetReadEntry()
-                   << " rejected as sample " << sampleCut.sampleIndex << " because of "
-                   << lCollection.getLeafFormList()[sampleCut.cutIndex].getSummary() << std::endl;
+          // pass cut?
+        else if( selectionCutList[sampleCut.cutIndex].resultList[iBatchEntry] != 0 ){
+          _cache_.threadSelectionResults[iThread_].eventIsInSamplesList[iEntry][sampleCut.sampleIndex] = true;
+          _cache_.threadSelectionResults[iThread_].sampleNbOfEvents[sampleCut.sampleIndex]++;
+          if (GundamGlobals::getVerboseLevel() == VerboseLevel::INLOOP_TRACE) {
+            LogDebug << "Event #" << iEntry << " included as sample " << sampleCut.sampleIndex << " because of \""
+                     << selectionCutList[sampleCut.cutIndex].expression << "\"" << std::endl;
+          }
+        }
+          // don't pass cut?
+        else {
+          if (GundamGlobals::getVerboseLevel() == VerboseLevel::INLOOP_TRACE) {
+            LogTrace << "Event #" << iEntry << " rejected as sample " << sampleCut.sampleIndex << " because of \""
+                     << selectionCutList[sampleCut.cutIndex].expression << "\"" << std::endl;
+          }
         }
       }
     }
 
-  } // iEvent
+  } // iBatchBegin
 
   if( iThread_ == 0 ){ GenericToolbox::displayProgressBar(nEvents, nEvents, ssProgressTitle.str()); }
 
@@ -790,6 +1415,8 @@ void DataDispenser::fillFunction(int iThread_){
   int nThreads = GundamGlobals::getNumberOfThreads();
   if( iThread_ == -1 ){ iThread_ = 0; nThreads = 1; } // special mode
 
+  auto& profile = _profiler_.getThreadProfile(iThread_);
+
   auto treeChain = this->openChain();
 
   GenericToolbox::LeafCollection lCollection;
@@ -842,6 +1469,9 @@ void DataDispenser::fillFunction(int iThread_){
   for( auto& lfInd: leafFormIndexingList ){ lfInd = &(lCollection.getLeafFormList()[(size_t) lfInd]); }
   for( auto& lfSto: leafFormStorageList ){ lfSto = &(lCollection.getLeafFormList()[(size_t) lfSto]); }
 
+  // variable indices of the compiled apply conditions (filled on the first event)
+  std::vector<std::vector<int>> applyConditionIndexDictList(_cache_.dialCollectionsRefList.size());
+
   // Event Var Transform
   auto eventVarTransformList = _cache_.eventVarTransformList; // copy for cache
   std::vector<EventVarTransformLib*> varTransformForIndexingList;
@@ -1006,15 +1636,26 @@ void DataDispenser::fillFunction(int iThread_){
         );
     if( not hasSample ){ continue; }
 
-    Int_t nBytes{ treeChain->GetEntry(iEntry) };
+    Int_t nBytes;
+    {
+      LoadingProfiler::ScopedTimer timer(profile, LoadingProfiler::DiskRead);
+      nBytes = treeChain->GetEntry(iEntry);
+    }
+    profile.stageList[LoadingProfiler::DiskRead].nbBytes += nBytes;
 
     // monitor
     if( iThread_ == 0 ){
       readSpeed.addQuantity(nBytes * nThreads);
     }
 
+    // the base weight might be stored in float: keep the evaluated value
+    double nominalWeight{eventIndexingBuffer.getWeights().base};
     if( nominalWeightTreeFormula != nullptr ){
-      eventIndexingBuffer.getWeights().base = (nominalWeightTreeFormula->EvalInstance());
+      {
+        LoadingProfiler::ScopedTimer timer(profile, LoadingProfiler::NominalWeight);
+        nominalWeight = nominalWeightTreeFormula->EvalInstance();
+        eventIndexingBuffer.getWeights().base = nominalWeight;
+      }
       if( eventIndexingBuffer.getWeights().base < 0 ){
         LogError << "Negative nominal weight:" << std::endl;
 
@@ -1039,41 +1680,54 @@ void DataDispenser::fillFunction(int iThread_){
       if( not _cache_.eventIsInSamplesList[iEntry][iSample] ){ continue; }
 
       // Getting loaded data in tEventBuffer
-      eventIndexingBuffer.getVariables().copyData( leafFormIndexingList );
+      {
+        LoadingProfiler::ScopedTimer timer(profile, LoadingProfiler::LeafCopy);
+        eventIndexingBuffer.getVariables().copyData( leafFormIndexingList );
+      }
 
       // Propagate variable transformations for indexing
-      for( auto* varTransformPtr : varTransformForIndexingList ){
-        varTransformPtr->evalAndStore(eventIndexingBuffer);
+      {
+        LoadingProfiler::ScopedTimer timer(profile, LoadingProfiler::VarTransform);
+        for( auto* varTransformPtr : varTransformForIndexingList ){
+          varTransformPtr->evalAndStore(eventIndexingBuffer);
+        }
       }
 
       // Look for the bin index
-      eventIndexingBuffer.fillBinIndex( _cache_.samplesToFillList[iSample]->getBinning() );
+      {
+        LoadingProfiler::ScopedTimer timer(profile, LoadingProfiler::BinLookup);
+        eventIndexingBuffer.fillBinIndex( _cache_.samplesToFillList[iSample]->getBinning() );
+      }
 
       // No bin found -> next sample
       if( eventIndexingBuffer.getIndices().bin == -1){ break; }
 
       // OK, now we have a valid fit bin. Let's claim an index.
-      // Shared index among threads
-      size_t sampleEventIndex{};
-      EventDialCache::IndexedCacheEntry* eventDialCacheEntry{nullptr};
-      {
-        std::unique_lock<std::mutex> lock(GundamGlobals::getThreadMutex());
-        if( _parameters_.useMcContainer ){
-
-          if( _parameters_.debugNbMaxEventsToLoad != 0 ){
-            // check if the limit has been reached
-            if( _cache_.propagatorPtr->getEventDialCache().getFillIndex() >= _parameters_.debugNbMaxEventsToLoad ){
-              LogAlertIf(iThread_==0) << std::endl << std::endl; // flush pBar
-              LogAlertIf(iThread_==0) << "debugNbMaxEventsToLoad: Event number cap reached (";
-              LogAlertIf(iThread_==0) << _parameters_.debugNbMaxEventsToLoad << ")" << std::endl;
-              return;
-            }
-          }
-
-          eventDialCacheEntry = _cache_.propagatorPtr->getEventDialCache().fetchNextCacheEntry();
+      // Slots are taken from the ranges reserved for this thread: no lock
+      if( _parameters_.useMcContainer and _parameters_.debugNbMaxEventsToLoad != 0 ){
+        std::unique_lock<std::mutex> lock(GundamGlobals::getThreadMutex(), std::defer_lock);
+        {
+          LoadingProfiler::ScopedTimer timer(profile, LoadingProfiler::LockWait);
+          lock.lock();
         }
-        sampleEventIndex = _cache_.sampleIndexOffsetList[iSample]++;
+        // check if the limit has been reached
+        if( _cache_.debugNbEventsLoaded >= _parameters_.debugNbMaxEventsToLoad ){
+          LogAlertIf(iThread_==0) << std::endl << std::endl; // flush pBar
+          LogAlertIf(iThread_==0) << "debugNbMaxEventsToLoad: Event number cap reached (";
+          LogAlertIf(iThread_==0) << _parameters_.debugNbMaxEventsToLoad << ")" << std::endl;
+          return;
+        }
+        _cache_.debugNbEventsLoaded++;
+      }
+
+      auto& fillRange = _cache_.threadFillRangeList[iThread_];
+      EventDialCache::IndexedCacheEntry* eventDialCacheEntry{nullptr};
+      if( _parameters_.useMcContainer ){
+        eventDialCacheEntry = _cache_.propagatorPtr->getEventDialCache().getCacheEntryPtr(
+            fillRange.cacheEntryBegin + fillRange.nbCacheEntries++
+        );
       }
+      size_t sampleEventIndex{ fillRange.sampleEventBegin[iSample] + fillRange.sampleNbEvents[iSample]++ };
 
       // Get the next free event in our buffer
       Event *eventPtr = &(*_cache_.sampleEventListPtrToFill[iSample])[sampleEventIndex];
@@ -1084,13 +1738,23 @@ void DataDispenser::fillFunction(int iThread_){
       eventPtr->getIndices().bin = eventIndexingBuffer.getIndices().bin;
       eventPtr->getWeights().base = eventIndexingBuffer.getWeights().base;
       eventPtr->getWeights().resetCurrentWeight();
+      if( _parameters_.useMcContainer ){
+        auto& doubleBaseWeightList = _cache_.samplesToFillList[iSample]->getMcContainer().getDoubleBaseWeightList();
+        if( not doubleBaseWeightList.empty() ){ doubleBaseWeightList[sampleEventIndex] = nominalWeight; }
+      }
 
       // drop the content of the leaves
-      eventPtr->getVariables().copyData( leafFormStorageList );
+      {
+        LoadingProfiler::ScopedTimer timer(profile, LoadingProfiler::LeafCopy);
+        eventPtr->getVariables().copyData( leafFormStorageList );
+      }
 
       // Propagate transformation for storage -> use the previous results calculated for indexing
-      for( auto *varTransformPtr: varTransformForStorageList ){
-        varTransformPtr->storeCachedOutput(*eventPtr);
+      {
+        LoadingProfiler::ScopedTimer timer(profile, LoadingProfiler::VarTransform);
+        for( auto *varTransformPtr: varTransformForStorageList ){
+          varTransformPtr->storeCachedOutput(*eventPtr);
+        }
       }
 
       // Now the event is ready. Let's index the dials:
@@ -1102,15 +1766,24 @@ void DataDispenser::fillFunction(int iThread_){
 
         auto* dialEntryPtr = &eventDialCacheEntry->dials[0];
 
-        for( auto *dialCollectionRef: _cache_.dialCollectionsRefList ){
+        for( size_t iDialCollection = 0 ; iDialCollection < _cache_.dialCollectionsRefList.size() ; iDialCollection++ ){
+          auto* dialCollectionRef = _cache_.dialCollectionsRefList[iDialCollection];
 
           // dial collections may come with a condition formula
-          if( dialCollectionRef->getApplyConditionFormula() != nullptr ){
-            if( eventIndexingBuffer.getVariables().evalFormula(dialCollectionRef->getApplyConditionFormula().get()) == 0 ){
-              // next dialSet
-              continue;
+          bool isConditionFailed{false};
+          {
+            LoadingProfiler::ScopedTimer timer(profile, LoadingProfiler::DialIndexing);
+            if( dialCollectionRef->getApplyConditionCompiledFormula().isValid() ){
+              isConditionFailed = eventIndexingBuffer.getVariables().evalFormula(
+                  dialCollectionRef->getApplyConditionCompiledFormula(), applyConditionIndexDictList[iDialCollection]
+              ) == 0;
+            }
+            else if( dialCollectionRef->getApplyConditionFormula() != nullptr ){
+              isConditionFailed = eventIndexingBuffer.getVariables().evalFormula(dialCollectionRef->getApplyConditionFormula().get()) == 0;
             }
           }
+          // next dialSet
+          if( isConditionFailed ){ continue; }
 
           int iCollection = dialCollectionRef->getIndex();
 
@@ -1130,7 +1803,11 @@ void DataDispenser::fillFunction(int iThread_){
               // to apply the dial to.  Check if the event falls into
               // a bin, and apply the correct binning.  Some events
               // may not be in any bin.
-              auto dialBinIdx = eventIndexingBuffer.getVariables().findBinIndex( dialCollectionRef->getDialBinSet() );
+              int dialBinIdx;
+              {
+                LoadingProfiler::ScopedTimer timer(profile, LoadingProfiler::DialIndexing);
+                dialBinIdx = eventIndexingBuffer.getVariables().findBinIndex( dialCollectionRef->getDialBinSet() );
+              }
               if( dialBinIdx != -1 ){
                 dialEntryPtr->collectionIndex = iCollection;
                 dialEntryPtr->interfaceIndex = dialBinIdx;
@@ -1143,16 +1820,20 @@ void DataDispenser::fillFunction(int iThread_){
             // can hold things like oscillation weights and is filled before
             // the event weighting is done.
 
-            std::unique_ptr<DialBase> dialBase(
-              dialCollectionRef->getCollectionData<TabulatedDialFactory>(0)
-              ->makeDial(eventIndexingBuffer));
+            // built in the arena of the collection, which keeps the ownership
+            DialBase* dialBase{nullptr};
+            {
+              LoadingProfiler::ScopedTimer timer(profile, LoadingProfiler::DialCreation);
+              dialBase = dialCollectionRef->getCollectionData<TabulatedDialFactory>(0)
+                  ->makeDial(eventIndexingBuffer, &dialCollectionRef->getDialArena());
+            }
 
             // dialBase is valid -> store it
             if (dialBase != nullptr) {
+              profile.stageList[LoadingProfiler::DialCreation].nbAllocations++;
               size_t freeSlotDial = dialCollectionRef->getNextDialFreeSlot();
               dialBase->setAllowExtrapolation(dialCollectionRef->isAllowDialExtrapolation());
-              dialCollectionRef->getDialBaseList()[freeSlotDial] = DialCollection::DialBaseObject(
-                dialBase.release());
+              dialCollectionRef->setEventByEventDial(freeSlotDial, dialBase);
 
               dialEntryPtr->collectionIndex = iCollection;
               dialEntryPtr->interfaceIndex = freeSlotDial;
@@ -1167,7 +1848,7 @@ void DataDispenser::fillFunction(int iThread_){
             auto *dialObjectPtr = (TObject *) *(
                 (TObject **) eventIndexingBuffer.getVariables().fetchVariable(
                     dialCollectionRef->getGlobalDialLeafName()
-                ).get().getPlaceHolderPtr()->getVariableAddress()
+                ).getRawDataPtr()
             );
 
             // Extra-step for selecting the right dial with TClonesArray
@@ -1177,25 +1858,33 @@ void DataDispenser::fillFunction(int iThread_){
               );
             }
 
-            // Do the unique_ptr dance so that memory gets deleted if
-            // there is an exception (being stupidly paranoid).
+            // The dial is constructed in the arena of the collection, which
+            // keeps the ownership (also if there is an exception).
             DialBaseFactory factory{};
-            std::unique_ptr<DialBase> dialBase(
-                factory.makeDial(
-                    dialCollectionRef->getTitle(),
-                    dialCollectionRef->getGlobalDialType(),
-                    dialCollectionRef->getGlobalDialSubType(),
-                    dialObjectPtr,
-                    false
-                )
-            );
+            factory.setDialArena( &dialCollectionRef->getDialArena() );
+            DialBase* dialBase{nullptr};
+            {
+              LoadingProfiler::ScopedTimer timer(profile, LoadingProfiler::DialCreation);
+              dialBase = factory.makeDial(
+                  dialCollectionRef->getTitle(),
+                  dialCollectionRef->getGlobalDialType(),
+                  dialCollectionRef->getGlobalDialSubType(),
+                  dialObjectPtr,
+                  false
+              );
+            }
 
             // dialBase is valid -> store it
             if (dialBase != nullptr) {
+              profile.stageList[LoadingProfiler::DialCreation].nbAllocations++;
               size_t freeSlotDial = dialCollectionRef->getNextDialFreeSlot();
               dialBase->setAllowExtrapolation(dialCollectionRef->isAllowDialExtrapolation());
-              dialCollectionRef->getDialBaseList()[freeSlotDial] = DialCollection::DialBaseObject(
-                  dialBase.release());
+              dialCollectionRef->setEventByEventDial(freeSlotDial, dialBase);
+
+              if( not _cache_.dialInitializerList.empty() ){
+                // keep the spline/graph: the dial will be rebuilt from the event cache
+                _cache_.dialInitializerList[iCollection][freeSlotDial] = EventCacheFile::serializeObject(dialObjectPtr);
+              }
 
               dialEntryPtr->collectionIndex = iCollection;
               dialEntryPtr->interfaceIndex = freeSlotDial;
@@ -25,6 +25,7 @@ std::string DataDispenserParameters::getSummary() const{
   ss << std::endl << "filePathList = " << GenericToolbox::toString(filePathList, true);
   ss << std::endl << "variableDict = " << GenericToolbox::toString(variableDict, true);
   ss << std::endl << "additionalVarsStorage = " << GenericToolbox::toString(additionalVarsStorage, true);
+  ss << std::endl << GET_VAR_NAME_VALUE(eventCacheDir);
   return ss.str();
 }
 
@@ -46,6 +47,16 @@ void DataDispenserCache::clear(){
   varsToOverrideList.clear();
 
   eventVarTransformList.clear();
+
+  threadFillRangeList.clear();
+  debugNbEventsLoaded = 0;
+
+  eventCacheKey = 0;
+  eventCacheFilePath.clear();
+  varsStorageLeafTypeList.clear();
+  sampleEventOffsetList.clear();
+  dialCacheFillIndexBegin = 0;
+  dialInitializerList.clear();
 }
 void DataDispenserCache::addVarRequestedForIndexing(const std::string& varName_) {
   LogThrowIf(varName_.empty(), "no var name provided.");
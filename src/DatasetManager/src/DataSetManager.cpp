@@ -131,11 +131,11 @@ void DataSetManager::loadPropagator( bool isModel_ ){
           LogDebug << "Toy events:" << std::endl;
           LogDebug << GET_VAR_NAME_VALUE(propagatorPtr->getDebugPrintLoadedEventsNbPerSample()) << std::endl;
           int iEvt{0};
-          for( auto& entry : propagatorPtr->getEventDialCache().getCache() ) {
+          for( size_t iEntry = 0 ; iEntry < propagatorPtr->getEventDialCache().getNbEntries() ; iEntry++ ) {
             LogDebug << "Event #" << iEvt++ << "{" << std::endl;
             {
               LogScopeIndent;
-              LogDebug << entry.getSummary() << std::endl;
+              LogDebug << propagatorPtr->getEventDialCache().getEntry(iEntry).getSummary() << std::endl;
             }
             LogDebug << "}" << std::endl;
             if( iEvt >= propagatorPtr->getDebugPrintLoadedEventsNbPerSample() ) break;
@@ -196,6 +196,7 @@ void DataSetManager::load(){
 
   LogInfo << "Loading data into the propagator engine..." << std::endl;
   this->loadPropagator( false );
+  _isDataLoadedFromModel_ = not _reloadModelRequested_;
 
   // For non-Asimov fits, we need to reload the data.
   if( _reloadModelRequested_ ){
@@ -231,9 +232,14 @@ void DataSetManager::load(){
   LogInfo << "Filling up sample bin caches..." << std::endl;
   _threadPool_.runJob([this](int iThread){
     LogInfoIf(iThread <= 0) << "Updating sample per bin event lists..." << std::endl;
+    int nThreads{GundamGlobals::getNumberOfThreads()};
+    if( iThread == -1 ){ iThread = 0; nThreads = 1; }
+
+    // each container is sorted in one pass -> split the containers among threads
+    int iContainer{0};
     for( auto& sample : _propagator_.getSampleSet().getSampleList() ){
-      sample.getMcContainer().updateBinEventList(iThread);
-      sample.getDataContainer().updateBinEventList(iThread);
+      if( iContainer++ % nThreads == iThread ){ sample.getMcContainer().updateBinEventList(); }
+      if( iContainer++ % nThreads == iThread ){ sample.getDataContainer().updateBinEventList(); }
     }
   });
 
@@ -246,34 +252,84 @@ void DataSetManager::load(){
   });
 
   // Throwing stat error on data -> BINNING SHOULD BE SET!!
-  if( _propagator_.isThrowAsimovToyParameters() and _propagator_.isEnableStatThrowInToys() ){
-    LogInfo << "Throwing statistical error for data container..." << std::endl;
-
-    if( _propagator_.isEnableEventMcThrow() ){
-      // Take into account the finite amount of event in MC
-      LogInfo << "enableEventMcThrow is enabled: throwing individual MC events" << std::endl;
-      for( auto& sample : _propagator_.getSampleSet().getSampleList() ) {
-        sample.getDataContainer().throwEventMcError();
-      }
-    }
-    else{
-      LogWarning << "enableEventMcThrow is disabled. Not throwing individual MC events" << std::endl;
-    }
+  if( _propagator_.isThrowAsimovToyParameters() ){ this->throwStatErrors(); }
 
-    LogInfo << "Throwing statistical error on histograms..." << std::endl;
-    if( _propagator_.isGaussStatThrowInToys() ) {
-      LogWarning << "Using gaussian statistical throws. (caveat: distribution truncated when the bins are close to zero)" << std::endl;
+  /// Now caching the event for the plot generator
+  _propagator_.getPlotGenerator().defineHistogramHolders();
+
+  /// Propagator needs to be fast, let the workers wait for the signal
+  _propagator_.getThreadPool().setCpuTimeSaverIsEnabled(false);
+
+}
+void DataSetManager::throwToyData(){
+  LogThrowIf( not isInitialized(), "DataSetManager not initialized." );
+  LogThrowIf( not _propagator_.isThrowAsimovToyParameters(), "Can't throw toy data: toy throwing is not enabled." );
+  LogThrowIf( not _isDataLoadedFromModel_, "The toy data are not generated from the loaded model: they can't be thrown again without reloading the events." );
+
+  auto& parManager = _propagator_.getParametersManager();
+  parManager.moveParametersToPrior();
+  if( _toyParameterInjector_.empty() ){ parManager.throwParameters(); }
+  else{ parManager.injectParameterValues( _toyParameterInjector_ ); }
+
+  // same as the loading: the data should be reweighted as the model is
+  for( auto& parSet: parManager.getParameterSetsList() ) {
+    if( not parSet.isEnabled() ){ continue; }
+    if( parSet.isEnableEigenDecomp() ) { parSet.propagateEigenToOriginal(); }
+  }
+  _propagator_.reweightMcEvents();
+
+  // the data containers hold a copy of the MC events, in the same order
+  for( auto& sample : _propagator_.getSampleSet().getSampleList() ){
+    auto& mcEventList = sample.getMcContainer().getEventList();
+    auto& dataEventList = sample.getDataContainer().getEventList();
+    LogThrowIf( mcEventList.size() != dataEventList.size(),
+                "Data events of sample \"" << sample.getName() << "\" are not a copy of the MC events." );
+    for( size_t iEvent = 0 ; iEvent < mcEventList.size() ; iEvent++ ){
+      dataEventList[iEvent].getWeights().current = mcEventList[iEvent].getEventWeight();
     }
+  }
+
+  _threadPool_.runJob([this](int iThread){
     for( auto& sample : _propagator_.getSampleSet().getSampleList() ){
-      // Asimov bin content -> toy data
-      sample.getDataContainer().throwStatError( _propagator_.isGaussStatThrowInToys() );
+      sample.getDataContainer().refillHistogram(iThread);
+    }
+  });
+
+  this->throwStatErrors();
+}
+void DataSetManager::writeLoadingProfiles(TDirectory* saveDir_){
+  std::vector<const LoadingProfiler*> profilerList;
+  for( auto& dataSet : _dataSetList_ ){
+    if( not dataSet.isEnabled() ){ continue; }
+    profilerList.emplace_back( &dataSet.getModelDispenser().getLoadingProfiler() );
+    for( auto& dataDispenser : dataSet.getDataDispenserDict() ){
+      profilerList.emplace_back( &dataDispenser.second.getLoadingProfiler() );
     }
   }
+  LoadingProfiler::writeToDirectory( saveDir_, profilerList );
+}
+void DataSetManager::throwStatErrors(){
+  if( not _propagator_.isEnableStatThrowInToys() ){ return; }
 
-  /// Now caching the event for the plot generator
-  _propagator_.getPlotGenerator().defineHistogramHolders();
+  LogInfo << "Throwing statistical error for data container..." << std::endl;
 
-  /// Propagator needs to be fast, let the workers wait for the signal
-  _propagator_.getThreadPool().setCpuTimeSaverIsEnabled(false);
+  if( _propagator_.isEnableEventMcThrow() ){
+    // Take into account the finite amount of event in MC
+    LogInfo << "enableEventMcThrow is enabled: throwing individual MC events" << std::endl;
+    for( auto& sample : _propagator_.getSampleSet().getSampleList() ) {
+      sample.getDataContainer().throwEventMcError();
+    }
+  }
+  else{
+    LogWarning << "enableEventMcThrow is disabled. Not throwing individual MC events" << std::endl;
+  }
 
+  LogInfo << "Throwing statistical error on histograms..." << std::endl;
+  if( _propagator_.isGaussStatThrowInToys() ) {
+    LogWarning << "Using gaussian statistical throws. (caveat: distribution truncated when the bins are close to zero)" << std::endl;
+  }
+  for( auto& sample : _propagator_.getSampleSet().getSampleList() ){
+    // Asimov bin content -> toy data
+    sample.getDataContainer().throwStatError( _propagator_.isGaussStatThrowInToys() );
+  }
 }
@@ -0,0 +1,153 @@
+//
+// On-disk cache of the events loaded by a DataDispenser.
+//
+
+#include "EventCacheFile.h"
+
+#include "Logger.h"
+
+#include "TBufferFile.h"
+#include "TClass.h"
+
+#include <cstdio>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifndef DISABLE_USER_HEADER
+LoggerInit([]{ Logger::setUserHeaderStr("[EventCacheFile]"); });
+#endif
+
+
+namespace EventCacheFile{
+
+  constexpr char magicStr[8]{'G','U','N','D','A','M','E','C'};
+  constexpr size_t columnAlignment{8};
+
+  uint64_t hashString(const std::string& str_, uint64_t seed_){
+    uint64_t out{seed_};
+    for( unsigned char c : str_ ){
+      out ^= c;
+      out *= 1099511628211ULL;
+    }
+    return out;
+  }
+  uint64_t hashFileMetadata(const std::string& filePath_, uint64_t seed_){
+    struct stat fileStat{};
+    LogThrowIf( stat(filePath_.c_str(), &fileStat) != 0, "Could not stat file: " << filePath_ );
+    uint64_t out{hashString(filePath_, seed_)};
+    out = hashString(std::to_string(fileStat.st_size), out);
+    out = hashString(std::to_string(fileStat.st_mtime), out);
+    return out;
+  }
+
+  std::string serializeObject(const TObject* object_){
+    LogThrowIf(object_ == nullptr, "Can't serialize a null object.");
+    TBufferFile buffer(TBuffer::kWrite);
+    buffer.WriteObjectAny(object_, object_->IsA());
+    return {buffer.Buffer(), size_t(buffer.Length())};
+  }
+  std::unique_ptr<TObject> deserializeObject(const char* data_, size_t size_){
+    // the buffer does not take ownership of the data (adopt = false)
+    TBufferFile buffer(TBuffer::kRead, Int_t(size_), const_cast<char*>(data_), false);
+    return std::unique_ptr<TObject>( (TObject*) buffer.ReadObjectAny(TObject::Class()) );
+  }
+
+
+  Writer::Writer(const std::string& filePath_) : _filePath_(filePath_), _tmpFilePath_(filePath_ + ".tmp"){
+    _stream_.open(_tmpFilePath_, std::ios::binary | std::ios::trunc);
+    LogThrowIf(not _stream_.is_open(), "Could not open event cache file for writing: " << _tmpFilePath_);
+  }
+  Writer::~Writer(){
+    if( not _stream_.is_open() ){ return; }
+    // not closed: something went wrong while writing
+    _stream_.close();
+    std::remove(_tmpFilePath_.c_str());
+  }
+
+  void Writer::writeHeader(uint64_t key_){
+    writeRaw(magicStr, sizeof(magicStr));
+    write(formatVersion);
+    write(uint32_t(0)); // padding
+    write(key_);
+  }
+  void Writer::writeRaw(const void* data_, size_t nBytes_){
+    _stream_.write(static_cast<const char*>(data_), std::streamsize(nBytes_));
+    _nBytesWritten_ += nBytes_;
+  }
+  void Writer::writeColumn(const void* data_, size_t nBytes_){
+    static const char zeros[columnAlignment]{};
+    writeRaw(zeros, (columnAlignment - _nBytesWritten_ % columnAlignment) % columnAlignment);
+    writeRaw(data_, nBytes_);
+  }
+  void Writer::writeString(const std::string& str_){
+    write(uint64_t(str_.size()));
+    writeRaw(str_.data(), str_.size());
+  }
+  void Writer::close(){
+    _stream_.close();
+    LogThrowIf(_stream_.fail(), "Could not write event cache file: " << _tmpFilePath_);
+    LogThrowIf(std::rename(_tmpFilePath_.c_str(), _filePath_.c_str()) != 0,
+               "Could not move " << _tmpFilePath_ << " to " << _filePath_);
+  }
+
+
+  Reader::Reader(const std::string& filePath_, uint64_t key_){
+    int fd{::open(filePath_.c_str(), O_RDONLY)};
+    if( fd < 0 ){ return; }
+
+    struct stat fileStat{};
+    if( fstat(fd, &fileStat) == 0 and fileStat.st_size > 0 ){
+      void* ptr{mmap(nullptr, size_t(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0)};
+      if( ptr != MAP_FAILED ){
+        _data_ = static_cast<const char*>(ptr);
+        _size_ = size_t(fileStat.st_size);
+      }
+    }
+    ::close(fd); // the mapping stays valid
+    if( _data_ == nullptr ){ return; }
+
+    // the header must match, otherwise the file is treated as absent
+    size_t headerSize{sizeof(magicStr) + 2*sizeof(uint32_t) + sizeof(uint64_t)};
+    if( _size_ < headerSize
+        or std::memcmp(_data_, magicStr, sizeof(magicStr)) != 0 ){
+      LogAlert << "Invalid event cache file: " << filePath_ << std::endl;
+      unmap(); return;
+    }
+    readRaw(sizeof(magicStr));
+    auto version = read<uint32_t>();
+    read<uint32_t>(); // padding
+    auto key = read<uint64_t>();
+    if( version != formatVersion or key != key_ ){
+      LogAlert << "Outdated event cache file: " << filePath_ << std::endl;
+      unmap(); return;
+    }
+  }
+  Reader::~Reader(){ unmap(); }
+
+  const char* Reader::readRaw(size_t nBytes_){
+    LogThrowIf(_data_ == nullptr, "Event cache file not opened.");
+    LogThrowIf(_cursor_ + nBytes_ > _size_, "Event cache file is truncated.");
+    const char* out{_data_ + _cursor_};
+    _cursor_ += nBytes_;
+    return out;
+  }
+  const char* Reader::readColumn(size_t nBytes_){
+    _cursor_ += (columnAlignment - _cursor_ % columnAlignment) % columnAlignment;
+    return readRaw(nBytes_);
+  }
+  std::string Reader::readString(){
+    auto size = read<uint64_t>();
+    return {readRaw(size), size};
+  }
+
+  void Reader::unmap(){
+    if( _data_ == nullptr ){ return; }
+    munmap(const_cast<char*>(_data_), _size_);
+    _data_ = nullptr;
+    _size_ = 0;
+    _cursor_ = 0;
+  }
+
+}
@@ -59,11 +59,15 @@ void EventTreeWriter::writeSamples(TDirectory* saveDir_, const Propagator& propa
         this->writeEvents(GenericToolbox::mkdirTFile(saveDir_, sample.getName()), (isData ? "Data" : "MC"), *evListPtr);
       }
       else{
-        std::vector<const EventDialCache::CacheEntry*> cacheSampleList{};
-        cacheSampleList.reserve( propagator_.getEventDialCache().getCache().size() );
-        for( auto& cacheEntry : propagator_.getEventDialCache().getCache() ){
-          if( cacheEntry.event->getIndices().sample == sample.getIndex() ){
-            cacheSampleList.emplace_back( &cacheEntry );
+        std::vector<EventDialCache::CacheEntry> cacheSampleList{};
+        cacheSampleList.reserve( propagator_.getEventDialCache().getNbEntries() );
+        for( size_t iEntry = 0 ; iEntry < propagator_.getEventDialCache().getNbEntries() ; iEntry++ ){
+          auto cacheEntry = propagator_.getEventDialCache().getEntry(iEntry);
+          if( cacheEntry.event->getIndices().sample != sample.getIndex() ){ continue; }
+          // grouped events share the dials of their super-event entry
+          for( auto* eventPtr : propagator_.getEventDialCache().getEntryEventList(iEntry) ){
+            cacheEntry.event = eventPtr;
+            cacheSampleList.emplace_back( cacheEntry );
           }
         }
         cacheSampleList.shrink_to_fit();
@@ -78,7 +82,7 @@ void EventTreeWriter::writeEvents(TDirectory *saveDir_, const std::string& treeN
   LogReturnIf(not _isEnabled_, "Disabled EventTreeWriter. Skipping writeEvents.");
   this->writeEventsTemplate(saveDir_, treeName_, eventList_);
 }
-void EventTreeWriter::writeEvents(TDirectory* saveDir_, const std::string& treeName_, const std::vector<const EventDialCache::CacheEntry*>& cacheSampleList_) const{
+void EventTreeWriter::writeEvents(TDirectory* saveDir_, const std::string& treeName_, const std::vector<EventDialCache::CacheEntry>& cacheSampleList_) const{
   LogReturnIf(not _isEnabled_, "Disabled EventTreeWriter. Skipping writeEvents.");
   this->writeEventsTemplate(saveDir_, treeName_, cacheSampleList_);
 }
@@ -89,7 +93,7 @@ template<typename T> void EventTreeWriter::writeEventsTemplate(TDirectory* saveD
 
   LogReturnIf(eventList_.empty(), "No event to be written. Leaving...");
 
-  const std::vector<EventDialCache::DialResponseCache>* dialElements{getDialElementsPtr(eventList_[0])};
+  const EventDialCache::DialInterfaceRange* dialElements{getDialElementsPtr(eventList_[0])};
   bool writeDials{dialElements != nullptr};
 
   LogInfo << "Writing " << eventList_.size() << " events " << (writeDials? "with response dials": "without response dials") << " in TTree " << treeName_ << std::endl;
@@ -101,8 +105,8 @@ template<typename T> void EventTreeWriter::writeEventsTemplate(TDirectory* saveD
 
   GenericToolbox::RawDataArray privateMemberArr;
   std::map<std::string, std::function<void(GenericToolbox::RawDataArray&, const Event&)>> leafDictionary;
-  leafDictionary["eventWeight/D"] =   [](GenericToolbox::RawDataArray& arr_, const Event& ev_){ arr_.writeRawData(ev_.getWeights().current); };
-  leafDictionary["treeWeight/D"] =    [](GenericToolbox::RawDataArray& arr_, const Event& ev_){ arr_.writeRawData(ev_.getWeights().base); };
+  leafDictionary["eventWeight/D"] =   [](GenericToolbox::RawDataArray& arr_, const Event& ev_){ arr_.writeRawData(double(ev_.getWeights().current)); };
+  leafDictionary["treeWeight/D"] =    [](GenericToolbox::RawDataArray& arr_, const Event& ev_){ arr_.writeRawData(double(ev_.getWeights().base)); };
   leafDictionary["sampleBinIndex/I"]= [](GenericToolbox::RawDataArray& arr_, const Event& ev_){ arr_.writeRawData(ev_.getIndices().bin); };
   leafDictionary["dataSetIndex/I"] =  [](GenericToolbox::RawDataArray& arr_, const Event& ev_){ arr_.writeRawData(ev_.getIndices().dataset); };
   leafDictionary["entryIndex/L"] =    [](GenericToolbox::RawDataArray& arr_, const Event& ev_){ arr_.writeRawData(ev_.getIndices().entry); };
@@ -121,11 +125,8 @@ template<typename T> void EventTreeWriter::writeEventsTemplate(TDirectory* saveD
     std::string leafDefinitionStr{};
     bool disableArray{false};
 
-    void dropData(GenericToolbox::RawDataArray& arr_, const GenericToolbox::AnyType& var_){
-      arr_.writeMemoryContent(
-          var_.getPlaceHolderPtr()->getVariableAddress(),
-          var_.getPlaceHolderPtr()->getVariableSize()
-      );
+    void dropData(GenericToolbox::RawDataArray& arr_, const EventUtils::Variables::Variable& var_){
+      arr_.writeMemoryContent( var_.getRawDataPtr(), var_.getRawDataSize() );
       if( disableArray ){ return; }
     }
   };
@@ -138,7 +139,7 @@ template<typename T> void EventTreeWriter::writeEventsTemplate(TDirectory* saveD
       lDict.emplace_back();
       lDict.back().disableArray = true;
 
-      auto& var = evPtr->getVariables().fetchVariable( varName ).get();
+      auto& var = evPtr->getVariables().fetchVariable( varName ).getPrototype();
       char typeTag = GenericToolbox::findOriginalVariableType(var);
       LogThrowIf( typeTag == 0 or typeTag == char(0xFF), varName << " has an invalid leaf type." );
 
@@ -158,7 +159,7 @@ template<typename T> void EventTreeWriter::writeEventsTemplate(TDirectory* saveD
       branchDefStr += lDict[iLeaf].leafDefinitionStr;
       leafNamesList.emplace_back(
           lDict[iLeaf].leafDefinitionStr.substr(0,lDict[iLeaf].leafDefinitionStr.find("[")).substr(0, lDict[iLeaf].leafDefinitionStr.find("/")));
-      lDict[iLeaf].dropData(loadedLeavesArr, EventTreeWriter::getEventPtr(eventList_[0])->getVariables().getVarList()[iLeaf].get()); // resize buffer
+      lDict[iLeaf].dropData(loadedLeavesArr, EventTreeWriter::getEventPtr(eventList_[0])->getVariables().getVariable(iLeaf)); // resize buffer
     }
     loadedLeavesArr.lockArraySize();
     tree->Branch("Leaves", &loadedLeavesArr.getRawDataArray()[0], branchDefStr.c_str());
@@ -229,11 +230,12 @@ template<typename T> void EventTreeWriter::writeEventsTemplate(TDirectory* saveD
         grPtr->SetPointY(0, 1);
 
         // fetch corresponding dial if it exists
-        for( auto& dial : *dialElements ){
-          if( dial.dialInterface.getInputBufferRef()->getInputParameterIndicesList()[0].parSetIndex == parIndexList[iGlobalPar].first
-              and dial.dialInterface.getInputBufferRef()->getInputParameterIndicesList()[0].parIndex == parIndexList[iGlobalPar].second ){
+        for( auto& dialInterface : *dialElements ){
+          if( dialInterface.getInputBufferRef()->getInputParameterIndicesList()[0].parSetIndex == parIndexList[iGlobalPar].first
+              and dialInterface.getInputBufferRef()->getInputParameterIndicesList()[0].parIndex == parIndexList[iGlobalPar].second ){
 
-            DialInputBuffer inputBuf{*dial.dialInterface.getInputBufferRef()};
+            DialInputBuffer inputBuf{*dialInterface.getInputBufferRef()};
+            inputBuf.invalidateEpoch(); // the inputs are set by hand below
             grPtr->RemovePoint(0); // remove the first and recreate the whole thing
             for( double xPoint : parameterXvalues[iGlobalPar] ){
               inputBuf.getInputBuffer()[0] = xPoint;
@@ -241,8 +243,8 @@ template<typename T> void EventTreeWriter::writeEventsTemplate(TDirectory* saveD
                   xPoint,
                   DialInterface::evalResponse(
                       &inputBuf,
-                      dial.dialInterface.getDialBaseRef(),
-                      dial.dialInterface.getResponseSupervisorRef()
+                      dialInterface.getDialBaseRef(),
+                      dialInterface.getResponseSupervisorRef()
                   )
               );
             }
@@ -266,7 +268,7 @@ template<typename T> void EventTreeWriter::writeEventsTemplate(TDirectory* saveD
     for( int iLeaf = 0 ; iLeaf < lDict.size() ; iLeaf++ ){
       lDict[iLeaf].dropData(
           loadedLeavesArr,
-          EventTreeWriter::getEventPtr( cacheEntry )->getVariables().getVarList()[iLeaf].get()
+          EventTreeWriter::getEventPtr( cacheEntry )->getVariables().getVariable(iLeaf)
       );
     }
 
@@ -45,6 +45,19 @@ const std::vector<std::string>& EventVarTransform::fetchRequestedVars() const {
   return _requestedLeavesForEvalCache_;
 }
 
+void EventVarTransform::buildInputIndexDict(const std::vector<std::string>& varNameList_){
+  _inputIndexDictVarNameList_ = varNameList_;
+  _inputIndexDictList_.clear();
+  _inputIndexDictList_.resize( _compiledInputFormulaList_.size() );
+  for( size_t iFormula = 0 ; iFormula < _compiledInputFormulaList_.size() ; iFormula++ ){
+    for( auto& varName : _compiledInputFormulaList_[iFormula].getVariableNameList() ){
+      int varIndex{GenericToolbox::findElementIndex( varName, varNameList_ )};
+      LogThrowIf( varIndex == -1, _name_ << ": input variable \"" << varName << "\" is not available." );
+      _inputIndexDictList_[iFormula].emplace_back( varIndex );
+    }
+  }
+}
+
 double EventVarTransform::eval(const Event& event_){
   if( not _useCache_ ){ return this->evalTransformation(event_); }
   _outputCache_ = this->evalTransformation(event_, _inputBuffer_);
@@ -70,7 +83,7 @@ double EventVarTransform::evalTransformation( const Event& event_, std::vector<d
   return std::nan("defaultEvalTransformOutput");
 }
 void EventVarTransform::storeOutput( double output_, Event& storeEvent_ ) const{
-  auto& variable = storeEvent_.getVariables().fetchVariable(this->getOutputVariableName());
+  auto variable = storeEvent_.getVariables().fetchVariable(this->getOutputVariableName());
   variable.set( output_ );
 }
 
@@ -44,12 +44,42 @@ void EventVarTransformLib::initInputFormulas(){
     LogThrowIf(not _inputFormulaList_.back().IsValid(), "\"" << inputFormulaStr << "\": could not be parsed as formula expression.")
   }
   _inputBuffer_.resize(_inputFormulaList_.size(), std::nan("unset"));
+
+  // evaluated for every loaded event: use the bytecode versions if they can all be compiled
+  _compiledInputFormulaList_.clear();
+  _inputIndexDictVarNameList_.clear();
+  _inputIndexDictList_.clear();
+  for( auto& inputFormulaStr : _inputFormulaStrList_ ){
+    _compiledInputFormulaList_.emplace_back();
+    if( not _compiledInputFormulaList_.back().compile(inputFormulaStr, CompiledFormula::Syntax::TFormula) ){
+      LogDebug << "Input evaluated with TFormula: " << _compiledInputFormulaList_.back().getSummary() << std::endl;
+      _compiledInputFormulaList_.clear();
+      break;
+    }
+  }
 }
 double EventVarTransformLib::evalTransformation( const Event& event_, std::vector<double>& inputBuffer_) const{
   // Eval the requested variables
   size_t nFormula{_inputFormulaList_.size()};
-  for( size_t iFormula = 0 ; iFormula < nFormula ; iFormula++ ){
-    inputBuffer_[iFormula] = event_.getVariables().evalFormula(&(_inputFormulaList_[iFormula]));
+  if( not _inputIndexDictList_.empty() ){
+    // the variable indices have been looked up once for all (buildInputIndexDict)
+    LogThrowIf( event_.getVariables().getNbVariables() != _inputIndexDictVarNameList_.size(),
+                _name_ << ": the event variables don't match the input index dictionary." );
+    for( size_t iFormula = 0 ; iFormula < nFormula ; iFormula++ ){
+      inputBuffer_[iFormula] = event_.getVariables().evalFormula(_compiledInputFormulaList_[iFormula], _inputIndexDictList_[iFormula]);
+    }
+  }
+  else if( not _compiledInputFormulaList_.empty() ){
+    std::vector<int> indexDict;
+    for( size_t iFormula = 0 ; iFormula < nFormula ; iFormula++ ){
+      indexDict.clear();
+      inputBuffer_[iFormula] = event_.getVariables().evalFormula(_compiledInputFormulaList_[iFormula], indexDict);
+    }
+  }
+  else{
+    for( size_t iFormula = 0 ; iFormula < nFormula ; iFormula++ ){
+      inputBuffer_[iFormula] = event_.getVariables().evalFormula(&(_inputFormulaList_[iFormula]));
+    }
   }
   // Eval with dynamic function
   return reinterpret_cast<double(*)(double*)>(_evalVariable_)(&inputBuffer_[0]);
@@ -0,0 +1,172 @@
+//
+// Per-stage timers and counters of the DataDispenser loading.
+//
+
+#include "LoadingProfiler.h"
+
+#include "GundamUtils.h"
+
+#include "GenericToolbox.Utils.h"
+#include "GenericToolbox.Root.h"
+#include "Logger.h"
+
+#include "TTree.h"
+
+#include <sstream>
+#include <cstdlib>
+
+#ifndef DISABLE_USER_HEADER
+LoggerInit([]{ Logger::setUserHeaderStr("[LoadingProfiler]"); });
+#endif
+
+
+const char* LoadingProfiler::getStageName(Stage stage_){
+  switch( stage_ ){
+    case EventSelection:   return "Event selection";
+    case DiskRead:         return "Disk read";
+    case NominalWeight:    return "Nominal weight";
+    case LeafCopy:         return "Leaf copy";
+    case VarTransform:     return "Variable transformations";
+    case BinLookup:        return "Sample bin lookup";
+    case DialIndexing:     return "Dial indexing";
+    case DialCreation:     return "Dial creation";
+    case LockWait:         return "Lock wait";
+    case MemoryAllocation: return "Memory allocation";
+    case Compaction:       return "Compaction";
+    case EventCache:       return "Event cache";
+    default:               return "Unknown";
+  }
+}
+
+LoadingProfiler::StageCounters& LoadingProfiler::StageCounters::operator+=(const StageCounters& other_){
+  cpuTime += other_.cpuTime;
+  nbCalls += other_.nbCalls;
+  nbBytes += other_.nbBytes;
+  nbAllocations += other_.nbAllocations;
+  return *this;
+}
+
+void LoadingProfiler::reset(const std::string& title_){
+  _isFinalized_ = false;
+  _title_ = title_;
+  _wallTime_ = 0;
+  _nbLoadedEvents_ = 0;
+  _memoryIncrease_ = 0;
+
+  _threadProfileList_.clear();
+  _threadProfileList_.resize(1);
+  _totalList_ = {};
+
+  _start_ = std::chrono::steady_clock::now();
+}
+void LoadingProfiler::setNbThreads(int nbThreads_){
+  if( nbThreads_ > int(_threadProfileList_.size()) ){ _threadProfileList_.resize(nbThreads_); }
+}
+void LoadingProfiler::finalize(){
+  _totalList_ = {};
+  for( auto& threadProfile : _threadProfileList_ ){
+    for( int iStage = 0 ; iStage < nbStages ; iStage++ ){
+      _totalList_[iStage] += threadProfile.stageList[iStage];
+    }
+  }
+  _wallTime_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - _start_).count();
+  _isFinalized_ = true;
+}
+
+std::string LoadingProfiler::getSummary() const{
+  std::stringstream ss;
+
+  double totalCpuTime{0};
+  for( auto& stage : _totalList_ ){ totalCpuTime += stage.cpuTime; }
+
+  GenericToolbox::TablePrinter t;
+  t << "Stage" << GenericToolbox::TablePrinter::NextColumn;
+  t << "CPU time (s)" << GenericToolbox::TablePrinter::NextColumn;
+  t << "Fraction" << GenericToolbox::TablePrinter::NextColumn;
+  t << "Calls" << GenericToolbox::TablePrinter::NextColumn;
+  t << "Calls/s" << GenericToolbox::TablePrinter::NextColumn;
+  t << "Bytes" << GenericToolbox::TablePrinter::NextColumn;
+  t << "Bytes/s" << GenericToolbox::TablePrinter::NextColumn;
+  t << "Allocations" << GenericToolbox::TablePrinter::NextLine;
+
+  for( int iStage = 0 ; iStage < nbStages ; iStage++ ){
+    auto& stage = _totalList_[iStage];
+    if( stage.nbCalls == 0 ){ continue; }
+
+    t << getStageName(Stage(iStage)) << GenericToolbox::TablePrinter::NextColumn;
+    t << GenericToolbox::toString(stage.cpuTime) << GenericToolbox::TablePrinter::NextColumn;
+    t << GenericToolbox::toString(totalCpuTime != 0 ? 100. * stage.cpuTime / totalCpuTime : 0) << "%" << GenericToolbox::TablePrinter::NextColumn;
+    t << stage.nbCalls << GenericToolbox::TablePrinter::NextColumn;
+    t << (stage.cpuTime != 0 ? GenericToolbox::toString(double(stage.nbCalls) / stage.cpuTime) : "-") << GenericToolbox::TablePrinter::NextColumn;
+    t << (stage.nbBytes != 0 ? GenericToolbox::parseSizeUnits(double(stage.nbBytes)) : "-") << GenericToolbox::TablePrinter::NextColumn;
+    t << (stage.nbBytes != 0 and stage.cpuTime != 0 ? GenericToolbox::parseSizeUnits(double(stage.nbBytes) / stage.cpuTime) + "/s" : "-") << GenericToolbox::TablePrinter::NextColumn;
+    t << (stage.nbAllocations != 0 ? std::to_string(stage.nbAllocations) : "-") << GenericToolbox::TablePrinter::NextLine;
+  }
+
+  ss << "Loading profile of " << _title_ << " (CPU time summed over " << _threadProfileList_.size() << " thread(s)):" << std::endl;
+  ss << t.generateTableString();
+  ss << "Wall time: " << GenericToolbox::toString(_wallTime_) << " s";
+  ss << " / Loaded events: " << _nbLoadedEvents_;
+  if( _wallTime_ != 0 ){ ss << " (" << GenericToolbox::toString(double(_nbLoadedEvents_) / _wallTime_) << " events/s)"; }
+  ss << " / RAM increase: " << (_memoryIncrease_ < 0 ? "-" : "") << GenericToolbox::parseSizeUnits(double(std::abs(_memoryIncrease_)));
+  return ss.str();
+}
+
+void LoadingProfiler::writeToDirectory(TDirectory* saveDir_, const std::vector<const LoadingProfiler*>& profilerList_){
+  if( saveDir_ == nullptr or profilerList_.empty() ){ return; }
+
+  std::string title{};
+  std::string gundamVersion{GundamUtils::getVersionStr()};
+  std::string stageName{};
+  int stageIndex{};
+  int nbThreads{};
+  double cpuTime{};
+  double wallTime{};
+  ULong64_t nbCalls{};
+  ULong64_t nbBytes{};
+  ULong64_t nbAllocations{};
+  ULong64_t nbLoadedEvents{};
+  Long64_t memoryIncrease{};
+
+  auto* oldDir = GenericToolbox::getCurrentTDirectory();
+
+  saveDir_->cd();
+  auto* tree = new TTree("loadingProfile", "Time spent in each stage of the dataset loading");
+  tree->Branch("dataset", &title);
+  tree->Branch("gundamVersion", &gundamVersion);
+  tree->Branch("stage", &stageName);
+  tree->Branch("stageIndex", &stageIndex);
+  tree->Branch("nbThreads", &nbThreads);
+  tree->Branch("cpuTime", &cpuTime);
+  tree->Branch("wallTime", &wallTime);
+  tree->Branch("nbCalls", &nbCalls);
+  tree->Branch("nbBytes", &nbBytes);
+  tree->Branch("nbAllocations", &nbAllocations);
+  tree->Branch("nbLoadedEvents", &nbLoadedEvents);
+  tree->Branch("memoryIncrease", &memoryIncrease);
+
+  for( auto* profiler : profilerList_ ){
+    if( profiler == nullptr or not profiler->isFinalized() ){ continue; }
+
+    title = profiler->getTitle();
+    nbThreads = int(profiler->_threadProfileList_.size());
+    wallTime = profiler->_wallTime_;
+    nbLoadedEvents = profiler->_nbLoadedEvents_;
+    memoryIncrease = profiler->_memoryIncrease_;
+
+    for( stageIndex = 0 ; stageIndex < nbStages ; stageIndex++ ){
+      auto& stage = profiler->_totalList_[stageIndex];
+      stageName = getStageName(Stage(stageIndex));
+      cpuTime = stage.cpuTime;
+      nbCalls = stage.nbCalls;
+      nbBytes = stage.nbBytes;
+      nbAllocations = stage.nbAllocations;
+      tree->Fill();
+    }
+  }
+
+  GenericToolbox::writeInTFile( saveDir_, tree );
+  delete tree;
+
+  if(oldDir != nullptr) oldDir->cd();
+}
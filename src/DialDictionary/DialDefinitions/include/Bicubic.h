@@ -12,7 +12,6 @@ class Bicubic : public DialBase {
 
 public:
   Bicubic() = default;
-  ~Bicubic() override = default;
 
   [[nodiscard]] std::unique_ptr<DialBase> clone() const override {
        return std::make_unique<Bicubic>(*this);
@@ -28,12 +27,13 @@ public:
   // Return the dial response for the input parameters.  The DialInputBuffer
   // should contain two input parameters.
   [[nodiscard]] double evalResponse(const DialInputBuffer& input_) const override;
+  [[nodiscard]] double evalResponseAndDerivative(const DialInputBuffer& input_, double* derivativeList_) const override;
 
   /// Pass information to the dial so that it can build it's internal
   /// information.
   virtual void buildDial(const TH2& h2, const std::string& option_="") override;
 
-  [[nodiscard]] const std::vector<double>& getDialData() const override {return _splineData_;}
+  [[nodiscard]] DialDataView getDialData() const override {return _splineData_;}
 
 protected:
   bool _allowExtrapolation_{false};
@@ -7,23 +7,46 @@
 
 #include "DialInputBuffer.h"
 
+#include <atomic>
+#include <cstdint>
+
+class DialDataPool;
+
+
 /// This is a template to add caching to a DialBase derived class.
+///
+/// The cached response is keyed on the epoch stamped by
+/// DialInputBuffer::update(), so there is no lock and no copy of the
+/// inputs.  The (epoch, response) pair is published as a seqlock: a writer
+/// marks the slot busy, stores the response, then the epoch, and a reader
+/// checks the epoch again after reading the response.  An unstamped buffer
+/// (epoch 0) bypasses the cache.
 template <typename T> class CachedDial: public T {
 public:
   CachedDial() = default;
+  /// Only for the dials keeping their data in a pool (see DialArena).
+  explicit CachedDial(DialDataPool* dataPool_) : T(dataPool_) {}
   double evalResponse(const DialInputBuffer& input_) const override;
+  double evalResponseAndDerivative(const DialInputBuffer& input_, double* derivativeList_) const override;
+  double evalUncachedResponse(const DialInputBuffer& input_) const override { return this->T::evalResponse(input_); }
   bool isCacheValid(const DialInputBuffer& input_) const;
-  void updateInputCache(const DialInputBuffer& input_) const;
 
 protected:
-  mutable double _cachedResponse_{std::nan("unset")}; // + 8 bytes
-  mutable GenericToolbox::NoCopyWrapper<std::mutex> _evalLock_{}; // + 64 bytes
-#if USE_ZLIB
-  // + 4 bytes (keeping a vector empty is already 24...)
-  mutable uint32_t _cachedInputHash_{0};
-#else
-  mutable std::vector<double> _cachedInputs_{}; // + 24 bytes
-#endif
+  /// The response slot.  A copy starts unset since the epoch it refers to
+  /// belongs to the evaluations of the original.
+  struct ResponseSlot{
+    ResponseSlot() = default;
+    ResponseSlot(const ResponseSlot&){}
+    ResponseSlot& operator=(const ResponseSlot&){ epoch.store(0, std::memory_order_relaxed); return *this; }
+
+    /// Set while a response is written.  Never a buffer epoch (they count
+    /// up from 1).
+    static constexpr uint64_t busyEpoch{~uint64_t(0)};
+
+    mutable std::atomic<uint64_t> epoch{0}; // + 8 bytes
+    mutable std::atomic<double> response{0}; // + 8 bytes
+  };
+  ResponseSlot _responseSlot_{};
 };
 
 
@@ -7,38 +7,46 @@
 
 #include "CachedDial.h"
 
+#include <type_traits>
+
 template <typename T> double CachedDial<T>::evalResponse(const DialInputBuffer& input_) const {
-  if (isCacheValid(input_)) {return _cachedResponse_;}
-  #if HAS_CPP_17
-  std::scoped_lock<std::mutex> g(_evalLock_);
-  #else
-  std::lock_guard<std::mutex> g(_evalLock_);
-  #endif
-  if (isCacheValid(input_)) {return _cachedResponse_;}
-  _cachedResponse_ = this->T::evalResponse(input_);
-  updateInputCache(input_);
-  return _cachedResponse_;
-}
-template <typename T> bool CachedDial<T>::isCacheValid(const DialInputBuffer& input_) const {
-#if USE_ZLIB
-  return _cachedInputHash_ == input_.getCurrentHash();
-#else
-  if( _cachedInputs_.size() != input_.getBufferSize() ) return false;
-  return ( memcmp(
-             _cachedInputs_.data(), input_.getInputBuffer().data(),
-             input_.getBufferSize() * sizeof(*input_.getInputBuffer().data())) == 0 );
-#endif
+  const uint64_t epoch{input_.getEpoch()};
+  if( epoch == 0 ){ return this->T::evalResponse(input_); }
+
+  // seqlock read: the response is only taken if the epoch didn't change
+  // while reading it
+  if( _responseSlot_.epoch.load(std::memory_order_acquire) == epoch ){
+    const double cached{_responseSlot_.response.load(std::memory_order_relaxed)};
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if( _responseSlot_.epoch.load(std::memory_order_relaxed) == epoch ){ return cached; }
+  }
+
+  const double response{this->T::evalResponse(input_)};
+
+  // seqlock write: the slot is claimed by marking it busy, so there is a
+  // single writer and a reader can't pair this response with another epoch.
+  // If another thread is writing, the response is just not cached.
+  uint64_t previous{_responseSlot_.epoch.load(std::memory_order_relaxed)};
+  if( previous != ResponseSlot::busyEpoch
+      and _responseSlot_.epoch.compare_exchange_strong(previous, ResponseSlot::busyEpoch, std::memory_order_relaxed) ){
+    std::atomic_thread_fence(std::memory_order_release);
+    _responseSlot_.response.store(response, std::memory_order_relaxed);
+    _responseSlot_.epoch.store(epoch, std::memory_order_release);
+  }
+  return response;
 }
-template <typename T> void CachedDial<T>::updateInputCache(const DialInputBuffer& input_) const {
-#if USE_ZLIB
-  _cachedInputHash_ = input_.getCurrentHash();
-#else
-  if( _cachedInputs_.size() != input_.getBufferSize() ){
-    _cachedInputs_.resize(input_.getBufferSize(), std::nan("unset"));
+template <typename T> double CachedDial<T>::evalResponseAndDerivative(const DialInputBuffer& input_, double* derivativeList_) const {
+  // without a closed form, the finite differences must not go through the
+  // response cache (kept for clarity: the shifted copies are not stamped)
+  if( std::is_same<decltype(&T::evalResponseAndDerivative), decltype(&DialBase::evalResponseAndDerivative)>::value ){
+    return DialBase::evalFiniteDifferences(input_, derivativeList_, [this](const DialInputBuffer& buffer_){
+      return this->T::evalResponse(buffer_);
+    });
   }
-  memcpy(_cachedInputs_.data(), input_.getInputBuffer().data(),
-         input_.getBufferSize() * sizeof(*input_.getInputBuffer().data()));
-#endif
+  return this->T::evalResponseAndDerivative(input_, derivativeList_);
+}
+template <typename T> bool CachedDial<T>::isCacheValid(const DialInputBuffer& input_) const {
+  return input_.getEpoch() != 0 and _responseSlot_.epoch.load(std::memory_order_acquire) == input_.getEpoch();
 }
 
 #endif //GUNDAM_CACHEDDIAL_IMPL_H
@@ -7,6 +7,7 @@
 
 #include "DialBase.h"
 #include "DialInputBuffer.h"
+#include "DialDataBuffer.h"
 
 #include "TGraph.h"
 
@@ -17,11 +18,13 @@ class CompactSpline : public DialBase {
 
 public:
   CompactSpline() = default;
-  ~CompactSpline() override = default;
+  /// Keep the spline data in the pool (see DialArena).
+  explicit CompactSpline(DialDataPool* dataPool_) : _splineData_{dataPool_} {}
 
   [[nodiscard]] std::unique_ptr<DialBase> clone() const override { return std::make_unique<CompactSpline>(*this); }
   [[nodiscard]] std::string getDialTypeName() const override { return {"CompactSpline"}; }
   [[nodiscard]] double evalResponse(const DialInputBuffer& input_) const override;
+  [[nodiscard]] double evalResponseAndDerivative(const DialInputBuffer& input_, double* derivativeList_) const override;
 
   [[nodiscard]] std::string getSummary() const override;
 
@@ -42,15 +45,17 @@ public:
                          const std::vector<double>& v3,
                          const std::string& option_="") override;
 
-  [[nodiscard]] const std::vector<double>& getDialData() const override {return _splineData_;}
+  [[nodiscard]] DialDataView getDialData() const override {return _splineData_;}
+  [[nodiscard]] const std::pair<double, double>& getSplineBounds() const {return _splineBounds_;}
 
 protected:
   bool _allowExtrapolation_{false};
 
   // A block of data to calculate the spline values.  This must be filled for
   // the Cache::Manager to work, and provides the input for spline calculation
-  // functions that can be shared between the CPU and the GPU.
-  std::vector<double> _splineData_{};
+  // functions that can be shared between the CPU and the GPU.  Taken from
+  // the pool of the arena when the dial is stored in a DialArena.
+  DialDataBuffer _splineData_{};
   std::pair<double, double> _splineBounds_{std::nan("unset"), std::nan("unset")};
 };
 
@@ -6,10 +6,12 @@
 #define GUNDAM_DIALBASE_H
 
 #include "DialInputBuffer.h"
+#include "DialDataView.h"
 
 #include <vector>
 #include <string>
 #include <memory>
+#include <functional>
 
 // should be thread safe -> add lock?
 // any number of inputs (provided doubles) -> set input size
@@ -38,6 +40,26 @@ public:
   /// DialInputBuffer.
   [[nodiscard]] virtual double evalResponse(const DialInputBuffer& input_) const = 0;
 
+  /// Evaluate the dial response together with its derivatives with respect
+  /// to each input of the DialInputBuffer.  derivativeList_ must have room
+  /// for input_.getBufferSize() values.  The default implementation uses
+  /// central finite differences: dials with a closed form should override it.
+  [[nodiscard]] virtual double evalResponseAndDerivative(const DialInputBuffer& input_, double* derivativeList_) const;
+
+  /// Same as evalResponse(), but never reading nor updating any cached
+  /// response.  Safe to call concurrently with inputs other than the
+  /// propagated ones (e.g. with a private copy of the DialInputBuffer).
+  [[nodiscard]] virtual double evalUncachedResponse(const DialInputBuffer& input_) const { return evalResponse(input_); }
+
+  /// False if the response is not only a function of the DialInputBuffer
+  /// (e.g. tabulated externally): the dial can then only be evaluated at
+  /// the propagated parameter values.
+  [[nodiscard]] virtual bool isResponseFromInputs() const { return true; }
+
+  /// The derivatives can't be evaluated if the inputs are not driving the
+  /// response.
+  [[nodiscard]] virtual bool isDerivativeAvailable() const { return isResponseFromInputs(); }
+
   /// Allow extrapolation of the data.  The default is to
   /// forbid extrapolation.
   virtual void setAllowExtrapolation(bool allow_) {}
@@ -80,8 +102,13 @@ public:
   virtual void buildDial(const TH2& h2, const std::string& option_="") {throw std::runtime_error("Not implemented");}
 
   /// Return the data used by the dial to calculate the output values. The
-  /// specific data contained in the vector depends on the derived class.
-  [[nodiscard]] virtual const std::vector<double>& getDialData() const;
+  /// specific data contained in the block depends on the derived class.
+  [[nodiscard]] virtual DialDataView getDialData() const;
+
+protected:
+  /// Central finite differences of responseFct_ around the inputs of input_.
+  static double evalFiniteDifferences(const DialInputBuffer& input_, double* derivativeList_,
+                                      const std::function<double(const DialInputBuffer&)>& responseFct_);
 
 };
 
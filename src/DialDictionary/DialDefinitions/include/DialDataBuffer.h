@@ -0,0 +1,102 @@
+//
+// Storage of the data block of the spline dials.
+//
+
+#ifndef GUNDAM_DIALDATABUFFER_H
+#define GUNDAM_DIALDATABUFFER_H
+
+#include "DialDataView.h"
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+
+
+/// Contiguous storage for the data blocks of many dials.  The blocks are
+/// handed out one after the other from large chunks that are only released
+/// with the pool, so the data of the dials built in a row are next to each
+/// other in memory, and there is no heap allocation per dial.  Thread safe.
+class DialDataPool {
+
+public:
+  DialDataPool() = default;
+
+  // the blocks are referenced by pointer
+  DialDataPool(const DialDataPool&) = delete;
+  DialDataPool& operator=(const DialDataPool&) = delete;
+
+  /// A block of size_ values, valid for the lifetime of the pool.
+  double* allocate(size_t size_);
+
+  /// Number of values handed out.
+  [[nodiscard]] size_t getNbValues() const;
+
+private:
+  // 8 MB per chunk
+  static constexpr size_t chunkSize{size_t(1) << 20};
+
+  /// The blocks of a chunk are reserved with an atomic counter, so the
+  /// threads only lock the pool to add the next chunk.
+  struct Chunk {
+    explicit Chunk(size_t size_) : data(new double[size_]) {}
+    std::unique_ptr<double[]> data;
+    // counts the failed reservations too, so it can go past chunkSize
+    std::atomic<size_t> fill{0};
+  };
+
+  std::mutex _mutex_{};
+  std::vector<std::unique_ptr<Chunk>> _chunkList_{};
+  std::atomic<Chunk*> _currentChunk_{nullptr};
+  std::atomic<size_t> _nValues_{0};
+
+};
+
+
+/// The data block of a spline dial.  It is taken from a DialDataPool when
+/// one is given (the dial is then stored in a DialArena), and is kept on
+/// the heap otherwise.  A copy is always on the heap, so a clone doesn't
+/// depend on the pool of the original.
+class DialDataBuffer {
+
+public:
+  DialDataBuffer() = default;
+  explicit DialDataBuffer(DialDataPool* pool_) : _pool_{pool_} {}
+
+  DialDataBuffer(const DialDataBuffer& other_) : _heapData_(other_.begin(), other_.end()) { this->pointToHeap(); }
+  DialDataBuffer(DialDataBuffer&& other_) noexcept { this->swap(other_); }
+  DialDataBuffer& operator=(const DialDataBuffer& other_);
+  DialDataBuffer& operator=(DialDataBuffer&& other_) noexcept;
+
+  /// Set the number of values.  From a pool, this takes a new block: the
+  /// data of a dial is expected to be sized once.
+  void resize(size_t size_);
+
+  [[nodiscard]] double* data() { return _data_; }
+  [[nodiscard]] const double* data() const { return _data_; }
+  [[nodiscard]] size_t size() const { return _size_; }
+  [[nodiscard]] bool empty() const { return _size_ == 0; }
+
+  [[nodiscard]] const double* begin() const { return _data_; }
+  [[nodiscard]] const double* end() const { return _data_ + _size_; }
+
+  double& operator[](size_t i_) { return _data_[i_]; }
+  const double& operator[](size_t i_) const { return _data_[i_]; }
+
+  operator DialDataView() const { return {_data_, _size_}; }
+
+  void swap(DialDataBuffer& other_) noexcept;
+
+private:
+  void pointToHeap(){ _data_ = _heapData_.data(); _size_ = _heapData_.size(); }
+
+  DialDataPool* _pool_{nullptr};
+  std::vector<double> _heapData_{};
+  double* _data_{nullptr};
+  size_t _size_{0};
+
+};
+
+
+#endif //GUNDAM_DIALDATABUFFER_H
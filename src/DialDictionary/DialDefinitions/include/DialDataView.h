@@ -0,0 +1,48 @@
+//
+// Read-only view on the data block of a dial.
+//
+
+#ifndef GUNDAM_DIALDATAVIEW_H
+#define GUNDAM_DIALDATAVIEW_H
+
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <cstddef>
+
+
+/// The data block of a dial as given by DialBase::getDialData().  The block
+/// is owned by the dial (or by the DialArena the dial is stored in), so the
+/// view must not outlive the dial.
+class DialDataView {
+
+public:
+  DialDataView() = default;
+  DialDataView(const double* data_, size_t size_) : _data_{data_}, _size_{size_} {}
+
+  // implicit: the dials keeping their data in a vector can return it as is
+  DialDataView(const std::vector<double>& data_) : _data_{data_.data()}, _size_{data_.size()} {}
+
+  [[nodiscard]] const double* data() const { return _data_; }
+  [[nodiscard]] size_t size() const { return _size_; }
+  [[nodiscard]] bool empty() const { return _size_ == 0; }
+
+  [[nodiscard]] const double* begin() const { return _data_; }
+  [[nodiscard]] const double* end() const { return _data_ + _size_; }
+
+  const double& operator[](size_t i_) const { return _data_[i_]; }
+  [[nodiscard]] const double& at(size_t i_) const {
+    if( i_ >= _size_ ){
+      throw std::out_of_range("DialDataView: index " + std::to_string(i_) + " >= size " + std::to_string(_size_));
+    }
+    return _data_[i_];
+  }
+
+private:
+  const double* _data_{nullptr};
+  size_t _size_{0};
+
+};
+
+
+#endif //GUNDAM_DIALDATAVIEW_H
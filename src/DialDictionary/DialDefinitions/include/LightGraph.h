@@ -29,7 +29,7 @@ public:
 
   virtual void buildDial(const TGraph& grf, const std::string& option_="") override;
 
-  const std::vector<double>& getDialData() const override {return _Data_;}
+  [[nodiscard]] DialDataView getDialData() const override {return _Data_;}
 
 protected:
   bool _allowExtrapolation_{false};
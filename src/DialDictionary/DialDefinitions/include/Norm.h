@@ -18,6 +18,9 @@ public:
   [[nodiscard]] std::unique_ptr<DialBase> clone() const override { return std::make_unique<Norm>(*this); }
   [[nodiscard]] std::string getDialTypeName() const override { return {"Norm"}; }
   [[nodiscard]] double evalResponse(const DialInputBuffer& input_) const override { return input_.getInputBuffer()[0]; }
+  [[nodiscard]] double evalResponseAndDerivative(const DialInputBuffer& input_, double* derivativeList_) const override {
+    derivativeList_[0] = 1; return input_.getInputBuffer()[0];
+  }
 
   /// Build the dial with no input arguments.  This is here for completeness,
   /// but could eventually do... something.
@@ -18,6 +18,10 @@ public:
   [[nodiscard]] std::unique_ptr<DialBase> clone() const override { return std::make_unique<Shift>(*this); }
   [[nodiscard]] std::string getDialTypeName() const override { return {"Shift"}; }
   [[nodiscard]] double evalResponse(const DialInputBuffer& input_) const override { return _shiftValue_; }
+  [[nodiscard]] double evalResponseAndDerivative(const DialInputBuffer& input_, double* derivativeList_) const override {
+    for( int iInput = 0 ; iInput < input_.getBufferSize() ; iInput++ ){ derivativeList_[iInput] = 0; }
+    return _shiftValue_;
+  }
 
   void buildDial(double shift_, const std::string& options_="") override { _shiftValue_ = shift_; }
 
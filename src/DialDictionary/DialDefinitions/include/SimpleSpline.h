@@ -18,7 +18,6 @@ class SimpleSpline : public DialBase {
 
 public:
   SimpleSpline() = default;
-  ~SimpleSpline() override = default;
 
   [[nodiscard]] std::unique_ptr<DialBase> clone() const override { return std::make_unique<SimpleSpline>(*this); }
   [[nodiscard]] std::string getDialTypeName() const override { return {"SimpleSpline"}; }
@@ -35,7 +34,7 @@ public:
   virtual void buildDial(const TGraph& grf, const std::string& option_="") override;
   virtual void buildDial(const TSpline3& spl, const std::string& option_="") override;
 
-  [[nodiscard]] const std::vector<double>& getDialData() const override {return _splineData_;}
+  [[nodiscard]] DialDataView getDialData() const override {return _splineData_;}
 
 protected:
   bool _isUniform_{false};
@@ -11,7 +11,6 @@
 class Tabulated : public DialBase {
 
 public:
-    ~Tabulated() = default;
     Tabulated() = delete;
     Tabulated(const std::vector<double>* table_, int index_, double fraction_,
         const std::string& options_="")
@@ -23,6 +22,9 @@ public:
     [[nodiscard]] double evalResponse(const DialInputBuffer& input_) const override
         { return _fraction_*(*_table_)[_index_] + (1.0-_fraction_)*(*_table_)[_index_+1]; }
 
+    // The table is filled outside of the dial (see TabulatedDialFactory).
+    [[nodiscard]] bool isResponseFromInputs() const override { return false; }
+
     // Provide the internal information for the dial.  These could (should) be
     // private and add the Cache::Manager classes as friends.
     const std::vector<double>* getTable() const { return _table_; }
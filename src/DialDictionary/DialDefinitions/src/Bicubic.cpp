@@ -58,8 +58,8 @@ double Bicubic::evalResponse(const DialInputBuffer& input_) const {
     if( not _allowExtrapolation_ ){
         if (input0 < _splineBounds_[0].first) input0 = _splineBounds_[0].first;
         if (input0 > _splineBounds_[0].second) input0 = _splineBounds_[0].second;
-        if (input1 < _splineBounds_[1].first) input0 = _splineBounds_[1].first;
-        if (input1 > _splineBounds_[1].second) input0 = _splineBounds_[1].second;
+        if (input1 < _splineBounds_[1].first) input1 = _splineBounds_[1].first;
+        if (input1 > _splineBounds_[1].second) input1 = _splineBounds_[1].second;
     }
 
     const double *data = _splineData_.data();
@@ -75,3 +75,36 @@ double Bicubic::evalResponse(const DialInputBuffer& input_) const {
                                   xx, nx,
                                   yy, ny);
 }
+
+double Bicubic::evalResponseAndDerivative(const DialInputBuffer& input_, double* derivativeList_) const {
+    double input0{input_.getInputBuffer()[0]};
+    double input1{input_.getInputBuffer()[1]};
+
+    // the response is flat along an input outside of its bounds
+    bool isClamped0{false};
+    bool isClamped1{false};
+    if( not _allowExtrapolation_ ){
+        if (input0 < _splineBounds_[0].first) { input0 = _splineBounds_[0].first; isClamped0 = true; }
+        if (input0 > _splineBounds_[0].second) { input0 = _splineBounds_[0].second; isClamped0 = true; }
+        if (input1 < _splineBounds_[1].first) { input1 = _splineBounds_[1].first; isClamped1 = true; }
+        if (input1 > _splineBounds_[1].second) { input1 = _splineBounds_[1].second; isClamped1 = true; }
+    }
+
+    const double *data = _splineData_.data();
+    const int nx = *(data++);
+    const int ny = *(data++);
+    const double* xx = data;
+    data += nx;
+    const double* yy = data;
+    data += ny;
+    const double* knots = data;
+    double response = CalculateBicubicSpline(
+        input0, input1, -1E20, 1E20,
+        knots, nx, ny,
+        xx, nx,
+        yy, ny,
+        derivativeList_);
+    if (isClamped0) derivativeList_[0] = 0;
+    if (isClamped1) derivativeList_[1] = 0;
+    return response;
+}
@@ -127,10 +127,24 @@ double CompactSpline::evalResponse(const DialInputBuffer& input_) const {
   return CalculateCompactSpline( dialInput, -1E20, 1E20, _splineData_.data(), int(_splineData_.size()-2) );
 }
 
+double CompactSpline::evalResponseAndDerivative(const DialInputBuffer& input_, double* derivativeList_) const {
+  double dialInput{input_.getInputBuffer()[0]};
+
+  // the response is flat outside of the bounds
+  bool isClamped{false};
+  if( not _allowExtrapolation_ ){
+    if     (dialInput < _splineBounds_.first) { dialInput = _splineBounds_.first; isClamped = true; }
+    else if(dialInput > _splineBounds_.second){ dialInput = _splineBounds_.second; isClamped = true; }
+  }
+
+  double response{CalculateCompactSpline( dialInput, -1E20, 1E20, _splineData_.data(), int(_splineData_.size()-2), &derivativeList_[0] )};
+  if( isClamped ){ derivativeList_[0] = 0; }
+  return response;
+}
 
 std::string CompactSpline::getSummary() const {
   std::stringstream ss;
-  ss << this->getDialTypeName() << ": spline data = " << GenericToolbox::toString(_splineData_);
+  ss << this->getDialTypeName() << ": spline data = " << GenericToolbox::toString(std::vector<double>(_splineData_.begin(), _splineData_.end()));
   ss << std::endl << this->getDialTypeName() << ": defined bounds = { " << _splineBounds_.first << ", " << _splineBounds_.second << " }";
   ss << std::endl << this->getDialTypeName() << ": allow extrapolation ? " << _allowExtrapolation_;
   return ss.str();
@@ -6,11 +6,14 @@
 
 #include "Logger.h"
 
+#include <cmath>
+#include <algorithm>
+
 #ifndef DISABLE_USER_HEADER
 LoggerInit([]{ Logger::setUserHeaderStr("[DialBase]"); });
 #endif
 
-const std::vector<double>& DialBase::getDialData() const {
+DialDataView DialBase::getDialData() const {
     LogError << "getDialData not implemented for "
              << this->getDialTypeName()
              << std::endl;
@@ -18,8 +21,33 @@ const std::vector<double>& DialBase::getDialData() const {
     throw std::runtime_error("DialBase::getDialData not implemented for "
                              + this->getDialTypeName());
 #endif
-    static const std::vector<double> dummy;
-    return dummy;
+    return {};
 }
 
 std::string DialBase::getDialTypeName() const { return {"DialBase"}; }
+
+double DialBase::evalResponseAndDerivative(const DialInputBuffer& input_, double* derivativeList_) const {
+  return DialBase::evalFiniteDifferences(input_, derivativeList_, [this](const DialInputBuffer& buffer_){
+    return this->evalResponse(buffer_);
+  });
+}
+
+double DialBase::evalFiniteDifferences(const DialInputBuffer& input_, double* derivativeList_,
+                                       const std::function<double(const DialInputBuffer&)>& responseFct_){
+  // the inputs are shifted on a copy so the shared buffer is left untouched
+  DialInputBuffer buffer{input_};
+  buffer.invalidateEpoch();
+  for( int iInput = 0 ; iInput < input_.getBufferSize() ; iInput++ ){
+    double input{input_.getInputBuffer()[iInput]};
+    double step{1E-6 * std::max(1., std::abs(input))};
+
+    buffer.getInputBuffer()[iInput] = input + step;
+    double upResponse{responseFct_(buffer)};
+    buffer.getInputBuffer()[iInput] = input - step;
+    double downResponse{responseFct_(buffer)};
+    buffer.getInputBuffer()[iInput] = input;
+
+    derivativeList_[iInput] = (upResponse - downResponse) / (2 * step);
+  }
+  return responseFct_(input_);
+}
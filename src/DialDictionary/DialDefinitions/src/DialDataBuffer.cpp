@@ -0,0 +1,82 @@
+//
+// Storage of the data block of the spline dials.
+//
+
+#include "DialDataBuffer.h"
+
+#include <algorithm>
+#include <utility>
+
+
+double* DialDataPool::allocate(size_t size_){
+  if( size_ == 0 ){ return nullptr; }
+
+  // a block larger than a chunk gets a chunk of its own, and the current
+  // chunk keeps being filled
+  if( size_ > chunkSize ){
+    std::lock_guard<std::mutex> lock(_mutex_);
+    _chunkList_.emplace_back( std::make_unique<Chunk>(size_) );
+    _nValues_ += size_;
+    return _chunkList_.back()->data.get();
+  }
+
+  Chunk* chunk{_currentChunk_.load(std::memory_order_acquire)};
+  while( true ){
+    if( chunk != nullptr ){
+      size_t begin{chunk->fill.fetch_add(size_, std::memory_order_relaxed)};
+      if( begin + size_ <= chunkSize ){
+        _nValues_.fetch_add(size_, std::memory_order_relaxed);
+        return chunk->data.get() + begin;
+      }
+    }
+
+    // the chunk is full: the first thread to get the lock adds the next one,
+    // and the end of the full chunk is left unused
+    std::lock_guard<std::mutex> lock(_mutex_);
+    if( _currentChunk_.load(std::memory_order_relaxed) == chunk ){
+      _chunkList_.emplace_back( std::make_unique<Chunk>(chunkSize) );
+      _currentChunk_.store(_chunkList_.back().get(), std::memory_order_release);
+    }
+    chunk = _currentChunk_.load(std::memory_order_relaxed);
+  }
+}
+size_t DialDataPool::getNbValues() const {
+  return _nValues_.load();
+}
+
+DialDataBuffer& DialDataBuffer::operator=(const DialDataBuffer& other_){
+  if( this != &other_ ){
+    DialDataBuffer copy(other_);
+    this->swap(copy);
+  }
+  return *this;
+}
+DialDataBuffer& DialDataBuffer::operator=(DialDataBuffer&& other_) noexcept {
+  DialDataBuffer moved(std::move(other_));
+  this->swap(moved);
+  return *this;
+}
+
+void DialDataBuffer::resize(size_t size_){
+  if( _pool_ == nullptr ){
+    _heapData_.resize(size_);
+    this->pointToHeap();
+    return;
+  }
+
+  // same content as a resized vector
+  double* block{_pool_->allocate(size_)};
+  const size_t nKept{std::min(_size_, size_)};
+  std::copy(_data_, _data_ + nKept, block);
+  std::fill(block + nKept, block + size_, 0.);
+  _data_ = block;
+  _size_ = size_;
+}
+
+void DialDataBuffer::swap(DialDataBuffer& other_) noexcept {
+  // the vector buffers are exchanged, not moved: _data_ stays valid
+  std::swap(_pool_, other_._pool_);
+  _heapData_.swap(other_._heapData_);
+  std::swap(_data_, other_._data_);
+  std::swap(_size_, other_._size_);
+}
@@ -81,3 +81,17 @@ double GeneralSpline::evalResponse(const DialInputBuffer& input_) const {
 
   return CalculateGeneralSpline( dialInput, -1E20, 1E20, _splineData_.data(), int(_splineData_.size()) );
 }
+double GeneralSpline::evalResponseAndDerivative(const DialInputBuffer& input_, double* derivativeList_) const {
+  double dialInput{input_.getInputBuffer()[0]};
+
+  // the response is flat outside of the bounds
+  bool isClamped{false};
+  if( not _allowExtrapolation_ ){
+    if     (dialInput < _splineBounds_.first) { dialInput = _splineBounds_.first; isClamped = true; }
+    else if(dialInput > _splineBounds_.second){ dialInput = _splineBounds_.second; isClamped = true; }
+  }
+
+  double response{CalculateGeneralSpline( dialInput, -1E20, 1E20, _splineData_.data(), int(_splineData_.size()), &derivativeList_[0] )};
+  if( isClamped ){ derivativeList_[0] = 0; }
+  return response;
+}
@@ -20,3 +20,26 @@ double Polynomial::evalResponse(const DialInputBuffer& input_) const {
   }
   return result;
 }
+double Polynomial::evalResponseAndDerivative(const DialInputBuffer& input_, double* derivativeList_) const {
+  double result{0};
+  double derivative{0};
+  double factor{1};
+  double dialInput{input_.getInputBuffer()[0]};
+
+  bool isClamped{false};
+  if( not _allowExtrapolation_ ){
+    if     ( dialInput < _splineBounds_.first  ){ dialInput = _splineBounds_.first; isClamped = true; }
+    else if( dialInput > _splineBounds_.second ){ dialInput = _splineBounds_.second; isClamped = true; }
+  }
+
+  for( size_t iCoef = 0 ; iCoef < _coefficientList_.size() ; iCoef++ ) {
+    result += _coefficientList_[iCoef] * factor; // y += a_n * x^{n}
+    if( iCoef + 1 < _coefficientList_.size() ){
+      derivative += double(iCoef + 1) * _coefficientList_[iCoef + 1] * factor; // y' += (n+1) * a_{n+1} * x^{n}
+    }
+    factor *= dialInput; // x^{n} * x
+  }
+
+  derivativeList_[0] = isClamped ? 0 : derivative;
+  return result;
+}
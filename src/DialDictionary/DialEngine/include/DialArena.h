@@ -0,0 +1,214 @@
+//
+// Contiguous storage of the event-by-event dials of a DialCollection.
+//
+
+#ifndef GUNDAM_DIALARENA_H
+#define GUNDAM_DIALARENA_H
+
+#include "DialBase.h"
+#include "DialInputBuffer.h"
+#include "DialDataBuffer.h"
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <array>
+#include <atomic>
+#include <algorithm>
+#include <new>
+#include <utility>
+#include <cstdint>
+
+
+/// The event-by-event dials are kept by value, in blocks of dials of the same
+/// concrete type, instead of one heap object (and one shared_ptr control
+/// block) per dial.  The dials are constructed in place by the factories
+/// (see makeDial()), and the data blocks of the spline dials are taken from
+/// the DialDataPool of the arena, so building a dial doesn't allocate.  A
+/// stored dial never moves, so the DialInterface can point to it for the
+/// lifetime of the arena.  The concrete type is also available as a tag, so
+/// the reweight loops can call the dial directly instead of going through
+/// the virtual table.
+class DialArena {
+
+public:
+  /// The dial types the arena can store.  Any other type is tagged Other.
+  enum class Type : uint8_t {
+    Other = 0,
+    Norm,
+    Shift,
+    Graph,
+    LightGraph,
+    Spline,
+    SimpleSpline,
+    CompactSpline,
+    UniformSpline,
+    GeneralSpline,
+    MonotonicSpline,
+    Bilinear,
+    Bicubic,
+    Tabulated,
+    GraphCache,
+    LightGraphCache,
+    SplineCache,
+    SimpleSplineCache,
+    CompactSplineCache,
+    UniformSplineCache,
+    GeneralSplineCache,
+    MonotonicSplineCache,
+    BilinearCache,
+    BicubicCache,
+    nTypes
+  };
+
+  /// Deleter of the dials made by makeDial(): the dials stored in an arena
+  /// are left to it.
+  struct DialDeleter {
+    bool isArenaOwned{false};
+    void operator()(DialBase* dial_) const { if( not isArenaOwned ){ delete dial_; } }
+  };
+  typedef std::unique_ptr<DialBase, DialDeleter> DialPtr;
+
+  DialArena() = default;
+  ~DialArena() = default;
+
+  // the stored dials are referenced by pointer
+  DialArena(const DialArena&) = delete;
+  DialArena& operator=(const DialArena&) = delete;
+
+  /// Default construct a dial of type type_, in the arena arena_ or on the
+  /// heap if arena_ is null.  The spline dials made in an arena keep their
+  /// data in its pool.  This is how the factories build the dials.
+  [[nodiscard]] static DialPtr makeDial(Type type_, DialArena* arena_);
+
+  /// Default construct a dial of type type_ in the arena, and return where
+  /// it is stored.  Thread safe.
+  DialBase* emplace(Type type_){ return makeDial(type_, this).release(); }
+
+  /// Construct a dial of class T (tagged type_, see getDialType()) in the
+  /// arena with the given arguments.  Thread safe.
+  template<typename T, typename... Args> T* emplace(Type type_, Args&&... args_){
+    auto* blockList = _blockListPtrArray_[size_t(type_)].load(std::memory_order_acquire);
+    if( blockList == nullptr ){
+      // first dial of this type: the arena lock is only taken here
+      std::lock_guard<std::mutex> lock(_mutex_);
+      auto& ownedBlockList = _blockListArray_[size_t(type_)];
+      if( ownedBlockList == nullptr ){
+        ownedBlockList = std::make_unique<BlockList<T>>();
+        _blockListPtrArray_[size_t(type_)].store(ownedBlockList.get(), std::memory_order_release);
+      }
+      blockList = ownedBlockList.get();
+    }
+    return static_cast<BlockList<T>*>(blockList)->emplace( std::forward<Args>(args_)... );
+  }
+
+  /// Number of dials in the arena (of all types).
+  [[nodiscard]] size_t getNbDials() const;
+
+  /// Pool holding the data of the spline dials of the arena.
+  DialDataPool& getDataPool(){ return _dataPool_; }
+
+  /// The concrete type of the dial.
+  [[nodiscard]] static Type getDialType(const DialBase* dial_);
+
+  /// Evaluate the dial of type type_ (as given by getDialType()) with a
+  /// direct call.  Other falls back on the virtual evalResponse().
+  [[nodiscard]] static double evalResponse(Type type_, const DialBase* dial_, const DialInputBuffer& input_);
+
+private:
+  /// A list of fixed size blocks holding dials of the same type.  Blocks are
+  /// only added, so the dials never move.  The slots of the current block are
+  /// reserved with an atomic counter, so the loader threads only lock the
+  /// list to add the next block.
+  class BlockListBase {
+  public:
+    virtual ~BlockListBase() = default;
+    [[nodiscard]] virtual size_t getNbDials() const = 0;
+  };
+
+  template<typename T> class BlockList : public BlockListBase {
+  public:
+    static constexpr size_t blockSize{4096};
+
+    BlockList() = default;
+    ~BlockList() override {
+      for( auto& block : _blockList_ ){
+        for( size_t iSlot = 0 ; iSlot < block->getNbSlots() ; iSlot++ ){
+          T* dial{block->at(iSlot)};
+          if( std::find(_failedSlotList_.begin(), _failedSlotList_.end(), dial) != _failedSlotList_.end() ){ continue; }
+          dial->~T();
+        }
+      }
+    }
+
+    [[nodiscard]] size_t getNbDials() const override {
+      std::lock_guard<std::mutex> lock(_mutex_);
+      size_t out{0};
+      for( auto& block : _blockList_ ){ out += block->getNbSlots(); }
+      return out - _failedSlotList_.size();
+    }
+
+    /// Construct the next dial.  Thread safe.
+    template<typename... Args> T* emplace(Args&&... args_){
+      T* slot{this->reserveSlot()};
+      try{ return new (slot) T( std::forward<Args>(args_)... ); }
+      catch( ... ){
+        // the slot stays reserved: the destructor must skip it
+        std::lock_guard<std::mutex> lock(_mutex_);
+        _failedSlotList_.emplace_back( slot );
+        throw;
+      }
+    }
+
+  private:
+    struct alignas(T) Storage { unsigned char bytes[sizeof(T)]; };
+
+    struct Block {
+      Storage slotList[blockSize];
+      // counts the failed reservations too, so it can go past blockSize
+      std::atomic<size_t> nReserved{0};
+
+      [[nodiscard]] size_t getNbSlots() const { return std::min(nReserved.load(), blockSize); }
+      T* at(size_t iSlot_){ return reinterpret_cast<T*>( &slotList[iSlot_] ); }
+    };
+
+    T* reserveSlot(){
+      Block* block{_currentBlock_.load(std::memory_order_acquire)};
+      while( true ){
+        if( block != nullptr ){
+          size_t iSlot{block->nReserved.fetch_add(1, std::memory_order_relaxed)};
+          if( iSlot < blockSize ){ return block->at(iSlot); }
+        }
+
+        // the block is full: the first thread to get the lock adds the next one
+        std::lock_guard<std::mutex> lock(_mutex_);
+        if( _currentBlock_.load(std::memory_order_relaxed) == block ){
+          // default initialized: the slots aren't touched
+          _blockList_.emplace_back( new Block );
+          _currentBlock_.store(_blockList_.back().get(), std::memory_order_release);
+        }
+        block = _currentBlock_.load(std::memory_order_relaxed);
+      }
+    }
+
+    mutable std::mutex _mutex_{};
+    std::vector<std::unique_ptr<Block>> _blockList_{};
+    std::atomic<Block*> _currentBlock_{nullptr};
+    std::vector<T*> _failedSlotList_{};
+  };
+
+  template<typename T, typename... Args> static DialPtr makeDialIn(DialArena* arena_, Type type_, Args&&... args_);
+
+  // declared first: the spline dials point into it
+  DialDataPool _dataPool_{};
+
+  // the lists are created with the arena lock, and then read through the
+  // atomic pointers
+  mutable std::mutex _mutex_{};
+  std::array<std::unique_ptr<BlockListBase>, size_t(Type::nTypes)> _blockListArray_{};
+  std::array<std::atomic<BlockListBase*>, size_t(Type::nTypes)> _blockListPtrArray_{};
+
+};
+
+
+#endif //GUNDAM_DIALARENA_H
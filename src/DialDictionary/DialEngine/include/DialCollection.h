@@ -9,7 +9,9 @@
 #include "DialInterface.h"
 #include "DialInputBuffer.h"
 #include "DialResponseSupervisor.h"
+#include "DialArena.h"
 #include "SampleSet.h"
+#include "CompiledFormula.h"
 
 #include "GenericToolbox.Wrappers.h"
 
@@ -39,7 +41,9 @@ public:
   // Temporarily replace specialty class with shared_ptr.  The shared_ptr
   // class has the correct semantics (copyable, and deletes the object), but
   // we don't need the reference counting since we can only have one of each
-  // object.  Also shared_ptr is a bit to memory hungry.
+  // object.  Also shared_ptr is a bit to memory hungry.  The event-by-event
+  // dials share the ownership of the DialArena they are stored in (see
+  // setEventByEventDial()), so they don't get a control block each.
   typedef std::shared_ptr<DialBase> DialBaseObject;
 
   // setters
@@ -94,6 +98,9 @@ public:
   // A formula to decide if the dial should be applied to an event.  The dial
   // should be applied if this returns a non-zero value.
   [[nodiscard]] const std::shared_ptr<TFormula> &getApplyConditionFormula() const{ return _applyConditionFormula_; }
+  // Same formula compiled by CompiledFormula.  Not valid if the expression
+  // is not supported: getApplyConditionFormula() should be used instead.
+  [[nodiscard]] const CompiledFormula &getApplyConditionCompiledFormula() const{ return _applyConditionCompiledFormula_; }
 
   // non-const getters
   DataBinSet &getDialBinSet(){ return _dialBinSet_; }
@@ -156,6 +163,16 @@ public:
   // thread safe, so multiple threads can fill the list.
   size_t getNextDialFreeSlot(){ return _dialFreeSlot_++; }
 
+  // The arena holding the event-by-event dials.  The factories construct
+  // the dials directly in it (see DialBaseFactory::setDialArena()).
+  DialArena& getDialArena(){ return *_dialArena_; }
+
+  // Store an event-by-event dial in the slot iSlot_ of the DialBaseList.
+  // The dial must have been built in the arena of the collection, so it
+  // costs neither a heap object nor a shared_ptr control block.  Thread safe
+  // (as long as the slots are different).
+  void setEventByEventDial(size_t iSlot_, DialBase* dialBase_);
+
   // Provide access to a the collection data.  The ownership is retained by
   // the collection.
   template <typename T>
@@ -227,8 +244,13 @@ private:
 
   // A formula to decide if the dial should be applied to an event.
   std::shared_ptr<TFormula> _applyConditionFormula_{nullptr};
+  CompiledFormula _applyConditionCompiledFormula_{};
   GenericToolbox::Atomic<size_t> _dialFreeSlot_{0};
 
+  // Owner of the event-by-event dials.  The DialBaseObject of these dials
+  // share its ownership, so the arena lives as long as any of them.
+  std::shared_ptr<DialArena> _dialArena_{std::make_shared<DialArena>()};
+
   // A pointer to dial specific data
   std::vector<std::shared_ptr<DialCollection::CollectionData>>  _dialCollectionData_;
 
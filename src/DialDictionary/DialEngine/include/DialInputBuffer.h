@@ -58,20 +58,23 @@ public:
   [[nodiscard]] size_t getInputSize() const{ return _inputParameterReferenceList_.size(); }
   [[nodiscard]] const std::vector<double>& getInputBuffer() const { return _inputBuffer_; }
   [[nodiscard]] const std::vector<ParameterReference> &getInputParameterIndicesList() const{ return _inputParameterReferenceList_; }
-#if USE_ZLIB
-  [[nodiscard]] const uint32_t& getCurrentHash() const{ return _currentHash_; }
-#endif
+  [[nodiscard]] uint64_t getEpoch() const{ return _epoch_; }
 
   // mutable getters
 
   /// Function that allow to tweak the buffer from the inside. Used for
-  /// individual spline evaluation.
+  /// individual spline evaluation.  Call invalidateEpoch() before editing
+  /// the values, or the cached dials would return the stamped responses.
   std::vector<double>& getInputBuffer(){ return _inputBuffer_; }
   std::vector<ParameterReference> &getInputParameterIndicesList(){ return _inputParameterReferenceList_; }
 
   // core
   void invalidateBuffers();
 
+  /// Drop the epoch stamped by update(), so the cached dials evaluate the
+  /// buffer directly.  Needed when the values are edited by hand.
+  void invalidateEpoch(){ _epoch_ = 0; }
+
   /// Make sure everything is ready for use
   void initialise();
 
@@ -79,11 +82,20 @@ public:
   /// mirroring to the parameter values.
   void update();
 
+  /// Same as update(), but taking the parameter values from
+  /// parameterValueList_[parSetIndex][parIndex] instead of the parameter
+  /// sets.  Used on private copies of the buffer.
+  void update(const std::vector<std::vector<double>>& parameterValueList_);
+
   // nested getters
   [[nodiscard]] const ParameterSet& getParameterSet(int iInput_) const{ return _inputParameterReferenceList_[iInput_].getParameterSet(_parSetListPtr_); }
   [[nodiscard]] const Parameter& getParameter(int iInput_) const { return _inputParameterReferenceList_[iInput_].getParameter(_parSetListPtr_); }
   [[nodiscard]] const ParameterReference::MirrorEdges& getMirrorEdges(int iInput_) const{ return _inputParameterReferenceList_[iInput_].mirrorEdges; }
 
+  /// Derivative of the buffered input with respect to its parameter value:
+  /// +1, or -1 on the mirrored segments.
+  [[nodiscard]] double getInputDerivative(int iInput_) const;
+
   /// Push the index of a ParameterSet and Parameter in the set onto the
   /// vector of parameters.  This must be used in the order that the dial will
   /// be expecting the parameters (e.g. for a 2D parameter,
@@ -97,9 +109,8 @@ public:
   [[deprecated("use getParameterSet()")]] [[nodiscard]] const ParameterSet& getFitParameterSet(int i=0) const { return getParameterSet(i); }
 
 protected:
-#if USE_ZLIB
-  uint32_t generateHash();
-#endif
+  void stampEpoch();
+  void setInputValue(const ParameterReference& inputRef_, double parValue_);
 
 private:
   /// Flag if the member can be still edited.
@@ -126,10 +137,11 @@ private:
   /// has one entry)
   std::vector<ParameterReference> _inputParameterReferenceList_{};
 
-#if USE_ZLIB
-  // for cache
-  uint32_t _currentHash_{0};
-#endif
+  /// Identifies the current buffer values for the cached dials.  A new
+  /// value is drawn from a process-wide counter each time update() changes
+  /// the buffer, so two buffers only share an epoch if one is a copy of the
+  /// other holding the same values.  Zero means "not stamped".
+  uint64_t _epoch_{0};
 
 };
 
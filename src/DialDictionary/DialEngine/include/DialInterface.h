@@ -48,6 +48,11 @@ public:
   [[nodiscard]] inline const DataBin* getDialBinRef() const {return _dialBinRef_;}
 
   [[nodiscard]] double evalResponse() const;
+
+  /// Evaluate the response and fill derivativeList_ with its derivatives
+  /// with respect to the parameters of the input buffer (mirroring and
+  /// response cap included).  derivativeList_ needs one slot per input.
+  [[nodiscard]] double evalResponseAndDerivative(double* derivativeList_) const;
   [[nodiscard]] std::string getSummary(bool shallow_=true) const;
 
 private:
@@ -58,6 +63,10 @@ private:
 
 public:
   [[nodiscard]] static double evalResponse(DialInputBuffer* inputBufferPtr_, DialBase* dialBaseRef_, const DialResponseSupervisor* responseSupervisorRef_);
+  [[nodiscard]] static double evalResponseAndDerivative(DialInputBuffer* inputBufferPtr_, DialBase* dialBaseRef_, const DialResponseSupervisor* responseSupervisorRef_, double* derivativeList_);
+  /// Evaluate the dial with another input buffer than its own, bypassing the
+  /// dial response cache.
+  [[nodiscard]] static double evalUncachedResponse(const DialInputBuffer& inputBuffer_, const DialBase* dialBaseRef_, const DialResponseSupervisor* responseSupervisorRef_);
 
 };
 
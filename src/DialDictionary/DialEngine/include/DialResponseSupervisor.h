@@ -25,6 +25,8 @@ public:
   [[nodiscard]] double getMaxResponse() const{ return _maxResponse_; }
 
   [[nodiscard]] double process(double reponse_) const;
+  /// Derivative of the processed response: zero where the cap applies
+  [[nodiscard]] double processDerivative(double reponse_, double derivative_) const;
   [[nodiscard]] std::string getSummary() const;
 
 
@@ -9,6 +9,7 @@
 #include "DialCollection.h"
 #include "Event.h"
 #include "DialInterface.h"
+#include "DialArena.h"
 
 
 // DEV
@@ -18,6 +19,7 @@
 
 #include <vector>
 #include <utility>
+#include <cstdint>
 
 
 class EventDialCache{
@@ -36,46 +38,119 @@ public:
     }
   };
 
-  /// DialResponseCache is keeping a reference of a DialInterface and a cached double for the response
+  /// DialResponseCache is keeping a reference of a DialInterface and a cached
+  /// double for the response.  There is only ONE DialResponseCache per
+  /// DialInterface used in the cache: events sharing a dial (norms, binned
+  /// splines...) are all pointing to the same slot, so the response is only
+  /// evaluated once per propagation.
   struct DialResponseCache {
     explicit DialResponseCache( DialInterface& interface_ )
-      : dialInterface(interface_) {
-      this->updateRequested = dialInterface.getInputBufferRef()->isDialUpdateRequestedPtr();
+      : dialInterface(&interface_) {
+      this->updateRequested = dialInterface->getInputBufferRef()->isDialUpdateRequestedPtr();
     }
     // The dial interface to be used with the Event.
-    DialInterface& dialInterface;
-    // The cached result calculated by the dial.
-    double response{std::nan("unset")};
+    DialInterface* dialInterface{nullptr};
     // A cached boolean to check if the dial needs to be updated.
     bool *updateRequested{nullptr};
-    void update(){
-      // Reevaluate the dial if an update has been requested
+    [[nodiscard]] bool isUpdateRequested() const {
 #ifdef EVENT_DIAL_CACHE_SAFE_SLOW_INTERFACE
-      if( dialInterface.getInputBufferRef()->isDialUpdateRequested() ){
+      return dialInterface->getInputBufferRef()->isDialUpdateRequested();
 #else
-      if( *(this->updateRequested) ) {
+      return *(this->updateRequested);
 #endif
-        response = dialInterface.evalResponse();
-      }
     }
-    double getResponse(){
-      this->update();
-      return response;
+  };
+
+  /// DialInputGroup is referencing the update flag of one DialInputBuffer.
+  /// All the dials sharing this input will need to be reevaluated at once,
+  /// so the cache is keeping track of the entries depending on it.
+  struct DialInputGroup {
+    explicit DialInputGroup( DialInputBuffer* inputBuffer_ )
+      : inputBuffer(inputBuffer_), updateRequested(inputBuffer_->isDialUpdateRequestedPtr()) {}
+    DialInputBuffer* inputBuffer{nullptr};
+    bool *updateRequested{nullptr};
+    [[nodiscard]] bool isUpdateRequested() const {
+#ifdef EVENT_DIAL_CACHE_SAFE_SLOW_INTERFACE
+      return inputBuffer->isDialUpdateRequested();
+#else
+      return *(this->updateRequested);
+#endif
     }
   };
 
+  /// SplineBatch is grouping the spline dials of the same type that are
+  /// sharing the same DialInputGroup.  The spline data is copied in a single
+  /// buffer (with the Cache::Manager layout) so the splines can be evaluated
+  /// together by the vectorized CalculateSplineBatch functions.
+  struct SplineBatch {
+    enum class Type { Compact, Uniform, General, Monotonic };
+    Type type{Type::Compact};
+    // Index of the DialInputGroup providing the parameter value.
+    size_t inputGroupIndex{0};
+    // The response slots filled by the batch.
+    std::vector<uint32_t> slotList{};
+    // Range of the input value for each spline (only if extrapolation is
+    // not allowed, otherwise infinite).
+    std::vector<double> inputMinList{};
+    std::vector<double> inputMaxList{};
+    // The spline i is using splineData[ dataIndexList[i] .. dataIndexList[i+1] [
+    std::vector<int> dataIndexList{};
+    std::vector<double> splineData{};
+    // Shared-knot batch: all the splines have the same knots and input range
+    // (inputMinList and inputMaxList then hold a single value).  The knots
+    // are kept once in knotList, and splineData is replaced by the cubic
+    // coefficients of each segment: spline i in segment s uses
+    // coefficientList[ 4*(s*nSplines + i) .. 4*(s*nSplines + i) + 4 [
+    std::vector<double> knotList{};
+    std::vector<double> coefficientList{};
+    [[nodiscard]] bool isSharedKnot() const { return not knotList.empty(); }
+  };
+
+  /// Non-owning view on the dials associated with one cache entry. The dials
+  /// are stored in the flat arrays of the EventDialCache, so this is only a
+  /// pair of pointers and can be used in range-based for loops.
+  class DialInterfaceRange {
+  public:
+    class Iterator {
+    public:
+      Iterator(const uint32_t* indexPtr_, const DialResponseCache* slotList_) : _indexPtr_(indexPtr_), _slotList_(slotList_) {}
+      DialInterface& operator*() const { return *_slotList_[*_indexPtr_].dialInterface; }
+      Iterator& operator++(){ ++_indexPtr_; return *this; }
+      bool operator!=(const Iterator& other_) const { return _indexPtr_ != other_._indexPtr_; }
+    private:
+      const uint32_t* _indexPtr_{nullptr};
+      const DialResponseCache* _slotList_{nullptr};
+    };
+
+    DialInterfaceRange() = default;
+    DialInterfaceRange(const uint32_t* begin_, const uint32_t* end_, const DialResponseCache* slotList_)
+      : _begin_(begin_), _end_(end_), _slotList_(slotList_) {}
+
+    [[nodiscard]] Iterator begin() const { return {_begin_, _slotList_}; }
+    [[nodiscard]] Iterator end() const { return {_end_, _slotList_}; }
+    [[nodiscard]] size_t size() const { return size_t(_end_ - _begin_); }
+    [[nodiscard]] bool empty() const { return _begin_ == _end_; }
+    [[nodiscard]] DialInterface& operator[](size_t i_) const { return *_slotList_[_begin_[i_]].dialInterface; }
+
+  private:
+    const uint32_t* _begin_{nullptr};
+    const uint32_t* _end_{nullptr};
+    const DialResponseCache* _slotList_{nullptr};
+  };
+
   /// The cache element associating a Event to the appropriate
-  /// DialInterface.
+  /// DialInterface.  This is a lightweight view built on request: the
+  /// actual data is held in the flat reweight arrays.
   struct CacheEntry {
-    Event* event;
-    std::vector<DialResponseCache> dialResponseCacheList{};
+    Event* event{nullptr};
+    DialInterfaceRange dialInterfaceList{};
 
     [[nodiscard]] std::string getSummary() const {
       std::stringstream ss;
       ss << *event << std::endl;
       ss << "Dials{";
-      for( auto& dialResponseCache : dialResponseCacheList ){
-        ss << std::endl << "  { " << dialResponseCache.dialInterface.getSummary() << " }";
+      for( auto& dialInterface : dialInterfaceList ){
+        ss << std::endl << "  { " << dialInterface.getSummary() << " }";
       }
       ss << std::endl << "}";
       return ss.str();
@@ -128,7 +203,7 @@ public:
   /// A mapping between the event (in the SampleSet, and the dial (in the
   /// DialCollectionVector).  This will be used to build a fast lookup table
   /// between the PhysicsEvent* and the DialInterface* (i.e. a CacheElem_t
-  /// returned by getCache().
+  /// returned by getEntry().
   struct IndexedCacheEntry{
     EventIndexCacheEntry event;
     std::vector<DialIndexCacheEntry> dials;
@@ -150,18 +225,42 @@ public:
   // returns the current index
   [[nodiscard]] size_t getFillIndex() const { return _fillIndex_; }
 
-  /// Provide the event dial cache.  The event dial cache containes a
-  /// CacheElem_t object for every dial applied to a physics event.  The
-  /// CacheElem_t is a pointer to the PhysicsEvent that will be reweighted and
-  /// a pointer to the DialInterface that will do the reweighting.  Note: Each
-  /// PhysicsEvent will probably be in the cache multiple times (for different
-  /// DialInterface objects), and each DialInterface object could be in the
-  /// cache multiple times (but for different Physics event objects).
-  std::vector<CacheEntry> &getCache(){ return _cache_; }
-  [[nodiscard]] const std::vector<CacheEntry> &getCache() const{ return _cache_; }
+  /// The indexed cache entries as filled by the data loader.
+  [[nodiscard]] const std::vector<IndexedCacheEntry>& getIndexedCache() const { return _indexedCache_; }
+
+  /// Number of events handled by the cache.
+  [[nodiscard]] size_t getNbEntries() const { return _eventPtrList_.size(); }
+
+  /// Provide a view on the cache entry for the event at index iEntry_. The
+  /// entry holds a pointer to the Event that will be reweighted and the
+  /// DialInterface objects that will do the reweighting.  Note: Each
+  /// DialInterface object could be referenced by multiple entries (but for
+  /// different Event objects).
+  [[nodiscard]] CacheEntry getEntry(size_t iEntry_) const;
+
+  /// The list of unique dial responses slots
+  [[nodiscard]] const std::vector<DialResponseCache>& getDialResponseCacheList() const { return _dialResponseCacheList_; }
+
+  /// The spline batches built by buildReferenceCache()
+  [[nodiscard]] const std::vector<SplineBatch>& getSplineBatchList() const { return _splineBatchList_; }
 
   GlobalEventReweightCap& getGlobalEventReweightCap(){ return _globalEventReweightCap_; }
 
+  /// Reweight factor the entry iEntry_ would get with the slot responses
+  /// responseList_ (one per getDialResponseCacheList() element), cap
+  /// included.  The event itself is left untouched.
+  [[nodiscard]] double evalEntryReweight(size_t iEntry_, const double* responseList_) const;
+
+  /// Base weight of the entry, and sum of the squared base weights of its
+  /// events.  For a super-event (see setEnableEventGrouping()) these are
+  /// summed over all the grouped events.
+  [[nodiscard]] double getEntryBaseWeight(size_t iEntry_) const;
+  [[nodiscard]] double getEntrySquaredBaseWeight(size_t iEntry_) const;
+
+  /// The events reweighted by the entry: only one unless the entry is a
+  /// super-event.
+  [[nodiscard]] SampleElement::Histogram::EventPtrRange getEntryEventList(size_t iEntry_) const;
+
   /// Allocate entries for events in the indexed cache.  The first parameter
   /// arethe number of events to allocate space for, and the second number is
   /// the total number of dials that might exist for each event.
@@ -173,6 +272,16 @@ public:
   /// of the pointer is not passed to the caller.
   IndexedCacheEntry* fetchNextCacheEntry();
 
+  /// Claim nEntries_ consecutive indexed cache entries at once and return
+  /// the index of the first one.  This lets each loading thread fill its own
+  /// range without locking.  The entries that are left unfilled keep an
+  /// invalid event index and are skipped by buildReferenceCache().
+  size_t reserveCacheEntries(size_t nEntries_);
+
+  /// Get an entry claimed with reserveCacheEntries().  Same WARNING as
+  /// fetchNextCacheEntry().
+  IndexedCacheEntry* getCacheEntryPtr(size_t iEntry_){ return &_indexedCache_[iEntry_]; }
+
   /// Build the association between pointers to PhysicsEvent objects and the
   /// pointers to DialInterface objects.  This must be done before the event
   /// dial cache can be used, but after the index cache has been filled.
@@ -182,10 +291,130 @@ public:
   /// Resize the cache vectors to remove entries with null events
   void shrinkIndexedCache();
 
-  void reweightEntry( CacheEntry& entry_);
+  /// Evaluate the spline dials sharing the same input with the vectorized
+  /// batch functions.  Must be set before buildReferenceCache().
+  void setEnableSplineBatchEval(bool enableSplineBatchEval_){ _enableSplineBatchEval_ = enableSplineBatchEval_; }
+
+  /// The batched splines sharing the same knots are reduced to per-segment
+  /// cubic coefficients, so the knot search is done once per batch.  Must be
+  /// set before buildReferenceCache().
+  void setEnableSharedKnotSplines(bool enableSharedKnotSplines_){ _enableSharedKnotSplines_ = enableSharedKnotSplines_; }
+
+  /// Merge the entries sharing the same sample bin and the same dials into
+  /// super-events carrying the sum of the base weights (and of their
+  /// squares).  The reweight is then done once per super-event: the
+  /// histograms have to be filled with fillHistograms() and the weights of
+  /// the grouped events are only set by updateGroupedEventWeights().  The
+  /// entries with event-by-event dials are left as they are.  Must be set
+  /// before buildReferenceCache().
+  void setEnableEventGrouping(bool enableEventGrouping_){ _enableEventGrouping_ = enableEventGrouping_; }
+
+  /// Reorder the events of each sample (within each dataset) so the events
+  /// using the same dials, then falling in the same sample bin, are next to
+  /// each other in memory.  Otherwise the events are sorted by dataset
+  /// entry.  Must be set before buildReferenceCache().
+  void setEnableLocalityOrdering(bool enableLocalityOrdering_){ _enableLocalityOrdering_ = enableLocalityOrdering_; }
+
+  /// True if some of the entries are super-events.
+  [[nodiscard]] bool isEventGrouped() const { return _nSingleEntries_ < _eventPtrList_.size(); }
+
+  /// Evaluate the responses of the dials that have been flagged for an
+  /// update.  Dials are split among threads by slot index, and each batch of
+  /// splines is split among threads.  This must be done for every thread
+  /// before calling reweightEvents().
+  void updateDialResponses(int iThread_, int nThreads_);
+
+  /// Single thread step to be called in between updateDialResponses() and
+  /// reweightEvents().  Looks up the dial inputs that have been updated and
+  /// list the entries that need to be reweighted.  If too many entries are
+  /// affected (or if a full reweight has been requested), all the events will
+  /// be reweighted.  A full reweight is also done if the MC weights have
+  /// been thrown since the last call (see SampleElement::throwEventMcError()),
+  /// since only a full reweight resets the weights of every event.
+  void prepareReweight();
+
+  /// Apply the product of the cached dial responses to each event.  Events
+  /// are split among threads by contiguous ranges.  In incremental mode, only
+  /// the entries flagged by prepareReweight() are processed.
+  void reweightEvents(int iThread_, int nThreads_);
+
+  /// Force the next reweight to process every event.
+  void requestFullReweight(){ _isFullReweightRequested_ = true; }
+
+  /// Set the MC histograms of the samples from the last reweight: each
+  /// super-event adds its summed weights to its bin.  Bins are split among
+  /// threads.  Only needed if isEventGrouped().
+  void fillHistograms(SampleSet& sampleSet_, int iThread_, int nThreads_) const;
+
+  /// Propagate the reweight of each super-event to the weights of its
+  /// events.  Super-events are split among threads.
+  void updateGroupedEventWeights(int iThread_, int nThreads_);
+
+  /// True if the last prepareReweight() only selected a subset of entries.
+  [[nodiscard]] bool isIncrementalReweight() const { return _isIncrementalReweight_; }
+
+  /// Indices of the entries reweighted in incremental mode.
+  [[nodiscard]] const std::vector<uint32_t>& getDirtyEntryList() const { return _dirtyEntryList_; }
+
+  /// Event weights prior to the incremental reweight, in sync with
+  /// getDirtyEntryList().  Used to propagate weight deltas to the histograms.
+  [[nodiscard]] const std::vector<EventUtils::WeightType>& getDirtyEntryPreviousWeightList() const { return _dirtyEntryPreviousWeightList_; }
+
+  /// Number of incremental histogram updates in a row after which
+  /// prepareHistogramUpdate() asks for a full refill, to get rid of the
+  /// accumulated rounding errors.
+  void setHistogramResumPeriod(int histogramResumPeriod_){ _histogramResumPeriod_ = histogramResumPeriod_; }
+
+  /// Single thread step before updateHistograms(): the dirty entries of the
+  /// last incremental reweight are split among nThreads_ threads by bin
+  /// (iBin % nThreads_), so each bin is only touched by one thread.  Returns
+  /// false if the histograms have to be refilled instead: full or grouped
+  /// reweight, or periodic resum.  The histograms must have been in sync
+  /// with the event weights prior to the reweight.
+  bool prepareHistogramUpdate(int nThreads_);
+
+  /// The histograms have been refilled from the event weights: the count of
+  /// incremental updates starts over.
+  void resetHistogramUpdateCount(){ _nHistogramUpdates_ = 0; }
+
+  /// Propagate the weight change of the dirty entries of the thread iThread_
+  /// (see prepareHistogramUpdate()) to the bin contents and sums of squared
+  /// weights of the MC histograms.
+  void updateHistograms(SampleSet& sampleSet_, int iThread_) const;
+
+  /// Prepare the buffers holding the derivatives of each dial slot.  The
+  /// derivatives are accumulated in a flat parameter vector where the
+  /// parameter set iParSet starts at parSetOffsetList_[iParSet].  Returns
+  /// false if one of the dials can't provide its derivatives.
+  bool buildDerivativeCache(const std::vector<size_t>& parSetOffsetList_);
+
+  /// Evaluate the response and the derivatives of every dial slot.  Slots
+  /// are split among threads.  Must be done for every thread before calling
+  /// accumulateGradient().
+  void updateDialDerivatives(int iThread_, int nThreads_);
+
+  /// Add the derivatives of the likelihood with respect to the parameters
+  /// (flat index, see buildDerivativeCache()) to gradient_.  The chain rule
+  /// goes through the weight of each event: contentDerivativeList_ and
+  /// sumW2DerivativeList_ are the derivatives of the likelihood with respect
+  /// to the content and to the sum of squared weights of each [sample][bin].
+  /// Events are split among threads, each thread needs its own gradient_.
+  void accumulateGradient(int iThread_, int nThreads_,
+                          const std::vector<std::vector<double>>& contentDerivativeList_,
+                          const std::vector<std::vector<double>>& sumW2DerivativeList_,
+                          std::vector<double>& gradient_) const;
 
 
 private:
+  void reweightEntry(size_t iEntry_);
+  [[nodiscard]] std::vector<size_t> getEventOrdering(const std::vector<Event>& eventList_,
+                                                     const std::vector<IndexedCacheEntry>& indexCacheList_,
+                                                     const std::vector<DialCollection>& dialCollectionList_) const;
+  void buildInputEntryIndex(const std::vector<size_t>& slotGroupIndexList_);
+  void buildSplineBatches(const std::vector<size_t>& slotGroupIndexList_);
+  void groupEvents(SampleSet& sampleSet_, const std::vector<size_t>& slotGroupIndexList_);
+  void evalSplineBatch(const SplineBatch& batch_, size_t beginIndex_, size_t endIndex_);
+
   // The next available entry in the indexed cache.
   size_t _fillIndex_{0};
 
@@ -196,9 +425,82 @@ private:
   // and dials.
   std::vector<IndexedCacheEntry> _indexedCache_{};
 
-  /// A cache of all of the valid PhysicsEvent* and DialInterface*
-  /// associations for efficient use when reweighting the MC events.
-  std::vector<CacheEntry> _cache_{};
+  /// The flat (CSR-like) reweight arrays.  Entry iEntry is reweighting the
+  /// event _eventPtrList_[iEntry] with the response of the dial slots
+  /// _dialIndexList_[ _dialOffsetList_[iEntry] .. _dialOffsetList_[iEntry+1] [
+  /// All of them are contiguous, so the reweight loop is only streaming
+  /// through memory.
+  std::vector<Event*> _eventPtrList_{};
+  std::vector<size_t> _dialOffsetList_{};
+  std::vector<uint32_t> _dialIndexList_{};
+
+  /// One slot per unique DialInterface, and the associated cached response.
+  /// The responses are multiplied in double precision.
+  std::vector<DialResponseCache> _dialResponseCacheList_{};
+  std::vector<EventUtils::WeightType> _dialResponseList_{};
+
+  /// The slots evaluated one by one through the DialInterface, and the
+  /// batches of splines evaluated together.
+  bool _enableSplineBatchEval_{true};
+  bool _enableSharedKnotSplines_{true};
+  bool _enableLocalityOrdering_{true};
+  std::vector<uint32_t> _scalarSlotList_{};
+  std::vector<DialArena::Type> _scalarSlotTypeList_{};
+  std::vector<SplineBatch> _splineBatchList_{};
+
+  /// Inverted index: entries affected by each DialInputGroup.  The entries of
+  /// the group iGroup are _inputEntryIndexList_[ _inputEntryOffsetList_[iGroup]
+  /// .. _inputEntryOffsetList_[iGroup+1] [
+  std::vector<DialInputGroup> _dialInputGroupList_{};
+  std::vector<size_t> _inputEntryOffsetList_{};
+  std::vector<uint32_t> _inputEntryIndexList_{};
+
+  /// Super-events: the entries from _nSingleEntries_ are the super-events
+  /// iSuper = iEntry - _nSingleEntries_.  Their events are
+  /// _superEventMemberList_[ _superEventOffsetList_[iSuper] ..
+  /// _superEventOffsetList_[iSuper+1] [ and the last reweight factor is kept
+  /// in _superEventReweightList_[iSuper].
+  bool _enableEventGrouping_{false};
+  size_t _nSingleEntries_{0};
+  std::vector<size_t> _superEventOffsetList_{};
+  std::vector<Event*> _superEventMemberList_{};
+  std::vector<double> _superEventSumWeightList_{};
+  std::vector<double> _superEventSumSquaredWeightList_{};
+  std::vector<double> _superEventReweightList_{};
+
+  /// Entries of each sample bin, to fill the histograms of the grouped
+  /// events: _binEntryIndexList_[iSample][ _binEntryOffsetList_[iSample][iBin]
+  /// .. _binEntryOffsetList_[iSample][iBin+1] [
+  std::vector<std::vector<size_t>> _binEntryOffsetList_{};
+  std::vector<std::vector<uint32_t>> _binEntryIndexList_{};
+
+  /// Incremental reweight state
+  const SampleSet* _sampleSetPtr_{nullptr};
+  size_t _mcExternalEditCount_{0};
+  bool _isFullReweightRequested_{true};
+  bool _isIncrementalReweight_{false};
+  double _maxIncrementalReweightFraction_{0.5};
+  std::vector<uint32_t> _dirtyEntryList_{};
+  std::vector<EventUtils::WeightType> _dirtyEntryPreviousWeightList_{};
+  std::vector<unsigned char> _isEntryDirtyList_{};
+
+  /// Incremental histogram update state.  _threadDirtyIndexList_[iThread]
+  /// holds the indices in _dirtyEntryList_ of the events falling in the
+  /// bins iBin % nThreads == iThread.
+  int _histogramResumPeriod_{100};
+  int _nHistogramUpdates_{0};
+  std::vector<std::vector<uint32_t>> _threadDirtyIndexList_{};
+
+  /// Derivative buffers: the derivatives of the slot iSlot are
+  /// _slotDerivativeList_[ _slotDerivativeOffsetList_[iSlot] ..
+  /// _slotDerivativeOffsetList_[iSlot+1] [ with respect to the parameters at
+  /// the same positions in _slotDerivativeParIndexList_.  The responses are
+  /// kept apart from _dialResponseList_, which is not filled when the
+  /// weights are computed by the Cache::Manager.
+  std::vector<size_t> _slotDerivativeOffsetList_{};
+  std::vector<uint32_t> _slotDerivativeParIndexList_{};
+  std::vector<double> _slotDerivativeList_{};
+  std::vector<double> _slotDerivativeResponseList_{};
 
   /// Global cap
   GlobalEventReweightCap _globalEventReweightCap_{};
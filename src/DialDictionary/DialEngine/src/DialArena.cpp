@@ -0,0 +1,137 @@
+//
+// Contiguous storage of the event-by-event dials of a DialCollection.
+//
+
+#include "DialArena.h"
+
+#include "Norm.h"
+#include "Shift.h"
+#include "Graph.h"
+#include "LightGraph.h"
+#include "Spline.h"
+#include "SimpleSpline.h"
+#include "CompactSpline.h"
+#include "UniformSpline.h"
+#include "GeneralSpline.h"
+#include "MonotonicSpline.h"
+#include "Bilinear.h"
+#include "Bicubic.h"
+#include "Tabulated.h"
+
+#include "Logger.h"
+
+#include <typeinfo>
+#include <utility>
+
+#ifndef DISABLE_USER_HEADER
+LoggerInit([]{ Logger::setUserHeaderStr("[DialArena]"); });
+#endif
+
+
+template<typename T, typename... Args> DialArena::DialPtr DialArena::makeDialIn(DialArena* arena_, Type type_, Args&&... args_){
+  if( arena_ == nullptr ){ return DialPtr( new T( std::forward<Args>(args_)... ), DialDeleter{false} ); }
+  return DialPtr( arena_->emplace<T>( type_, std::forward<Args>(args_)... ), DialDeleter{true} );
+}
+
+DialArena::DialPtr DialArena::makeDial(Type type_, DialArena* arena_){
+  // on the heap, the spline data is on the heap too
+  DialDataPool* dataPool{arena_ != nullptr ? &arena_->_dataPool_ : nullptr};
+
+  switch( type_ ){
+    case Type::Norm:                 return makeDialIn<Norm>( arena_, type_ );
+    case Type::Shift:                return makeDialIn<Shift>( arena_, type_ );
+    case Type::Graph:                return makeDialIn<Graph>( arena_, type_ );
+    case Type::LightGraph:           return makeDialIn<LightGraph>( arena_, type_ );
+    case Type::Spline:               return makeDialIn<Spline>( arena_, type_ );
+    case Type::SimpleSpline:         return makeDialIn<SimpleSpline>( arena_, type_ );
+    case Type::CompactSpline:        return makeDialIn<CompactSpline>( arena_, type_, dataPool );
+    case Type::UniformSpline:        return makeDialIn<UniformSpline>( arena_, type_, dataPool );
+    case Type::GeneralSpline:        return makeDialIn<GeneralSpline>( arena_, type_, dataPool );
+    case Type::MonotonicSpline:      return makeDialIn<MonotonicSpline>( arena_, type_, dataPool );
+    case Type::Bilinear:             return makeDialIn<Bilinear>( arena_, type_ );
+    case Type::Bicubic:              return makeDialIn<Bicubic>( arena_, type_ );
+    case Type::GraphCache:           return makeDialIn<GraphCache>( arena_, type_ );
+    case Type::LightGraphCache:      return makeDialIn<LightGraphCache>( arena_, type_ );
+    case Type::SplineCache:          return makeDialIn<SplineCache>( arena_, type_ );
+    case Type::SimpleSplineCache:    return makeDialIn<SimpleSplineCache>( arena_, type_ );
+    case Type::CompactSplineCache:   return makeDialIn<CompactSplineCache>( arena_, type_, dataPool );
+    case Type::UniformSplineCache:   return makeDialIn<UniformSplineCache>( arena_, type_, dataPool );
+    case Type::GeneralSplineCache:   return makeDialIn<GeneralSplineCache>( arena_, type_, dataPool );
+    case Type::MonotonicSplineCache: return makeDialIn<MonotonicSplineCache>( arena_, type_, dataPool );
+    case Type::BilinearCache:        return makeDialIn<BilinearCache>( arena_, type_ );
+    case Type::BicubicCache:         return makeDialIn<BicubicCache>( arena_, type_ );
+    default: break;
+  }
+
+  // Tabulated needs its table: see emplace<T>()
+  LogThrow( "Dial type " << int(type_) << " can't be default constructed." );
+}
+
+size_t DialArena::getNbDials() const {
+  std::lock_guard<std::mutex> lock(_mutex_);
+  size_t out{0};
+  for( auto& blockList : _blockListArray_ ){
+    if( blockList != nullptr ){ out += blockList->getNbDials(); }
+  }
+  return out;
+}
+
+DialArena::Type DialArena::getDialType(const DialBase* dial_){
+  // exact type only: a CachedDial<T> has its own tag, not the one of T
+  auto& typeId = typeid(*dial_);
+  if( typeId == typeid(Norm) )                 return Type::Norm;
+  if( typeId == typeid(Shift) )                return Type::Shift;
+  if( typeId == typeid(Graph) )                return Type::Graph;
+  if( typeId == typeid(LightGraph) )           return Type::LightGraph;
+  if( typeId == typeid(Spline) )               return Type::Spline;
+  if( typeId == typeid(SimpleSpline) )         return Type::SimpleSpline;
+  if( typeId == typeid(CompactSpline) )        return Type::CompactSpline;
+  if( typeId == typeid(UniformSpline) )        return Type::UniformSpline;
+  if( typeId == typeid(GeneralSpline) )        return Type::GeneralSpline;
+  if( typeId == typeid(MonotonicSpline) )      return Type::MonotonicSpline;
+  if( typeId == typeid(Bilinear) )             return Type::Bilinear;
+  if( typeId == typeid(Bicubic) )              return Type::Bicubic;
+  if( typeId == typeid(Tabulated) )            return Type::Tabulated;
+  if( typeId == typeid(GraphCache) )           return Type::GraphCache;
+  if( typeId == typeid(LightGraphCache) )      return Type::LightGraphCache;
+  if( typeId == typeid(SplineCache) )          return Type::SplineCache;
+  if( typeId == typeid(SimpleSplineCache) )    return Type::SimpleSplineCache;
+  if( typeId == typeid(CompactSplineCache) )   return Type::CompactSplineCache;
+  if( typeId == typeid(UniformSplineCache) )   return Type::UniformSplineCache;
+  if( typeId == typeid(GeneralSplineCache) )   return Type::GeneralSplineCache;
+  if( typeId == typeid(MonotonicSplineCache) ) return Type::MonotonicSplineCache;
+  if( typeId == typeid(BilinearCache) )        return Type::BilinearCache;
+  if( typeId == typeid(BicubicCache) )         return Type::BicubicCache;
+  return Type::Other;
+}
+
+double DialArena::evalResponse(Type type_, const DialBase* dial_, const DialInputBuffer& input_){
+  // qualified calls: no lookup in the virtual table
+  switch( type_ ){
+    case Type::Norm:                 return static_cast<const Norm*>(dial_)->Norm::evalResponse(input_);
+    case Type::Shift:                return static_cast<const Shift*>(dial_)->Shift::evalResponse(input_);
+    case Type::Graph:                return static_cast<const Graph*>(dial_)->Graph::evalResponse(input_);
+    case Type::LightGraph:           return static_cast<const LightGraph*>(dial_)->LightGraph::evalResponse(input_);
+    case Type::Spline:               return static_cast<const Spline*>(dial_)->Spline::evalResponse(input_);
+    case Type::SimpleSpline:         return static_cast<const SimpleSpline*>(dial_)->SimpleSpline::evalResponse(input_);
+    case Type::CompactSpline:        return static_cast<const CompactSpline*>(dial_)->CompactSpline::evalResponse(input_);
+    case Type::UniformSpline:        return static_cast<const UniformSpline*>(dial_)->UniformSpline::evalResponse(input_);
+    case Type::GeneralSpline:        return static_cast<const GeneralSpline*>(dial_)->GeneralSpline::evalResponse(input_);
+    case Type::MonotonicSpline:      return static_cast<const MonotonicSpline*>(dial_)->MonotonicSpline::evalResponse(input_);
+    case Type::Bilinear:             return static_cast<const Bilinear*>(dial_)->Bilinear::evalResponse(input_);
+    case Type::Bicubic:              return static_cast<const Bicubic*>(dial_)->Bicubic::evalResponse(input_);
+    case Type::Tabulated:            return static_cast<const Tabulated*>(dial_)->Tabulated::evalResponse(input_);
+    case Type::GraphCache:           return static_cast<const GraphCache*>(dial_)->GraphCache::evalResponse(input_);
+    case Type::LightGraphCache:      return static_cast<const LightGraphCache*>(dial_)->LightGraphCache::evalResponse(input_);
+    case Type::SplineCache:          return static_cast<const SplineCache*>(dial_)->SplineCache::evalResponse(input_);
+    case Type::SimpleSplineCache:    return static_cast<const SimpleSplineCache*>(dial_)->SimpleSplineCache::evalResponse(input_);
+    case Type::CompactSplineCache:   return static_cast<const CompactSplineCache*>(dial_)->CompactSplineCache::evalResponse(input_);
+    case Type::UniformSplineCache:   return static_cast<const UniformSplineCache*>(dial_)->UniformSplineCache::evalResponse(input_);
+    case Type::GeneralSplineCache:   return static_cast<const GeneralSplineCache*>(dial_)->GeneralSplineCache::evalResponse(input_);
+    case Type::MonotonicSplineCache: return static_cast<const MonotonicSplineCache*>(dial_)->MonotonicSplineCache::evalResponse(input_);
+    case Type::BilinearCache:        return static_cast<const BilinearCache*>(dial_)->BilinearCache::evalResponse(input_);
+    case Type::BicubicCache:         return static_cast<const BicubicCache*>(dial_)->BicubicCache::evalResponse(input_);
+    default: break;
+  }
+  return dial_->evalResponse(input_);
+}
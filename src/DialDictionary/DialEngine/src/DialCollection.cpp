@@ -137,6 +137,13 @@ void DialCollection::clear(){
   _dialInterfaceList_.shrink_to_fit();
   _dialBaseList_.shrink_to_fit();
   _dialFreeSlot_.setValue(0);
+
+  // the previous arena is released with the last of its dials
+  _dialArena_ = std::make_shared<DialArena>();
+}
+void DialCollection::setEventByEventDial(size_t iSlot_, DialBase* dialBase_){
+  // aliasing constructor: the arena is the owner, no control block per dial
+  _dialBaseList_[iSlot_] = DialBaseObject( _dialArena_, dialBase_ );
 }
 
 void DialCollection::resizeContainers(){
@@ -374,6 +381,11 @@ void DialCollection::readGlobals(const JsonType &config_) {
     _applyConditionFormula_ = std::make_shared<TFormula>("_applyConditionFormula_", _applyConditionStr_.c_str());
     LogThrowIf(not _applyConditionFormula_->IsValid(),
                "\"" << _applyConditionStr_ << "\": could not be parsed as formula expression.")
+
+    // evaluated for every loaded event: use the bytecode version if possible
+    if( not _applyConditionCompiledFormula_.compile(_applyConditionStr_, CompiledFormula::Syntax::TFormula) ){
+      LogDebug << "Apply condition evaluated with TFormula: " << _applyConditionCompiledFormula_.getSummary() << std::endl;
+    }
   }
 
   _minDialResponse_ = GenericToolbox::Json::fetchValue(config_, {{"minDialResponse"}, {"minimumSplineResponse"}}, _minDialResponse_);
@@ -571,6 +583,8 @@ bool DialCollection::initializeDialsWithBinningFile(const JsonType& dialsDefinit
           _dialBinSet_.getBinList().erase(_dialBinSet_.getBinList().begin() + iBin);
         }
       }
+      // the lookup index refers to the bins by position
+      _dialBinSet_.buildBinLookupIndex();
     }
 
     dialsTFile->Close();
@@ -6,17 +6,21 @@
 
 #include "Logger.h"
 
-#if USE_ZLIB
-#include "zlib.h"
-#endif
+#include <atomic>
 
 #ifndef DISABLE_USER_HEADER
 LoggerInit([]{ Logger::setUserHeaderStr("[DialInputBuffer]"); });
 #endif
 
+namespace{
+  // shared by all the buffers (and their private copies) so an epoch is never reused
+  std::atomic<uint64_t> globalEpochCounter{0};
+}
+
 void DialInputBuffer::invalidateBuffers(){
   // invalidate buffer
   for( auto& buf : _inputBuffer_ ){ buf = std::nan("unset"); }
+  _epoch_ = 0;
 }
 
 void DialInputBuffer::initialise(){
@@ -30,6 +34,7 @@ void DialInputBuffer::initialise(){
 
   // set the buffer to the proper size
   _inputBuffer_.resize(_inputArraySize_, std::nan("unset"));
+  _epoch_ = 0;
 
   // sanity checks
   for( int iInput = 0 ; iInput < _inputArraySize_ ; iInput++ ){
@@ -52,39 +57,60 @@ void DialInputBuffer::update(){
   _isDialUpdateRequested_ = true;
 
   // look for the parameter values
-  double tempBuffer;
   _isDialUpdateRequested_ = false; // if ANY is different, request the update
   for( auto& inputRef : _inputParameterReferenceList_ ){
-    // grab the value of the parameter
-    tempBuffer = inputRef.getParameter(_parSetListPtr_).getParameterValue();
-
-    // find the actual parameter value if mirroring is applied
-    if( not std::isnan( inputRef.mirrorEdges.minValue ) ){
-      tempBuffer = std::abs(std::fmod(
-          tempBuffer - inputRef.mirrorEdges.minValue,
-          2 * inputRef.mirrorEdges.range
-      ));
-
-      if( tempBuffer > inputRef.mirrorEdges.range ){
-        // odd pattern  -> mirrored -> decreasing effective X while increasing parameter
-        tempBuffer -= 2 * inputRef.mirrorEdges.range;
-        tempBuffer = -tempBuffer;
-      }
-
-      // re-apply the offset
-      tempBuffer += inputRef.mirrorEdges.minValue;
-    }
+    this->setInputValue( inputRef, inputRef.getParameter(_parSetListPtr_).getParameterValue() );
+  }
 
-    // has it been updated?
-    if( _inputBuffer_[inputRef.bufferIndex] != tempBuffer ){
-      _isDialUpdateRequested_ = true;
-      _inputBuffer_[inputRef.bufferIndex] = tempBuffer;
+  this->stampEpoch();
+}
+void DialInputBuffer::update(const std::vector<std::vector<double>>& parameterValueList_){
+  _isDialUpdateRequested_ = false;
+  for( auto& inputRef : _inputParameterReferenceList_ ){
+    this->setInputValue( inputRef, parameterValueList_[inputRef.parSetIndex][inputRef.parIndex] );
+  }
+
+  this->stampEpoch();
+}
+void DialInputBuffer::stampEpoch(){
+  // keeping the epoch when nothing has changed lets the cached responses survive
+  if( _isDialUpdateRequested_ or _epoch_ == 0 ){ _epoch_ = ++globalEpochCounter; }
+}
+void DialInputBuffer::setInputValue(const ParameterReference& inputRef_, double parValue_){
+  double tempBuffer{parValue_};
+
+  // find the actual parameter value if mirroring is applied
+  if( not std::isnan( inputRef_.mirrorEdges.minValue ) ){
+    tempBuffer = std::abs(std::fmod(
+        tempBuffer - inputRef_.mirrorEdges.minValue,
+        2 * inputRef_.mirrorEdges.range
+    ));
+
+    if( tempBuffer > inputRef_.mirrorEdges.range ){
+      // odd pattern  -> mirrored -> decreasing effective X while increasing parameter
+      tempBuffer -= 2 * inputRef_.mirrorEdges.range;
+      tempBuffer = -tempBuffer;
     }
+
+    // re-apply the offset
+    tempBuffer += inputRef_.mirrorEdges.minValue;
   }
 
-#if USE_ZLIB
-  _currentHash_ = generateHash();
-#endif
+  // has it been updated?
+  if( _inputBuffer_[inputRef_.bufferIndex] != tempBuffer ){
+    _isDialUpdateRequested_ = true;
+    _inputBuffer_[inputRef_.bufferIndex] = tempBuffer;
+  }
+}
+double DialInputBuffer::getInputDerivative(int iInput_) const{
+  auto& inputRef = _inputParameterReferenceList_[iInput_];
+  if( std::isnan( inputRef.mirrorEdges.minValue ) ){ return 1; }
+
+  // same folding as in update()
+  double shiftedValue{inputRef.getParameter(_parSetListPtr_).getParameterValue() - inputRef.mirrorEdges.minValue};
+  double sign{shiftedValue < 0 ? -1. : 1.}; // abs() of fmod
+  if( std::abs(std::fmod(shiftedValue, 2 * inputRef.mirrorEdges.range)) > inputRef.mirrorEdges.range ){ sign = -sign; }
+  return sign;
 }
 void DialInputBuffer::addParameterReference( const ParameterReference& parReference_){
   LogThrowIf(_isInitialized_, "Can't add parameter index while initialized.");
@@ -114,15 +140,3 @@ std::string DialInputBuffer::getSummary() const{
 
   return ss.str();
 }
-
-#if USE_ZLIB
-uint32_t DialInputBuffer::generateHash(){
-  uint32_t out = crc32(0L, Z_NULL, 0);
-  double* inputPtr = _inputBuffer_.data();
-  while( inputPtr < _inputBuffer_.data() + _inputBuffer_.size() ){
-    out = crc32( out, (const Bytef*) inputPtr, sizeof(double) );
-    inputPtr++;
-  }
-  return out;
-}
-#endif
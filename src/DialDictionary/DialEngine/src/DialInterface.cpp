@@ -15,6 +15,9 @@ LoggerInit([]{ Logger::setUserHeaderStr("[DialInterface]"); });
 double DialInterface::evalResponse() const {
   return DialInterface::evalResponse(_inputBufferRef_, _dialBaseRef_, _responseSupervisorRef_);
 }
+double DialInterface::evalResponseAndDerivative(double* derivativeList_) const {
+  return DialInterface::evalResponseAndDerivative(_inputBufferRef_, _dialBaseRef_, _responseSupervisorRef_, derivativeList_);
+}
 std::string DialInterface::getSummary(bool shallow_) const {
   std::stringstream ss;
   ss << _dialBaseRef_->getDialTypeName() << ":";
@@ -48,3 +51,21 @@ double DialInterface::evalResponse(
     ) {
   return responseSupervisorRef_->process( dialBaseRef_->evalResponse( *inputBufferPtr_ ) );
 }
+double DialInterface::evalUncachedResponse(
+    const DialInputBuffer& inputBuffer_, const DialBase *dialBaseRef_,
+    const DialResponseSupervisor *responseSupervisorRef_
+    ) {
+  return responseSupervisorRef_->process( dialBaseRef_->evalUncachedResponse( inputBuffer_ ) );
+}
+double DialInterface::evalResponseAndDerivative(
+    DialInputBuffer *inputBufferPtr_, DialBase *dialBaseRef_,
+    const DialResponseSupervisor *responseSupervisorRef_, double* derivativeList_
+    ) {
+  double response{dialBaseRef_->evalResponseAndDerivative( *inputBufferPtr_, derivativeList_ )};
+  for( int iInput = 0 ; iInput < inputBufferPtr_->getBufferSize() ; iInput++ ){
+    derivativeList_[iInput] = responseSupervisorRef_->processDerivative(
+        response, derivativeList_[iInput] * inputBufferPtr_->getInputDerivative( iInput )
+    );
+  }
+  return responseSupervisorRef_->process( response );
+}
@@ -16,6 +16,11 @@ double DialResponseSupervisor::process(double reponse_) const {
 
   return reponse_;
 }
+double DialResponseSupervisor::processDerivative(double reponse_, double derivative_) const {
+  if     ( not std::isnan(_minResponse_) and reponse_ < _minResponse_ ){ return 0; }
+  else if( not std::isnan(_maxResponse_) and reponse_ > _maxResponse_ ){ return 0; }
+  return derivative_;
+}
 std::string DialResponseSupervisor::getSummary() const{
   std::stringstream ss;
 
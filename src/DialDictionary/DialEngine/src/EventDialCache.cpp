@@ -3,13 +3,138 @@
 //
 
 #include "EventDialCache.h"
+#include "CompactSpline.h"
+#include "UniformSpline.h"
+#include "GeneralSpline.h"
+#include "MonotonicSpline.h"
+#include "CalculateSplineBatch.h"
 
+#include "GenericToolbox.Thread.h"
 #include "Logger.h"
 
+#include <unordered_map>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <cmath>
+#include <map>
+
 #ifndef DISABLE_USER_HEADER
 LoggerInit([]{ Logger::setUserHeaderStr("[EventDialCache]"); });
 #endif
 
+namespace {
+  // The knots of a spline, as read by the CalculateXXXSpline functions:
+  // {low, step, nKnots} for the uniformly spaced knots, or the list of the
+  // knot positions for a GeneralSpline.  Empty if there are too few knots.
+  std::vector<double> getSplineKnotList(EventDialCache::SplineBatch::Type type_, const DialDataView& data_){
+    using Type = EventDialCache::SplineBatch::Type;
+    if( type_ == Type::Compact or type_ == Type::Monotonic ){
+      if( data_.size() < 4 ){ return {}; }
+      return { data_[0], data_[1], double(data_.size() - 2) };
+    }
+    if( type_ == Type::Uniform ){
+      if( data_.size() < 8 ){ return {}; }
+      return { data_[0], data_[1], double((data_.size() - 2) / 2) };
+    }
+    size_t nKnots{(data_.size() - 2) / 3};
+    if( nKnots < 2 ){ return {}; }
+    std::vector<double> out(nKnots);
+    for( size_t iKnot = 0 ; iKnot < nKnots ; iKnot++ ){ out[iKnot] = data_[2 + 3*iKnot + 2]; }
+    return out;
+  }
+
+  size_t getNbSegments(EventDialCache::SplineBatch::Type type_, const std::vector<double>& knotList_){
+    using Type = EventDialCache::SplineBatch::Type;
+    // the compact splines have a different slope on both extrapolated sides
+    if( type_ == Type::Compact or type_ == Type::Monotonic ){ return size_t(knotList_[2]) + 1; }
+    if( type_ == Type::Uniform ){ return size_t(knotList_[2]) - 1; }
+    return knotList_.size() - 1;
+  }
+
+  // Same segment as found by the CalculateXXXSpline functions for the input
+  // x_, and the position fx_ of x_ in it.
+  size_t findSharedKnotSegment(const EventDialCache::SplineBatch& batch_, double x_, double& fx_){
+    using Type = EventDialCache::SplineBatch::Type;
+    auto& knotList = batch_.knotList;
+    if( batch_.type == Type::General ){
+      const int knotCount = int(knotList.size()) - 2;
+      int ix = 0;
+      for( int offset : {8, 4, 2, 1} ){
+        if( ix + offset < knotCount and x_ > knotList[ix + offset] ){ ix += offset; }
+      }
+      fx_ = (x_ - knotList[ix]) / (knotList[ix+1] - knotList[ix]);
+      return size_t(ix);
+    }
+
+    const int nKnots{int(knotList[2])};
+    const double xx{(x_ - knotList[0]) / knotList[1]};
+    if( batch_.type == Type::Uniform ){
+      int ix = int(xx);
+      ix = std::min(std::max(ix, 0), nKnots - 2);
+      fx_ = xx - ix;
+      return size_t(ix);
+    }
+
+    const int ix{int(xx) - (xx < 0.0 ? 1 : 0)};
+    fx_ = xx - std::min(std::max(ix, 0), nKnots - 2);
+    return size_t(std::min(std::max(ix, -1), nKnots - 1) + 1);
+  }
+
+  // Cubic coefficients {c0, c1, c2, c3} of the segment iSegment_ of the
+  // spline, so the response is c0 + c1*fx + c2*fx^2 + c3*fx^3.  The slopes
+  // are the ones of the CalculateXXXSpline functions.
+  void fillSharedKnotCoefficients(EventDialCache::SplineBatch::Type type_, const DialDataView& data_,
+                                  size_t iSegment_, double* out_){
+    using Type = EventDialCache::SplineBatch::Type;
+    double p1, m1, p2, m2;
+    if( type_ == Type::Compact or type_ == Type::Monotonic ){
+      const int dim{int(data_.size()) - 2};
+      const int ix{int(iSegment_) - 1};
+      const int d21_0{std::min(std::max(ix - 1, 0), dim - 2)};
+      const int d32_0{std::min(std::max(ix, 0), dim - 2)};
+      const int d43_0{std::min(std::max(ix + 1, 0), dim - 2)};
+
+      p1 = data_[2 + d32_0];
+      p2 = data_[3 + d32_0];
+      const double d21{data_[3 + d21_0] - data_[2 + d21_0]};
+      const double d32{p2 - p1};
+      const double d43{data_[3 + d43_0] - data_[2 + d43_0]};
+      m1 = 0.5*(d21 + d32);
+      m2 = 0.5*(d32 + d43);
+
+      if( type_ == Type::Monotonic ){
+        // Fritsch-Carlson condition, as in CalculateMonotonicSpline
+        if( d32*d21 <= 0.0 ){ m1 = 0.0; }
+        if( d43*d32 <= 0.0 ){ m2 = 0.0; }
+        const double delta1{3.0*std::min(std::abs(d21), std::abs(d32))};
+        const double delta2{3.0*std::min(std::abs(d32), std::abs(d43))};
+        m1 = std::min(std::max(m1, -delta1), delta1);
+        m2 = std::min(std::max(m2, -delta2), delta2);
+      }
+    }
+    else if( type_ == Type::Uniform ){
+      const double step{data_[1]};
+      p1 = data_[2 + 2*iSegment_];
+      m1 = data_[3 + 2*iSegment_] * step;
+      p2 = data_[4 + 2*iSegment_];
+      m2 = data_[5 + 2*iSegment_] * step;
+    }
+    else{
+      const double step{data_[2 + 3*(iSegment_+1) + 2] - data_[2 + 3*iSegment_ + 2]};
+      p1 = data_[2 + 3*iSegment_];
+      m1 = data_[3 + 3*iSegment_] * step;
+      p2 = data_[2 + 3*(iSegment_+1)];
+      m2 = data_[3 + 3*(iSegment_+1)] * step;
+    }
+
+    out_[0] = p1;
+    out_[1] = m1;
+    out_[2] = 3.0*p2 - 3.0*p1 - m2 - 2.0*m1;
+    out_[3] = 2.0*p1 - 2.0*p2 + m2 + m1;
+  }
+}
+
 void EventDialCache::buildReferenceCache( SampleSet& sampleSet_, std::vector<DialCollection>& dialCollectionList_){
   LogInfo << "Building event dial cache..." << std::endl;
 
@@ -22,42 +147,50 @@ void EventDialCache::buildReferenceCache( SampleSet& sampleSet_, std::vector<Dia
   {
     LogScopeIndent;
     LogInfo << "Breaking down indexed cache per sample..." << std::endl;
+    // each entry is placed at the index of its event, so both lists can be
+    // permuted together
+    std::vector<size_t> nPlacedEntriesList(sampleIndexCacheList.size(), 0);
+    for( size_t iSample = 0 ; iSample < sampleIndexCacheList.size() ; iSample++ ){
+      sampleIndexCacheList[iSample].resize( sampleSet_.getSampleList()[iSample].getMcContainer().getEventList().size() );
+    }
     for( auto& entry : _indexedCache_ ){
       if( entry.event.sampleIndex == size_t(-1) ){ continue; }
       if( entry.event.eventIndex == size_t(-1) ){ continue; }
 
-      sampleIndexCacheList[entry.event.sampleIndex].emplace_back( entry );
-      sampleIndexCacheList[entry.event.sampleIndex].back().dials.clear();
+      auto& sampleIndexCache = sampleIndexCacheList[entry.event.sampleIndex];
+      LogThrowIf(entry.event.eventIndex >= sampleIndexCache.size(),
+                 "Indexed cache entry is pointing to a non-existing event: " << entry.event);
+      auto& indexCache = sampleIndexCache[entry.event.eventIndex];
+      LogThrowIf(indexCache.event.eventIndex != size_t(-1),
+                 "Several indexed cache entries are pointing to the same event: " << entry.event);
+      nPlacedEntriesList[entry.event.sampleIndex]++;
+
+      indexCache.event = entry.event;
       for( auto& dial : entry.dials ){
         if( dial.collectionIndex == size_t(-1) ){ continue; }
         if( dial.interfaceIndex == size_t(-1)  ){ continue; }
-        sampleIndexCacheList[entry.event.sampleIndex].back().dials.emplace_back(dial);
+        indexCache.dials.emplace_back(dial);
       }
     }
 
     LogInfo << "Cleaning up the index cache..." << std::endl;
     _indexedCache_.clear();
 
-    LogInfo << "Performing per sample sorting..." << std::endl;
+    LogInfo << "Performing per sample sorting"
+            << ( _enableLocalityOrdering_ ? " (clustering the events by dials and bins)" : "" ) << "..." << std::endl;
     int iSample{-1};
     for( auto& sample : sampleSet_.getSampleList() ){
       iSample++;
 
-      auto p = GenericToolbox::getSortPermutation(
-          sample.getMcContainer().getEventList(), []( const Event& a, const Event& b) {
-            if( a.getIndices().dataset < a.getIndices().dataset ){ return true; }
-            if( a.getIndices().entry < b.getIndices().entry ){ return true; }
-            return false;
-          });
-
       LogThrowIf(
-          sampleIndexCacheList[iSample].size() != sample.getMcContainer().getEventList().size(),
+          nPlacedEntriesList[iSample] != sample.getMcContainer().getEventList().size(),
           std::endl << "MISMATCH cache and event list for sample: #" << sample.getIndex() << " " << sample.getName()
-              << std::endl << GET_VAR_NAME_VALUE(sampleIndexCacheList[iSample].size())
+              << std::endl << GET_VAR_NAME_VALUE(nPlacedEntriesList[iSample])
               << " <-> " << GET_VAR_NAME_VALUE(sample.getMcContainer().getEventList().size())
       );
       nCacheSlots += sampleIndexCacheList[iSample].size();
 
+      auto p = getEventOrdering( sample.getMcContainer().getEventList(), sampleIndexCacheList[iSample], dialCollectionList_ );
       GenericToolbox::applyPermutation( sample.getMcContainer().getEventList(), p );
       GenericToolbox::applyPermutation( sampleIndexCacheList[iSample],     p );
 
@@ -69,44 +202,436 @@ void EventDialCache::buildReferenceCache( SampleSet& sampleSet_, std::vector<Dia
 
   }
 
-  auto countValidDials = [](std::vector<DialIndexCacheEntry>& dialIndices_){
-    return std::count_if(dialIndices_.begin(), dialIndices_.end(),
-      []( DialIndexCacheEntry& dialIndex_){
-        if( dialIndex_.collectionIndex == size_t(-1) ){ return false; }
-        if( dialIndex_.interfaceIndex == size_t(-1) ){ return false; }
-        return true;
-      });
-  };
+  LogInfo << "Assigning response slots to the dial interfaces..." << std::endl;
+  // Only ONE slot per DialInterface: shared dials (norm, binned...) are then
+  // evaluated once, no matter how many events they apply to. Slots are
+  // assigned following the collection order for better memory locality.
+  std::vector<std::vector<uint32_t>> slotIndexList(dialCollectionList_.size());
+  for( size_t iCollection = 0 ; iCollection < dialCollectionList_.size() ; iCollection++ ){
+    slotIndexList[iCollection].resize(dialCollectionList_[iCollection].getDialInterfaceList().size(), uint32_t(-1));
+  }
+
+  size_t nDialRefs{0};
+  for( auto& sampleIndexCache : sampleIndexCacheList ){
+    for( auto& indexCache : sampleIndexCache ){
+      for( auto& dialIndex : indexCache.dials ){
+        slotIndexList[dialIndex.collectionIndex][dialIndex.interfaceIndex] = 0; // flag as used
+        nDialRefs++;
+      }
+    }
+  }
+
+  _dialResponseCacheList_.clear();
+  for( size_t iCollection = 0 ; iCollection < dialCollectionList_.size() ; iCollection++ ){
+    for( size_t iInterface = 0 ; iInterface < slotIndexList[iCollection].size() ; iInterface++ ){
+      if( slotIndexList[iCollection][iInterface] == uint32_t(-1) ){ continue; } // not used by any event
+      LogThrowIf(_dialResponseCacheList_.size() >= size_t(uint32_t(-1)), "Too many dials to be indexed with 32 bits.");
+      slotIndexList[iCollection][iInterface] = uint32_t(_dialResponseCacheList_.size());
+      _dialResponseCacheList_.emplace_back( dialCollectionList_[iCollection].getDialInterfaceList()[iInterface] );
+    }
+  }
+  _dialResponseCacheList_.shrink_to_fit();
+  _dialResponseList_.clear();
+  _dialResponseList_.resize(_dialResponseCacheList_.size(), std::nan("unset"));
+
+  LogInfo << "Filling up the " << nCacheSlots << " cache entries with " << nDialRefs
+          << " references to " << _dialResponseCacheList_.size() << " dials..." << std::endl;
+  _eventPtrList_.clear();
+  _dialOffsetList_.clear();
+  _dialIndexList_.clear();
 
-  LogInfo << "Filling up the " << nCacheSlots << " cache dial with references..." << std::endl;
-  _cache_.reserve( nCacheSlots );
+  _eventPtrList_.reserve( nCacheSlots );
+  _dialOffsetList_.reserve( nCacheSlots + 1 );
+  _dialIndexList_.reserve( nDialRefs );
 
+  _dialOffsetList_.emplace_back( 0 );
   for( auto& sampleIndexCache : sampleIndexCacheList ){
     for( auto& indexCache : sampleIndexCache ){
-      
-      _cache_.emplace_back();
-      auto& cacheEntry = _cache_.back();
 
-      cacheEntry.event =
+      _eventPtrList_.emplace_back(
           &sampleSet_.getSampleList().at(
               indexCache.event.sampleIndex
           ).getMcContainer().getEventList().at(
               indexCache.event.eventIndex
-          );
-
-      // make sure we don't need extra allocation while emplace_back
-      cacheEntry.dialResponseCacheList.reserve( countValidDials(indexCache.dials) );
+          )
+      );
 
       // filling up the dial references
       for( auto& dialIndex : indexCache.dials ){
-        if( dialIndex.collectionIndex == size_t(-1) or dialIndex.interfaceIndex == size_t(-1) ){ continue; }
-        cacheEntry.dialResponseCacheList.emplace_back(
-            dialCollectionList_.at(dialIndex.collectionIndex)
-            .getDialInterfaceList().at(dialIndex.interfaceIndex)
-        );
+        _dialIndexList_.emplace_back( slotIndexList[dialIndex.collectionIndex][dialIndex.interfaceIndex] );
       }
+
+      _dialOffsetList_.emplace_back( _dialIndexList_.size() );
+    }
+  }
+
+  LogInfo << "Building the inverted index of the dial inputs..." << std::endl;
+  LogThrowIf(_eventPtrList_.size() >= size_t(uint32_t(-1)), "Too many events to be indexed with 32 bits.");
+  std::vector<size_t> slotGroupIndexList(_dialResponseCacheList_.size());
+  {
+    std::unordered_map<const DialInputBuffer*, size_t> groupIndexMap{};
+    _dialInputGroupList_.clear();
+    for( size_t iSlot = 0 ; iSlot < _dialResponseCacheList_.size() ; iSlot++ ){
+      auto* inputBuffer = _dialResponseCacheList_[iSlot].dialInterface->getInputBufferRef();
+      auto it = groupIndexMap.find(inputBuffer);
+      if( it == groupIndexMap.end() ){
+        it = groupIndexMap.emplace(inputBuffer, _dialInputGroupList_.size()).first;
+        _dialInputGroupList_.emplace_back( inputBuffer );
+      }
+      slotGroupIndexList[iSlot] = it->second;
+    }
+  }
+
+  buildInputEntryIndex( slotGroupIndexList );
+  LogInfo << _dialInputGroupList_.size() << " dial inputs are referenced by the cache." << std::endl;
+
+  buildSplineBatches( slotGroupIndexList );
+
+  _nSingleEntries_ = _eventPtrList_.size();
+  if( _enableEventGrouping_ ){ groupEvents( sampleSet_, slotGroupIndexList ); }
+
+  _sampleSetPtr_ = &sampleSet_;
+  _mcExternalEditCount_ = sampleSet_.getMcExternalEditCount();
+  _dirtyEntryList_.clear();
+  _isEntryDirtyList_.clear();
+  _isEntryDirtyList_.resize(_eventPtrList_.size(), false);
+  _isIncrementalReweight_ = false;
+  _isFullReweightRequested_ = true;
+}
+std::vector<size_t> EventDialCache::getEventOrdering(const std::vector<Event>& eventList_,
+                                                     const std::vector<IndexedCacheEntry>& indexCacheList_,
+                                                     const std::vector<DialCollection>& dialCollectionList_) const{
+  std::vector<size_t> out(eventList_.size());
+  std::iota(out.begin(), out.end(), 0);
+
+  if( not _enableLocalityOrdering_ ){
+    std::sort(out.begin(), out.end(), [&](size_t a_, size_t b_){
+      auto& a = eventList_[a_].getIndices();
+      auto& b = eventList_[b_].getIndices();
+      if( a.dataset != b.dataset ){ return a.dataset < b.dataset; }
+      return a.entry < b.entry;
+    });
+    return out;
+  }
+
+  // The dial signature of an event is the list of its (collection, dial bin)
+  // pairs.  An event-by-event dial is unique to its event, so only its
+  // collection is taken into account.
+  typedef std::vector<std::pair<size_t, size_t>> DialSignature;
+  std::map<DialSignature, uint32_t> signatureIndexMap{};
+  std::vector<std::map<DialSignature, uint32_t>::iterator> eventSignatureList(eventList_.size());
+  DialSignature signature{};
+  for( size_t iEvent = 0 ; iEvent < eventList_.size() ; iEvent++ ){
+    signature.clear();
+    for( auto& dial : indexCacheList_[iEvent].dials ){
+      signature.emplace_back(
+          dial.collectionIndex,
+          dialCollectionList_[dial.collectionIndex].isEventByEvent() ? size_t(-1) : dial.interfaceIndex
+      );
     }
+    std::sort( signature.begin(), signature.end() );
+    eventSignatureList[iEvent] = signatureIndexMap.emplace( signature, 0 ).first;
   }
+
+  // ranked in the map order so the similar signatures are next to each other
+  uint32_t signatureIndex{0};
+  for( auto& signatureEntry : signatureIndexMap ){ signatureEntry.second = signatureIndex++; }
+
+  // the datasets are kept as contiguous blocks: the SampleElement refers to
+  // their events by range
+  std::sort(out.begin(), out.end(), [&](size_t a_, size_t b_){
+    auto& a = eventList_[a_].getIndices();
+    auto& b = eventList_[b_].getIndices();
+    if( a.dataset != b.dataset ){ return a.dataset < b.dataset; }
+    if( eventSignatureList[a_]->second != eventSignatureList[b_]->second ){
+      return eventSignatureList[a_]->second < eventSignatureList[b_]->second;
+    }
+    if( a.bin != b.bin ){ return a.bin < b.bin; }
+    return a.entry < b.entry;
+  });
+  return out;
+}
+void EventDialCache::buildInputEntryIndex(const std::vector<size_t>& slotGroupIndexList_){
+  // counting sort of the (group, entry) pairs: entries are visited in order,
+  // so duplicates within a group are consecutive
+  std::vector<uint32_t> lastEntryInGroup(_dialInputGroupList_.size(), uint32_t(-1));
+  _inputEntryOffsetList_.clear();
+  _inputEntryOffsetList_.resize(_dialInputGroupList_.size() + 1, 0);
+  for( size_t iEntry = 0 ; iEntry < _eventPtrList_.size() ; iEntry++ ){
+    for( size_t iDial = _dialOffsetList_[iEntry] ; iDial < _dialOffsetList_[iEntry+1] ; iDial++ ){
+      auto iGroup = slotGroupIndexList_[_dialIndexList_[iDial]];
+      if( lastEntryInGroup[iGroup] == uint32_t(iEntry) ){ continue; }
+      lastEntryInGroup[iGroup] = uint32_t(iEntry);
+      _inputEntryOffsetList_[iGroup+1]++;
+    }
+  }
+  for( size_t iGroup = 0 ; iGroup < _dialInputGroupList_.size() ; iGroup++ ){
+    _inputEntryOffsetList_[iGroup+1] += _inputEntryOffsetList_[iGroup];
+  }
+
+  _inputEntryIndexList_.clear();
+  _inputEntryIndexList_.resize(_inputEntryOffsetList_.back());
+  std::vector<size_t> fillPosition(_inputEntryOffsetList_.begin(), _inputEntryOffsetList_.end() - 1);
+  std::fill(lastEntryInGroup.begin(), lastEntryInGroup.end(), uint32_t(-1));
+  for( size_t iEntry = 0 ; iEntry < _eventPtrList_.size() ; iEntry++ ){
+    for( size_t iDial = _dialOffsetList_[iEntry] ; iDial < _dialOffsetList_[iEntry+1] ; iDial++ ){
+      auto iGroup = slotGroupIndexList_[_dialIndexList_[iDial]];
+      if( lastEntryInGroup[iGroup] == uint32_t(iEntry) ){ continue; }
+      lastEntryInGroup[iGroup] = uint32_t(iEntry);
+      _inputEntryIndexList_[fillPosition[iGroup]++] = uint32_t(iEntry);
+    }
+  }
+}
+void EventDialCache::groupEvents(SampleSet& sampleSet_, const std::vector<size_t>& slotGroupIndexList_){
+  LogInfo << "Grouping the events sharing the same bin and the same dials..." << std::endl;
+
+  // a response slot used by a single entry is an event-by-event dial: these
+  // entries can't share their reweight with any other one
+  std::vector<uint32_t> slotNbRefList(_dialResponseCacheList_.size(), 0);
+  for( auto iSlot : _dialIndexList_ ){ slotNbRefList[iSlot]++; }
+
+  // the entries with the same sample, bin and (sorted) response slots get
+  // the same reweight factor
+  std::map<std::vector<uint32_t>, uint32_t> keyIndexMap{};
+  std::vector<uint32_t> entryKeyIndexList(_eventPtrList_.size(), uint32_t(-1));
+  std::vector<uint32_t> keyNbEntriesList{};
+  std::vector<uint32_t> key{};
+  for( size_t iEntry = 0 ; iEntry < _eventPtrList_.size() ; iEntry++ ){
+    auto dialBegin = _dialIndexList_.begin() + long(_dialOffsetList_[iEntry]);
+    auto dialEnd = _dialIndexList_.begin() + long(_dialOffsetList_[iEntry+1]);
+    if( std::any_of(dialBegin, dialEnd, [&](uint32_t iSlot_){ return slotNbRefList[iSlot_] < 2; }) ){ continue; }
+
+    auto& indices = _eventPtrList_[iEntry]->getIndices();
+    key.clear();
+    key.emplace_back( uint32_t(indices.sample) );
+    key.emplace_back( uint32_t(indices.bin) );
+    key.insert( key.end(), dialBegin, dialEnd );
+    std::sort( key.begin() + 2, key.end() );
+
+    auto it = keyIndexMap.find( key );
+    if( it == keyIndexMap.end() ){
+      it = keyIndexMap.emplace( key, uint32_t(keyNbEntriesList.size()) ).first;
+      keyNbEntriesList.emplace_back( 0 );
+    }
+    entryKeyIndexList[iEntry] = it->second;
+    keyNbEntriesList[it->second]++;
+  }
+
+  // only the keys shared by several entries are worth a super-event
+  std::vector<uint32_t> keySuperEventList(keyNbEntriesList.size(), uint32_t(-1));
+  _superEventOffsetList_.assign( 1, 0 );
+  for( size_t iKey = 0 ; iKey < keyNbEntriesList.size() ; iKey++ ){
+    if( keyNbEntriesList[iKey] < 2 ){ continue; }
+    keySuperEventList[iKey] = uint32_t(_superEventOffsetList_.size() - 1);
+    _superEventOffsetList_.emplace_back( _superEventOffsetList_.back() + keyNbEntriesList[iKey] );
+  }
+  size_t nSuperEvents{_superEventOffsetList_.size() - 1};
+  if( nSuperEvents == 0 ){
+    LogInfo << "No event can be grouped." << std::endl;
+    _superEventOffsetList_.clear();
+    return;
+  }
+
+  // the single entries are kept in their order, followed by the super-events
+  _superEventMemberList_.resize( _superEventOffsetList_.back() );
+  _superEventSumWeightList_.assign( nSuperEvents, 0 );
+  _superEventSumSquaredWeightList_.assign( nSuperEvents, 0 );
+  _superEventReweightList_.assign( nSuperEvents, 1 );
+  std::vector<size_t> superEventFirstEntryList(nSuperEvents, 0);
+  std::vector<size_t> fillPosition(_superEventOffsetList_.begin(), _superEventOffsetList_.end() - 1);
+
+  std::vector<Event*> eventPtrList{};
+  std::vector<size_t> dialOffsetList{};
+  std::vector<uint32_t> dialIndexList{};
+  eventPtrList.reserve( _eventPtrList_.size() - _superEventMemberList_.size() + nSuperEvents );
+  dialOffsetList.reserve( eventPtrList.capacity() + 1 );
+  dialOffsetList.emplace_back( 0 );
+
+  for( size_t iEntry = 0 ; iEntry < _eventPtrList_.size() ; iEntry++ ){
+    auto iKey = entryKeyIndexList[iEntry];
+    auto iSuper = ( iKey == uint32_t(-1) ? uint32_t(-1) : keySuperEventList[iKey] );
+
+    if( iSuper == uint32_t(-1) ){
+      eventPtrList.emplace_back( _eventPtrList_[iEntry] );
+      dialIndexList.insert( dialIndexList.end(),
+                            _dialIndexList_.begin() + long(_dialOffsetList_[iEntry]),
+                            _dialIndexList_.begin() + long(_dialOffsetList_[iEntry+1]) );
+      dialOffsetList.emplace_back( dialIndexList.size() );
+      continue;
+    }
+
+    if( fillPosition[iSuper] == _superEventOffsetList_[iSuper] ){ superEventFirstEntryList[iSuper] = iEntry; }
+    _superEventMemberList_[fillPosition[iSuper]++] = _eventPtrList_[iEntry];
+
+    double baseWeight{_eventPtrList_[iEntry]->getWeights().base};
+    _superEventSumWeightList_[iSuper] += baseWeight;
+    _superEventSumSquaredWeightList_[iSuper] += baseWeight * baseWeight;
+  }
+
+  _nSingleEntries_ = eventPtrList.size();
+  for( auto iEntry : superEventFirstEntryList ){
+    // the first event stands for the super-event (sample, bin and dials)
+    eventPtrList.emplace_back( _eventPtrList_[iEntry] );
+    dialIndexList.insert( dialIndexList.end(),
+                          _dialIndexList_.begin() + long(_dialOffsetList_[iEntry]),
+                          _dialIndexList_.begin() + long(_dialOffsetList_[iEntry+1]) );
+    dialOffsetList.emplace_back( dialIndexList.size() );
+  }
+
+  LogInfo << _superEventMemberList_.size() << " events grouped in " << nSuperEvents << " super-events, "
+          << _nSingleEntries_ << " events left alone: " << _eventPtrList_.size() << " -> "
+          << eventPtrList.size() << " cache entries." << std::endl;
+
+  _eventPtrList_ = std::move( eventPtrList );
+  _dialOffsetList_ = std::move( dialOffsetList );
+  _dialIndexList_ = std::move( dialIndexList );
+  _dialIndexList_.shrink_to_fit();
+
+  // the entry indices have changed
+  buildInputEntryIndex( slotGroupIndexList_ );
+
+  // entries of each bin to fill the histograms
+  auto& sampleList = sampleSet_.getSampleList();
+  _binEntryOffsetList_.assign( sampleList.size(), {} );
+  _binEntryIndexList_.assign( sampleList.size(), {} );
+  for( size_t iSample = 0 ; iSample < sampleList.size() ; iSample++ ){
+    _binEntryOffsetList_[iSample].resize( sampleList[iSample].getMcContainer().getHistogram().nBins + 1, 0 );
+  }
+  for( auto* eventPtr : _eventPtrList_ ){
+    auto& indices = eventPtr->getIndices();
+    if( indices.bin < 0 ){ continue; }
+    LogThrowIf( indices.bin + 1 >= int(_binEntryOffsetList_[indices.sample].size()),
+                "Invalid bin index " << indices.bin << " for sample #" << indices.sample );
+    _binEntryOffsetList_[indices.sample][indices.bin+1]++;
+  }
+  for( size_t iSample = 0 ; iSample < sampleList.size() ; iSample++ ){
+    auto& offsetList = _binEntryOffsetList_[iSample];
+    for( size_t iBin = 1 ; iBin < offsetList.size() ; iBin++ ){ offsetList[iBin] += offsetList[iBin-1]; }
+    _binEntryIndexList_[iSample].resize( offsetList.back() );
+
+    std::vector<size_t> binFillPosition(offsetList.begin(), offsetList.end() - 1);
+    for( size_t iEntry = 0 ; iEntry < _eventPtrList_.size() ; iEntry++ ){
+      auto& indices = _eventPtrList_[iEntry]->getIndices();
+      if( indices.sample != int(iSample) or indices.bin < 0 ){ continue; }
+      _binEntryIndexList_[iSample][binFillPosition[indices.bin]++] = uint32_t(iEntry);
+    }
+  }
+}
+void EventDialCache::buildSplineBatches(const std::vector<size_t>& slotGroupIndexList_){
+  _scalarSlotList_.clear();
+  _splineBatchList_.clear();
+
+  // the spline slots are first sorted per (input, spline type)
+  struct BatchCandidate{
+    uint32_t slot{0};
+    double inputMin{0};
+    double inputMax{0};
+  };
+  std::map<std::pair<size_t, SplineBatch::Type>, std::vector<BatchCandidate>> candidateListMap{};
+
+  for( size_t iSlot = 0 ; iSlot < _dialResponseCacheList_.size() ; iSlot++ ){
+    const DialBase* dialBase{_dialResponseCacheList_[iSlot].dialInterface->getDialBaseRef()};
+
+    SplineBatch::Type type;
+    std::pair<double, double> bounds;
+    if     ( auto* spline = dynamic_cast<const CompactSpline*>(dialBase) )  { type = SplineBatch::Type::Compact;   bounds = spline->getSplineBounds(); }
+    else if( auto* spline = dynamic_cast<const UniformSpline*>(dialBase) )  { type = SplineBatch::Type::Uniform;   bounds = spline->getSplineBounds(); }
+    else if( auto* spline = dynamic_cast<const GeneralSpline*>(dialBase) )  { type = SplineBatch::Type::General;   bounds = spline->getSplineBounds(); }
+    else if( auto* spline = dynamic_cast<const MonotonicSpline*>(dialBase) ){ type = SplineBatch::Type::Monotonic; bounds = spline->getSplineBounds(); }
+    else{ _scalarSlotList_.emplace_back( uint32_t(iSlot) ); continue; }
+
+    if( not _enableSplineBatchEval_ or dialBase->getDialData().empty() ){
+      _scalarSlotList_.emplace_back( uint32_t(iSlot) );
+      continue;
+    }
+
+    // same clamping of the input as done in the evalResponse() of the splines
+    BatchCandidate candidate{uint32_t(iSlot), -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()};
+    if( not dialBase->getAllowExtrapolation() ){
+      candidate.inputMin = bounds.first;
+      candidate.inputMax = bounds.second;
+    }
+    candidateListMap[{slotGroupIndexList_[iSlot], type}].emplace_back( candidate );
+  }
+
+  size_t nSharedKnotSlots{0};
+  for( auto& candidateList : candidateListMap ){
+    const auto type{candidateList.first.second};
+    const auto inputGroupIndex{candidateList.first.first};
+
+    std::vector<BatchCandidate> genericList{};
+    if( not _enableSharedKnotSplines_ ){ genericList = candidateList.second; }
+    else{
+      // the splines of a collection mostly have the same knots: their
+      // segment only needs to be found once
+      std::map<std::vector<double>, std::vector<BatchCandidate>> knotGroupMap{};
+      for( auto& candidate : candidateList.second ){
+        auto knotList = getSplineKnotList( type, _dialResponseCacheList_[candidate.slot].dialInterface->getDialBaseRef()->getDialData() );
+        if( knotList.empty() ){ genericList.emplace_back( candidate ); continue; }
+        knotList.emplace_back( candidate.inputMin );
+        knotList.emplace_back( candidate.inputMax );
+        knotGroupMap[knotList].emplace_back( candidate );
+      }
+
+      for( auto& knotGroup : knotGroupMap ){
+        auto& groupList = knotGroup.second;
+        if( groupList.size() < 2 ){ genericList.insert( genericList.end(), groupList.begin(), groupList.end() ); continue; }
+
+        _splineBatchList_.emplace_back();
+        auto& batch = _splineBatchList_.back();
+        batch.type = type;
+        batch.inputGroupIndex = inputGroupIndex;
+        batch.inputMinList.emplace_back( groupList.front().inputMin );
+        batch.inputMaxList.emplace_back( groupList.front().inputMax );
+        batch.knotList.assign( knotGroup.first.begin(), knotGroup.first.end() - 2 );
+
+        size_t nSegments{getNbSegments( type, batch.knotList )};
+        batch.slotList.reserve( groupList.size() );
+        batch.coefficientList.resize( 4 * nSegments * groupList.size() );
+        for( size_t iSpline = 0 ; iSpline < groupList.size() ; iSpline++ ){
+          batch.slotList.emplace_back( groupList[iSpline].slot );
+          auto splineData = _dialResponseCacheList_[groupList[iSpline].slot].dialInterface->getDialBaseRef()->getDialData();
+          for( size_t iSegment = 0 ; iSegment < nSegments ; iSegment++ ){
+            fillSharedKnotCoefficients( type, splineData, iSegment, &batch.coefficientList[4*(iSegment*groupList.size() + iSpline)] );
+          }
+        }
+        nSharedKnotSlots += groupList.size();
+      }
+
+      // keep the slot order for the other splines
+      std::sort( genericList.begin(), genericList.end(),
+                 [](const BatchCandidate& a_, const BatchCandidate& b_){ return a_.slot < b_.slot; } );
+    }
+
+    if( genericList.empty() ){ continue; }
+    _splineBatchList_.emplace_back();
+    auto& batch = _splineBatchList_.back();
+    batch.type = type;
+    batch.inputGroupIndex = inputGroupIndex;
+    batch.dataIndexList.emplace_back( 0 );
+    for( auto& candidate : genericList ){
+      auto splineData = _dialResponseCacheList_[candidate.slot].dialInterface->getDialBaseRef()->getDialData();
+      LogThrowIf(batch.splineData.size() + splineData.size() >= size_t(std::numeric_limits<int>::max()),
+                 "Too much spline data to be indexed with an int.");
+      batch.slotList.emplace_back( candidate.slot );
+      batch.inputMinList.emplace_back( candidate.inputMin );
+      batch.inputMaxList.emplace_back( candidate.inputMax );
+      batch.splineData.insert( batch.splineData.end(), splineData.begin(), splineData.end() );
+      batch.dataIndexList.emplace_back( int(batch.splineData.size()) );
+    }
+  }
+
+  // the other dials are called directly with their concrete type
+  _scalarSlotTypeList_.resize( _scalarSlotList_.size() );
+  for( size_t iScalar = 0 ; iScalar < _scalarSlotList_.size() ; iScalar++ ){
+    _scalarSlotTypeList_[iScalar] = DialArena::getDialType(
+        _dialResponseCacheList_[_scalarSlotList_[iScalar]].dialInterface->getDialBaseRef()
+    );
+  }
+
+  size_t nBatchedSlots{_dialResponseCacheList_.size() - _scalarSlotList_.size()};
+  LogInfo << nBatchedSlots << " spline dials are evaluated in " << _splineBatchList_.size() << " batches ("
+          << nSharedKnotSlots << " with shared knots)." << std::endl;
 }
 void EventDialCache::allocateCacheEntries( size_t nEvent_, size_t nDialsMaxPerEvent_) {
     _indexedCache_.resize(
@@ -126,21 +651,374 @@ EventDialCache::IndexedCacheEntry* EventDialCache::fetchNextCacheEntry(){
   LogThrowIf(_fillIndex_ >= _indexedCache_.size());
   return &_indexedCache_[_fillIndex_++];
 }
+size_t EventDialCache::reserveCacheEntries(size_t nEntries_){
+  LogThrowIf(_fillIndex_ + nEntries_ > _indexedCache_.size(),
+             "Can't reserve " << nEntries_ << " cache entries: " << _indexedCache_.size() - _fillIndex_ << " left.");
+  size_t out{_fillIndex_};
+  _fillIndex_ += nEntries_;
+  return out;
+}
+
+
+EventDialCache::CacheEntry EventDialCache::getEntry(size_t iEntry_) const{
+  CacheEntry out;
+  out.event = _eventPtrList_[iEntry_];
+  out.dialInterfaceList = DialInterfaceRange(
+      _dialIndexList_.data() + _dialOffsetList_[iEntry_],
+      _dialIndexList_.data() + _dialOffsetList_[iEntry_+1],
+      _dialResponseCacheList_.data()
+  );
+  return out;
+}
+
+void EventDialCache::updateDialResponses(int iThread_, int nThreads_){
+  if( iThread_ == -1 ){ iThread_ = 0; nThreads_ = 1; }
+
+  auto bounds = GenericToolbox::ParallelWorker::getThreadBoundIndices(
+      iThread_, nThreads_, int(_scalarSlotList_.size())
+  );
+
+  // Reevaluate the dial if an update has been requested
+  for( size_t iScalar = bounds.beginIndex ; iScalar < size_t(bounds.endIndex) ; iScalar++ ){
+    auto iSlot = _scalarSlotList_[iScalar];
+    if( not _dialResponseCacheList_[iSlot].isUpdateRequested() ){ continue; }
+    auto* dialInterface = _dialResponseCacheList_[iSlot].dialInterface;
+    _dialResponseList_[iSlot] = dialInterface->getResponseSupervisorRef()->process( DialArena::evalResponse(
+        _scalarSlotTypeList_[iScalar], dialInterface->getDialBaseRef(), *dialInterface->getInputBufferRef()
+    ) );
+  }
+
+  // The splines sharing an input are all updated at once
+  for( auto& batch : _splineBatchList_ ){
+    if( not _dialInputGroupList_[batch.inputGroupIndex].isUpdateRequested() ){ continue; }
+    auto batchBounds = GenericToolbox::ParallelWorker::getThreadBoundIndices(
+        iThread_, nThreads_, int(batch.slotList.size())
+    );
+    evalSplineBatch( batch, batchBounds.beginIndex, batchBounds.endIndex );
+  }
+}
+void EventDialCache::evalSplineBatch(const SplineBatch& batch_, size_t beginIndex_, size_t endIndex_){
+  const DialInputBuffer& inputBuffer{*_dialInputGroupList_[batch_.inputGroupIndex].inputBuffer};
+  const double input{inputBuffer.getInputBuffer()[0]};
+
+  double xBuffer[CALCULATE_SPLINE_BATCH_SIZE];
+  double responseBuffer[CALCULATE_SPLINE_BATCH_SIZE];
+
+  // shared knots: the segment and the powers of fx are the same for all the
+  // splines of the batch
+  double fxPowers[4]{1, 0, 0, 0};
+  const double* coefficientPtr{nullptr};
+  if( batch_.isSharedKnot() ){
+    double fx{0};
+    size_t iSegment{findSharedKnotSegment(
+        batch_, std::min(std::max(input, batch_.inputMinList[0]), batch_.inputMaxList[0]), fx
+    )};
+    fxPowers[1] = fx;
+    fxPowers[2] = fx*fx;
+    fxPowers[3] = fx*fx*fx;
+    coefficientPtr = batch_.coefficientList.data() + 4*iSegment*batch_.slotList.size();
+  }
+
+  for( size_t iStart = beginIndex_ ; iStart < endIndex_ ; iStart += CALCULATE_SPLINE_BATCH_SIZE ){
+    int nSplines{int(std::min(endIndex_ - iStart, size_t(CALCULATE_SPLINE_BATCH_SIZE)))};
+
+    if( batch_.isSharedKnot() ){
+      CalculateSharedKnotSplineBatch(nSplines, fxPowers, -1E20, 1E20, coefficientPtr + 4*iStart, responseBuffer);
+    }
+    else{
+      for( int iSpline = 0 ; iSpline < nSplines ; iSpline++ ){
+        xBuffer[iSpline] = std::min(std::max(input, batch_.inputMinList[iStart + iSpline]), batch_.inputMaxList[iStart + iSpline]);
+      }
+
+      const int* dataIndexPtr{batch_.dataIndexList.data() + iStart};
+      switch( batch_.type ){
+        case SplineBatch::Type::Compact:
+          CalculateCompactSplineBatch(nSplines, xBuffer, -1E20, 1E20, batch_.splineData.data(), dataIndexPtr, responseBuffer);
+          break;
+        case SplineBatch::Type::Uniform:
+          CalculateUniformSplineBatch(nSplines, xBuffer, -1E20, 1E20, batch_.splineData.data(), dataIndexPtr, responseBuffer);
+          break;
+        case SplineBatch::Type::General:
+          CalculateGeneralSplineBatch(nSplines, xBuffer, -1E20, 1E20, batch_.splineData.data(), dataIndexPtr, responseBuffer);
+          break;
+        case SplineBatch::Type::Monotonic:
+          CalculateMonotonicSplineBatch(nSplines, xBuffer, -1E20, 1E20, batch_.splineData.data(), dataIndexPtr, responseBuffer);
+          break;
+      }
+    }
+
+    // apply the response supervisor like DialInterface::evalResponse()
+    for( int iSpline = 0 ; iSpline < nSplines ; iSpline++ ){
+      auto iSlot = batch_.slotList[iStart + iSpline];
+      _dialResponseList_[iSlot] = _dialResponseCacheList_[iSlot].dialInterface->getResponseSupervisorRef()->process( responseBuffer[iSpline] );
+    }
+  }
+}
+void EventDialCache::prepareReweight(){
+  _isIncrementalReweight_ = false;
+  _dirtyEntryList_.clear();
+
+  // the weights written by the throws are only overwritten by a full reweight
+  if( _sampleSetPtr_ != nullptr and _sampleSetPtr_->getMcExternalEditCount() != _mcExternalEditCount_ ){
+    _mcExternalEditCount_ = _sampleSetPtr_->getMcExternalEditCount();
+    _isFullReweightRequested_ = true;
+  }
+
+  if( _isFullReweightRequested_ ){
+    _isFullReweightRequested_ = false;
+    return;
+  }
+
+  // above this number of entries, the streaming full reweight is faster
+  auto nMaxDirtyEntries = size_t(_maxIncrementalReweightFraction_ * double(_eventPtrList_.size()));
+
+  bool isOverflow{false};
+  for( size_t iGroup = 0 ; iGroup < _dialInputGroupList_.size() ; iGroup++ ){
+    if( not _dialInputGroupList_[iGroup].isUpdateRequested() ){ continue; }
+    for( size_t iRef = _inputEntryOffsetList_[iGroup] ; iRef < _inputEntryOffsetList_[iGroup+1] ; iRef++ ){
+      auto iEntry = _inputEntryIndexList_[iRef];
+      if( _isEntryDirtyList_[iEntry] ){ continue; }
+      _isEntryDirtyList_[iEntry] = true;
+      _dirtyEntryList_.emplace_back( iEntry );
+    }
+    if( _dirtyEntryList_.size() > nMaxDirtyEntries ){ isOverflow = true; break; }
+  }
+
+  // reset the flags for the next call
+  for( auto iEntry : _dirtyEntryList_ ){ _isEntryDirtyList_[iEntry] = false; }
+
+  if( isOverflow ){ _dirtyEntryList_.clear(); return; }
+  _dirtyEntryPreviousWeightList_.resize( _dirtyEntryList_.size() );
+  _isIncrementalReweight_ = true;
+}
+void EventDialCache::reweightEvents(int iThread_, int nThreads_){
 
+  //! Warning: everything you modify here, may significantly slow down the
+  //! fitter
 
-void EventDialCache::reweightEntry( EventDialCache::CacheEntry& entry_){
+  if( iThread_ == -1 ){ iThread_ = 0; nThreads_ = 1; }
+
+  if( _isIncrementalReweight_ ){
+    auto bounds = GenericToolbox::ParallelWorker::getThreadBoundIndices(
+        iThread_, nThreads_, int(_dirtyEntryList_.size())
+    );
+    for( size_t iDirty = bounds.beginIndex ; iDirty < size_t(bounds.endIndex) ; iDirty++ ){
+      _dirtyEntryPreviousWeightList_[iDirty] = _eventPtrList_[_dirtyEntryList_[iDirty]]->getWeights().current;
+      reweightEntry( _dirtyEntryList_[iDirty] );
+    }
+    return;
+  }
+
+  auto bounds = GenericToolbox::ParallelWorker::getThreadBoundIndices(
+      iThread_, nThreads_, int(_eventPtrList_.size())
+  );
+  for( size_t iEntry = bounds.beginIndex ; iEntry < size_t(bounds.endIndex) ; iEntry++ ){
+    reweightEntry( iEntry );
+  }
+}
+void EventDialCache::reweightEntry(size_t iEntry_){
   // storing the reweight factor in a temporary buffer
   // this allows to perform capping of the value
   double tempReweight{1};
 
-  // calculate the dial responses
-  for( auto& dialResponseCache : entry_.dialResponseCacheList ){
-    tempReweight *= dialResponseCache.getResponse();
+  // the dial references of the entry are contiguous
+  const uint32_t* dialIndexEndPtr{_dialIndexList_.data() + _dialOffsetList_[iEntry_+1]};
+  for( const uint32_t* dialIndexPtr = _dialIndexList_.data() + _dialOffsetList_[iEntry_] ; dialIndexPtr != dialIndexEndPtr ; dialIndexPtr++ ){
+    tempReweight *= _dialResponseList_[*dialIndexPtr];
   }
 
   // applying event weight cap if defined
   _globalEventReweightCap_.process( tempReweight );
 
-  entry_.event->getWeights().resetCurrentWeight(); // reset to the base weight
-  entry_.event->getWeights().current *= tempReweight; // apply the reweight factor
+  // the events of a super-event are set by updateGroupedEventWeights()
+  if( iEntry_ >= _nSingleEntries_ ){
+    _superEventReweightList_[iEntry_ - _nSingleEntries_] = tempReweight;
+    return;
+  }
+
+  // apply the reweight factor on top of the base weight
+  auto& weights = _eventPtrList_[iEntry_]->getWeights();
+  weights.current = weights.base * tempReweight;
+}
+double EventDialCache::evalEntryReweight(size_t iEntry_, const double* responseList_) const {
+  double tempReweight{1};
+  for( size_t iDial = _dialOffsetList_[iEntry_] ; iDial < _dialOffsetList_[iEntry_+1] ; iDial++ ){
+    tempReweight *= responseList_[_dialIndexList_[iDial]];
+  }
+  _globalEventReweightCap_.process( tempReweight );
+  return tempReweight;
+}
+double EventDialCache::getEntryBaseWeight(size_t iEntry_) const {
+  if( iEntry_ >= _nSingleEntries_ ){ return _superEventSumWeightList_[iEntry_ - _nSingleEntries_]; }
+  return _eventPtrList_[iEntry_]->getWeights().base;
+}
+double EventDialCache::getEntrySquaredBaseWeight(size_t iEntry_) const {
+  if( iEntry_ >= _nSingleEntries_ ){ return _superEventSumSquaredWeightList_[iEntry_ - _nSingleEntries_]; }
+  double baseWeight{_eventPtrList_[iEntry_]->getWeights().base};
+  return baseWeight * baseWeight;
+}
+SampleElement::Histogram::EventPtrRange EventDialCache::getEntryEventList(size_t iEntry_) const {
+  if( iEntry_ >= _nSingleEntries_ ){
+    auto iSuper = iEntry_ - _nSingleEntries_;
+    return { _superEventMemberList_.data() + _superEventOffsetList_[iSuper],
+             _superEventMemberList_.data() + _superEventOffsetList_[iSuper+1] };
+  }
+  return { _eventPtrList_.data() + iEntry_, _eventPtrList_.data() + iEntry_ + 1 };
+}
+void EventDialCache::fillHistograms(SampleSet& sampleSet_, int iThread_, int nThreads_) const {
+  if( iThread_ == -1 ){ iThread_ = 0; nThreads_ = 1; }
+
+  // each bin is handled by one thread only
+  for( size_t iSample = 0 ; iSample < _binEntryOffsetList_.size() ; iSample++ ){
+    auto& container = sampleSet_.getSampleList()[iSample].getMcContainer();
+    auto& offsetList = _binEntryOffsetList_[iSample];
+    for( size_t iBin = iThread_ ; iBin + 1 < offsetList.size() ; iBin += nThreads_ ){
+      double sumWeights{0};
+      double sumSquaredWeights{0};
+      for( size_t iRef = offsetList[iBin] ; iRef < offsetList[iBin+1] ; iRef++ ){
+        auto iEntry = _binEntryIndexList_[iSample][iRef];
+        if( iEntry < _nSingleEntries_ ){
+          double weight{_eventPtrList_[iEntry]->getEventWeight()};
+          sumWeights += weight;
+          sumSquaredWeights += weight * weight;
+        }
+        else{
+          auto iSuper = iEntry - _nSingleEntries_;
+          double reweight{_superEventReweightList_[iSuper]};
+          sumWeights += _superEventSumWeightList_[iSuper] * reweight;
+          sumSquaredWeights += _superEventSumSquaredWeightList_[iSuper] * reweight * reweight;
+        }
+      }
+      container.setBinContent( int(iBin), sumWeights, sumSquaredWeights );
+    }
+  }
+}
+void EventDialCache::updateGroupedEventWeights(int iThread_, int nThreads_){
+  if( iThread_ == -1 ){ iThread_ = 0; nThreads_ = 1; }
+
+  auto bounds = GenericToolbox::ParallelWorker::getThreadBoundIndices(
+      iThread_, nThreads_, int(_superEventReweightList_.size())
+  );
+  for( size_t iSuper = bounds.beginIndex ; iSuper < size_t(bounds.endIndex) ; iSuper++ ){
+    double reweight{_superEventReweightList_[iSuper]};
+    for( size_t iMember = _superEventOffsetList_[iSuper] ; iMember < _superEventOffsetList_[iSuper+1] ; iMember++ ){
+      auto& weights = _superEventMemberList_[iMember]->getWeights();
+      weights.current = weights.base * reweight;
+    }
+  }
+}
+bool EventDialCache::prepareHistogramUpdate(int nThreads_){
+  // the dirty entries of a grouped cache can't be mapped to a single event weight
+  if( not _isIncrementalReweight_ or isEventGrouped() ){ _nHistogramUpdates_ = 0; return false; }
+  if( ++_nHistogramUpdates_ >= _histogramResumPeriod_ ){ _nHistogramUpdates_ = 0; return false; }
+
+  // split the dirty entries among the threads once, rather than letting
+  // each thread skim the whole list
+  _threadDirtyIndexList_.resize( std::max(1, nThreads_) );
+  for( auto& threadDirtyIndexList : _threadDirtyIndexList_ ){ threadDirtyIndexList.clear(); }
+  for( size_t iDirty = 0 ; iDirty < _dirtyEntryList_.size() ; iDirty++ ){
+    int iBin = _eventPtrList_[_dirtyEntryList_[iDirty]]->getIndices().bin;
+    if( iBin < 0 ){ continue; }
+    _threadDirtyIndexList_[iBin % _threadDirtyIndexList_.size()].emplace_back( uint32_t(iDirty) );
+  }
+  return true;
+}
+void EventDialCache::updateHistograms(SampleSet& sampleSet_, int iThread_) const {
+  if( iThread_ == -1 ){ iThread_ = 0; }
+
+  for( auto iDirty : _threadDirtyIndexList_[iThread_] ){
+    auto* eventPtr = _eventPtrList_[_dirtyEntryList_[iDirty]];
+    sampleSet_.getSampleList()[eventPtr->getIndices().sample].getMcContainer().updateBinContent(
+        eventPtr->getIndices().bin, _dirtyEntryPreviousWeightList_[iDirty], eventPtr->getEventWeight()
+    );
+  }
+}
+bool EventDialCache::buildDerivativeCache(const std::vector<size_t>& parSetOffsetList_){
+  _slotDerivativeOffsetList_.clear();
+  _slotDerivativeParIndexList_.clear();
+  _slotDerivativeOffsetList_.reserve( _dialResponseCacheList_.size() + 1 );
+  _slotDerivativeOffsetList_.emplace_back( 0 );
+
+  for( auto& slot : _dialResponseCacheList_ ){
+    if( not slot.dialInterface->getDialBaseRef()->isDerivativeAvailable() ){
+      LogWarning << "No derivative available for dial: " << slot.dialInterface->getSummary() << std::endl;
+      return false;
+    }
+    // the references are stored in the order of the input buffer
+    for( auto& parRef : slot.dialInterface->getInputBufferRef()->getInputParameterIndicesList() ){
+      _slotDerivativeParIndexList_.emplace_back( uint32_t(parSetOffsetList_[parRef.parSetIndex] + parRef.parIndex) );
+    }
+    _slotDerivativeOffsetList_.emplace_back( _slotDerivativeParIndexList_.size() );
+  }
+
+  _slotDerivativeList_.resize( _slotDerivativeParIndexList_.size() );
+  _slotDerivativeResponseList_.resize( _dialResponseCacheList_.size() );
+  return true;
+}
+void EventDialCache::updateDialDerivatives(int iThread_, int nThreads_){
+  if( iThread_ == -1 ){ iThread_ = 0; nThreads_ = 1; }
+
+  auto bounds = GenericToolbox::ParallelWorker::getThreadBoundIndices(
+      iThread_, nThreads_, int(_dialResponseCacheList_.size())
+  );
+  for( size_t iSlot = bounds.beginIndex ; iSlot < size_t(bounds.endIndex) ; iSlot++ ){
+    _slotDerivativeResponseList_[iSlot] = _dialResponseCacheList_[iSlot].dialInterface->evalResponseAndDerivative(
+        &_slotDerivativeList_[_slotDerivativeOffsetList_[iSlot]]
+    );
+  }
+}
+void EventDialCache::accumulateGradient(int iThread_, int nThreads_,
+                                        const std::vector<std::vector<double>>& contentDerivativeList_,
+                                        const std::vector<std::vector<double>>& sumW2DerivativeList_,
+                                        std::vector<double>& gradient_) const {
+  if( iThread_ == -1 ){ iThread_ = 0; nThreads_ = 1; }
+
+  auto bounds = GenericToolbox::ParallelWorker::getThreadBoundIndices(
+      iThread_, nThreads_, int(_eventPtrList_.size())
+  );
+  for( size_t iEntry = bounds.beginIndex ; iEntry < size_t(bounds.endIndex) ; iEntry++ ){
+    auto* eventPtr = _eventPtrList_[iEntry];
+    int iBin = eventPtr->getIndices().bin;
+    if( iBin < 0 ){ continue; }
+
+    // product of the responses, leaving aside a null one: its derivative
+    // is multiplied by the product of the other responses
+    double reweight{1};
+    int nNullResponses{0};
+    size_t nullDialIndex{0};
+    for( size_t iDial = _dialOffsetList_[iEntry] ; iDial < _dialOffsetList_[iEntry+1] ; iDial++ ){
+      double response{_slotDerivativeResponseList_[_dialIndexList_[iDial]]};
+      if( response == 0 ){ nNullResponses++; nullDialIndex = iDial; continue; }
+      reweight *= response;
+    }
+    if( nNullResponses > 1 ){ continue; } // moving a single dial can't change the weight
+
+    // the weight is flat where the cap applies
+    if( nNullResponses == 0 and _globalEventReweightCap_.isEnabled and reweight > _globalEventReweightCap_.maxReweight ){ continue; }
+
+    // derivative with respect to the reweight factor: the entry adds
+    // base * reweight to the bin content and squaredBase * reweight^2 to
+    // its sum of squared weights (base^2 for a single event)
+    double fullReweight{nNullResponses == 0 ? reweight : 0};
+    auto iSample = eventPtr->getIndices().sample;
+    double llhDerivative{
+        contentDerivativeList_[iSample][iBin] * getEntryBaseWeight(iEntry)
+        + 2 * fullReweight * getEntrySquaredBaseWeight(iEntry) * sumW2DerivativeList_[iSample][iBin]
+    };
+    if( llhDerivative == 0 ){ continue; }
+
+    for( size_t iDial = _dialOffsetList_[iEntry] ; iDial < _dialOffsetList_[iEntry+1] ; iDial++ ){
+      auto iSlot = _dialIndexList_[iDial];
+
+      double otherReweight;
+      if     ( nNullResponses == 0 ){ otherReweight = reweight / _slotDerivativeResponseList_[iSlot]; }
+      else if( iDial == nullDialIndex ){ otherReweight = reweight; }
+      else{ continue; }
+
+      double factor{llhDerivative * otherReweight};
+      for( size_t iDer = _slotDerivativeOffsetList_[iSlot] ; iDer < _slotDerivativeOffsetList_[iSlot+1] ; iDer++ ){
+        gradient_[_slotDerivativeParIndexList_[iDer]] += factor * _slotDerivativeList_[iDer];
+      }
+    }
+  }
 }
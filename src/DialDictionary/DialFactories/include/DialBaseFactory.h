@@ -2,6 +2,7 @@
 #define DialBaseFactory_h_Seen
 
 #include <DialBase.h>
+#include <DialArena.h>
 
 #include "GenericToolbox.Json.h"
 
@@ -36,6 +37,14 @@ public:
                      bool useCachedDial_);
 
   DialBase* makeDial(const JsonType& config_);
+
+  /// Construct the dials in place in dialArena_ (see DialArena::makeDial())
+  /// instead of on the heap.  The arena then keeps the ownership of the
+  /// dials, and the caller must not delete them.
+  void setDialArena(DialArena* dialArena_){ _dialArena_ = dialArena_; }
+
+private:
+  DialArena* _dialArena_{nullptr};
 };
 
 //  A Lesser GNU Public License
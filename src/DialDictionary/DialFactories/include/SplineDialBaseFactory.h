@@ -2,6 +2,7 @@
 #define SplineDialBaseFactory_h_Seen
 
 #include <DialBase.h>
+#include <DialArena.h>
 
 #include <TObject.h>
 
@@ -46,7 +47,12 @@ public:
                      TObject* dialInitializer_,
                      bool useCachedDial_);
 
+  /// Build the dials in dialArena_ (see DialBaseFactory::setDialArena()).
+  void setDialArena(DialArena* dialArena_){ _dialArena_ = dialArena_; }
+
 private:
+  DialArena* _dialArena_{nullptr};
+
   std::vector<double> _xPointListBuffer_{};
   std::vector<double> _yPointListBuffer_{};
   std::vector<double> _slopeListBuffer_{};
@@ -2,6 +2,7 @@
 #define SurfaceDialBaseFactory_h_Seen
 
 #include <DialBase.h>
+#include <DialArena.h>
 
 #include <TObject.h>
 
@@ -32,6 +33,12 @@ public:
                      TObject* dialInitializer_,
                      bool useCachedDial_);
 
+  /// Build the dials in dialArena_ (see DialBaseFactory::setDialArena()).
+  void setDialArena(DialArena* dialArena_){ _dialArena_ = dialArena_; }
+
+private:
+  DialArena* _dialArena_{nullptr};
+
 };
 
 //  A Lesser GNU Public License
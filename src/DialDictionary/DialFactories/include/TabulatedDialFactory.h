@@ -96,11 +96,12 @@ public:
     ~TabulatedDialFactory() = default;
     TabulatedDialFactory(const JsonType& config_);
 
-    /// Create an event-by-event weighting dial for this table.
-    [[nodiscard]] DialBase* makeDial(const Event& event);
+    /// Create an event-by-event weighting dial for this table.  The dial
+    /// is built in dialArena (which keeps the ownership) if one is given.
+    [[nodiscard]] DialBase* makeDial(const Event& event, DialArena* dialArena = nullptr);
 
     /// Update the tabulated buffer.
-    void updateTable(DialInputBuffer& inputBuffer);
+    void updateTable(const DialInputBuffer& inputBuffer);
 
     /// Get the table name
     const std::string& getName() {return _name_;}
@@ -21,25 +21,29 @@ DialBase* DialBaseFactory::makeDial(const std::string& dialTitle_,
                                     bool useCachedDial_) {
 
   // Stuff the created dial into a unique_ptr, so it will be properly deleted
-  // in the event of an exception.
-  std::unique_ptr<DialBase> dialBase;
+  // in the event of an exception (a dial in the arena is left to it).
+  DialArena::DialPtr dialBase{nullptr, DialArena::DialDeleter{_dialArena_ != nullptr}};
 
   LogThrowIf(dialType_.empty(), "Dial type not set.");
 
   if (dialType_ == "Norm" || dialType_ == "Normalization") {
     NormDialBaseFactory factory;
+    factory.setDialArena(_dialArena_);
     dialBase.reset(factory.makeDial(dialTitle_, dialType_, dialSubType_, dialInitializer_, useCachedDial_));
   }
   else if (dialType_ == "Graph") {
     GraphDialBaseFactory factory;
+    factory.setDialArena(_dialArena_);
     dialBase.reset(factory.makeDial(dialTitle_, dialType_, dialSubType_, dialInitializer_, useCachedDial_));
   }
   else if (dialType_ == "Spline") {
     SplineDialBaseFactory factory;
+    factory.setDialArena(_dialArena_);
     dialBase.reset(factory.makeDial(dialTitle_, dialType_, dialSubType_, dialInitializer_, useCachedDial_));
   }
   else if (dialType_ == "Surface") {
     SurfaceDialBaseFactory factory;
+    factory.setDialArena(_dialArena_);
     dialBase.reset(factory.makeDial(dialTitle_, dialType_, dialSubType_, dialInitializer_, useCachedDial_));
   }
 #define INCLUDE_DEPRECATED_DIAL_TYPES
@@ -50,6 +54,7 @@ DialBase* DialBaseFactory::makeDial(const std::string& dialTitle_,
                  << std::endl << "  dialSubType: \"catmull-rom, monotonic\""
                  << std::endl;
     SplineDialBaseFactory factory;
+    factory.setDialArena(_dialArena_);
     dialBase.reset(factory.makeDial(dialTitle_, "Spline", "catmull-rom, monotonic",
                            dialInitializer_, useCachedDial_));
   }
@@ -59,6 +64,7 @@ DialBase* DialBaseFactory::makeDial(const std::string& dialTitle_,
                  << std::endl << "  dialSubType: \"not-a-knot\""
                  << std::endl;
    SplineDialBaseFactory factory;
+    factory.setDialArena(_dialArena_);
     dialBase.reset(factory.makeDial(dialTitle_, "Spline", "not-a-knot", dialInitializer_, useCachedDial_));
   }
   else if (dialType_ == "SimpleSpline") {
@@ -67,6 +73,7 @@ DialBase* DialBaseFactory::makeDial(const std::string& dialTitle_,
                  << std::endl << "  dialSubType: \"not-a-knot\""
                  << std::endl;
     SplineDialBaseFactory factory;
+    factory.setDialArena(_dialArena_);
     dialBase.reset(factory.makeDial(dialTitle_, "Spline", "knot-a-knot", dialInitializer_, useCachedDial_));
   }
   else if (dialType_ == "LightGraph") {
@@ -75,6 +82,7 @@ DialBase* DialBaseFactory::makeDial(const std::string& dialTitle_,
                  << std::endl << "  dialSubType: \"light\""
                  << std::endl;
     GraphDialBaseFactory factory;
+    factory.setDialArena(_dialArena_);
     dialBase.reset(factory.makeDial(dialTitle_, "Graph", "light", dialInitializer_, useCachedDial_));
   }
 #endif
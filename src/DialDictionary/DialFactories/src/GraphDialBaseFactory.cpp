@@ -24,14 +24,14 @@ DialBase* GraphDialBaseFactory::makeDial(const std::string& dialTitle_,
 
   // Stuff the created dial into a unique_ptr, so it will be properly deleted
   // in the event of an exception.
-  std::unique_ptr<DialBase> dialBase;
+  DialArena::DialPtr dialBase;
 
   if (dialSubType_ == "ROOT") {
     // Basic coding: Give a hint to the reader and put likely branch "first".
     // Do we really expect the cached version more than the uncached?
-    dialBase = (useCachedDial_) ?
-      std::make_unique<GraphCache>():
-      std::make_unique<Graph>();
+    dialBase = DialArena::makeDial((useCachedDial_) ?
+                                   DialArena::Type::GraphCache:
+                                   DialArena::Type::Graph, _dialArena_);
   }
   else if (srcGraph->GetN() < 2) {
     // For one point graph, just use a scale. Do the unique_ptr dance in case
@@ -40,14 +40,14 @@ DialBase* GraphDialBaseFactory::makeDial(const std::string& dialTitle_,
     if (std::abs(value-1.0) < 2*std::numeric_limits<float>::epsilon()) {
       return nullptr;
     }
-    dialBase = std::make_unique<Shift>();
+    dialBase = DialArena::makeDial(DialArena::Type::Shift, _dialArena_);
     dialBase->buildDial(value);
     return dialBase.release();
   }
   else {
-    dialBase = (useCachedDial_) ?
-      std::make_unique<LightGraphCache>():
-      std::make_unique<LightGraph>();
+    dialBase = DialArena::makeDial((useCachedDial_) ?
+                                   DialArena::Type::LightGraphCache:
+                                   DialArena::Type::LightGraph, _dialArena_);
   }
 
   dialBase->buildDial(*srcGraph);
@@ -12,10 +12,10 @@ DialBase* NormDialBaseFactory::makeDial(const std::string& dialTitle_,
                                         bool useCachedDial_) {
   // Stuff the created dial into a unique_ptr, so it will be properly deleted
   // in the event of an exception.
-  std::unique_ptr<DialBase> dialBase;
+  DialArena::DialPtr dialBase;
 
   // Nothing much to do for a normalization dial!
-  dialBase = std::make_unique<Norm>();
+  dialBase = DialArena::makeDial(DialArena::Type::Norm, _dialArena_);
   dialBase->buildDial();
 
   // Pass the ownership without any constraints!
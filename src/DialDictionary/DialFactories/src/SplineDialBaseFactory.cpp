@@ -300,7 +300,7 @@ DialBase* SplineDialBaseFactory::makeDial(const std::string& dialTitle_,
   // factor, and not an additive shift).
   if (isFlat) {
     // Do the unique_ptr dance in case there are exceptions.
-    std::unique_ptr<DialBase> dialBase = std::make_unique<Shift>();
+    DialArena::DialPtr dialBase = DialArena::makeDial(DialArena::Type::Shift, _dialArena_);
     dialBase->buildDial(_yPointListBuffer_[0]);
     return dialBase.release();
   }
@@ -309,6 +309,7 @@ DialBase* SplineDialBaseFactory::makeDial(const std::string& dialTitle_,
 #ifdef  SHORT_CIRCUIT_SMALL_SPLINES
   if (_xPointListBuffer_.size() < 3) {
     GraphDialBaseFactory grapher;
+    grapher.setDialArena(_dialArena_);
     return grapher.makeDial(dialTitle_,
                             "Graph","",
                             dialInitializer_,
@@ -380,11 +381,11 @@ DialBase* SplineDialBaseFactory::makeDial(const std::string& dialTitle_,
   // should change to the do-while-false idiom.  Make sure the individual
   // conditionals are less than 10 lines.
   ///////////////////////////////////////////////////////////
-  std::unique_ptr<DialBase> dialBase;
+  DialArena::DialPtr dialBase;
   if (splType == "ROOT") {
     // The ROOT implementation of the spline has been explicitly requested, so
     // use it.
-    dialBase = std::make_unique<Spline>();
+    dialBase = DialArena::makeDial(DialArena::Type::Spline, _dialArena_);
   }
   else if (splType == "catmull-rom" and isMonotonic) {
     // Catmull-Rom is handled as a special case because it ignores the slopes,
@@ -407,9 +408,9 @@ DialBase* SplineDialBaseFactory::makeDial(const std::string& dialTitle_,
       LogThrowIf(uniformityTolerance != defUniformityTolerance,
                  "Invalid catmull-rom inputs -- Nonuniform spacing");
     }
-    dialBase = (not useCachedDial_) ?
-      std::make_unique<MonotonicSpline>():
-      std::make_unique<MonotonicSplineCache>();
+    dialBase = DialArena::makeDial((not useCachedDial_) ?
+                                   DialArena::Type::MonotonicSpline:
+                                   DialArena::Type::MonotonicSplineCache, _dialArena_);
   }
   else if (splType == "catmull-rom") {
     // Catmull-Rom is handled as a special case because it ignores the slopes.
@@ -431,24 +432,24 @@ DialBase* SplineDialBaseFactory::makeDial(const std::string& dialTitle_,
       LogThrowIf(uniformityTolerance != defUniformityTolerance,
                  "Invalid catmull-rom inputs -- Nonuniform spacing");
     }
-    dialBase = (not useCachedDial_) ?
-      std::make_unique<CompactSpline>():
-      std::make_unique<CompactSplineCache>();
+    dialBase = DialArena::makeDial((not useCachedDial_) ?
+                                   DialArena::Type::CompactSpline:
+                                   DialArena::Type::CompactSplineCache, _dialArena_);
   }
   else if (isUniform) {
     // Haven't matched a specific special case, but we have uniformly spaced
     // knots so we can use the faster UniformSpline implementation.
-    dialBase = (not useCachedDial_) ?
-      std::make_unique<UniformSpline>():
-      std::make_unique<UniformSplineCache>();
+    dialBase = DialArena::makeDial((not useCachedDial_) ?
+                                   DialArena::Type::UniformSpline:
+                                   DialArena::Type::UniformSplineCache, _dialArena_);
   }
   else {
     // Haven't matched a specific special case, and the knots are not
     // uniformly spaced, so we have to use the GeneralSpline implemenatation
     // which can handle any kind of cubic spline.
-    dialBase = (not useCachedDial_) ?
-      std::make_unique<GeneralSpline>():
-      std::make_unique<GeneralSplineCache>();
+    dialBase = DialArena::makeDial((not useCachedDial_) ?
+                                   DialArena::Type::GeneralSpline:
+                                   DialArena::Type::GeneralSplineCache, _dialArena_);
   }
 
   // Initialize the spline from the slopes
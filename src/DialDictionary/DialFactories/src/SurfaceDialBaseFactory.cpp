@@ -23,19 +23,19 @@ DialBase* SurfaceDialBaseFactory::makeDial(const std::string& dialTitle_,
 
   // Stuff the created dial into a unique_ptr, so it will be properly deleted
   // in the event of an exception.
-  std::unique_ptr<DialBase> dialBase;
+  DialArena::DialPtr dialBase;
 
   if (dialSubType_ == "Bilinear") {
     // Basic coding: Give a hint to the reader and put likely branch "first".
     // Do we really expect the cached version more than the uncached?
-    dialBase = (useCachedDial_) ?
-      std::make_unique<BilinearCache>():
-      std::make_unique<Bilinear>();
+    dialBase = DialArena::makeDial((useCachedDial_) ?
+                                   DialArena::Type::BilinearCache:
+                                   DialArena::Type::Bilinear, _dialArena_);
   }
   else if (dialSubType_ == "Bicubic") {
-    dialBase = (useCachedDial_) ?
-      std::make_unique<BicubicCache>():
-      std::make_unique<Bicubic>();
+    dialBase = DialArena::makeDial((useCachedDial_) ?
+                                   DialArena::Type::BicubicCache:
+                                   DialArena::Type::Bicubic, _dialArena_);
   }
 
   if (not dialBase) {
@@ -117,7 +117,7 @@ TabulatedDialFactory::TabulatedDialFactory(const JsonType& config_) {
 
 }
 
-void TabulatedDialFactory::updateTable(DialInputBuffer& inputBuffer) {
+void TabulatedDialFactory::updateTable(const DialInputBuffer& inputBuffer) {
     _updateFunc_(_name_.c_str(),
                  _table_.data(),
                  (int) _table_.size(),
@@ -125,7 +125,7 @@ void TabulatedDialFactory::updateTable(DialInputBuffer& inputBuffer) {
                  (int) inputBuffer.getInputBuffer().size());
 }
 
-DialBase* TabulatedDialFactory::makeDial(const Event& event) {
+DialBase* TabulatedDialFactory::makeDial(const Event& event, DialArena* dialArena) {
     int i=0;
     for (const std::string& varName : getBinningVariables()) {
         double v = event.getVariables().fetchVariable(varName).getVarAsDouble();
@@ -146,6 +146,10 @@ DialBase* TabulatedDialFactory::makeDial(const Event& event) {
     if (fracBin < 0.0) fracBin = 0.0;
     if (fracBin > 1.0) fracBin = 1.0;
 
+    if (dialArena != nullptr) {
+        return dialArena->emplace<Tabulated>(DialArena::Type::Tabulated, &_table_, iBin, fracBin);
+    }
+
     // Do the unique_ptr dance in case there are exceptions.
     std::unique_ptr<Tabulated> dialBase = std::make_unique<Tabulated>(&_table_, iBin, fracBin);
     return dialBase.release();
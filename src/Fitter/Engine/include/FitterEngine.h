@@ -79,6 +79,10 @@ public:
 
   // Core
   void fit();
+  /// Fit nbToys_ toys in a row with the events loaded once: for each toy the
+  /// data are thrown again from the model (see DataSetManager::throwToyData)
+  /// and the results are appended to a single "toys/toyFitResults" tree.
+  void runToyFits(int nbToys_);
   void runPcaCheck();
   void rescaleParametersStepSize();
   void checkNumericalAccuracy();
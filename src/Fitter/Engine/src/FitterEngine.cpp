@@ -16,6 +16,7 @@
 #include "TGraph.h"
 #include "TLegend.h"
 
+#include <algorithm>
 #include <cmath>
 #include <memory>
 
@@ -186,6 +187,7 @@ void FitterEngine::initializeImpl(){
       GenericToolbox::mkdirTFile(_saveDir_, "propagator"),
       getLikelihoodInterface().getDataSetManager().getPropagator().getParametersManager().getStrippedCovarianceMatrix().get(), "strippedCovarianceMatrix"
   );
+  getLikelihoodInterface().getDataSetManager().writeLoadingProfiles( GenericToolbox::mkdirTFile(_saveDir_, "propagator/loading") );
   for( auto& parSet : getLikelihoodInterface().getDataSetManager().getPropagator().getParametersManager().getParameterSetsList() ){
     if(not parSet.isEnabled()) continue;
 
@@ -439,6 +441,88 @@ void FitterEngine::fit(){
   LogWarning << "Fit is done." << std::endl;
 }
 
+void FitterEngine::runToyFits(int nbToys_){
+  LogWarning << __METHOD_NAME__ << std::endl;
+  LogThrowIf( not isInitialized() );
+  LogThrowIf( nbToys_ <= 0, "Invalid number of toys: " << nbToys_ );
+
+  auto& dataSetManager = getLikelihoodInterface().getDataSetManager();
+  auto& propagator = dataSetManager.getPropagator();
+  auto& parSetList = propagator.getParametersManager().getParameterSetsList();
+
+  // one entry per toy
+  int toyIndex{0};
+  int minimizerStatus{0};
+  bool fitConverged{false};
+  double totalLikelihood{0};
+  double statLikelihood{0};
+  double penaltyLikelihood{0};
+  std::vector<std::vector<double>> thrownValueList(parSetList.size());
+  std::vector<std::vector<double>> bestFitValueList(parSetList.size());
+
+  auto toyFitResults = std::make_unique<TTree>("toyFitResults", "toyFitResults");
+  toyFitResults->SetDirectory( nullptr );
+  toyFitResults->Branch("toyIndex", &toyIndex);
+  toyFitResults->Branch("fitConverged", &fitConverged);
+  toyFitResults->Branch("minimizerStatus", &minimizerStatus);
+  toyFitResults->Branch("totalLikelihoodAtBestFit", &totalLikelihood);
+  toyFitResults->Branch("statLikelihoodAtBestFit", &statLikelihood);
+  toyFitResults->Branch("penaltyLikelihoodAtBestFit", &penaltyLikelihood);
+  for( size_t iParSet = 0 ; iParSet < parSetList.size() ; iParSet++ ){
+    if( not parSetList[iParSet].isEnabled() ){ continue; }
+    auto branchName = GenericToolbox::generateCleanBranchName(parSetList[iParSet].getName());
+    toyFitResults->Branch((branchName + "_thrown").c_str(), &thrownValueList[iParSet]);
+    toyFitResults->Branch((branchName + "_bestFit").c_str(), &bestFitValueList[iParSet]);
+  }
+
+  auto fetchParameterValues = [&](std::vector<std::vector<double>>& valueList_){
+    for( size_t iParSet = 0 ; iParSet < parSetList.size() ; iParSet++ ){
+      valueList_[iParSet].clear();
+      for( auto& par : parSetList[iParSet].getParameterList() ){ valueList_[iParSet].emplace_back( par.getParameterValue() ); }
+    }
+  };
+
+  // the fit outputs of each toy are written in their own folder
+  auto* engineSaveDir = _saveDir_;
+  auto* toysSaveDir = GenericToolbox::mkdirTFile( engineSaveDir, "toys" );
+
+  int firstToyIndex{std::max(0, propagator.getIThrow())};
+  for( int iToy = 0 ; iToy < nbToys_ ; iToy++ ){
+    toyIndex = firstToyIndex + iToy;
+    LogWarning << std::endl << GenericToolbox::addUpDownBars("Toy fit #" + std::to_string(toyIndex) + " (" + std::to_string(iToy+1) + "/" + std::to_string(nbToys_) + ")") << std::endl;
+
+    propagator.setIThrow( toyIndex );
+    dataSetManager.throwToyData();
+    fetchParameterValues( thrownValueList );
+
+    // every toy is fitted from the prior
+    propagator.getParametersManager().moveParametersToPrior();
+    _minimizer_->updateStartingPoint();
+
+    _saveDir_ = GenericToolbox::mkdirTFile( toysSaveDir, "toy_" + std::to_string(toyIndex) );
+    _minimizer_->minimize();
+    if( _minimizer_->getMinimizerStatus() == 0 and _minimizer_->isErrorCalcEnabled() ){
+      LogInfo << "Computing post-fit errors..." << std::endl;
+      _minimizer_->calcErrors();
+    }
+    _saveDir_ = engineSaveDir;
+
+    minimizerStatus = _minimizer_->getMinimizerStatus();
+    fitConverged = ( minimizerStatus == 0 );
+    totalLikelihood = getLikelihoodInterface().getLastLikelihood();
+    statLikelihood = getLikelihoodInterface().getLastStatLikelihood();
+    penaltyLikelihood = getLikelihoodInterface().getLastPenaltyLikelihood();
+    fetchParameterValues( bestFitValueList );
+    toyFitResults->Fill();
+
+    // written after each toy so the finished ones are kept if the job is killed
+    toysSaveDir->WriteObject( toyFitResults.get(), toyFitResults->GetName(), "overwrite" );
+    GenericToolbox::triggerTFileWrite( toysSaveDir );
+  }
+
+  LogWarning << nbToys_ << " toy fits done." << std::endl;
+}
+
 // protected
 void FitterEngine::runPcaCheck(){
 
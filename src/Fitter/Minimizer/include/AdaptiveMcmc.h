@@ -6,6 +6,7 @@
 #define GUNDAM_ADAPTIVE_MCMC_H
 
 #include "ParameterSet.h"
+#include "PropagatorWorker.h"
 #include "MinimizerBase.h"
 #include "JsonBaseClass.h"
 
@@ -16,7 +17,9 @@
 #include "TDirectory.h"
 #include "nlohmann/json.hpp"
 
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 // Override TSimpleMCMC.H for how much output to use and where to send it.
@@ -116,6 +119,28 @@ private:
   // The number of steps in each run cycle.
   int _steps_{10000};
 
+  //////////////////////////////////////////
+  // Parameters for the parallel chains (adaptive proposal only).
+
+  // The number of chains run concurrently.  Each chain has its own private
+  // propagation state (see PropagatorWorker) and its own output tree.  With
+  // one chain, the usual (multi-threaded) propagator is used.
+  int _nbChains_{1};
+
+  // The number of steps each chain runs between two synchronisations.  The
+  // tempered chains are exchanged at each synchronisation.
+  int _chainSyncSteps_{100};
+
+  // Merge the running covariance of all the chains before each update of the
+  // proposal, so every chain learns from the points of the others.
+  bool _shareProposalCovariance_{true};
+
+  // Run the chains at increasing temperatures and exchange their states
+  // (parallel tempering).  Chain k samples the posterior to the power
+  // 1/temperatureStep^k, so only the first chain samples the posterior.
+  bool _enableParallelTempering_{false};
+  double _temperatureStep_{1.5};
+
   // The model for the likelihood takes up quite a bit of space, so it should
   // NOT be saved most of the time.  The _modelStride_ sets the number of
   // steps between when the model is saved to the output file.  The model is a
@@ -269,6 +294,87 @@ private:
   typedef sMCMC::TSimpleMCMC<PrivateProxyLikelihood,sMCMC::TProposeAdaptiveStep> AdaptiveStepMCMC;
   void setupAndRunAdaptiveStep(AdaptiveStepMCMC& mcmc);
 
+  /// The parts of an adaptive chain that differ between the single chain
+  /// and the parallel chains: where the accepted points and the saved model
+  /// are kept.
+  struct AdaptiveChainHandle {
+    AdaptiveStepMCMC* mcmc{nullptr};
+    std::function<void(bool fillModel_)> fillPoint{};
+    std::function<void()> saveModel{};
+  };
+
+  /// Run nSteps_ steps of every chain, calling step_(chain, iStep) for each
+  /// of them.  The title_ is used for the progress printout.
+  typedef std::function<void(AdaptiveChainHandle& chain_, int iStep_)> AdaptiveStepFct;
+  typedef std::function<void(const std::string& title_, int nSteps_, const AdaptiveStepFct& step_)> AdaptiveStepRunner;
+
+  /// The burn-in cycles (skipped if runBurnin_ is false) and the main cycles
+  /// of the adaptive step.  This is shared by setupAndRunAdaptiveStep() and
+  /// runParallelChains().  The shareCovariance_ function (if set) is called
+  /// whenever the proposal covariances of the chains should be merged.
+  void runAdaptiveCycles(std::vector<AdaptiveChainHandle>& chainList_,
+                         bool runBurnin_,
+                         const AdaptiveStepRunner& runSteps_,
+                         const std::function<void()>& shareCovariance_);
+
+  /// A random starting point within one sigma of the prior (and within the
+  /// allowed ranges) in the space seen by the MCMC.
+  sMCMC::Vector throwRandomStartPoint() const;
+
+  /////////////////////////////////////////////////////////////////
+  // Support for the parallel chains.
+
+  /// One of several adaptive chains running concurrently.  The chains share
+  /// the events and the dials of the propagator.  Each one reweights them
+  /// with its own PropagatorWorker, and that is the only part running
+  /// concurrently: the proposal, the likelihood and the output are handled
+  /// while holding _chainMutex_, since they use the shared parameters and
+  /// samples (and gRandom).
+  struct ParallelChain {
+    explicit ParallelChain(Propagator& propagator_) : worker(propagator_) {}
+
+    PropagatorWorker worker;
+    std::unique_ptr<AdaptiveStepMCMC> mcmc{};
+    TTree* tree{nullptr};
+
+    // The inverse temperature of the chain (one without tempering).
+    double beta{1.0};
+
+    // The lock held by the thread running the chain.  It is released while
+    // the worker is propagating.
+    std::unique_lock<std::mutex>* lock{nullptr};
+
+    // Same as the single chain output buffers.
+    std::vector<float> point{};
+    std::vector<float> model{};
+    std::vector<float> saveModel{};
+    std::vector<float> uncertainty{};
+    std::vector<float> saveUncertainty{};
+    float llhStatistical{0.0};
+    float llhPenalty{0.0};
+  };
+  std::mutex _chainMutex_{};
+
+  /// Run _nbChains_ adaptive chains concurrently.  This follows the same
+  /// burn-in and run cycles as setupAndRunAdaptiveStep() (see
+  /// runAdaptiveCycles()).
+  void runParallelChains();
+
+  /// The likelihood function of a parallel chain: same as evalFitValid, but
+  /// propagated with the chain worker, and scaled by the chain temperature.
+  /// Must be called by the thread holding the chain lock.
+  double evalChainLikelihood(ParallelChain& chain_, const double* parArray_);
+
+  /// Same as fillPoint(), for the buffers of a parallel chain.
+  void fillChainPoint(ParallelChain& chain_, bool fillModel_);
+
+  /// Merge the running covariance estimates of the chains (see
+  /// _shareProposalCovariance_).
+  void shareProposalCovariance(std::vector<std::unique_ptr<ParallelChain>>& chainList_);
+
+  /// Propose to exchange the states of chains with neighbouring temperatures.
+  void swapTemperedChains(std::vector<std::unique_ptr<ParallelChain>>& chainList_);
+
   /////////////////////////////////////////////////////////////////
   // Support routines for the adaptive step.
 
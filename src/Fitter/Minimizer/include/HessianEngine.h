@@ -0,0 +1,79 @@
+//
+// Finite difference hessian evaluated with several PropagatorWorker.
+//
+
+#ifndef GUNDAM_HESSIAN_ENGINE_H
+#define GUNDAM_HESSIAN_ENGINE_H
+
+#include "LikelihoodInterface.h"
+#include "PropagatorWorker.h"
+#include "Parameter.h"
+
+#include "GenericToolbox.Thread.h"
+
+#include "TMatrixDSym.h"
+
+#include <vector>
+
+
+/// Evaluate the post-fit covariance matrix from the finite difference
+/// hessian of the likelihood at the best fit point.  The O(N^2) points of the
+/// stencil are independent: they are propagated in batches, one point per
+/// PropagatorWorker, each worker running on its own thread.  Only the
+/// likelihood evaluation itself (cheap once the histograms are filled) is
+/// done sequentially on the propagator samples.
+///
+/// The parameters are the ones seen by the minimizer (normalized and/or
+/// eigen parameters), so the covariance matrix is equivalent to the one
+/// provided by ROOT::Math::Minimizer::GetCovMatrix().
+class HessianEngine {
+
+public:
+  HessianEngine(LikelihoodInterface& likelihood_, const std::vector<Parameter*>& parameterList_, bool useNormalizedFitSpace_);
+
+  // setters
+  void setNbWorkers(int nbWorkers_){ _nbWorkers_ = nbWorkers_; }
+
+  // const getters
+  /// Same codes as ROOT::Math::Minimizer::Status() after Hesse
+  [[nodiscard]] int getHesseStatus() const { return _hesseStatus_; }
+  /// Same codes as ROOT::Math::Minimizer::CovMatrixStatus()
+  [[nodiscard]] int getCovMatrixStatus() const { return _covMatrixStatus_; }
+  [[nodiscard]] size_t getNbLikelihoodEvals() const { return _nbLikelihoodEvals_; }
+  [[nodiscard]] const TMatrixDSym& getCovarianceMatrix() const { return _covarianceMatrix_; }
+
+  /// Evaluate the hessian around bestFit_ with the steps stepList_ (in the
+  /// minimizer space).  Parameters with a null step are treated as fixed.
+  /// The likelihood is the -2 log(L), so the covariance is 2*H^-1.  Returns
+  /// true on success.
+  bool evalCovarianceMatrix(const std::vector<double>& bestFit_, const std::vector<double>& stepList_);
+
+private:
+  /// A point of the stencil: up to two parameters are moved from the best fit
+  struct Displacement{
+    int iPar{-1}; double iStep{0};
+    int jPar{-1}; double jStep{0};
+  };
+
+  void setParameterValues(const Displacement& displacement_);
+  void evalLikelihoods(const std::vector<Displacement>& displacementList_, std::vector<double>& llhList_);
+
+  // parameters
+  int _nbWorkers_{1};
+  bool _useNormalizedFitSpace_{true};
+
+  // internals
+  int _hesseStatus_{-1};
+  int _covMatrixStatus_{0};
+  size_t _nbLikelihoodEvals_{0};
+  LikelihoodInterface* _likelihood_{nullptr};
+  std::vector<Parameter*> _parameterList_{};
+  std::vector<double> _bestFit_{};
+  std::vector<PropagatorWorker> _workerList_{};
+  GenericToolbox::ParallelWorker _threadPool_{};
+  TMatrixDSym _covarianceMatrix_{};
+
+};
+
+
+#endif //GUNDAM_HESSIAN_ENGINE_H
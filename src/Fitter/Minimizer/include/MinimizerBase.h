@@ -98,6 +98,16 @@ public:
   /// defined by the vector of pointers to Parameter returned by the LikelihoodInterface.
   virtual double evalFit( const double* parArray_ );
 
+  /// Fill gradient_ with the derivatives of the likelihood with respect to
+  /// the parameters of parArray_ (same meaning as for evalFit).  This is only
+  /// valid if getLikelihoodInterface().isAnalyticGradientAvailable().
+  virtual void evalFitGradient( const double* parArray_, double* gradient_ );
+
+  /// A virtual method that makes the next call to minimize() start from the
+  /// current parameter values (e.g. when fitting several toys in a row).
+  /// The default is a no-op for minimizers reading the parameters directly.
+  virtual void updateStartingPoint(){}
+
   // default calcErrors() is not defined
   [[nodiscard]] virtual bool isErrorCalcEnabled() const { return false; }
 
@@ -171,6 +181,7 @@ private:
 
   // internals
   bool _disableCalcError_{false};
+  std::vector<double> _gradientBuffer_{};
   Monitor _monitor_{};
 
 };
@@ -15,7 +15,9 @@
 
 #include "Math/Minimizer.h"
 #include "Math/Functor.h"
+#include "Math/IFunction.h"
 #include "TDirectory.h"
+#include "TMatrixDSym.h"
 #include "nlohmann/json.hpp"
 
 #include <memory>
@@ -33,6 +35,7 @@ public:
   void minimize() override;
   void calcErrors() override;
   void scanParameters( TDirectory* saveDir_ ) override;
+  void updateStartingPoint() override;
   bool isErrorCalcEnabled() const override { return not disableCalcError(); }
 
   // c-tor
@@ -49,7 +52,8 @@ public:
   void saveMinimizerSettings(TDirectory* saveDir_) const;
 
 protected:
-  void writePostFitData(TDirectory* saveDir_);
+  /// The post-fit covariance is taken from the minimizer, unless provided
+  void writePostFitData(TDirectory* saveDir_, const TMatrixDSym* covarianceMatrix_ = nullptr);
   void updateCacheToBestfitPoint();
   void saveGradientSteps();
 
@@ -68,14 +72,18 @@ private:
   bool _restoreStepSizeBeforeHesse_{false};
   bool _generatedPostFitParBreakdown_{false};
   bool _generatedPostFitEigenBreakdown_{false};
+  bool _useAnalyticGradient_{false};
+  bool _enableParallelHesse_{false};
 
   int _strategy_{1};
   int _printLevel_{2};
   int _simplexStrategy_{1};
+  int _parallelHesseNbWorkers_{0};
 
   double _tolerance_{1E-4};
   double _stepSizeScaling_{1};
   double _simplexToleranceLoose_{1000.};
+  double _parallelHesseStepFraction_{0.1};
 
   unsigned int _maxIterations_{500};
   unsigned int _maxFcnCalls_{1000000000};
@@ -91,6 +99,28 @@ private:
   /// A functor that can be called by Minuit or anybody else.  This wraps
   /// evalFit.
   ROOT::Math::Functor _functor_{};
+
+  /// Same as _functor_, but also providing the analytic gradient of the
+  /// likelihood through evalFitGradient.  Only used when requested and if
+  /// the likelihood and all the dials can provide their derivatives.
+  class GradientFunctor : public ROOT::Math::IMultiGradFunction {
+  public:
+    explicit GradientFunctor(RootMinimizer* owner_): _owner_(owner_) {}
+    [[nodiscard]] unsigned int NDim() const override { return _owner_->getMinimizerFitParameterPtr().size(); }
+    [[nodiscard]] ROOT::Math::IMultiGradFunction* Clone() const override { return new GradientFunctor(*this); }
+    void Gradient(const double* x_, double* grad_) const override { _owner_->evalFitGradient(x_, grad_); }
+  private:
+    [[nodiscard]] double DoEval(const double* x_) const override { return _owner_->evalFit(x_); }
+    [[nodiscard]] double DoDerivative(const double* x_, unsigned int iCoord_) const override {
+      _gradientBuffer_.resize(NDim());
+      this->Gradient(x_, _gradientBuffer_.data());
+      return _gradientBuffer_[iCoord_];
+    }
+    RootMinimizer* _owner_{nullptr};
+    mutable std::vector<double> _gradientBuffer_{};
+  };
+  GradientFunctor _gradientFunctor_{this};
+
   std::unique_ptr<ROOT::Math::Minimizer> _rootMinimizer_{nullptr};
 
 };
@@ -9,8 +9,10 @@
 
 #include "GenericToolbox.Json.h"
 #include "GenericToolbox.Root.h"
+#include "GenericToolbox.Thread.h"
 #include "Logger.h"
 
+#include <functional>
 #include <locale>
 
 #ifndef DISABLE_USER_HEADER
@@ -86,6 +88,22 @@ void AdaptiveMcmc::readConfigImpl(){
   _steps_ = GenericToolbox::Json::fetchValue(_config_,
                                              "steps", _steps_);
 
+  // The number of chains to run concurrently in this job.  The chains share
+  // the loaded events, and each one propagates its own parameters.
+  _nbChains_ = GenericToolbox::Json::fetchValue(_config_, "nbChains", _nbChains_);
+
+  // The number of steps between the synchronisations of the parallel chains.
+  _chainSyncSteps_ = GenericToolbox::Json::fetchValue(_config_, "chainSyncSteps", _chainSyncSteps_);
+
+  // Share the covariance learned by the parallel chains when the proposal is
+  // updated.
+  _shareProposalCovariance_ = GenericToolbox::Json::fetchValue(_config_, "shareProposalCovariance", _shareProposalCovariance_);
+
+  // Run the parallel chains at different temperatures and exchange them.
+  // The temperature of chain k is temperatureStep^k.
+  _enableParallelTempering_ = GenericToolbox::Json::fetchValue(_config_, "enableParallelTempering", _enableParallelTempering_);
+  _temperatureStep_ = GenericToolbox::Json::fetchValue(_config_, "temperatureStep", _temperatureStep_);
+
   ///////////////////////////////////////////////////////////////
   // Get parameters for the adaptive proposal.
 
@@ -491,6 +509,44 @@ bool AdaptiveMcmc::adaptiveLoadProposalCovariance( AdaptiveStepMCMC& mcmc,
   return true;
 }
 
+sMCMC::Vector AdaptiveMcmc::throwRandomStartPoint() const {
+  sMCMC::Vector point;
+  for (const Parameter* par : getMinimizerFitParameterPtr() ) {
+    double val = par->getPriorValue();
+    double err = par->getStdDevValue();
+    double r = gRandom->Uniform(0.0,1.0);
+    double lowBound = val-1.0*err;
+    double highBound = val+1.0*err;
+    if(not std::isnan(par->getMinValue())) {
+      lowBound = std::max(lowBound, par->getMinValue());
+    }
+    if(not std::isnan(par->getMinMirror())) {
+      lowBound = std::max(lowBound, par->getMinMirror());
+    }
+    if(not std::isnan(par->getMinPhysical())) {
+      lowBound = std::max(lowBound, par->getMinPhysical());
+    }
+
+    if(not std::isnan(par->getMaxValue())) {
+      highBound = std::min(highBound, par->getMaxValue());
+    }
+    if(not std::isnan(par->getMaxMirror())) {
+      highBound = std::min(highBound, par->getMaxMirror());
+    }
+    if(not std::isnan(par->getMaxPhysical())) {
+      highBound = std::min(highBound, par->getMaxPhysical());
+    }
+    val = lowBound + r*(highBound-lowBound);
+    if (not useNormalizedFitSpace()) {
+      point.push_back(val);
+    }
+    else {
+      point.push_back(ParameterSet::toNormalizedParValue(val, *par));
+    }
+  }
+  return point;
+}
+
 void AdaptiveMcmc::setupAndRunAdaptiveStep( AdaptiveStepMCMC& mcmc) {
 
   mcmc.GetProposeStep().SetDim(getMinimizerFitParameterPtr().size());
@@ -507,40 +563,7 @@ void AdaptiveMcmc::setupAndRunAdaptiveStep( AdaptiveStepMCMC& mcmc) {
     LogInfo<<"MCMC chain starts from a random point"<<std::endl;
     int throttle =10;
     do{
-    for (const Parameter* par : getMinimizerFitParameterPtr() ) {
-      double val = par->getPriorValue();
-      double err = par->getStdDevValue();
-      double r = gRandom->Uniform(0.0,1.0);
-      double lowBound = val-1.0*err;
-      double highBound = val+1.0*err;
-      if(not std::isnan(par->getMinValue())) {
-        lowBound = std::max(lowBound, par->getMinValue());
-      }
-      if(not std::isnan(par->getMinMirror())) {
-        lowBound = std::max(lowBound, par->getMinMirror());
-      }
-      if(not std::isnan(par->getMinPhysical())) {
-        lowBound = std::max(lowBound, par->getMinPhysical());
-      }
-
-      if(not std::isnan(par->getMaxValue())) {
-        highBound = std::min(highBound, par->getMaxValue());
-      }
-      if(not std::isnan(par->getMaxMirror())) {
-        highBound = std::min(highBound, par->getMaxMirror());
-      }
-      if(not std::isnan(par->getMaxPhysical())) {
-        highBound = std::min(highBound, par->getMaxPhysical());
-      }
-      val = lowBound + r*(highBound-lowBound);
-      if (not useNormalizedFitSpace()) {
-        prior.push_back(val);
-      }
-      else {
-         prior.push_back(ParameterSet::toNormalizedParValue(val, *par));
-      }
-
-    }
+    prior = throwRandomStartPoint();
     StartStatus = mcmc.Start(prior, false);
     if(!StartStatus) prior.clear();
     LogInfo<<"The size of prior is "<<prior.size()<<std::endl;
@@ -583,80 +606,116 @@ void AdaptiveMcmc::setupAndRunAdaptiveStep( AdaptiveStepMCMC& mcmc) {
   std::string restorationTree = "FitterEngine/fit/" + _outTreeName_;
   bool restored = adaptiveRestoreState(mcmc,_adaptiveRestore_, restorationTree);
 
+  // The single chain runs its steps directly.
+  std::vector<AdaptiveChainHandle> chainList(1);
+  chainList.front().mcmc = &mcmc;
+  chainList.front().fillPoint = [this](bool fillModel_){ fillPoint(fillModel_); };
+  chainList.front().saveModel = [this](){
+    _saveModel_.resize(_model_.size());
+    std::copy(_model_.begin(), _model_.end(), _saveModel_.begin());
+    _saveUncertainty_.resize(_uncertainty_.size());
+    std::copy(_uncertainty_.begin(), _uncertainty_.end(),
+              _saveUncertainty_.begin());
+  };
+  auto runSteps = [&](const std::string& title_, int nSteps_,
+                      const AdaptiveStepFct& step_) {
+    for (int i = 0; i < nSteps_; ++i) {
+      step_(chainList.front(), i);
+      if(nSteps_ > 100 && !(i%(nSteps_/100))){
+        LogInfo << title_
+                << " step: " << i << "/" << nSteps_ << " "
+                << i*100./nSteps_ << "%"
+                << " Trials: "
+                << mcmc.GetProposeStep().GetSuccesses()
+                << "/" << mcmc.GetProposeStep().GetTrials()
+                << " (acc " << mcmc.GetProposeStep().GetAcceptance()
+                << ", sig " << mcmc.GetProposeStep().GetSigma()
+                << ", rms " << mcmc.GetStepRMS()
+                << ")"
+                << std::endl;
+      }
+    }
+  };
+
+  runAdaptiveCycles(chainList, not restored, runSteps, {});
+}
+void AdaptiveMcmc::runAdaptiveCycles(std::vector<AdaptiveChainHandle>& chainList_,
+                                     bool runBurnin_,
+                                     const AdaptiveStepRunner& runSteps_,
+                                     const std::function<void()>& shareCovariance_) {
+
+  // Limit the number of times that the model histogram data is saved to
+  // the output file.  It won't be saved if the _modelStride_ is less than
+  // one.  Otherwise it will be saved every _modelStride_ steps.
+  auto saveModel = [&](AdaptiveChainHandle& chain_) {
+    if (_modelStride_ > 0
+        and 0 == (chain_.mcmc->GetProposeStep().GetTrials()%_modelStride_)) {
+      chain_.saveModel();
+    }
+  };
+
   // Check if there should be some burn-in cycles.  Burn-in in this context is
   // mainly about moving the current point away from the default.
-  if (not restored and _burninCycles_ > 0 and _burninLength_ > 0) {
+  if (runBurnin_ and _burninCycles_ > 0 and _burninLength_ > 0) {
     // Burn-In cycles
-    mcmc.GetProposeStep().SetCovarianceWindow(_burninCovWindow_);
-    mcmc.GetProposeStep().SetAcceptanceWindow(_burninWindow_);
-    mcmc.SetStepRMSWindow(_burninWindow_);
-    mcmc.GetProposeStep()
-        .SetCovarianceUpdateDeweighting(_burninCovDeweighting_);
-    mcmc.GetProposeStep().UpdateProposal();
-    mcmc.GetProposeStep().SetCovarianceFrozen(false);
-    for (int chain = 0; chain < _burninCycles_; ++chain) {
-      LogInfo << "Start burn-In chain " << chain << std::endl;
-      // Override default number of steps until the next automatic
-      // UpdateProposal call.  This disables automatic updates during adaptive
-      // burn-in.
-      mcmc.GetProposeStep().SetNextUpdate(2*_burninLength_*_burninCycles_);
-      mcmc.GetProposeStep()
-          .SetCovarianceUpdateDeweighting(_burninCovDeweighting_);
-      if (chain < _burninFreezeAfter_) {
+    for (auto& chain : chainList_) {
+      auto& propose = chain.mcmc->GetProposeStep();
+      propose.SetCovarianceWindow(_burninCovWindow_);
+      propose.SetAcceptanceWindow(_burninWindow_);
+      chain.mcmc->SetStepRMSWindow(_burninWindow_);
+      propose.SetCovarianceUpdateDeweighting(_burninCovDeweighting_);
+      propose.UpdateProposal();
+      propose.SetCovarianceFrozen(false);
+    }
+    for (int cycle = 0; cycle < _burninCycles_; ++cycle) {
+      LogInfo << "Start burn-In chain " << cycle << std::endl;
+      if (cycle < _burninFreezeAfter_) {
         LogInfo << "Burn-in step length will be updated" << std::endl;
-        mcmc.GetProposeStep().SetAcceptanceRigidity(2.0);
       }
       else {
         LogInfo << "Burn-in step length is frozen" << std::endl;
-        mcmc.GetProposeStep().SetAcceptanceRigidity(-1);
+      }
+      for (auto& chain : chainList_) {
+        auto& propose = chain.mcmc->GetProposeStep();
+        // Override default number of steps until the next automatic
+        // UpdateProposal call.  This disables automatic updates during
+        // adaptive burn-in.
+        propose.SetNextUpdate(2*_burninLength_*_burninCycles_);
+        propose.SetCovarianceUpdateDeweighting(_burninCovDeweighting_);
+        propose.SetAcceptanceRigidity(cycle < _burninFreezeAfter_ ? 2.0 : -1);
       }
       // Burn-In chain in each cycle
-      for (int i = 0; i < _burninLength_; ++i) {
+      runSteps_("Burn-in: " + std::to_string(cycle), _burninLength_,
+                [&](AdaptiveChainHandle& chain_, int iStep_) {
         // Run the burn-in step.
-        if (mcmc.Step(false)) fillPoint(false);
-        if (_modelStride_ > 0
-            and 0 == (mcmc.GetProposeStep().GetTrials()%_modelStride_)) {
-          _saveModel_.resize(_model_.size());
-          std::copy(_model_.begin(), _model_.end(), _saveModel_.begin());
-          _saveUncertainty_.resize(_uncertainty_.size());
-          std::copy(_uncertainty_.begin(), _uncertainty_.end(),
-                    _saveUncertainty_.begin());
-        }
+        if (chain_.mcmc->Step(false)) chain_.fillPoint(false);
+        saveModel(chain_);
         // Now save the step.  Check to see if this is the last step of the
         // run, and if it is, then save the full state.
-        if (_saveBurnin_) mcmc.SaveStep(_burninLength_ <= (i+1));
-        if(_burninLength_ > 100 && !(i%(_burninLength_/100))){
-          LogInfo << "Burn-in: " << chain
-                  << " step: " << i << "/" << _burninLength_ << " "
-                  << i*100./_burninLength_ << "%"
-                  << " Trials: "
-                  << mcmc.GetProposeStep().GetSuccesses()
-                  << "/" << mcmc.GetProposeStep().GetTrials()
-                  << " (acc " << mcmc.GetProposeStep().GetAcceptance()
-                  << ", sig " << mcmc.GetProposeStep().GetSigma()
-                  << ", rms " << mcmc.GetStepRMS()
-                  << ")"
-                  << std::endl;
-        }
-      }
-      // Do an update at the *END* of the burn-in step.
-      mcmc.GetProposeStep().UpdateProposal();
-      // Reset the covariance to the initial state.  This forgets the path of
-      // the previous cycle.  This only happens a few times to let it forget
-      // about the very first burn-in cycles
-      if (chain < _burninResets_) {
-        sMCMC::Vector saveCenter{mcmc.GetProposeStep().GetEstimatedCenter()};
-        mcmc.GetProposeStep().ResetProposal();
-        // After the reset, set how many trials the prior covariance counts
-        // for.  This needs to be done by hand since the extra weight lives
-        // here, and not in TSimpleMCMC.h (TSimpleMCMC doesn't, and shouldn't,
-        // know about this burn-in process).
-        if (_adaptiveCovTrials_ > 0) {
-          mcmc.GetProposeStep().SetCovarianceTrials(_adaptiveCovTrials_);
-          // We have a good prior (usually based on a previous MINUIT fit), so
-          // restore the current estimate of the centeral value.
-          mcmc.GetProposeStep().SetEstimatedCenter(saveCenter);
-          mcmc.GetProposeStep().SetEstimatedCenterTrials(_adaptiveCovTrials_);
+        if (_saveBurnin_) chain_.mcmc->SaveStep(_burninLength_ <= (iStep_+1));
+      });
+      if (shareCovariance_) shareCovariance_();
+      for (auto& chain : chainList_) {
+        auto& propose = chain.mcmc->GetProposeStep();
+        // Do an update at the *END* of the burn-in step.
+        propose.UpdateProposal();
+        // Reset the covariance to the initial state.  This forgets the path
+        // of the previous cycle.  This only happens a few times to let it
+        // forget about the very first burn-in cycles
+        if (cycle < _burninResets_) {
+          sMCMC::Vector saveCenter{propose.GetEstimatedCenter()};
+          propose.ResetProposal();
+          // After the reset, set how many trials the prior covariance counts
+          // for.  This needs to be done by hand since the extra weight lives
+          // here, and not in TSimpleMCMC.h (TSimpleMCMC doesn't, and
+          // shouldn't, know about this burn-in process).
+          if (_adaptiveCovTrials_ > 0) {
+            propose.SetCovarianceTrials(_adaptiveCovTrials_);
+            // We have a good prior (usually based on a previous MINUIT fit),
+            // so restore the current estimate of the centeral value.
+            propose.SetEstimatedCenter(saveCenter);
+            propose.SetEstimatedCenterTrials(_adaptiveCovTrials_);
+          }
         }
       }
     }
@@ -665,93 +724,77 @@ void AdaptiveMcmc::setupAndRunAdaptiveStep( AdaptiveStepMCMC& mcmc) {
 
   ////////////////////////////////////////////////////////////////
   // Run the main cycles.
-  mcmc.GetProposeStep().SetCovarianceWindow(_adaptiveCovWindow_);
-  mcmc.GetProposeStep().SetAcceptanceWindow(_adaptiveWindow_);
-  mcmc.SetStepRMSWindow(_adaptiveWindow_);
-  mcmc.GetProposeStep()
-      .SetCovarianceUpdateDeweighting(_adaptiveCovDeweighting_);
-  for (int chain = 0; chain < _cycles_; ++chain){
-    LogInfo << "Start run chain " << chain << std::endl;
-    // Update the covariance with the steps from the last cycle.  This starts
-    // a new "reversible-chain".  The update always happens at the start of a
-    // cycle, even if the sigma and covariance are frozen.
-    mcmc.GetProposeStep().UpdateProposal();
-    // Set whether the running covariance will be updated based on the new
-    // steps.  This freezes right after the last update that will be called.
-    if (chain < _adaptiveFreezeCorrelations_) {
+  for (auto& chain : chainList_) {
+    auto& propose = chain.mcmc->GetProposeStep();
+    propose.SetCovarianceWindow(_adaptiveCovWindow_);
+    propose.SetAcceptanceWindow(_adaptiveWindow_);
+    chain.mcmc->SetStepRMSWindow(_adaptiveWindow_);
+    propose.SetCovarianceUpdateDeweighting(_adaptiveCovDeweighting_);
+  }
+  for (int cycle = 0; cycle < _cycles_; ++cycle){
+    LogInfo << "Start run chain " << cycle << std::endl;
+    if (cycle > 0 and shareCovariance_) shareCovariance_();
+    if (cycle < _adaptiveFreezeCorrelations_) {
       LogInfo << "Step correlations are being updated" << std::endl;
-      mcmc.GetProposeStep().SetCovarianceFrozen(false);
     }
     else {
       LogInfo << "Step correlations are frozen" << std::endl;
-      mcmc.GetProposeStep().SetCovarianceFrozen(true);
     }
-    // Override default number of steps until the next automatic
-    // UpdateProposal call.  This disables automatic updates during normal
-    // chains.
-    mcmc.GetProposeStep().SetNextUpdate(2*_steps_*_cycles_);
-    // Set the adaptive covariance deweighting after the first update so that
-    // the previous deweighting is used for the first update.  This is a very
-    // cheap call so set it on every iteration.
-    mcmc.GetProposeStep()
-        .SetCovarianceUpdateDeweighting(_adaptiveCovDeweighting_);
-    // Set whether the step size is going to be tuned to deliver the target
-    // acceptance.
-    if (chain < _adaptiveFreezeAfter_) {
+    if (cycle < _adaptiveFreezeAfter_) {
       LogWarning << "Step length will be updated" << std::endl;
-      mcmc.GetProposeStep().SetAcceptanceRigidity(2.0);
     }
     else {
       LogInfo << "Step length is frozen" << std::endl;
-      mcmc.GetProposeStep().SetAcceptanceRigidity(-1);
+    }
+    for (auto& chain : chainList_) {
+      auto& propose = chain.mcmc->GetProposeStep();
+      // Update the covariance with the steps from the last cycle.  This
+      // starts a new "reversible-chain".  The update always happens at the
+      // start of a cycle, even if the sigma and covariance are frozen.
+      propose.UpdateProposal();
+      // Set whether the running covariance will be updated based on the new
+      // steps.  This freezes right after the last update that will be
+      // called.
+      propose.SetCovarianceFrozen(cycle >= _adaptiveFreezeCorrelations_);
+      // Override default number of steps until the next automatic
+      // UpdateProposal call.  This disables automatic updates during normal
+      // chains.
+      propose.SetNextUpdate(2*_steps_*_cycles_);
+      // Set the adaptive covariance deweighting after the first update so
+      // that the previous deweighting is used for the first update.  This is
+      // a very cheap call so set it on every iteration.
+      propose.SetCovarianceUpdateDeweighting(_adaptiveCovDeweighting_);
+      // Set whether the step size is going to be tuned to deliver the target
+      // acceptance.
+      propose.SetAcceptanceRigidity(cycle < _adaptiveFreezeAfter_ ? 2.0 : -1);
     }
     ////////////////////////////////
     // Run the steps for this chain
-    for (int i = 0; i < _steps_; ++i) {
+    runSteps_("Chain: " + std::to_string(cycle), _steps_,
+              [&](AdaptiveChainHandle& chain_, int iStep_) {
       // Run step, but do not save the step.  The step isn't saved so the
       // accepted step can be copied into the points (which will have
       // any decomposition removed).
-      if (mcmc.Step(false)) fillPoint();
+      if (chain_.mcmc->Step(false)) chain_.fillPoint(true);
       // Zero the size of the raw accepted points and only save the filled
       // points (which are in likelihood space).
-      if (not _saveRawSteps_) mcmc.ClearSavedAccepted();
-      // Limit the number of times that the model histogram data is saved to
-      // the output file.  It won't be saved if the _modelStride_ is less than
-      // one.  Otherwise it will be saved every _modelStride_ steps.
-      if (_modelStride_ > 0
-          and 0 == (mcmc.GetProposeStep().GetTrials()%_modelStride_)) {
-        _saveModel_.resize(_model_.size());
-        std::copy(_model_.begin(), _model_.end(), _saveModel_.begin());
-        _saveUncertainty_.resize(_uncertainty_.size());
-        std::copy(_uncertainty_.begin(), _uncertainty_.end(),
-                  _saveUncertainty_.begin());
-      }
+      if (not _saveRawSteps_) chain_.mcmc->ClearSavedAccepted();
+      saveModel(chain_);
       // Now save the step.  This is going to write the points in the
       // "likelihood" space.  If "_saveRawSteps_" is true, then this also
       // saves the accepted point in the (possibly) decomposed state.
-      mcmc.SaveStep(false);
-      if(_steps_ > 100 && !(i%(_steps_/100))){
-        LogInfo << "Chain: " << chain
-                << " step: " << i << "/" << _steps_ << " "
-                << i*100./_steps_ << "%"
-                << " Trials: "
-                << mcmc.GetProposeStep().GetSuccesses()
-                << "/" << mcmc.GetProposeStep().GetTrials()
-                << " (acc " << mcmc.GetProposeStep().GetAcceptance()
-                << ", sig " << mcmc.GetProposeStep().GetSigma()
-                << ", rms " << mcmc.GetStepRMS()
-                << ")"
-                << std::endl;
-      }
+      chain_.mcmc->SaveStep(false);
+    });
+    for (auto& chain : chainList_) {
+      // Make a final step and then save it with the covariance information.
+      // These steps can be identified since the covariance is not empty, but
+      // they should be real independent steps.
+      if (chain.mcmc->Step(false)) chain.fillPoint(true);
+      // This is not resetting the "SaveAccepted" size so the step is
+      // actually saved.
+      chain.mcmc->SaveStep(true);
     }
-    // Make a final step and then save it with the covariance information.
-    // These steps can be identified since the covariance is not empty, but
-    // they should be real independent steps.
-    if (mcmc.Step(false)) fillPoint();
-    // This is not resetting the "SaveAccepted" size so the step is actually
-    // saved.
-    mcmc.SaveStep(true);
-    LogInfo << "Chain: " << chain << " complete"
+    LogInfo << "Chain: " << cycle << " complete"
             << " Run Length: " << _steps_
             << " -- Saving state"
             << std::endl;
@@ -924,15 +967,6 @@ void AdaptiveMcmc::minimize() {
   _point_.resize(parameterName.size());
   LogInfo << "Parameters in likelihood: " << _point_.size() << std::endl;
 
-  // Create the output tree for the accepted points.
-  auto *outputTree = new TTree(_outTreeName_.c_str(),
-                               "Tree of accepted points");
-  outputTree->Branch("Points",&_point_);
-  outputTree->Branch("LLHPenalty",&_llhPenalty_);
-  outputTree->Branch("LLHStatistical",&_llhStatistical_);
-  outputTree->Branch("Models",&_saveModel_);
-  outputTree->Branch("ModelUncertainty",&_saveUncertainty_);
-
   getMonitor().stateTitleMonitor = "Running MCMC chain...";
   getMonitor().minimizerTitle = _algorithmName_ + "/" + _proposalName_;
 
@@ -940,14 +974,32 @@ void AdaptiveMcmc::minimize() {
   int nbFitCallOffset = getMonitor().nbEvalLikelihoodCalls;
   LogInfo << "Fit call offset: " << nbFitCallOffset << std::endl;
 
-  // Create the TSimpleMCMC object and call the specific runner.
-  if (_proposalName_ == "adaptive") {
-    sMCMC::TSimpleMCMC<PrivateProxyLikelihood,sMCMC::TProposeAdaptiveStep> mcmc(outputTree);
-    setupAndRunAdaptiveStep(mcmc);
+  if (_nbChains_ > 1) {
+    // Each of the chains is saved in its own tree.
+    runParallelChains();
   }
-  else if (_proposalName_ == "simple") {
-    sMCMC::TSimpleMCMC<PrivateProxyLikelihood,sMCMC::TProposeSimpleStep> mcmc(outputTree);
-    setupAndRunSimpleStep(mcmc);
+  else {
+    // Create the output tree for the accepted points.
+    auto *outputTree = new TTree(_outTreeName_.c_str(),
+                                 "Tree of accepted points");
+    outputTree->Branch("Points",&_point_);
+    outputTree->Branch("LLHPenalty",&_llhPenalty_);
+    outputTree->Branch("LLHStatistical",&_llhStatistical_);
+    outputTree->Branch("Models",&_saveModel_);
+    outputTree->Branch("ModelUncertainty",&_saveUncertainty_);
+
+    // Create the TSimpleMCMC object and call the specific runner.
+    if (_proposalName_ == "adaptive") {
+      sMCMC::TSimpleMCMC<PrivateProxyLikelihood,sMCMC::TProposeAdaptiveStep> mcmc(outputTree);
+      setupAndRunAdaptiveStep(mcmc);
+    }
+    else if (_proposalName_ == "simple") {
+      sMCMC::TSimpleMCMC<PrivateProxyLikelihood,sMCMC::TProposeSimpleStep> mcmc(outputTree);
+      setupAndRunSimpleStep(mcmc);
+    }
+
+    // Save the sampled points to the outputfile
+    outputTree->Write();
   }
 
   int nbMCMCCalls = getMonitor().nbEvalLikelihoodCalls - nbFitCallOffset;
@@ -956,13 +1008,272 @@ void AdaptiveMcmc::minimize() {
   LogInfo << getMonitor().convergenceMonitor.generateMonitorString();
   LogInfo << "MCMC ended after " << nbMCMCCalls << " calls." << std::endl;
 
-  // Save the sampled points to the outputfile
-  outputTree->Write();
-
   // success
   setMinimizerStatus(0);
 }
 
+void AdaptiveMcmc::runParallelChains() {
+  LogThrowIf(_proposalName_ != "adaptive",
+             "Parallel chains are only available with the adaptive proposal.");
+  LogThrowIf(not PropagatorWorker::isSupported(getPropagator()),
+             "Some dials can't be evaluated outside of the propagator: parallel chains are not available.");
+  LogThrowIf(_chainSyncSteps_ < 1, "Invalid chainSyncSteps: " << _chainSyncSteps_);
+
+  std::string restore = _adaptiveRestore_;
+  std::use_facet<std::ctype<std::string::value_type>>(std::locale())
+      .tolower(&restore[0],&restore[0]+restore.size());
+  LogThrowIf(not restore.empty() and restore != "none",
+             "Restoring a previous chain is not supported with parallel chains.");
+
+  LogInfo << "Running " << _nbChains_ << " parallel chains"
+          << (_enableParallelTempering_ ? " with parallel tempering" : "")
+          << std::endl;
+
+  const int nPars = int(getMinimizerFitParameterPtr().size());
+
+  // Everything but the propagation is done while holding the chain mutex.
+  // The main thread only releases it while the chains are stepping.
+  std::unique_lock<std::mutex> mainLock(_chainMutex_);
+
+  std::vector<std::unique_ptr<ParallelChain>> chainList;
+  chainList.reserve(_nbChains_);
+  for (int iChain = 0; iChain < _nbChains_; ++iChain) {
+    chainList.emplace_back(std::make_unique<ParallelChain>(getPropagator()));
+    ParallelChain& chain = *chainList.back();
+    ParallelChain* chainPtr = &chain;
+    chain.lock = &mainLock;
+    if (_enableParallelTempering_) chain.beta = std::pow(_temperatureStep_, -iChain);
+    chain.point.resize(_point_.size());
+
+    std::string treeName = _outTreeName_ + "_chain" + std::to_string(iChain);
+    chain.tree = new TTree(treeName.c_str(), "Tree of accepted points");
+    chain.tree->Branch("Points",&chain.point);
+    chain.tree->Branch("LLHPenalty",&chain.llhPenalty);
+    chain.tree->Branch("LLHStatistical",&chain.llhStatistical);
+    chain.tree->Branch("Models",&chain.saveModel);
+    chain.tree->Branch("ModelUncertainty",&chain.saveUncertainty);
+    chain.tree->Branch("InverseTemperature",&chain.beta);
+
+    chain.mcmc = std::make_unique<AdaptiveStepMCMC>(chain.tree);
+    AdaptiveStepMCMC& mcmc = *chain.mcmc;
+    mcmc.GetProposeStep().SetDim(nPars);
+    mcmc.GetLogLikelihood().functor = std::make_unique<ROOT::Math::Functor>(
+        [this, chainPtr](const double* parArray_){ return evalChainLikelihood(*chainPtr, parArray_); }, nPars);
+    mcmc.GetProposeStep().SetCovarianceUpdateDeweighting(0.0);
+    mcmc.GetProposeStep().SetCovarianceFrozen(false);
+
+    // Same starting point as a single chain.  With a random start, every
+    // chain gets its own point.
+    sMCMC::Vector start;
+    bool startStatus = false;
+    int throttle = 10;
+    do {
+      if (_randomStart_) start = throwRandomStartPoint();
+      else {
+        start.clear();
+        for (const Parameter* par : getMinimizerFitParameterPtr() ) {
+          if (not useNormalizedFitSpace()) start.push_back(par->getParameterValue());
+          else start.push_back(ParameterSet::toNormalizedParValue(par->getParameterValue(), *par));
+        }
+      }
+      startStatus = mcmc.Start(start, false);
+    } while (not startStatus and _randomStart_ and --throttle > 0);
+    LogThrowIf(not startStatus, "The initial point is bad. MCMC chain #" << iChain << " cannot start.");
+
+    // Set the correlations in the default step proposal.
+    if (not adaptiveLoadProposalCovariance(
+        mcmc,start,_adaptiveCovFile_,_adaptiveCovName_)) {
+      adaptiveDefaultProposalCovariance(mcmc,start);
+    }
+
+    // Fill the initial point.
+    fillChainPoint(chain, true);
+
+    mcmc.Start(start, _saveBurnin_);
+    mcmc.GetProposeStep().SetAcceptanceWindow(_adaptiveWindow_);
+    mcmc.SetStepRMSWindow(_adaptiveWindow_);
+  }
+
+  // The handles used by runAdaptiveCycles(), same order as the chains.
+  std::vector<AdaptiveChainHandle> handleList(chainList.size());
+  for (std::size_t iChain = 0; iChain < chainList.size(); ++iChain) {
+    ParallelChain* chainPtr = chainList[iChain].get();
+    handleList[iChain].mcmc = chainPtr->mcmc.get();
+    handleList[iChain].fillPoint = [this, chainPtr](bool fillModel_){ fillChainPoint(*chainPtr, fillModel_); };
+    handleList[iChain].saveModel = [chainPtr](){
+      chainPtr->saveModel = chainPtr->model;
+      chainPtr->saveUncertainty = chainPtr->uncertainty;
+    };
+  }
+
+  GenericToolbox::ParallelWorker chainThreads;
+  chainThreads.setNThreads(_nbChains_);
+
+  // Run nSteps_ steps of every chain (one thread per chain).  The chains are
+  // synchronised every _chainSyncSteps_ steps to exchange the tempered
+  // chains.
+  auto runSteps = [&](const std::string& title_, int nSteps_,
+                      const AdaptiveStepFct& step_) {
+    for (int iFirst = 0; iFirst < nSteps_; iFirst += _chainSyncSteps_) {
+      int iLast = std::min(nSteps_, iFirst + _chainSyncSteps_);
+      auto runChain = [&](std::size_t iChain_) {
+        std::unique_lock<std::mutex> lock(_chainMutex_);
+        chainList[iChain_]->lock = &lock;
+        for (int i = iFirst; i < iLast; ++i) step_(handleList[iChain_], i);
+        chainList[iChain_]->lock = nullptr;
+      };
+
+      mainLock.unlock();
+      chainThreads.runJob([&](int iThread) {
+        if (iThread == -1) { for (std::size_t iChain = 0; iChain < chainList.size(); ++iChain) runChain(iChain); }
+        else runChain(iThread);
+      });
+      mainLock.lock();
+      for (auto& chain : chainList) chain->lock = &mainLock;
+
+      if (_enableParallelTempering_) swapTemperedChains(chainList);
+
+      if ((10*iLast)/nSteps_ == (10*iFirst)/nSteps_) continue;
+      for (std::size_t iChain = 0; iChain < chainList.size(); ++iChain) {
+        const AdaptiveStepMCMC& mcmc = *chainList[iChain]->mcmc;
+        LogInfo << title_ << " chain #" << iChain
+                << " step: " << iLast << "/" << nSteps_ << " "
+                << iLast*100./nSteps_ << "%"
+                << " Trials: "
+                << mcmc.GetProposeStep().GetSuccesses()
+                << "/" << mcmc.GetProposeStep().GetTrials()
+                << " (acc " << mcmc.GetProposeStep().GetAcceptance()
+                << ", sig " << mcmc.GetProposeStep().GetSigma()
+                << ")"
+                << std::endl;
+      }
+    }
+  };
+
+  std::function<void()> shareCovariance{};
+  if (_shareProposalCovariance_) shareCovariance = [&](){ shareProposalCovariance(chainList); };
+
+  runAdaptiveCycles(handleList, true, runSteps, shareCovariance);
+
+  // Save the sampled points to the outputfile
+  for (auto& chain : chainList) chain->tree->Write();
+}
+
+double AdaptiveMcmc::evalChainLikelihood(ParallelChain& chain_, const double* parArray_) {
+  LogThrowIf(chain_.lock == nullptr or not chain_.lock->owns_lock(),
+             "The chain lock must be held to evaluate the likelihood.");
+
+  auto setParameterValues = [&]() {
+    const double* v = parArray_;
+    for( auto* par : getMinimizerFitParameterPtr() ){
+      double val = *(v++);
+      if (useNormalizedFitSpace()) val = ParameterSet::toRealParValue(val,*par);
+      par->setParameterValue(val);
+    }
+  };
+
+  // The worker takes a snapshot of the parameters, with the eigen
+  // decomposition propagated to the original parameters.
+  setParameterValues();
+  chain_.worker.fetchParameterValues();
+  if (not hasValidParameterValues()) return std::numeric_limits<double>::infinity();
+
+  // The reweighting is the only part running concurrently with the other
+  // chains.
+  chain_.lock->unlock();
+  chain_.worker.propagate();
+  chain_.lock->lock();
+
+  // The other chains have moved the parameters in the meantime.
+  setParameterValues();
+  for( auto& parSet : getPropagator().getParametersManager().getParameterSetsList() ){
+    if( parSet.isEnableEigenDecomp() ){ parSet.propagateEigenToOriginal(); }
+  }
+  chain_.worker.exportHistograms();
+  getMonitor().nbEvalLikelihoodCalls++;
+
+  return chain_.beta*getLikelihoodInterface().evalLikelihood();
+}
+void AdaptiveMcmc::fillChainPoint(ParallelChain& chain_, bool fillModel_) {
+  // The propagator holds the state of the last likelihood evaluation of
+  // this chain (the chain lock has not been released since).
+  fillPoint(fillModel_);
+  chain_.point = _point_;
+  chain_.model = _model_;
+  chain_.uncertainty = _uncertainty_;
+  chain_.saveModel = _saveModel_;
+  chain_.saveUncertainty = _saveUncertainty_;
+  chain_.llhStatistical = _llhStatistical_;
+  chain_.llhPenalty = _llhPenalty_;
+}
+void AdaptiveMcmc::shareProposalCovariance(std::vector<std::unique_ptr<ParallelChain>>& chainList_) {
+  // The tempered chains sample broader distributions: their covariance is
+  // scaled to the posterior before being merged, and back afterward.
+  const int dim = chainList_.front()->mcmc->GetProposeStep().GetDim();
+
+  double totalTrials = 0.0;
+  sMCMC::Vector center(dim, 0.0);
+  for (auto& chain : chainList_) {
+    const auto& propose = chain->mcmc->GetProposeStep();
+    double w = propose.GetCovarianceTrials();
+    totalTrials += w;
+    for (int i = 0; i < dim; ++i) center[i] += w*propose.GetEstimatedCenter()[i];
+  }
+  if (totalTrials <= 0.0) return;
+  for (int i = 0; i < dim; ++i) center[i] /= totalTrials;
+
+  // Total covariance: mean of the chain covariances plus the spread of the
+  // chain centers.
+  TMatrixD covariance(dim, dim);
+  for (auto& chain : chainList_) {
+    const auto& propose = chain->mcmc->GetProposeStep();
+    double w = chain->beta*propose.GetCovarianceTrials()/totalTrials;
+    const sMCMC::Vector& chainCenter = propose.GetEstimatedCenter();
+    for (int i = 0; i < dim; ++i) {
+      for (int j = 0; j < dim; ++j) {
+        covariance(i,j) += w*(propose.GetCovariance()(i,j)
+                              + (chainCenter[i]-center[i])*(chainCenter[j]-center[j]));
+      }
+    }
+  }
+
+  for (auto& chain : chainList_) {
+    auto& propose = chain->mcmc->GetProposeStep();
+    TMatrixD chainCovariance(covariance);
+    chainCovariance *= 1.0/chain->beta;
+    double trials = std::min(totalTrials, propose.GetCovarianceWindow());
+    propose.SetCovariance(chainCovariance);
+    propose.SetCovarianceTrials(trials);
+    propose.SetEstimatedCenter(center);
+    propose.SetEstimatedCenterTrials(trials);
+  }
+}
+void AdaptiveMcmc::swapTemperedChains(std::vector<std::unique_ptr<ParallelChain>>& chainList_) {
+  // Alternate between the (even, odd) and the (odd, even) neighbours.
+  for (std::size_t iCold = gRandom->Integer(2); iCold+1 < chainList_.size(); iCold += 2) {
+    ParallelChain& cold = *chainList_[iCold];
+    ParallelChain& hot = *chainList_[iCold+1];
+
+    // The chains hold the tempered log likelihood.
+    double coldLlh = cold.mcmc->GetAcceptedLogLikelihood()/cold.beta;
+    double hotLlh = hot.mcmc->GetAcceptedLogLikelihood()/hot.beta;
+    if (not std::isfinite(coldLlh) or not std::isfinite(hotLlh)) continue;
+
+    double logRatio = (cold.beta - hot.beta)*(hotLlh - coldLlh);
+    if (logRatio < std::log(gRandom->Uniform())) continue;
+
+    sMCMC::Vector coldPoint{cold.mcmc->GetAccepted()};
+    cold.mcmc->SetAccepted(hot.mcmc->GetAccepted(), cold.beta*hotLlh);
+    hot.mcmc->SetAccepted(coldPoint, hot.beta*coldLlh);
+
+    std::swap(cold.point, hot.point);
+    std::swap(cold.model, hot.model);
+    std::swap(cold.uncertainty, hot.uncertainty);
+    std::swap(cold.llhStatistical, hot.llhStatistical);
+    std::swap(cold.llhPenalty, hot.llhPenalty);
+  }
+}
+
 double AdaptiveMcmc::evalFitValid(const double* parArray_) {
 
   double value = this->evalFit( parArray_ );
@@ -0,0 +1,195 @@
+//
+// Finite difference hessian evaluated with several PropagatorWorker.
+//
+
+#include "HessianEngine.h"
+#include "ParameterSet.h"
+
+#include "GenericToolbox.Utils.h"
+#include "Logger.h"
+
+#include "TDecompChol.h"
+#include "TMatrixDSymEigen.h"
+
+#include <algorithm>
+#include <cmath>
+
+#ifndef DISABLE_USER_HEADER
+LoggerInit([]{ Logger::setUserHeaderStr("[HessianEngine]"); });
+#endif
+
+
+HessianEngine::HessianEngine(LikelihoodInterface& likelihood_, const std::vector<Parameter*>& parameterList_, bool useNormalizedFitSpace_) :
+    _useNormalizedFitSpace_(useNormalizedFitSpace_),
+    _likelihood_(&likelihood_),
+    _parameterList_(parameterList_){}
+
+bool HessianEngine::evalCovarianceMatrix(const std::vector<double>& bestFit_, const std::vector<double>& stepList_){
+  LogThrowIf( bestFit_.size() != _parameterList_.size() or stepList_.size() != _parameterList_.size(),
+              "Best fit point or step list does not match the number of parameters." );
+
+  _bestFit_ = bestFit_;
+  _nbLikelihoodEvals_ = 0;
+
+  std::vector<int> freeParList;
+  for( int iPar = 0 ; iPar < int(_parameterList_.size()) ; iPar++ ){
+    if( stepList_[iPar] != 0 ){ freeParList.emplace_back( iPar ); }
+  }
+  int nFree{int(freeParList.size())};
+
+  // stencil: best fit, +/- each parameter, then ++ and -- for each pair
+  std::vector<Displacement> displacementList;
+  displacementList.reserve( 1 + 2*nFree + nFree*(nFree-1) );
+  displacementList.emplace_back();
+  for( int iPar : freeParList ){
+    displacementList.push_back( {iPar, +stepList_[iPar]} );
+    displacementList.push_back( {iPar, -stepList_[iPar]} );
+  }
+  for( int i = 0 ; i < nFree ; i++ ){
+    for( int j = i+1 ; j < nFree ; j++ ){
+      int iPar{freeParList[i]}; int jPar{freeParList[j]};
+      displacementList.push_back( {iPar, +stepList_[iPar], jPar, +stepList_[jPar]} );
+      displacementList.push_back( {iPar, -stepList_[iPar], jPar, -stepList_[jPar]} );
+    }
+  }
+
+  // one worker per thread, but no more than needed
+  int nbWorkers{std::max(1, std::min(_nbWorkers_, int(displacementList.size())))};
+  LogInfo << "Evaluating " << displacementList.size() << " points of the hessian stencil with "
+          << nbWorkers << " parallel propagator workers..." << std::endl;
+
+  this->setParameterValues( displacementList.front() );
+  auto& propagator = _likelihood_->getDataSetManager().getPropagator();
+  _workerList_.clear();
+  _workerList_.reserve( nbWorkers );
+  for( int iWorker = 0 ; iWorker < nbWorkers ; iWorker++ ){ _workerList_.emplace_back( propagator ); }
+  _threadPool_ = GenericToolbox::ParallelWorker();
+  _threadPool_.setNThreads( nbWorkers );
+
+  std::vector<double> llhList;
+  this->evalLikelihoods( displacementList, llhList );
+
+  // release the memory of the workers
+  _workerList_.clear();
+  _workerList_.shrink_to_fit();
+
+  _covarianceMatrix_.ResizeTo( int(_parameterList_.size()), int(_parameterList_.size()) );
+  _covarianceMatrix_.Zero();
+
+  if( std::any_of(llhList.begin(), llhList.end(), [](double llh_){ return not std::isfinite(llh_); }) ){
+    LogError << "Invalid likelihood value found while evaluating the hessian." << std::endl;
+    _hesseStatus_ = 1;
+    _covMatrixStatus_ = 0;
+    return false;
+  }
+
+  // the llh list is in the same order as the displacement list
+  double llhBestFit{llhList[0]};
+  auto llhPlus  = [&](int i_){ return llhList[1 + 2*i_]; };
+  auto llhMinus = [&](int i_){ return llhList[2 + 2*i_]; };
+
+  TMatrixDSym hessian(nFree);
+  size_t iPoint{1 + 2*size_t(nFree)};
+  for( int i = 0 ; i < nFree ; i++ ){
+    double hi{stepList_[freeParList[i]]};
+    hessian[i][i] = (llhPlus(i) - 2*llhBestFit + llhMinus(i)) / (hi*hi);
+
+    for( int j = i+1 ; j < nFree ; j++ ){
+      double hj{stepList_[freeParList[j]]};
+      double llhPlusPlus{llhList[iPoint++]};
+      double llhMinusMinus{llhList[iPoint++]};
+      hessian[i][j] = ( llhPlusPlus + llhMinusMinus
+                        - llhPlus(i) - llhMinus(i) - llhPlus(j) - llhMinus(j)
+                        + 2*llhBestFit ) / (2*hi*hj);
+      hessian[j][i] = hessian[i][j];
+    }
+  }
+
+  _hesseStatus_ = 0;
+  _covMatrixStatus_ = 3;
+
+  TDecompChol choleskyDecomp(hessian);
+  if( not choleskyDecomp.Decompose() ){
+    LogAlert << "The hessian is not positive definite. Forcing it..." << std::endl;
+    _hesseStatus_ = 3;
+    _covMatrixStatus_ = 2;
+
+    // same eigen vectors, with eigen values bounded from below
+    TMatrixDSymEigen eigenDecomp(hessian);
+    auto eigenValues = eigenDecomp.GetEigenValues();
+    double minEigenValue{1E-8 * std::abs(eigenValues.Max())};
+    for( int iEigen = 0 ; iEigen < eigenValues.GetNrows() ; iEigen++ ){
+      eigenValues[iEigen] = std::max(eigenValues[iEigen], minEigenValue);
+    }
+    auto& eigenVectors = eigenDecomp.GetEigenVectors();
+    for( int i = 0 ; i < nFree ; i++ ){
+      for( int j = 0 ; j < nFree ; j++ ){
+        hessian[i][j] = 0;
+        for( int iEigen = 0 ; iEigen < nFree ; iEigen++ ){
+          hessian[i][j] += eigenVectors[i][iEigen] * eigenValues[iEigen] * eigenVectors[j][iEigen];
+        }
+      }
+    }
+  }
+
+  double determinant{0};
+  hessian.Invert( &determinant );
+  if( determinant == 0 or not std::isfinite(determinant) ){
+    LogError << "Could not invert the hessian." << std::endl;
+    _hesseStatus_ = 2;
+    _covMatrixStatus_ = 0;
+    return false;
+  }
+
+  // -2 log(L): the covariance is (H/2)^-1
+  for( int i = 0 ; i < nFree ; i++ ){
+    for( int j = 0 ; j < nFree ; j++ ){
+      _covarianceMatrix_[freeParList[i]][freeParList[j]] = 2 * hessian[i][j];
+    }
+  }
+
+  return true;
+}
+
+void HessianEngine::setParameterValues(const Displacement& displacement_){
+  for( size_t iPar = 0 ; iPar < _parameterList_.size() ; iPar++ ){
+    double value{_bestFit_[iPar]};
+    if( int(iPar) == displacement_.iPar ){ value += displacement_.iStep; }
+    if( int(iPar) == displacement_.jPar ){ value += displacement_.jStep; }
+    if( _useNormalizedFitSpace_ ){ value = ParameterSet::toRealParValue(value, *_parameterList_[iPar]); }
+    _parameterList_[iPar]->setParameterValue( value );
+  }
+}
+void HessianEngine::evalLikelihoods(const std::vector<Displacement>& displacementList_, std::vector<double>& llhList_){
+  llhList_.resize( displacementList_.size() );
+  std::string progressTitle = LogInfo.getPrefixString() + "Evaluating the hessian stencil...";
+
+  for( size_t iFirst = 0 ; iFirst < displacementList_.size() ; iFirst += _workerList_.size() ){
+    size_t nPoints{std::min(_workerList_.size(), displacementList_.size() - iFirst)};
+
+    // the parameter sets are shared: snapshots are taken one after the other
+    for( size_t iWorker = 0 ; iWorker < nPoints ; iWorker++ ){
+      this->setParameterValues( displacementList_[iFirst + iWorker] );
+      _workerList_[iWorker].fetchParameterValues();
+    }
+
+    // the expensive part: reweight and fill the histograms
+    if( _workerList_.size() == 1 ){ _workerList_[0].propagate(); }
+    else{
+      _threadPool_.runJob([&](int iThread){
+        if( iThread == -1 ){ for( size_t iWorker = 0 ; iWorker < nPoints ; iWorker++ ){ _workerList_[iWorker].propagate(); } }
+        else if( size_t(iThread) < nPoints ){ _workerList_[iThread].propagate(); }
+      });
+    }
+
+    // the likelihood is evaluated on the propagator samples and parameter sets
+    for( size_t iWorker = 0 ; iWorker < nPoints ; iWorker++ ){
+      this->setParameterValues( displacementList_[iFirst + iWorker] );
+      _workerList_[iWorker].exportHistograms();
+      llhList_[iFirst + iWorker] = _likelihood_->evalLikelihood();
+      _nbLikelihoodEvals_++;
+    }
+
+    GenericToolbox::displayProgressBar( iFirst + nPoints, displacementList_.size(), progressTitle );
+  }
+}
@@ -4,6 +4,8 @@
 #include "GenericToolbox.Json.h"
 #include "Logger.h"
 
+#include <algorithm>
+
 #ifndef DISABLE_USER_HEADER
 LoggerInit([]{ Logger::setUserHeaderStr("[MinimizerBase]"); });
 #endif
@@ -273,6 +275,37 @@ double MinimizerBase::evalFit( const double* parArray_ ){
   return getLikelihoodInterface().getLastLikelihood();
 }
 
+void MinimizerBase::evalFitGradient( const double* parArray_, double* gradient_ ){
+
+  // Most of the time, the gradient is requested at the point that has just
+  // been evaluated: only propagate if the parameters have changed since.
+  bool isSamePoint{true};
+  const double* v = parArray_;
+  for( auto* par : _minimizerParameterPtrList_ ){
+    double val = *(v++);
+    if (_useNormalizedFitSpace_) val = ParameterSet::toRealParValue(val,*par);
+    if( par->getParameterValue() != val ){ isSamePoint = false; break; }
+  }
+  if( not isSamePoint ){ this->evalFit( parArray_ ); }
+
+  _monitor_.externalTimer.stop();
+
+  if( not getLikelihoodInterface().getBuffer().isValid() ){
+    // no meaningful slope to follow
+    std::fill(gradient_, gradient_ + _minimizerParameterPtrList_.size(), 0);
+    _monitor_.externalTimer.start();
+    return;
+  }
+
+  getLikelihoodInterface().evalLikelihoodGradient( _minimizerParameterPtrList_, _gradientBuffer_ );
+  for( size_t iPar = 0 ; iPar < _minimizerParameterPtrList_.size() ; iPar++ ){
+    gradient_[iPar] = _gradientBuffer_[iPar];
+    if( _useNormalizedFitSpace_ ){ gradient_[iPar] *= ParameterSet::toRealParRange(1, *_minimizerParameterPtrList_[iPar]); }
+  }
+
+  _monitor_.externalTimer.start();
+}
+
 void MinimizerBase::printParameters(){
   // This prints the same set of parameters as are in the vector returned by
   // getMinimizerFitParameterPtr(), but does it by parameter set so that the
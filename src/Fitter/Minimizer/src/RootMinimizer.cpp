@@ -4,6 +4,7 @@
 
 #include "LikelihoodInterface.h"
 #include "RootMinimizer.h"
+#include "HessianEngine.h"
 #include "FitterEngine.h"
 #include "GenericToolbox.Json.h"
 #include "GundamGlobals.h"
@@ -48,11 +49,15 @@ void RootMinimizer::readConfigImpl(){
 
   _errorAlgo_ = GenericToolbox::Json::fetchValue(_config_, {{"errorsAlgo"}, {"errors"}}, "Hesse");
   _restoreStepSizeBeforeHesse_ = GenericToolbox::Json::fetchValue(_config_, "restoreStepSizeBeforeHesse", _restoreStepSizeBeforeHesse_);
+  _enableParallelHesse_ = GenericToolbox::Json::fetchValue(_config_, "enableParallelHesse", _enableParallelHesse_);
+  _parallelHesseNbWorkers_ = GenericToolbox::Json::fetchValue(_config_, "parallelHesseNbWorkers", _parallelHesseNbWorkers_);
+  _parallelHesseStepFraction_ = GenericToolbox::Json::fetchValue(_config_, "parallelHesseStepFraction", _parallelHesseStepFraction_);
 
   _generatedPostFitParBreakdown_ = GenericToolbox::Json::fetchValue(_config_, "generatedPostFitParBreakdown", _generatedPostFitParBreakdown_);
   _generatedPostFitEigenBreakdown_ = GenericToolbox::Json::fetchValue(_config_, "generatedPostFitEigenBreakdown", _generatedPostFitEigenBreakdown_);
 
   _stepSizeScaling_ = GenericToolbox::Json::fetchValue(_config_, "stepSizeScaling", _stepSizeScaling_);
+  _useAnalyticGradient_ = GenericToolbox::Json::fetchValue(_config_, "useAnalyticGradient", _useAnalyticGradient_);
 
   LogWarning << "RootMinimizer configured." << std::endl;
 }
@@ -73,7 +78,18 @@ void RootMinimizer::initializeImpl(){
   }
 
   _functor_ = ROOT::Math::Functor(this, &RootMinimizer::evalFit, getMinimizerFitParameterPtr().size());
-  _rootMinimizer_->SetFunction( _functor_ );
+  if( _useAnalyticGradient_ and not getLikelihoodInterface().isAnalyticGradientAvailable() ){
+    LogAlert << "Analytic gradient requested but not available for this likelihood or these dials. "
+             << "The minimizer will evaluate the gradient numerically." << std::endl;
+    _useAnalyticGradient_ = false;
+  }
+  if( _useAnalyticGradient_ ){
+    LogInfo << "Providing the analytic gradient of the likelihood to the minimizer." << std::endl;
+    _rootMinimizer_->SetFunction( _gradientFunctor_ );
+  }
+  else{
+    _rootMinimizer_->SetFunction( _functor_ );
+  }
   _rootMinimizer_->SetStrategy(_strategy_);
   _rootMinimizer_->SetPrintLevel(_printLevel_);
   _rootMinimizer_->SetTolerance(_tolerance_);
@@ -120,6 +136,20 @@ void RootMinimizer::initializeImpl(){
   LogWarning << "RootMinimizer initialized." << std::endl;
 }
 
+void RootMinimizer::updateStartingPoint(){
+  for( std::size_t iFitPar = 0 ; iFitPar < getMinimizerFitParameterPtr().size() ; iFitPar++ ){
+    auto& fitPar = *(getMinimizerFitParameterPtr()[iFitPar]);
+    if( not useNormalizedFitSpace() ){
+      _rootMinimizer_->SetVariableValue(iFitPar, fitPar.getParameterValue());
+      _rootMinimizer_->SetVariableStepSize(iFitPar, fitPar.getStepSize() * _stepSizeScaling_);
+    }
+    else{
+      _rootMinimizer_->SetVariableValue(iFitPar, ParameterSet::toNormalizedParValue(fitPar.getParameterValue(), fitPar));
+      _rootMinimizer_->SetVariableStepSize(iFitPar, ParameterSet::toNormalizedParRange(fitPar.getStepSize() * _stepSizeScaling_, fitPar));
+    }
+  }
+}
+
 void RootMinimizer::dumpFitParameterSettings() {
   for( std::size_t iFitPar = 0 ;
        iFitPar < getMinimizerFitParameterPtr().size() ; ++iFitPar ) {
@@ -390,13 +420,47 @@ void RootMinimizer::calcErrors(){
     getMonitor().minimizerTitle = _minimizerType_ + "/" + _errorAlgo_;
     getMonitor().stateTitleMonitor = "Running HESSE...";
 
-    getMonitor().isEnabled = true;
-    _fitHasConverged_ = _rootMinimizer_->Hesse();
-    getMonitor().isEnabled = false;
+    bool useParallelHesse{_enableParallelHesse_};
+    if( useParallelHesse and not PropagatorWorker::isSupported(getPropagator()) ){
+      LogAlert << "Some dials can't be evaluated by parallel propagator workers. Using the minimizer HESSE instead." << std::endl;
+      useParallelHesse = false;
+    }
 
-    LogInfo << "Hesse ended after " << getMonitor().nbEvalLikelihoodCalls - nbFitCallOffset << " calls." << std::endl;
-    LogWarning << "HESSE status code: " << GundamUtils::hesseStatusCodeStr.at(_rootMinimizer_->Status()) << std::endl;
-    LogWarning << "Covariance matrix status code: " << GundamUtils::covMatrixStatusCodeStr.at(_rootMinimizer_->CovMatrixStatus()) << std::endl;
+    int hesseStatus;
+    int covStatus;
+    std::unique_ptr<HessianEngine> hessianEngine{nullptr};
+    if( useParallelHesse ){
+      // steps: a fraction of the errors estimated by the minimizer
+      std::vector<double> bestFit(_rootMinimizer_->X(), _rootMinimizer_->X() + _rootMinimizer_->NDim());
+      std::vector<double> stepList(_rootMinimizer_->NDim(), 0);
+      for( int iFitPar = 0 ; iFitPar < int(_rootMinimizer_->NDim()) ; iFitPar++ ){
+        if( _rootMinimizer_->IsFixedVariable(iFitPar) ){ continue; }
+        double error{_rootMinimizer_->Errors() != nullptr ? _rootMinimizer_->Errors()[iFitPar] : 0};
+        if( not (error > 0) ){
+          auto& par = *getMinimizerFitParameterPtr()[iFitPar];
+          error = useNormalizedFitSpace() ? ParameterSet::toNormalizedParRange(par.getStepSize(), par) : par.getStepSize();
+        }
+        stepList[iFitPar] = _parallelHesseStepFraction_ * error;
+      }
+
+      hessianEngine = std::make_unique<HessianEngine>( getLikelihoodInterface(), getMinimizerFitParameterPtr(), useNormalizedFitSpace() );
+      hessianEngine->setNbWorkers( _parallelHesseNbWorkers_ > 0 ? _parallelHesseNbWorkers_ : GundamGlobals::getNumberOfThreads() );
+      _fitHasConverged_ = hessianEngine->evalCovarianceMatrix( bestFit, stepList );
+      hesseStatus = hessianEngine->getHesseStatus();
+      covStatus = hessianEngine->getCovMatrixStatus();
+      LogInfo << "Hesse ended after " << hessianEngine->getNbLikelihoodEvals() << " calls." << std::endl;
+    }
+    else{
+      getMonitor().isEnabled = true;
+      _fitHasConverged_ = _rootMinimizer_->Hesse();
+      getMonitor().isEnabled = false;
+      hesseStatus = _rootMinimizer_->Status();
+      covStatus = _rootMinimizer_->CovMatrixStatus();
+      LogInfo << "Hesse ended after " << getMonitor().nbEvalLikelihoodCalls - nbFitCallOffset << " calls." << std::endl;
+    }
+
+    LogWarning << "HESSE status code: " << GundamUtils::hesseStatusCodeStr.at(hesseStatus) << std::endl;
+    LogWarning << "Covariance matrix status code: " << GundamUtils::covMatrixStatusCodeStr.at(covStatus) << std::endl;
 
     // Make sure we are on the right spot
     updateCacheToBestfitPoint();
@@ -410,8 +474,6 @@ void RootMinimizer::calcErrors(){
       LogInfo << getMonitor().convergenceMonitor.generateMonitorString(); // lasting printout
     }
 
-    int covStatus = _rootMinimizer_->CovMatrixStatus();
-
     auto hesseStats = std::make_unique<TTree>("hesseStats", "hesseStats");
     hesseStats->SetDirectory(nullptr);
     hesseStats->Branch("hesseSuccess", &_fitHasConverged_);
@@ -421,7 +483,10 @@ void RootMinimizer::calcErrors(){
     GenericToolbox::mkdirTFile( getOwner().getSaveDir(), "postFit")->WriteObject(hesseStats.get(), hesseStats->GetName());
 
     LogInfo << "Writing HESSE post-fit errors" << std::endl;
-    this->writePostFitData(GenericToolbox::mkdirTFile(getOwner().getSaveDir(), "postFit/Hesse"));
+    this->writePostFitData(
+        GenericToolbox::mkdirTFile(getOwner().getSaveDir(), "postFit/Hesse"),
+        hessianEngine != nullptr ? &hessianEngine->getCovarianceMatrix() : nullptr
+    );
     GenericToolbox::triggerTFileWrite(GenericToolbox::mkdirTFile(getOwner().getSaveDir(), "postFit/Hesse"));
   }
   else{
@@ -492,7 +557,7 @@ void RootMinimizer::saveMinimizerSettings( TDirectory* saveDir_) const {
 }
 
 // protected
-void RootMinimizer::writePostFitData( TDirectory* saveDir_) {
+void RootMinimizer::writePostFitData( TDirectory* saveDir_, const TMatrixDSym* covarianceMatrix_) {
   LogInfo << __METHOD_NAME__ << std::endl;
   LogThrowIf(not isInitialized(), "not initialized");
   LogThrowIf(saveDir_==nullptr, "Save dir not specified");
@@ -501,7 +566,8 @@ void RootMinimizer::writePostFitData( TDirectory* saveDir_) {
   auto* matricesDir = GenericToolbox::mkdirTFile(saveDir_, "hessian");
 
   TMatrixDSym postfitCovarianceMatrix(int(_rootMinimizer_->NDim()));
-  _rootMinimizer_->GetCovMatrix(postfitCovarianceMatrix.GetMatrixArray());
+  if( covarianceMatrix_ != nullptr ){ postfitCovarianceMatrix = *covarianceMatrix_; }
+  else{ _rootMinimizer_->GetCovMatrix(postfitCovarianceMatrix.GetMatrixArray()); }
 
   std::function<void(TDirectory*)> decomposeCovarianceMatrixFct = [&](TDirectory* outDir_){
 
@@ -111,6 +111,25 @@ public:
 
   void updateDeltaVector() const;
 
+  /// Evaluate the prior penalty term (delta^T * Cinv * delta) of the set and
+  /// store it in the penalty chi2 buffer.  Cinv*delta is cached between calls
+  /// and only the columns of the parameters that moved since the previous
+  /// call are added, so a step of the minimizer changing k parameters costs
+  /// O(k*n) instead of O(n^2).
+  [[nodiscard]] double evalPenaltyChi2() const;
+
+  /// Derivative of the penalty term with respect to one of the effective
+  /// parameters of the set.  Uses the Cinv*delta cached by evalPenaltyChi2(),
+  /// so it must be called after the penalty has been evaluated at the current
+  /// parameter values.
+  [[nodiscard]] double evalPenaltyChi2Derivative(const Parameter& par_) const;
+
+  /// Chain rule from the original parameters to one of the eigen parameters:
+  /// derivativeList_ holds the derivatives with respect to the original
+  /// parameters (indexed as getParameterList()), and the enabled, non-fixed
+  /// originals are V * eigen.
+  [[nodiscard]] double evalEigenDerivative(const Parameter& eigenPar_, const std::vector<double>& derivativeList_) const;
+
   /// Set all of the parameters to their prior values.
   void moveParametersToPrior();
 
@@ -209,7 +228,7 @@ private:
   double _globalParameterMaxValue_{std::nan("unset")};
   std::pair<double, double> _eigenParBounds_{std::nan("unset"), std::nan("unset")};
 
-  double _penaltyChi2Buffer_{std::nan("unset")};
+  mutable double _penaltyChi2Buffer_{std::nan("unset")};
 
   std::vector<JsonType> _enableOnlyParameters_{};
   std::vector<JsonType> _disableParameters_{};
@@ -250,6 +269,15 @@ private:
 
   std::shared_ptr<TVectorD>  _deltaVectorPtr_{nullptr}; // difference from prior
 
+  // Penalty term cache (see evalPenaltyChi2)
+  void resetPenaltyCache() const;
+  mutable std::vector<double> _penaltyInvCovColumns_{};  // Cinv stored column by column
+  mutable std::vector<double> _penaltyDelta_{};          // delta used for the cached product
+  mutable std::vector<double> _penaltyInvCovDelta_{};    // Cinv * delta
+  mutable std::vector<int>    _penaltyStrippedIndexList_{}; // stripped index of each parameter, -1 if not correlated
+  mutable std::vector<std::pair<int, double>> _penaltyStepList_{}; // stripped index and delta step of the moved parameters
+  mutable int _penaltyNbIncrementalUpdates_{0};
+
   std::shared_ptr<TMatrixD> _choleskyMatrix_{nullptr};
   GenericToolbox::CorrelatedVariablesSampler _correlatedVariableThrower_{};
   std::shared_ptr<ParameterThrowerMarkHarz> _markHartzGen_{nullptr};
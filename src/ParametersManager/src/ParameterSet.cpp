@@ -15,6 +15,7 @@
 #include "Logger.h"
 
 #include <memory>
+#include <algorithm>
 
 #ifndef DISABLE_USER_HEADER
 LoggerInit([]{ Logger::setUserHeaderStr("[ParameterSet]"); });
@@ -199,6 +200,7 @@ void ParameterSet::processCovarianceMatrix(){
     }
   }
   _deltaVectorPtr_ = std::make_shared<TVectorD>(_strippedCovarianceMatrix_->GetNrows());
+  _penaltyInvCovColumns_.clear(); // rebuilt from the new inverse on the next penalty evaluation
 
   LogThrowIf(not _strippedCovarianceMatrix_->IsSymmetric(), "Covariance matrix is not symmetric");
 
@@ -378,6 +380,111 @@ void ParameterSet::updateDeltaVector() const{
   }
 }
 
+double ParameterSet::evalPenaltyChi2() const{
+  _penaltyChi2Buffer_ = 0;
+  if( _priorCovarianceMatrix_ == nullptr ){ return _penaltyChi2Buffer_; }
+
+  if( isEnableEigenDecomp() ){
+    // the eigen parameters are not correlated
+    for( const auto& eigenPar : _eigenParameterList_ ){
+      if( eigenPar.isFixed() ){ continue; }
+      _penaltyChi2Buffer_ += TMath::Sq( (eigenPar.getParameterValue() - eigenPar.getPriorValue()) / eigenPar.getStdDevValue() );
+    }
+    return _penaltyChi2Buffer_;
+  }
+
+  if( _penaltyInvCovColumns_.empty() ){ this->resetPenaltyCache(); }
+  auto nStripped = _penaltyDelta_.size();
+
+  // look for the parameters that moved since the last call
+  _penaltyStepList_.clear();
+  for( size_t iPar = 0 ; iPar < _parameterList_.size() ; iPar++ ){
+    int iStripped = _penaltyStrippedIndexList_[iPar];
+    if( iStripped == -1 ){ continue; }
+    double delta = _parameterList_[iPar].getParameterValue() - _parameterList_[iPar].getPriorValue();
+    if( delta == _penaltyDelta_[iStripped] ){ continue; }
+    _penaltyStepList_.emplace_back( iStripped, delta - _penaltyDelta_[iStripped] );
+    _penaltyDelta_[iStripped] = delta;
+  }
+
+  if( not _penaltyStepList_.empty() ){
+    // the incremental updates accumulate rounding errors: recompute from scratch every now and then
+    static const int nbMaxIncrementalUpdates{100};
+    if( 2*_penaltyStepList_.size() > nStripped or ++_penaltyNbIncrementalUpdates_ > nbMaxIncrementalUpdates ){
+      std::fill( _penaltyInvCovDelta_.begin(), _penaltyInvCovDelta_.end(), 0 );
+      _penaltyStepList_.clear();
+      for( size_t kStripped = 0 ; kStripped < nStripped ; kStripped++ ){
+        if( _penaltyDelta_[kStripped] == 0 ){ continue; }
+        _penaltyStepList_.emplace_back( kStripped, _penaltyDelta_[kStripped] );
+      }
+      _penaltyNbIncrementalUpdates_ = 0;
+    }
+
+    // Cinv*delta += step_k * (column k of Cinv)
+    for( auto& step : _penaltyStepList_ ){
+      const double* column{&_penaltyInvCovColumns_[step.first * nStripped]};
+      double* out{_penaltyInvCovDelta_.data()};
+      for( size_t iStripped = 0 ; iStripped < nStripped ; iStripped++ ){ out[iStripped] += step.second * column[iStripped]; }
+    }
+  }
+
+  for( size_t iStripped = 0 ; iStripped < nStripped ; iStripped++ ){
+    _penaltyChi2Buffer_ += _penaltyDelta_[iStripped] * _penaltyInvCovDelta_[iStripped];
+  }
+  return _penaltyChi2Buffer_;
+}
+double ParameterSet::evalPenaltyChi2Derivative(const Parameter& par_) const{
+  if( _priorCovarianceMatrix_ == nullptr ){ return 0; }
+  if( not ParameterSet::isValidCorrelatedParameter(par_) ){ return 0; }
+
+  if( isEnableEigenDecomp() ){
+    LogThrowIf(not par_.isEigen(), "Penalty derivative requested for " << par_.getFullTitle() << " while the eigen parameters are used.");
+    return 2 * (par_.getParameterValue() - par_.getPriorValue()) / TMath::Sq(par_.getStdDevValue());
+  }
+
+  LogThrowIf(_penaltyInvCovColumns_.empty(), "evalPenaltyChi2() should be called before evalPenaltyChi2Derivative().");
+  int iStripped = _penaltyStrippedIndexList_[par_.getParameterIndex()];
+  if( iStripped == -1 ){ return 0; }
+
+  // Cinv is symmetric: d(delta^T * Cinv * delta)/d(delta) = 2 * Cinv * delta
+  return 2 * _penaltyInvCovDelta_[iStripped];
+}
+double ParameterSet::evalEigenDerivative(const Parameter& eigenPar_, const std::vector<double>& derivativeList_) const{
+  LogThrowIf(not eigenPar_.isEigen() or eigenPar_.getOwner() != this, eigenPar_.getFullTitle() << " is not an eigen parameter of " << getName());
+  LogThrowIf(derivativeList_.size() != _parameterList_.size(), "Derivative list size mismatch: " << derivativeList_.size() << " / " << _parameterList_.size());
+
+  double out{0};
+  int iOrig{0};
+  for( const auto& par : _parameterList_ ){
+    if( par.isFixed() or not par.isEnabled() ){ continue; }
+    out += (*_eigenVectors_)[iOrig++][eigenPar_.getParameterIndex()] * derivativeList_[par.getParameterIndex()];
+  }
+  return out;
+}
+void ParameterSet::resetPenaltyCache() const{
+  auto nStripped = size_t(_inverseStrippedCovarianceMatrix_->GetNrows());
+
+  _penaltyStrippedIndexList_.clear();
+  _penaltyStrippedIndexList_.reserve(_parameterList_.size());
+  int iStripped{0};
+  for( const auto& par : _parameterList_ ){
+    _penaltyStrippedIndexList_.emplace_back( ParameterSet::isValidCorrelatedParameter(par) ? iStripped++ : -1 );
+  }
+  LogThrowIf(size_t(iStripped) != nStripped, "Stripped covariance matrix size mismatch: " << nStripped << " / " << iStripped << " correlated parameters.");
+
+  // columns are contiguous so the incremental update runs over contiguous memory
+  _penaltyInvCovColumns_.resize(nStripped * nStripped);
+  for( size_t kStripped = 0 ; kStripped < nStripped ; kStripped++ ){
+    for( size_t jStripped = 0 ; jStripped < nStripped ; jStripped++ ){
+      _penaltyInvCovColumns_[kStripped * nStripped + jStripped] = (*_inverseStrippedCovarianceMatrix_)[int(jStripped)][int(kStripped)];
+    }
+  }
+
+  // delta = 0 -> Cinv*delta = 0
+  _penaltyDelta_.assign(nStripped, 0);
+  _penaltyInvCovDelta_.assign(nStripped, 0);
+  _penaltyNbIncrementalUpdates_ = 0;
+}
 void ParameterSet::setValidity(const std::string& validity) {
   for (Parameter& par : getParameterList()) {
     par.setValidity(validity);
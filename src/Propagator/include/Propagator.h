@@ -36,15 +36,18 @@ public:
   void setIThrow(int iThrow){ _iThrow_ = iThrow; }
   void setLoadAsimovData(bool loadAsimovData){ _loadAsimovData_ = loadAsimovData; }
   void setParameterInjectorConfig(const JsonType &parameterInjector){ _parameterInjectorMc_ = parameterInjector; }
+  void setKeepDoubleBaseWeights(bool keepDoubleBaseWeights_){ _keepDoubleBaseWeights_ = keepDoubleBaseWeights_; }
 
   // Const getters
   [[nodiscard]] bool isThrowAsimovToyParameters() const { return _throwAsimovToyParameters_; }
+  [[nodiscard]] bool isEnableEigenToOrigInPropagate() const { return _enableEigenToOrigInPropagate_; }
   [[nodiscard]] bool isEnableStatThrowInToys() const { return _enableStatThrowInToys_; }
   [[nodiscard]] bool isEnableEventMcThrow() const { return _enableEventMcThrow_; }
   [[nodiscard]] bool isGaussStatThrowInToys() const { return _gaussStatThrowInToys_; }
   [[nodiscard]] bool isLoadAsimovData() const { return _loadAsimovData_; }
   [[nodiscard]] bool isShowEventBreakdown() const { return _showEventBreakdown_; }
   [[nodiscard]] bool isDebugPrintLoadedEvents() const { return _debugPrintLoadedEvents_; }
+  [[nodiscard]] bool isKeepDoubleBaseWeights() const { return _keepDoubleBaseWeights_; }
   [[nodiscard]] int getDebugPrintLoadedEventsNbPerSample() const { return _debugPrintLoadedEventsNbPerSample_; }
   [[nodiscard]] int getIThrow() const { return _iThrow_; }
   [[nodiscard]] const EventDialCache& getEventDialCache() const { return _eventDialCache_; }
@@ -65,8 +68,30 @@ public:
   void buildDialCache();
   void propagateParameters();
   void reweightMcEvents();
+
+  /// Likelihood path: same as propagateParameters() but the weights of the
+  /// grouped events are left behind.  Only the histograms are up-to-date.
+  void propagateParametersToHistograms();
+  /// Copy the reweight of each super-event to the weights of its events.
+  /// Nothing to do if the events are not grouped.
+  void updateGroupedEventWeights();
   void clearContent();
 
+  /// The MC histograms have been modified outside of the propagation: the
+  /// next refill can't be incremental.
+  void invalidateMcHistograms(){ _isMcHistogramOutdated_ = true; }
+
+  // Gradient
+  /// True if every dial of the event cache provides its derivatives.
+  bool isStatGradientAvailable();
+  /// Chain rule from the derivatives of the likelihood with respect to the
+  /// content and the sum of squared weights of each [sample][bin], to the
+  /// derivatives with respect to each [parSet][par] (original parameters).
+  /// The events must have been propagated with the current parameters.
+  void evalStatGradient(const std::vector<std::vector<double>>& contentDerivativeList_,
+                        const std::vector<std::vector<double>>& sumW2DerivativeList_,
+                        std::vector<std::vector<double>>& gradient_);
+
   // Misc
   [[nodiscard]] std::string getSampleBreakdownTableStr() const;
   void printBreakdowns();
@@ -79,10 +104,15 @@ private:
   void initializeThreads();
 
   // multithreading
+  void updateDialResponses(int iThread_);
   void reweightMcEvents(int iThread_);
+  void updateGroupedEventWeights(int iThread_);
   void refillMcHistogramsFct( int iThread_);
+  void updateDialDerivatives(int iThread_);
+  void accumulateGradient(int iThread_);
 
   void updateDialState();
+  void reweightCachedEvents();
   void refillMcHistograms();
 
   // Parameters
@@ -91,6 +121,11 @@ private:
   bool _debugPrintLoadedEvents_{false};
   bool _devSingleThreadReweight_{false};
   bool _devSingleThreadHistFill_{false};
+  bool _enableIncrementalReweight_{true};
+  bool _enableIncrementalHistFill_{true};
+  bool _enableEventGrouping_{false};
+  bool _keepDoubleBaseWeights_{false}; // see SampleElement::getDoubleBaseWeightList()
+  int _incrementalHistFillResumPeriod_{100};
   int _debugPrintLoadedEventsNbPerSample_{5};
   JsonType _parameterInjectorMc_;
   JsonType _parameterInjectorToy_;
@@ -106,6 +141,20 @@ private:
   bool _enableEigenToOrigInPropagate_{true};
   int _iThrow_{-1};
 
+  // Incremental histogram fill
+  bool _isMcHistogramOutdated_{false};
+  bool _isMcHistogramIncrementable_{false};
+  bool _doIncrementalHistFill_{false};
+  size_t _mcExternalEditCount_{0}; // see SampleSet::getMcExternalEditCount()
+
+  // Gradient
+  bool _isDerivativeCacheBuilt_{false};
+  bool _isStatGradientAvailable_{false};
+  std::vector<size_t> _parSetGradientOffsetList_{};
+  std::vector<std::vector<double>> _threadGradientList_{};
+  const std::vector<std::vector<double>>* _contentDerivativeListPtr_{nullptr};
+  const std::vector<std::vector<double>>* _sumW2DerivativeListPtr_{nullptr};
+
   // Sub-layers
   SampleSet _sampleSet_{};
   PlotGenerator _plotGenerator_{};
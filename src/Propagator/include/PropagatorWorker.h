@@ -0,0 +1,79 @@
+//
+// Private copy of the Propagator state, used to propagate several parameter
+// points at the same time.
+//
+
+#ifndef GUNDAM_PROPAGATOR_WORKER_H
+#define GUNDAM_PROPAGATOR_WORKER_H
+
+#include "Propagator.h"
+#include "DialInputBuffer.h"
+
+#include <vector>
+
+
+/// A PropagatorWorker holds its own copy of everything the Propagator
+/// modifies while propagating: the parameter values, the dial input buffers,
+/// the dial responses and the MC histograms.  The events, the dials and the
+/// event dial cache of the Propagator are only read, so several workers can
+/// propagate different parameter points concurrently.  The likelihood is
+/// evaluated on the Propagator samples once the histograms of a worker have
+/// been exported to them.
+class PropagatorWorker {
+
+public:
+  /// With useDoubleBaseWeights_, the events are weighted with the double
+  /// precision copy of their base weight when the loader kept it (see
+  /// SampleElement::getDoubleBaseWeight()).
+  explicit PropagatorWorker(Propagator& propagator_, bool useDoubleBaseWeights_ = false);
+
+  /// True if every dial of the propagator can be evaluated on a private copy
+  /// of its input buffer (tabulated dials can't).
+  [[nodiscard]] static bool isSupported(const Propagator& propagator_);
+
+  /// Take a snapshot of the current parameter values of the propagator.  The
+  /// eigen parameters are propagated to the original ones first, unless the
+  /// propagator has been told not to.  Single thread only.
+  void fetchParameterValues();
+
+  /// Evaluate the dial responses and refill the private histograms with the
+  /// fetched parameter values.  Can run concurrently with other workers.
+  void propagate();
+
+  /// Overwrite the MC histograms of the propagator with the private ones.
+  void exportHistograms();
+
+  /// Exchange the private histograms with the MC histograms of the
+  /// propagator.  Calling it a second time restores both of them exactly, so
+  /// the propagator histograms don't need to be refilled afterward.
+  void swapHistograms();
+
+private:
+  Propagator* _propagator_{nullptr};
+
+  /// [parSet][par] original parameter values
+  std::vector<std::vector<double>> _parameterValueList_{};
+
+  /// Copies of the input buffers of every dial collection, and for each
+  /// response slot of the EventDialCache, the index of its copy
+  std::vector<DialInputBuffer> _inputBufferList_{};
+  std::vector<size_t> _slotInputBufferIndexList_{};
+  std::vector<double> _slotResponseList_{};
+
+  /// [iEntry] base weights of the cache entries, only filled when the double
+  /// precision base weights are used.  The cache ones are used otherwise.
+  std::vector<double> _entryBaseWeightList_{};
+  std::vector<double> _entrySquaredBaseWeightList_{};
+
+  /// [sample][bin] sums of the weights and of the squared weights. The
+  /// events that are not reweighted by any dial are summed once for all.
+  std::vector<std::vector<double>> _staticSumWeightList_{};
+  std::vector<std::vector<double>> _staticSumSquaredWeightList_{};
+  std::vector<std::vector<double>> _sumWeightList_{};
+  std::vector<std::vector<double>> _sumSquaredWeightList_{};
+  std::vector<std::vector<double>> _errorList_{};
+
+};
+
+
+#endif //GUNDAM_PROPAGATOR_WORKER_H
@@ -17,6 +17,7 @@
 
 #include <memory>
 #include <vector>
+#include <algorithm>
 
 #ifndef DISABLE_USER_HEADER
 LoggerInit([]{ Logger::setUserHeaderStr("[Propagator]"); });
@@ -57,8 +58,15 @@ void Propagator::readConfigImpl(){
   _debugPrintLoadedEventsNbPerSample_ = GenericToolbox::Json::fetchValue(_config_, "debugPrintLoadedEventsNbPerSample", _debugPrintLoadedEventsNbPerSample_);
   _devSingleThreadReweight_ = GenericToolbox::Json::fetchValue(_config_, "devSingleThreadReweight", _devSingleThreadReweight_);
   _devSingleThreadHistFill_ = GenericToolbox::Json::fetchValue(_config_, "devSingleThreadHistFill", _devSingleThreadHistFill_);
+  _enableIncrementalReweight_ = GenericToolbox::Json::fetchValue(_config_, "enableIncrementalReweight", _enableIncrementalReweight_);
+  _enableIncrementalHistFill_ = GenericToolbox::Json::fetchValue(_config_, "enableIncrementalHistFill", _enableIncrementalHistFill_);
+  _incrementalHistFillResumPeriod_ = GenericToolbox::Json::fetchValue(_config_, "incrementalHistFillResumPeriod", _incrementalHistFillResumPeriod_);
+  _enableEventGrouping_ = GenericToolbox::Json::fetchValue(_config_, "enableEventGrouping", _enableEventGrouping_);
 
   // EventDialCache parameters
+  _eventDialCache_.setEnableSplineBatchEval( GenericToolbox::Json::fetchValue(_config_, "enableSplineBatchEval", true) );
+  _eventDialCache_.setEnableSharedKnotSplines( GenericToolbox::Json::fetchValue(_config_, "enableSharedKnotSplines", true) );
+  _eventDialCache_.setEnableLocalityOrdering( GenericToolbox::Json::fetchValue(_config_, "enableLocalityEventOrdering", true) );
   if( GenericToolbox::Json::doKeyExist(_config_, "globalEventReweightCap") ){
     _eventDialCache_.getGlobalEventReweightCap().isEnabled = true;
     _eventDialCache_.getGlobalEventReweightCap().maxReweight = GenericToolbox::Json::fetchValue<double>(_config_, "globalEventReweightCap");
@@ -135,7 +143,16 @@ void Propagator::initializeImpl(){
 // Core
 void Propagator::buildDialCache(){
   _eventDialCache_.shrinkIndexedCache();
+
+  if( _enableEventGrouping_ and GundamGlobals::getEnableCacheManager() ){
+    LogAlert << "Event grouping is not supported by the Cache::Manager: disabling it." << std::endl;
+    _enableEventGrouping_ = false;
+  }
+  _eventDialCache_.setEnableEventGrouping( _enableEventGrouping_ );
+  _eventDialCache_.setHistogramResumPeriod( _incrementalHistFillResumPeriod_ );
+
   _eventDialCache_.buildReferenceCache(_sampleSet_, _dialCollectionList_);
+  _isDerivativeCacheBuilt_ = false;
 
   // be extra sure the dial input will request an update
   for( auto& dialCollection : _dialCollectionList_ ){
@@ -145,6 +162,10 @@ void Propagator::buildDialCache(){
   }
 }
 void Propagator::propagateParameters(){
+  this->propagateParametersToHistograms();
+  this->updateGroupedEventWeights();
+}
+void Propagator::propagateParametersToHistograms(){
 
   if( _enableEigenToOrigInPropagate_ ){
     // Only real parameters are propagated on the spectra -> need to convert the eigen to original
@@ -153,7 +174,7 @@ void Propagator::propagateParameters(){
     }
   }
 
-  this->reweightMcEvents();
+  this->reweightCachedEvents();
   this->refillMcHistograms();
 
 }
@@ -168,8 +189,24 @@ void Propagator::updateDialState(){
                 });
 }
 void Propagator::reweightMcEvents() {
+  this->reweightCachedEvents();
+  this->updateGroupedEventWeights();
+}
+void Propagator::updateGroupedEventWeights(){
+  if( not _eventDialCache_.isEventGrouped() ){ return; }
+
+  if( not _devSingleThreadReweight_ ){ _threadPool_.runJob("Propagator::updateGroupedEventWeights"); }
+  else{ this->updateGroupedEventWeights(-1); }
+}
+void Propagator::reweightCachedEvents() {
   reweightTimer.start();
 
+  // the bins and weights written by the MC throws are not deltas of the last fill
+  if( _sampleSet_.getMcExternalEditCount() != _mcExternalEditCount_ ){
+    _mcExternalEditCount_ = _sampleSet_.getMcExternalEditCount();
+    this->invalidateMcHistograms();
+  }
+
   updateDialState();
 
   bool usedGPU{false};
@@ -182,20 +219,46 @@ void Propagator::reweightMcEvents() {
   }
 #endif
   if( not usedGPU ){
+    // only reweight the events depending on the updated dials if possible
+    if( not _enableIncrementalReweight_ ){ _eventDialCache_.requestFullReweight(); }
+
     if( not _devSingleThreadReweight_ ){
+      // all the dial responses need to be up-to-date before the events are reweighted
+      _threadPool_.runJob("Propagator::updateDialResponses");
+      _eventDialCache_.prepareReweight();
       _threadPool_.runJob("Propagator::reweightMcEvents");
     }
-    else{ this->reweightMcEvents(-1); }
+    else{
+      this->updateDialResponses(-1);
+      _eventDialCache_.prepareReweight();
+      this->reweightMcEvents(-1);
+    }
   }
 
+  // the histograms can only be updated with the weight deltas if they were
+  // in sync with the event weights prior to this reweight
+  _isMcHistogramIncrementable_ = not usedGPU and not _isMcHistogramOutdated_ and _eventDialCache_.isIncrementalReweight();
+  _isMcHistogramOutdated_ = true;
+
   reweightTimer.stop();
 }
 void Propagator::refillMcHistograms(){
   refillHistogramTimer.start();
 
+  _doIncrementalHistFill_ = _enableIncrementalHistFill_ and _isMcHistogramIncrementable_
+      and not GundamGlobals::getEnableCacheManager();
+  if( _doIncrementalHistFill_ ){
+    int nThreads{_devSingleThreadHistFill_ ? 1 : std::max(1, _threadPool_.getNbThreads())};
+    _doIncrementalHistFill_ = _eventDialCache_.prepareHistogramUpdate( nThreads );
+  }
+  else{ _eventDialCache_.resetHistogramUpdateCount(); }
+
   if( not _devSingleThreadHistFill_ ){ _threadPool_.runJob("Propagator::refillMcHistograms"); }
   else{ refillMcHistogramsFct(-1); }
 
+  _isMcHistogramOutdated_ = false;
+  _isMcHistogramIncrementable_ = false;
+
   refillHistogramTimer.stop();
 }
 void Propagator::clearContent(){
@@ -214,7 +277,59 @@ void Propagator::clearContent(){
     }
   }
   _eventDialCache_ = EventDialCache();
+  _isDerivativeCacheBuilt_ = false;
+
+}
+bool Propagator::isStatGradientAvailable(){
+  if( _isDerivativeCacheBuilt_ ){ return _isStatGradientAvailable_; }
+
+  _parSetGradientOffsetList_.clear();
+  size_t nPars{0};
+  for( auto& parSet : _parManager_.getParameterSetsList() ){
+    _parSetGradientOffsetList_.emplace_back( nPars );
+    nPars += parSet.getParameterList().size();
+  }
+
+  _isStatGradientAvailable_ = _eventDialCache_.buildDerivativeCache( _parSetGradientOffsetList_ );
+  _isDerivativeCacheBuilt_ = true;
+
+  // one gradient buffer per thread: the events are split among them
+  _threadGradientList_.clear();
+  _threadGradientList_.resize( std::max(1, _threadPool_.getNbThreads()), std::vector<double>(nPars, 0) );
 
+  return _isStatGradientAvailable_;
+}
+void Propagator::evalStatGradient(const std::vector<std::vector<double>>& contentDerivativeList_,
+                                  const std::vector<std::vector<double>>& sumW2DerivativeList_,
+                                  std::vector<std::vector<double>>& gradient_){
+  LogThrowIf( not isStatGradientAvailable(), "The derivatives of the dials are not available." );
+
+  _contentDerivativeListPtr_ = &contentDerivativeList_;
+  _sumW2DerivativeListPtr_ = &sumW2DerivativeList_;
+  for( auto& threadGradient : _threadGradientList_ ){ std::fill(threadGradient.begin(), threadGradient.end(), 0); }
+
+  if( not _devSingleThreadReweight_ ){
+    _threadPool_.runJob("Propagator::updateDialDerivatives");
+    _threadPool_.runJob("Propagator::accumulateGradient");
+  }
+  else{
+    this->updateDialDerivatives(-1);
+    this->accumulateGradient(-1);
+  }
+
+  _contentDerivativeListPtr_ = nullptr;
+  _sumW2DerivativeListPtr_ = nullptr;
+
+  auto& parSetList = _parManager_.getParameterSetsList();
+  gradient_.resize( parSetList.size() );
+  for( size_t iParSet = 0 ; iParSet < parSetList.size() ; iParSet++ ){
+    gradient_[iParSet].assign( parSetList[iParSet].getParameterList().size(), 0 );
+    for( size_t iPar = 0 ; iPar < gradient_[iParSet].size() ; iPar++ ){
+      for( auto& threadGradient : _threadGradientList_ ){
+        gradient_[iParSet][iPar] += threadGradient[_parSetGradientOffsetList_[iParSet] + iPar];
+      }
+    }
+  }
 }
 
 // Misc
@@ -256,14 +371,16 @@ void Propagator::printBreakdowns(){
     };
 
     std::map<const Parameter*, NbEventBreakdown> nbEventForParameter{}; // assuming int = 0 by default
-    for( auto& cache: _eventDialCache_.getCache() ){
-      for( auto& dial : cache.dialResponseCacheList ){
-        for( int iInput = 0 ; iInput < dial.dialInterface.getInputBufferRef()->getInputSize() ; iInput++ ){
-          nbEventForParameter[ &dial.dialInterface.getInputBufferRef()->getParameter(iInput) ].nbTotal += 1;
+    for( size_t iEntry = 0 ; iEntry < _eventDialCache_.getNbEntries() ; iEntry++ ){
+      auto cache = _eventDialCache_.getEntry(iEntry);
+      auto nbEvents = _eventDialCache_.getEntryEventList(iEntry).size(); // > 1 for grouped events
+      for( auto& dialInterface : cache.dialInterfaceList ){
+        for( int iInput = 0 ; iInput < dialInterface.getInputBufferRef()->getInputSize() ; iInput++ ){
+          nbEventForParameter[ &dialInterface.getInputBufferRef()->getParameter(iInput) ].nbTotal += nbEvents;
 
           if( _showNbEventPerSampleParameterBreakdown_ ){
-            nbEventForParameter[ &dial.dialInterface.getInputBufferRef()->getParameter(iInput) ]
-                .nbForSample[cache.event->getIndices().sample] += 1;
+            nbEventForParameter[ &dialInterface.getInputBufferRef()->getParameter(iInput) ]
+                .nbForSample[cache.event->getIndices().sample] += int(nbEvents);
           }
         }
       }
@@ -311,11 +428,11 @@ void Propagator::printBreakdowns(){
 
   if( _debugPrintLoadedEvents_ ){
     LogDebug << "Printing " << _debugPrintLoadedEventsNbPerSample_ << " events..." << std::endl;
-    for( int iEvt = 0 ; iEvt < _debugPrintLoadedEventsNbPerSample_ ; iEvt++ ){
+    for( int iEvt = 0 ; iEvt < _debugPrintLoadedEventsNbPerSample_ and iEvt < int(_eventDialCache_.getNbEntries()) ; iEvt++ ){
       LogDebug << "Event #" << iEvt << "{" << std::endl;
       {
         LogScopeIndent;
-        LogDebug << _eventDialCache_.getCache()[iEvt].getSummary() << std::endl;
+        LogDebug << _eventDialCache_.getEntry(iEvt).getSummary() << std::endl;
       }
       LogDebug << "}" << std::endl;
     }
@@ -328,41 +445,81 @@ void Propagator::initializeThreads() {
   _threadPool_ = GenericToolbox::ParallelWorker();
   _threadPool_.setNThreads( GundamGlobals::getNumberOfThreads() );
 
+  _threadPool_.addJob(
+      "Propagator::updateDialResponses",
+      [this](int iThread){ this->updateDialResponses(iThread); }
+  );
+
   _threadPool_.addJob(
       "Propagator::reweightMcEvents",
       [this](int iThread){ this->reweightMcEvents(iThread); }
   );
 
+  _threadPool_.addJob(
+      "Propagator::updateGroupedEventWeights",
+      [this](int iThread){ this->updateGroupedEventWeights(iThread); }
+  );
+
   _threadPool_.addJob(
       "Propagator::refillMcHistograms",
       [this](int iThread){ this->refillMcHistogramsFct(iThread); }
   );
 
+  _threadPool_.addJob(
+      "Propagator::updateDialDerivatives",
+      [this](int iThread){ this->updateDialDerivatives(iThread); }
+  );
+
+  _threadPool_.addJob(
+      "Propagator::accumulateGradient",
+      [this](int iThread){ this->accumulateGradient(iThread); }
+  );
+
 }
 
 // multithreading
+void Propagator::updateDialResponses(int iThread_) {
+  _eventDialCache_.updateDialResponses( iThread_, _threadPool_.getNbThreads() );
+}
 void Propagator::reweightMcEvents(int iThread_) {
 
   //! Warning: everything you modify here, may significantly slow down the
   //! fitter
 
-  auto bounds = GenericToolbox::ParallelWorker::getThreadBoundIndices(
-      iThread_, _threadPool_.getNbThreads(),
-      int(_eventDialCache_.getCache().size())
-  );
-
-  std::for_each(
-      _eventDialCache_.getCache().begin() + bounds.beginIndex,
-      _eventDialCache_.getCache().begin() + bounds.endIndex,
-      [this]( EventDialCache::CacheEntry& cache_){ _eventDialCache_.reweightEntry(cache_); }
-  );
+  _eventDialCache_.reweightEvents( iThread_, _threadPool_.getNbThreads() );
 
 }
+void Propagator::updateGroupedEventWeights(int iThread_){
+  _eventDialCache_.updateGroupedEventWeights( iThread_, _threadPool_.getNbThreads() );
+}
 void Propagator::refillMcHistogramsFct( int iThread_){
+
+  if( _doIncrementalHistFill_ ){
+    // each bin is handled by one thread only (see refillMcHistograms())
+    _eventDialCache_.updateHistograms( _sampleSet_, iThread_ );
+    return;
+  }
+
+  if( _eventDialCache_.isEventGrouped() ){
+    // the super-events are summed without their individual event weights
+    _eventDialCache_.fillHistograms( _sampleSet_, iThread_, _threadPool_.getNbThreads() );
+    return;
+  }
+
   for( auto& sample : _sampleSet_.getSampleList() ){
     sample.getMcContainer().refillHistogram(iThread_);
   }
 }
+void Propagator::updateDialDerivatives(int iThread_){
+  _eventDialCache_.updateDialDerivatives( iThread_, _threadPool_.getNbThreads() );
+}
+void Propagator::accumulateGradient(int iThread_){
+  _eventDialCache_.accumulateGradient(
+      iThread_, _threadPool_.getNbThreads(),
+      *_contentDerivativeListPtr_, *_sumW2DerivativeListPtr_,
+      _threadGradientList_[std::max(0, iThread_)]
+  );
+}
 
 //  A Lesser GNU Public License
 
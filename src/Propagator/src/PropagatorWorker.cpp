@@ -0,0 +1,173 @@
+//
+// Private copy of the Propagator state, used to propagate several parameter
+// points at the same time.
+//
+
+#include "PropagatorWorker.h"
+
+#include "Logger.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+
+#ifndef DISABLE_USER_HEADER
+LoggerInit([]{ Logger::setUserHeaderStr("[PropagatorWorker]"); });
+#endif
+
+
+PropagatorWorker::PropagatorWorker(Propagator& propagator_, bool useDoubleBaseWeights_) : _propagator_(&propagator_) {
+  LogThrowIf( not isSupported(propagator_), "Some dials can't be evaluated outside of the Propagator." );
+
+  // private copies of the input buffers, and the slot -> copy association
+  std::unordered_map<const DialInputBuffer*, size_t> inputBufferIndexMap;
+  for( auto& dialCollection : _propagator_->getDialCollectionList() ){
+    for( auto& inputBuffer : dialCollection.getDialInputBufferList() ){
+      inputBufferIndexMap[&inputBuffer] = _inputBufferList_.size();
+      _inputBufferList_.emplace_back( inputBuffer );
+    }
+  }
+
+  auto& cache = _propagator_->getEventDialCache();
+  _slotInputBufferIndexList_.reserve( cache.getDialResponseCacheList().size() );
+  for( auto& slot : cache.getDialResponseCacheList() ){
+    auto inputBufferIndex = inputBufferIndexMap.find( slot.dialInterface->getInputBufferRef() );
+    LogThrowIf( inputBufferIndex == inputBufferIndexMap.end(), "Input buffer not found for dial: " << slot.dialInterface->getSummary() );
+    _slotInputBufferIndexList_.emplace_back( inputBufferIndex->second );
+  }
+  _slotResponseList_.resize( _slotInputBufferIndexList_.size() );
+
+  // events that are not in the cache keep their weight whatever the parameters
+  std::unordered_set<const Event*> cachedEventSet;
+  cachedEventSet.reserve( cache.getNbEntries() );
+  for( size_t iEntry = 0 ; iEntry < cache.getNbEntries() ; iEntry++ ){
+    for( auto* eventPtr : cache.getEntryEventList(iEntry) ){ cachedEventSet.insert( eventPtr ); }
+  }
+
+  auto& sampleList = _propagator_->getSampleSet().getSampleList();
+  auto getBaseWeight = [&](const Event& event_){
+    return sampleList[event_.getIndices().sample].getMcContainer().getDoubleBaseWeight( event_ );
+  };
+
+  if( useDoubleBaseWeights_ ){
+    _entryBaseWeightList_.resize( cache.getNbEntries(), 0 );
+    _entrySquaredBaseWeightList_.resize( cache.getNbEntries(), 0 );
+    for( size_t iEntry = 0 ; iEntry < cache.getNbEntries() ; iEntry++ ){
+      for( auto* eventPtr : cache.getEntryEventList(iEntry) ){
+        double weight{getBaseWeight( *eventPtr )};
+        _entryBaseWeightList_[iEntry] += weight;
+        _entrySquaredBaseWeightList_[iEntry] += weight * weight;
+      }
+    }
+  }
+
+  _staticSumWeightList_.resize( sampleList.size() );
+  _staticSumSquaredWeightList_.resize( sampleList.size() );
+  for( size_t iSample = 0 ; iSample < sampleList.size() ; iSample++ ){
+    auto& histogram = sampleList[iSample].getMcContainer().getHistogram();
+    _staticSumWeightList_[iSample].resize( histogram.binList.size(), 0 );
+    _staticSumSquaredWeightList_[iSample].resize( histogram.binList.size(), 0 );
+    for( size_t iBin = 0 ; iBin < histogram.binList.size() ; iBin++ ){
+      for( auto* eventPtr : histogram.getBinEventPtrList( int(iBin) ) ){
+        if( cachedEventSet.find( eventPtr ) != cachedEventSet.end() ){ continue; }
+        double weight{useDoubleBaseWeights_ ? getBaseWeight( *eventPtr ) : double(eventPtr->getEventWeight())};
+        _staticSumWeightList_[iSample][iBin] += weight;
+        _staticSumSquaredWeightList_[iSample][iBin] += weight * weight;
+      }
+    }
+  }
+  _sumWeightList_ = _staticSumWeightList_;
+  _sumSquaredWeightList_ = _staticSumSquaredWeightList_;
+  _errorList_.resize( sampleList.size() );
+  for( size_t iSample = 0 ; iSample < sampleList.size() ; iSample++ ){ _errorList_[iSample].resize( _sumWeightList_[iSample].size(), 0 ); }
+
+  this->fetchParameterValues();
+}
+
+bool PropagatorWorker::isSupported(const Propagator& propagator_){
+  return std::all_of(
+      propagator_.getEventDialCache().getDialResponseCacheList().begin(),
+      propagator_.getEventDialCache().getDialResponseCacheList().end(),
+      [](const EventDialCache::DialResponseCache& slot_){
+        return slot_.dialInterface->getDialBaseRef()->isResponseFromInputs();
+      }
+  );
+}
+
+void PropagatorWorker::fetchParameterValues(){
+  auto& parSetList = _propagator_->getParametersManager().getParameterSetsList();
+  _parameterValueList_.resize( parSetList.size() );
+  for( size_t iParSet = 0 ; iParSet < parSetList.size() ; iParSet++ ){
+    auto& parSet = parSetList[iParSet];
+    if( parSet.isEnableEigenDecomp() and _propagator_->isEnableEigenToOrigInPropagate() ){ parSet.propagateEigenToOriginal(); }
+
+    _parameterValueList_[iParSet].resize( parSet.getParameterList().size() );
+    for( auto& par : parSet.getParameterList() ){
+      _parameterValueList_[iParSet][par.getParameterIndex()] = par.getParameterValue();
+    }
+  }
+}
+
+void PropagatorWorker::propagate(){
+  for( auto& inputBuffer : _inputBufferList_ ){ inputBuffer.update( _parameterValueList_ ); }
+
+  // the dial cache is bypassed: other workers are evaluating the same dials
+  auto& cache = _propagator_->getEventDialCache();
+  auto& slotList = cache.getDialResponseCacheList();
+  for( size_t iSlot = 0 ; iSlot < slotList.size() ; iSlot++ ){
+    auto* dialInterface = slotList[iSlot].dialInterface;
+    _slotResponseList_[iSlot] = DialInterface::evalUncachedResponse(
+        _inputBufferList_[_slotInputBufferIndexList_[iSlot]],
+        dialInterface->getDialBaseRef(), dialInterface->getResponseSupervisorRef()
+    );
+  }
+
+  for( size_t iSample = 0 ; iSample < _sumWeightList_.size() ; iSample++ ){
+    std::copy( _staticSumWeightList_[iSample].begin(), _staticSumWeightList_[iSample].end(), _sumWeightList_[iSample].begin() );
+    std::copy( _staticSumSquaredWeightList_[iSample].begin(), _staticSumSquaredWeightList_[iSample].end(), _sumSquaredWeightList_[iSample].begin() );
+  }
+  for( size_t iEntry = 0 ; iEntry < cache.getNbEntries() ; iEntry++ ){
+    auto& indices = cache.getEntry(iEntry).event->getIndices();
+    if( indices.bin < 0 ){ continue; }
+    // a grouped entry stands for several events sharing the same reweight
+    double reweight{cache.evalEntryReweight( iEntry, _slotResponseList_.data() )};
+    if( _entryBaseWeightList_.empty() ){
+      _sumWeightList_[indices.sample][indices.bin] += cache.getEntryBaseWeight( iEntry ) * reweight;
+      _sumSquaredWeightList_[indices.sample][indices.bin] += cache.getEntrySquaredBaseWeight( iEntry ) * reweight * reweight;
+    }
+    else{
+      _sumWeightList_[indices.sample][indices.bin] += _entryBaseWeightList_[iEntry] * reweight;
+      _sumSquaredWeightList_[indices.sample][indices.bin] += _entrySquaredBaseWeightList_[iEntry] * reweight * reweight;
+    }
+  }
+
+  for( size_t iSample = 0 ; iSample < _sumWeightList_.size() ; iSample++ ){
+    for( size_t iBin = 0 ; iBin < _sumWeightList_[iSample].size() ; iBin++ ){
+      _errorList_[iSample][iBin] = std::sqrt( _sumSquaredWeightList_[iSample][iBin] );
+    }
+  }
+}
+
+void PropagatorWorker::exportHistograms(){
+  auto& sampleList = _propagator_->getSampleSet().getSampleList();
+  for( size_t iSample = 0 ; iSample < sampleList.size() ; iSample++ ){
+    for( size_t iBin = 0 ; iBin < _sumWeightList_[iSample].size() ; iBin++ ){
+      sampleList[iSample].getMcContainer().setBinContent( int(iBin), _sumWeightList_[iSample][iBin], _sumSquaredWeightList_[iSample][iBin] );
+    }
+  }
+  _propagator_->invalidateMcHistograms();
+}
+void PropagatorWorker::swapHistograms(){
+  auto& sampleList = _propagator_->getSampleSet().getSampleList();
+  for( size_t iSample = 0 ; iSample < sampleList.size() ; iSample++ ){
+    auto& binList = sampleList[iSample].getMcContainer().getHistogram().binList;
+    for( size_t iBin = 0 ; iBin < _sumWeightList_[iSample].size() ; iBin++ ){
+      auto& bin = binList[iBin];
+      std::swap( bin.content, _sumWeightList_[iSample][iBin] );
+      std::swap( bin.errorSquared, _sumSquaredWeightList_[iSample][iBin] );
+      std::swap( bin.error, _errorList_[iSample][iBin] );
+    }
+  }
+}
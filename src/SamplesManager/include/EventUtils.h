@@ -7,6 +7,7 @@
 
 #include "DataBin.h"
 #include "DataBinSet.h"
+#include "CompiledFormula.h"
 
 #include "GenericToolbox.Utils.h"
 #include "GenericToolbox.Root.h"
@@ -14,11 +15,21 @@
 #include <RtypesCore.h> // ROOT types
 
 #include <string>
+#include <vector>
+#include <memory>
 #include <iostream>
 
 
 namespace EventUtils{
 
+  /// Storage type of the per-event weights and of the cached dial responses.
+  /// The sums over the events (histograms) are always done in double.
+#ifdef GUNDAM_FLOAT_WEIGHTS
+  typedef float WeightType;
+#else
+  typedef double WeightType;
+#endif
+
   struct Indices{
 
     // source
@@ -34,36 +45,92 @@ namespace EventUtils{
   };
 
   struct Weights{
-    double base{1};
-    double current{1};
+    WeightType base{1};
+    WeightType current{1};
 
     void resetCurrentWeight(){ current = base; }
     [[nodiscard]] std::string getSummary() const;
     friend std::ostream& operator <<( std::ostream& o, const Weights& this_ ){ o << this_.getSummary(); return o; }
   };
 
+  /// Columnar storage of the variables of a list of events.  Each variable
+  /// is held in one contiguous array of its own type, next to a contiguous
+  /// array of its values converted to double.  The events only keep their row
+  /// index, so reading a variable of many events is a strided load instead of
+  /// a lookup in a heap-allocated placeholder per event and per variable.
+  class VariableStore{
+
+  public:
+    struct Column{
+      GenericToolbox::AnyType prototype{}; // only used for its type
+      char typeTag{0}; // ROOT leaf type, 0 if the type can't be converted to double
+      size_t typeSize{0};
+      std::vector<char> dataList{}; // [row*typeSize]
+      std::vector<double> valueList{}; // [row]
+
+      [[nodiscard]] char* getDataPtr(size_t row_){ return &dataList[row_*typeSize]; }
+      [[nodiscard]] const char* getDataPtr(size_t row_) const { return &dataList[row_*typeSize]; }
+      /// Convert the typed value of row_ to double and store it in valueList
+      void updateValue(size_t row_);
+      /// Store value_ in valueList and its conversion in the typed array
+      void setValue(size_t row_, double value_);
+    };
+
+  public:
+    /// The variables are stored as double until setVarType() is called
+    explicit VariableStore(const std::shared_ptr<std::vector<std::string>>& nameListPtr_);
+
+    // setters
+    /// Change the type of a variable.  All the rows are reset.
+    void setVarType(size_t iVar_, const GenericToolbox::AnyType& prototype_);
+
+    // const-getters
+    [[nodiscard]] size_t getNbRows() const{ return _nbRows_; }
+    [[nodiscard]] const std::shared_ptr<std::vector<std::string>>& getNameListPtr() const{ return _nameListPtr_; }
+    [[nodiscard]] const std::vector<Column>& getColumnList() const{ return _columnList_; }
+
+    // mutable-getters
+    std::vector<Column>& getColumnList(){ return _columnList_; }
+
+    // core
+    void resize(size_t nRows_);
+    /// Empty store holding the same variables
+    [[nodiscard]] std::shared_ptr<VariableStore> makeEmptyCopy() const;
+    /// Copy the row srcRow_ of other_ (same variables) in the row row_
+    void copyRow(size_t row_, const VariableStore& other_, size_t srcRow_);
+
+  private:
+    size_t _nbRows_{0};
+    // keep only one list of name in memory -> shared_ptr is used to make sure it gets properly deleted
+    std::shared_ptr<std::vector<std::string>> _nameListPtr_{nullptr};
+    std::vector<Column> _columnList_{};
+
+  };
+
+  /// The variables of one event: a row of a VariableStore.  The store is
+  /// shared by all the events of a sample (and by their copies).
   class Variables{
 
   public:
+    /// View on the value of one variable of one event
     class Variable{
 
     public:
-      Variable() = default;
+      Variable(VariableStore::Column& column_, size_t row_) : _column_(&column_), _row_(row_) {}
 
-      template<typename T>void set(const T& value_){ var = value_; updateCache(); }
+      template<typename T>void set(const T& value_){ _column_->setValue(_row_, double(value_)); }
       void set(const GenericToolbox::LeafForm& leafForm_);
-      [[nodiscard]] const GenericToolbox::AnyType& get() const { return var; }
-      [[nodiscard]] double getVarAsDouble() const { return cache; }
-
-      GenericToolbox::AnyType& get(){ return var; }
+      void setRawData(const void* data_, size_t size_); // same layout as the held type
+      [[nodiscard]] const void* getRawDataPtr() const { return _column_->getDataPtr(_row_); }
+      [[nodiscard]] size_t getRawDataSize() const { return _column_->typeSize; }
+      [[nodiscard]] const GenericToolbox::AnyType& getPrototype() const { return _column_->prototype; }
+      [[nodiscard]] double getVarAsDouble() const { return _column_->valueList[_row_]; }
 
-    protected:
-      // user should not have to worry about the cache
-      void updateCache(){ cache = var.getValueAsDouble(); }
+      void* getRawDataPtr(){ return _column_->getDataPtr(_row_); }
 
     private:
-      GenericToolbox::AnyType var{};
-      double cache{std::nan("unset")};
+      VariableStore::Column* _column_{nullptr};
+      size_t _row_{0};
 
     };
 
@@ -71,23 +138,34 @@ namespace EventUtils{
     Variables() = default;
 
     // setters
+    /// Create a single row store for these variables
     void setVarNameList(const std::shared_ptr<std::vector<std::string>>& nameListPtr_);
+    void setVarType(size_t iVar_, const GenericToolbox::AnyType& prototype_){ _storePtr_->setVarType(iVar_, prototype_); }
+    /// Use the row row_ of storePtr_
+    void setStore(const std::shared_ptr<VariableStore>& storePtr_, size_t row_){ _storePtr_ = storePtr_; _row_ = row_; }
 
     // const-getters
-    [[nodiscard]] const std::shared_ptr<std::vector<std::string>>& getNameListPtr() const{ return _nameListPtr_; }
-    [[nodiscard]] const std::vector<Variable>& getVarList() const{ return _varList_; }
+    [[nodiscard]] size_t getRow() const{ return _row_; }
+    [[nodiscard]] size_t getNbVariables() const{ return _storePtr_ == nullptr ? 0 : _storePtr_->getColumnList().size(); }
+    [[nodiscard]] const std::shared_ptr<VariableStore>& getStorePtr() const{ return _storePtr_; }
+    [[nodiscard]] const std::shared_ptr<std::vector<std::string>>& getNameListPtr() const;
+    [[nodiscard]] const Variable getVariable(size_t iVar_) const{ return {const_cast<VariableStore::Column&>(_storePtr_->getColumnList()[iVar_]), _row_}; }
+    [[nodiscard]] double getVarAsDouble(size_t iVar_) const{ return _storePtr_->getColumnList()[iVar_].valueList[_row_]; }
 
     // mutable-getters
-    std::vector<Variable>& getVarList(){ return _varList_; }
+    Variable getVariable(size_t iVar_){ return {_storePtr_->getColumnList()[iVar_], _row_}; }
 
     // memory
     void allocateMemory( const std::vector<const GenericToolbox::LeafForm*>& leafFormList_);
     void copyData( const std::vector<const GenericToolbox::LeafForm*>& leafFormList_);
+    /// Store of nRows_ rows holding the same variables, each row being a
+    /// copy of this one
+    [[nodiscard]] std::shared_ptr<VariableStore> generateStore(size_t nRows_) const;
 
     // fetch
     [[nodiscard]] int findVarIndex( const std::string& leafName_, bool throwIfNotFound_ = true) const;
-    [[nodiscard]] const Variable& fetchVariable(const std::string& name_) const;
-    Variable& fetchVariable(const std::string& name_);
+    [[nodiscard]] const Variable fetchVariable(const std::string& name_) const;
+    Variable fetchVariable(const std::string& name_);
 
     // bin tools
     [[nodiscard]] bool isInBin(const DataBin& bin_) const;
@@ -96,15 +174,19 @@ namespace EventUtils{
 
     // formula
     [[nodiscard]] double evalFormula(const TFormula* formulaPtr_, std::vector<int>* indexDict_ = nullptr) const;
+    /// The indices of the formula variables are looked up on the first call
+    /// and kept in indexDict_ (valid for the events sharing the same variables)
+    [[nodiscard]] double evalFormula(const CompiledFormula& formula_, std::vector<int>& indexDict_) const;
+    /// Same, with the variable indices already looked up
+    [[nodiscard]] double evalFormula(const CompiledFormula& formula_, const std::vector<int>& indexDict_) const;
 
     // printouts
     [[nodiscard]] std::string getSummary() const;
     friend std::ostream& operator <<( std::ostream& o, const Variables& this_ ){ o << this_.getSummary(); return o; }
 
   private:
-    std::vector<Variable> _varList_{};
-    // keep only one list of name in memory -> shared_ptr is used to make sure it gets properly deleted
-    std::shared_ptr<std::vector<std::string>> _nameListPtr_{nullptr};
+    std::shared_ptr<VariableStore> _storePtr_{nullptr};
+    size_t _row_{0};
 
   };
 
@@ -29,11 +29,30 @@ public:
       int index{-1};
       double content{0};
       double error{0};
+      double errorSquared{0}; // sum of the squared weights, kept for incremental updates
       const DataBin* dataBinPtr{nullptr};
-      std::vector<Event*> eventPtrList{};
+    };
+    /// non-owning view on the events of one bin
+    struct EventPtrRange{
+      Event* const* beginPtr{nullptr};
+      Event* const* endPtr{nullptr};
+      [[nodiscard]] Event* const* begin() const { return beginPtr; }
+      [[nodiscard]] Event* const* end() const { return endPtr; }
+      [[nodiscard]] size_t size() const { return size_t(endPtr - beginPtr); }
+      [[nodiscard]] bool empty() const { return beginPtr == endPtr; }
     };
     std::vector<Bin> binList{};
     int nBins{0};
+
+    // all the binned events sorted by bin: the events of the bin iBin are
+    // eventPtrList[ binOffsetList[iBin] .. binOffsetList[iBin+1] [
+    std::vector<Event*> eventPtrList{};
+    std::vector<size_t> binOffsetList{};
+
+    [[nodiscard]] EventPtrRange getBinEventPtrList(int iBin_) const {
+      if( binOffsetList.empty() ){ return {}; } // bin event list not built yet
+      return { eventPtrList.data() + binOffsetList[iBin_], eventPtrList.data() + binOffsetList[iBin_+1] };
+    }
   };
 
 public:
@@ -45,24 +64,43 @@ public:
   // const-getters
   [[nodiscard]] const std::string& getName() const{ return _name_; }
   [[nodiscard]] const std::vector<Event> &getEventList() const{ return _eventList_; }
+  [[nodiscard]] const std::vector<double> &getDoubleBaseWeightList() const{ return _doubleBaseWeightList_; }
   [[nodiscard]] const Histogram &getHistogram() const{ return _histogram_; }
 
   // mutable-getters
   std::vector<Event> &getEventList(){ return _eventList_; }
+  std::vector<double> &getDoubleBaseWeightList(){ return _doubleBaseWeightList_; }
+  Histogram &getHistogram(){ return _histogram_; }
+
+  /// Base weight of one of the events of this container, in double precision
+  /// if the loader kept a copy of it (only used to validate the float
+  /// weights, see Propagator::isKeepDoubleBaseWeights()).
+  [[nodiscard]] double getDoubleBaseWeight(const Event& event_) const;
 
   // core
   void buildHistogram(const DataBinSet& binning_);
   void reserveEventMemory(size_t dataSetIndex_, size_t nEvents, const Event &eventBuffer_);
   void shrinkEventList(size_t newTotalSize_);
-  void updateBinEventList(int iThread_ = -1);
+  void updateBinEventList();
   void refillHistogram(int iThread_ = -1);
 
+  // propagate the weight change of one event to the content of its bin
+  void updateBinContent(int iBin_, double previousWeight_, double newWeight_);
+
+  // overwrite the content of a bin with externally computed sums
+  void setBinContent(int iBin_, double sumWeights_, double sumSquaredWeights_);
+
   // event by event poisson throw -> takes into account the finite amount of stat in MC
   void throwEventMcError();
 
   // generate a toy experiment -> hist content as the asimov -> throw poisson for each bin
   void throwStatError(bool useGaussThrow_ = false);
 
+  /// Number of times the event weights and the bin contents have been
+  /// overwritten by the throws above.  The incremental reweight and
+  /// histogram updates rely on the previous weights: they must start over.
+  [[nodiscard]] size_t getExternalEditCount() const{ return _externalEditCount_; }
+
   [[nodiscard]] double getSumWeights() const;
   [[nodiscard]] size_t getNbBinnedEvents() const;
   [[nodiscard]] std::shared_ptr<TH1D> generateRootHistogram() const; // for the plot generator or for TFile save
@@ -75,7 +113,9 @@ private:
   std::string _name_{};
   Histogram _histogram_{};
   std::vector<Event> _eventList_{};
+  std::vector<double> _doubleBaseWeightList_{}; // [iEvent], empty unless requested
   std::vector<DatasetProperties> _loadedDatasetList_{};
+  size_t _externalEditCount_{0};
 
 #ifdef GUNDAM_USING_CACHE_MANAGER
 public:
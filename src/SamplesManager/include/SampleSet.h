@@ -40,6 +40,10 @@ public:
   [[nodiscard]] bool empty() const{ return _sampleList_.empty(); }
   [[nodiscard]] std::vector<std::string> fetchRequestedVariablesForIndexing() const;
 
+  /// Sum of SampleElement::getExternalEditCount() over the MC containers:
+  /// changes whenever the MC weights have been thrown.
+  [[nodiscard]] size_t getMcExternalEditCount() const;
+
   // deprecated
   [[deprecated("use getSampleList()")]] std::vector<Sample> &getFitSampleList(){ return getSampleList(); }
   [[deprecated("use getSampleList()")]] [[nodiscard]] const std::vector<Sample> &getFitSampleList() const { return getSampleList(); }
@@ -10,6 +10,9 @@
 #include "Logger.h"
 
 #include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
 
 #ifndef DISABLE_USER_HEADER
 LoggerInit([]{ Logger::getUserHeader() << "[EventUtils]"; });
@@ -40,55 +43,170 @@ namespace EventUtils{
 }
 
 
+/// VariableStore
+namespace EventUtils{
+
+  template<typename T> double decodeValue(const char* data_){ T out; memcpy(&out, data_, sizeof(T)); return double(out); }
+  template<typename T> void encodeValue(char* data_, double value_){ T in(static_cast<T>(value_)); memcpy(data_, &in, sizeof(T)); }
+
+  void VariableStore::Column::updateValue(size_t row_){
+    const char* data{this->getDataPtr(row_)};
+    double& value{valueList[row_]};
+    switch( typeTag ){
+      case 'D': value = decodeValue<double>(data); break;
+      case 'F': value = decodeValue<float>(data); break;
+      case 'I': value = decodeValue<int>(data); break;
+      case 'i': value = decodeValue<unsigned int>(data); break;
+      case 'S': value = decodeValue<short>(data); break;
+      case 's': value = decodeValue<unsigned short>(data); break;
+      case 'L': value = decodeValue<long long>(data); break;
+      case 'l': value = decodeValue<unsigned long long>(data); break;
+      case 'G': value = decodeValue<long>(data); break;
+      case 'g': value = decodeValue<unsigned long>(data); break;
+      case 'B': value = decodeValue<char>(data); break;
+      case 'b': value = decodeValue<unsigned char>(data); break;
+      case 'O': value = decodeValue<bool>(data); break;
+      default: value = std::nan(""); break; // objects: only the raw data is meaningful
+    }
+  }
+  void VariableStore::Column::setValue(size_t row_, double value_){
+    char* data{this->getDataPtr(row_)};
+    switch( typeTag ){
+      case 'D': encodeValue<double>(data, value_); break;
+      case 'F': encodeValue<float>(data, value_); break;
+      case 'I': encodeValue<int>(data, value_); break;
+      case 'i': encodeValue<unsigned int>(data, value_); break;
+      case 'S': encodeValue<short>(data, value_); break;
+      case 's': encodeValue<unsigned short>(data, value_); break;
+      case 'L': encodeValue<long long>(data, value_); break;
+      case 'l': encodeValue<unsigned long long>(data, value_); break;
+      case 'G': encodeValue<long>(data, value_); break;
+      case 'g': encodeValue<unsigned long>(data, value_); break;
+      case 'B': encodeValue<char>(data, value_); break;
+      case 'b': encodeValue<unsigned char>(data, value_); break;
+      case 'O': encodeValue<bool>(data, value_); break;
+      default: LogThrow("Can't set a numerical value to a non-numerical variable (type tag: " << int(typeTag) << ")");
+    }
+    // the exact value is kept, even if the stored type is narrower
+    valueList[row_] = value_;
+  }
+
+  VariableStore::VariableStore(const std::shared_ptr<std::vector<std::string>>& nameListPtr_){
+    LogThrowIf(nameListPtr_ == nullptr, "Invalid commonNameListPtr_ provided.");
+    _nameListPtr_ = nameListPtr_;
+    _columnList_.resize(_nameListPtr_->size());
+    for( size_t iVar = 0 ; iVar < _columnList_.size() ; iVar++ ){ this->setVarType(iVar, GenericToolbox::AnyType(double(0))); }
+  }
+
+  void VariableStore::setVarType(size_t iVar_, const GenericToolbox::AnyType& prototype_){
+    auto& column = _columnList_.at(iVar_);
+    column.prototype = prototype_;
+    column.typeTag = GenericToolbox::findOriginalVariableType(prototype_);
+    if( column.typeTag == char(0xFF) ){ column.typeTag = 0; }
+    column.typeSize = prototype_.getPlaceHolderPtr()->getVariableSize();
+
+    column.dataList.clear();
+    column.valueList.clear();
+    column.dataList.reserve(_nbRows_ * column.typeSize);
+    for( size_t iRow = 0 ; iRow < _nbRows_ ; iRow++ ){
+      auto* src = static_cast<const char*>(prototype_.getPlaceHolderPtr()->getVariableAddress());
+      column.dataList.insert(column.dataList.end(), src, src + column.typeSize);
+    }
+    column.valueList.resize(_nbRows_, std::nan(""));
+    for( size_t iRow = 0 ; iRow < _nbRows_ ; iRow++ ){ column.updateValue(iRow); }
+  }
+
+  void VariableStore::resize(size_t nRows_){
+    _nbRows_ = nRows_;
+    for( auto& column : _columnList_ ){
+      column.dataList.resize(_nbRows_ * column.typeSize, 0);
+      column.valueList.resize(_nbRows_, std::nan(""));
+      column.dataList.shrink_to_fit();
+      column.valueList.shrink_to_fit();
+    }
+  }
+  std::shared_ptr<VariableStore> VariableStore::makeEmptyCopy() const{
+    auto out = std::make_shared<VariableStore>(_nameListPtr_);
+    for( size_t iVar = 0 ; iVar < _columnList_.size() ; iVar++ ){ out->setVarType(iVar, _columnList_[iVar].prototype); }
+    return out;
+  }
+  void VariableStore::copyRow(size_t row_, const VariableStore& other_, size_t srcRow_){
+    for( size_t iVar = 0 ; iVar < _columnList_.size() ; iVar++ ){
+      auto& column = _columnList_[iVar];
+      auto& srcColumn = other_.getColumnList()[iVar];
+      memcpy(column.getDataPtr(row_), srcColumn.getDataPtr(srcRow_), column.typeSize);
+      column.valueList[row_] = srcColumn.valueList[srcRow_];
+    }
+  }
+}
+
+
 /// Variables
 namespace EventUtils{
 
   void Variables::Variable::set(const GenericToolbox::LeafForm& leafForm_){
     if( leafForm_.getTreeFormulaPtr() != nullptr ){ leafForm_.fillLocalBuffer(); }
     memcpy(
-        var.getPlaceHolderPtr()->getVariableAddress(),
-        leafForm_.getDataAddress(), leafForm_.getDataSize()
+        _column_->getDataPtr(_row_),
+        leafForm_.getDataAddress(), std::min(size_t(leafForm_.getDataSize()), _column_->typeSize)
     );
-    updateCache();
+    _column_->updateValue(_row_);
+  }
+  void Variables::Variable::setRawData(const void* data_, size_t size_){
+    LogThrowIf(size_ != _column_->typeSize, "Raw data size mismatch: " << size_);
+    memcpy(_column_->getDataPtr(_row_), data_, size_);
+    _column_->updateValue(_row_);
   }
 
   void Variables::setVarNameList( const std::shared_ptr<std::vector<std::string>> &nameListPtr_ ){
-    LogThrowIf(nameListPtr_ == nullptr, "Invalid commonNameListPtr_ provided.");
-    _nameListPtr_ = nameListPtr_;
-    _varList_.clear();
-    _varList_.resize(_nameListPtr_->size());
+    _storePtr_ = std::make_shared<VariableStore>(nameListPtr_);
+    _storePtr_->resize(1);
+    _row_ = 0;
+  }
+  const std::shared_ptr<std::vector<std::string>>& Variables::getNameListPtr() const{
+    static const std::shared_ptr<std::vector<std::string>> nullNameListPtr{nullptr};
+    if( _storePtr_ == nullptr ){ return nullNameListPtr; }
+    return _storePtr_->getNameListPtr();
   }
 
   // memory
   void Variables::allocateMemory( const std::vector<const GenericToolbox::LeafForm*>& leafFormList_){
-    LogThrowIf( _nameListPtr_ == nullptr, "var name list not set." );
-    LogThrowIf( _nameListPtr_->size() != leafFormList_.size(), "size mismatch." );
+    LogThrowIf( _storePtr_ == nullptr, "var name list not set." );
+    LogThrowIf( this->getNbVariables() != leafFormList_.size(), "size mismatch." );
 
-    auto nLeaf{_nameListPtr_->size()};
+    auto nLeaf{this->getNbVariables()};
     for(size_t iVar = 0 ; iVar < nLeaf ; iVar++ ){
-      _varList_[iVar].set(GenericToolbox::leafToAnyType( leafFormList_[iVar]->getLeafTypeName() ));
+      _storePtr_->setVarType(iVar, GenericToolbox::leafToAnyType( leafFormList_[iVar]->getLeafTypeName() ));
     }
   }
   void Variables::copyData( const std::vector<const GenericToolbox::LeafForm*>& leafFormList_){
     size_t nLeaf{leafFormList_.size()};
     for( size_t iLeaf = 0 ; iLeaf < nLeaf ; iLeaf++ ){
-      _varList_[iLeaf].set( *leafFormList_[iLeaf] );
+      this->getVariable(iLeaf).set( *leafFormList_[iLeaf] );
     }
   }
+  std::shared_ptr<VariableStore> Variables::generateStore(size_t nRows_) const{
+    LogThrowIf( _storePtr_ == nullptr, "var name list not set." );
+    auto out = _storePtr_->makeEmptyCopy();
+    out->resize(nRows_);
+    for( size_t iRow = 0 ; iRow < nRows_ ; iRow++ ){ out->copyRow(iRow, *_storePtr_, _row_); }
+    return out;
+  }
 
   int Variables::findVarIndex( const std::string& leafName_, bool throwIfNotFound_) const{
-    LogThrowIf(_nameListPtr_ == nullptr, "Can't " << __METHOD_NAME__ << " while _commonLeafNameListPtr_ is empty.");
-    int out{GenericToolbox::findElementIndex(leafName_, *_nameListPtr_)};
-    LogThrowIf(throwIfNotFound_ and out == -1, leafName_ << " not found in: " << GenericToolbox::toString(*_nameListPtr_));
+    LogThrowIf(_storePtr_ == nullptr, "Can't " << __METHOD_NAME__ << " while _commonLeafNameListPtr_ is empty.");
+    auto& nameList = *_storePtr_->getNameListPtr();
+    int out{GenericToolbox::findElementIndex(leafName_, nameList)};
+    LogThrowIf(throwIfNotFound_ and out == -1, leafName_ << " not found in: " << GenericToolbox::toString(nameList));
     return out;
   }
-  const Variables::Variable& Variables::fetchVariable(const std::string& name_) const{
+  const Variables::Variable Variables::fetchVariable(const std::string& name_) const{
     int index = this->findVarIndex(name_, true);
-    return _varList_[index];
+    return this->getVariable(index);
   }
-  Variables::Variable& Variables::fetchVariable(const std::string& name_){
+  Variables::Variable Variables::fetchVariable(const std::string& name_){
     int index = this->findVarIndex(name_, true);
-    return _varList_[index];
+    return this->getVariable(index);
   }
 
   // bin tools
@@ -99,7 +217,7 @@ namespace EventUtils{
           return bin_.isBetweenEdges(
               edges_,
               ( edges_.varIndexCache != -1 ?
-                _varList_[edges_.varIndexCache].getVarAsDouble():    // use directly the index if available
+                this->getVarAsDouble(edges_.varIndexCache):            // use directly the index if available
                 this->fetchVariable(edges_.varName).getVarAsDouble() // look for the name otherwise
               )
           );
@@ -117,7 +235,24 @@ namespace EventUtils{
     if ( dialItr == binList_.end() ){ return -1; }
     return int( std::distance( binList_.begin(), dialItr ) );
   }
-  int Variables::findBinIndex( const DataBinSet& binSet_) const{ return this->findBinIndex( binSet_.getBinList() ); }
+  int Variables::findBinIndex( const DataBinSet& binSet_) const{
+    auto* lookupEdgesPtr = binSet_.getLookupEdgesPtr();
+    if( lookupEdgesPtr == nullptr ){ return this->findBinIndex( binSet_.getBinList() ); }
+
+    double value{
+      lookupEdgesPtr->varIndexCache != -1 ?
+      this->getVarAsDouble(lookupEdgesPtr->varIndexCache):
+      this->fetchVariable(lookupEdgesPtr->varName).getVarAsDouble()
+    };
+    // NaN would pass isBetweenEdges: keep the exact same behaviour as the scan
+    if( std::isnan(value) ){ return this->findBinIndex( binSet_.getBinList() ); }
+
+    // only check the bins overlapping with the value (they are sorted by index)
+    for( int iBin : binSet_.getBinCandidateList(value) ){
+      if( this->isInBin( binSet_.getBinList()[iBin] ) ){ return iBin; }
+    }
+    return -1;
+  }
 
   // formula
   double Variables::evalFormula( const TFormula* formulaPtr_, std::vector<int>* indexDict_) const{
@@ -125,20 +260,33 @@ namespace EventUtils{
 
     std::vector<double> parArray(formulaPtr_->GetNpar());
     for( int iPar = 0 ; iPar < formulaPtr_->GetNpar() ; iPar++ ){
-      if(indexDict_ != nullptr){ parArray[iPar] = _varList_[(*indexDict_)[iPar]].getVarAsDouble(); }
+      if(indexDict_ != nullptr){ parArray[iPar] = this->getVarAsDouble((*indexDict_)[iPar]); }
       else                     { parArray[iPar] = this->fetchVariable(formulaPtr_->GetParName(iPar)).getVarAsDouble(); }
     }
 
     return formulaPtr_->EvalPar(nullptr, &parArray[0]);
   }
+  double Variables::evalFormula( const CompiledFormula& formula_, std::vector<int>& indexDict_) const{
+    auto& varNameList = formula_.getVariableNameList();
+    if( indexDict_.size() != varNameList.size() ){
+      indexDict_.clear();
+      for( auto& varName : varNameList ){ indexDict_.emplace_back( this->findVarIndex(varName, true) ); }
+    }
+    return this->evalFormula( formula_, static_cast<const std::vector<int>&>(indexDict_) );
+  }
+  double Variables::evalFormula( const CompiledFormula& formula_, const std::vector<int>& indexDict_) const{
+    double varArray[CompiledFormula::maxNbVariables];
+    for( size_t iVar = 0 ; iVar < indexDict_.size() ; iVar++ ){ varArray[iVar] = this->getVarAsDouble(indexDict_[iVar]); }
+    return formula_.eval(varArray);
+  }
 
   // printout
   std::string Variables::getSummary() const{
     std::stringstream ss;
-    for( int iVar = 0 ; iVar < int(_varList_.size()) ; iVar++ ){
+    for( int iVar = 0 ; iVar < int(this->getNbVariables()) ; iVar++ ){
       if( not ss.str().empty() ){ ss << std::endl; }
-      ss << "  { name: " << _nameListPtr_->at(iVar);
-      ss << ", value: " << _varList_.at(iVar).get();
+      ss << "  { name: " << this->getNameListPtr()->at(iVar);
+      ss << ", value: " << this->getVarAsDouble(iVar);
       ss << " }";
     }
     return ss.str();
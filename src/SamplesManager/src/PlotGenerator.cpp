@@ -676,7 +676,7 @@ void PlotGenerator::defineHistogramHolders() {
       for( auto& event : samplePtr->getMcContainer().getEventList() ){
         for( auto& entry : splitVarsDictionary.entryList ){
           if( entry.name.empty() ){ continue; }
-          auto splitValue = int( event.getVariables().getVarList()[event.getVariables().findVarIndex( entry.name )].getVarAsDouble() );
+          auto splitValue = int( event.getVariables().getVarAsDouble( event.getVariables().findVarIndex( entry.name ) ) );
           GenericToolbox::addIfNotInVector(splitValue, entry.fetchSample( samplePtr ).splitValueList);
         } // splitVarList
       } // Event
@@ -940,7 +940,7 @@ void PlotGenerator::buildEventBinCache( const std::vector<HistHolder *> &histPtr
         for( const auto& event : *eventListPtr ){
           int splitValue;
           if( not histPtr->splitVarName.empty() ){
-            splitValue = event.getVariables().fetchVariable(histPtr->splitVarName).get().getValue<int>();
+            splitValue = int( event.getVariables().fetchVariable(histPtr->splitVarName).getVarAsDouble() );
           }
 
           if( histPtr->splitVarName.empty() or splitValue == histPtr->splitVarValue){
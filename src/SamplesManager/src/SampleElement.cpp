@@ -11,6 +11,7 @@
 
 #include "TRandom.h"
 
+#include <algorithm>
 #include <sstream>
 #include <cmath>
 
@@ -46,6 +47,13 @@ void SampleElement::reserveEventMemory(size_t dataSetIndex_, size_t nEvents, con
           << ")" << std::endl;
 
   _eventList_.resize(datasetProperties.eventOffSet + datasetProperties.eventNb, eventBuffer_);
+
+  // the variables of the new events are stored in contiguous columns
+  if( eventBuffer_.getVariables().getStorePtr() == nullptr ){ return; }
+  auto storePtr = eventBuffer_.getVariables().generateStore( nEvents );
+  for( size_t iEvent = 0 ; iEvent < nEvents ; iEvent++ ){
+    _eventList_[datasetProperties.eventOffSet + iEvent].getVariables().setStore( storePtr, iEvent );
+  }
 }
 void SampleElement::shrinkEventList(size_t newTotalSize_){
 
@@ -68,26 +76,54 @@ void SampleElement::shrinkEventList(size_t newTotalSize_){
   _loadedDatasetList_.back().eventNb -= (_eventList_.size() - newTotalSize_);
   _eventList_.resize(newTotalSize_);
   _eventList_.shrink_to_fit();
-}
-void SampleElement::updateBinEventList(int iThread_) {
-  int nbThreads = GundamGlobals::getNumberOfThreads();
-  if( iThread_ == -1 ){ iThread_ = 0; nbThreads = 1; }
-
-  if( iThread_ == 0 ){ LogScopeIndent; LogInfo << "Filling bin event cache for \"" << _name_ << "\"..." << std::endl; }
+  if( not _doubleBaseWeightList_.empty() ){
+    _doubleBaseWeightList_.resize(newTotalSize_);
+    _doubleBaseWeightList_.shrink_to_fit();
+  }
 
-  // multithread technique with iBin += nbThreads;
-  int iBin{iThread_};
-  while( iBin < _histogram_.nBins ){
-    size_t count = std::count_if(_eventList_.begin(), _eventList_.end(), [&]( auto& e) {return e.getIndices().bin == iBin;});
-    _histogram_.binList[iBin].eventPtrList.resize(count, nullptr);
+  // the events might have been moved while filling: repack the variables of
+  // the last dataset in the event order and release the unused rows
+  if( _loadedDatasetList_.empty() ){ return; }
+  auto& datasetProperties{_loadedDatasetList_.back()};
+  if( datasetProperties.eventNb == 0 ){ return; }
+  auto& firstEvent = _eventList_[datasetProperties.eventOffSet];
+  if( firstEvent.getVariables().getStorePtr() == nullptr ){ return; }
+
+  auto storePtr = firstEvent.getVariables().getStorePtr()->makeEmptyCopy();
+  storePtr->resize( datasetProperties.eventNb );
+  for( size_t iEvent = 0 ; iEvent < datasetProperties.eventNb ; iEvent++ ){
+    auto& variables = _eventList_[datasetProperties.eventOffSet + iEvent].getVariables();
+    storePtr->copyRow( iEvent, *variables.getStorePtr(), variables.getRow() );
+  }
+  for( size_t iEvent = 0 ; iEvent < datasetProperties.eventNb ; iEvent++ ){
+    _eventList_[datasetProperties.eventOffSet + iEvent].getVariables().setStore( storePtr, iEvent );
+  }
+}
+void SampleElement::updateBinEventList() {
+  // counting sort: O(nEvents + nBins), events keep their order within each bin
+  _histogram_.binOffsetList.clear();
+  _histogram_.binOffsetList.resize(_histogram_.nBins + 1, 0);
+
+  // count the events in each bin
+  for( auto& event : _eventList_ ){
+    int iBin = event.getIndices().bin;
+    if( iBin < 0 or iBin >= _histogram_.nBins ){ continue; }
+    _histogram_.binOffsetList[iBin+1]++;
+  }
 
-    // Now filling the event indexes
-    size_t index = 0;
-    std::for_each(_eventList_.begin(), _eventList_.end(), [&]( auto& e){
-      if( e.getIndices().bin == iBin){ _histogram_.binList[iBin].eventPtrList[index++] = &e; }
-    });
+  // prefix sum -> offset of each bin
+  for( int iBin = 0 ; iBin < _histogram_.nBins ; iBin++ ){
+    _histogram_.binOffsetList[iBin+1] += _histogram_.binOffsetList[iBin];
+  }
 
-    iBin += nbThreads;
+  // Now filling the event pointers
+  _histogram_.eventPtrList.clear();
+  _histogram_.eventPtrList.resize(_histogram_.binOffsetList.back(), nullptr);
+  std::vector<size_t> fillPosition(_histogram_.binOffsetList.begin(), _histogram_.binOffsetList.end() - 1);
+  for( auto& event : _eventList_ ){
+    int iBin = event.getIndices().bin;
+    if( iBin < 0 or iBin >= _histogram_.nBins ){ continue; }
+    _histogram_.eventPtrList[fillPosition[iBin]++] = &event;
   }
 }
 void SampleElement::refillHistogram(int iThread_){
@@ -134,7 +170,7 @@ void SampleElement::refillHistogram(int iThread_){
     if (not binFilled) {  // Will (should) optimize away w/o Cache::Manager
       binPtr->content = 0;
       binPtr->error = 0;
-      for (auto *eventPtr: binPtr->eventPtrList) {
+      for (auto *eventPtr: _histogram_.getBinEventPtrList(iBin)) {
         buffer = eventPtr->getEventWeight();
         binPtr->content += buffer;
         binPtr->error += buffer * buffer;
@@ -174,30 +210,63 @@ void SampleElement::refillHistogram(int iThread_){
     // We don't use TH1D anymore.  TH1 tracks the variance, while we track the
     // standard deviation (i.e. sqrt(variance)).  This changed from older
     // versions.
+    binPtr->errorSquared = binPtr->error;
     binPtr->error = std::sqrt(binPtr->error); // YIKES!  NOTICE THIS!
     iBin += nThreads;
   }
 
 }
 
+void SampleElement::updateBinContent(int iBin_, double previousWeight_, double newWeight_){
+  auto& bin = _histogram_.binList[iBin_];
+  bin.content += newWeight_ - previousWeight_;
+  bin.errorSquared += newWeight_ * newWeight_ - previousWeight_ * previousWeight_;
+  // rounding errors could make it slightly negative
+  bin.error = std::sqrt( std::max(bin.errorSquared, 0.) );
+}
+
+double SampleElement::getDoubleBaseWeight(const Event& event_) const{
+  if( _doubleBaseWeightList_.empty() ){ return event_.getWeights().base; }
+  auto iEvent = size_t( &event_ - _eventList_.data() );
+  LogThrowIf( iEvent >= _doubleBaseWeightList_.size(), "Event not in " << _name_ );
+  return _doubleBaseWeightList_[iEvent];
+}
+
+void SampleElement::setBinContent(int iBin_, double sumWeights_, double sumSquaredWeights_){
+  auto& bin = _histogram_.binList[iBin_];
+  bin.content = sumWeights_;
+  bin.errorSquared = sumSquaredWeights_;
+  bin.error = std::sqrt( sumSquaredWeights_ );
+}
+
 void SampleElement::throwEventMcError(){
+  _externalEditCount_++;
+
   // Take into account the finite number of events
   double weightSum;
+  double weightSquaredSum;
   for( auto& bin : _histogram_.binList ){
     weightSum = 0;
-    for (auto *eventPtr: bin.eventPtrList) {
+    weightSquaredSum = 0;
+    for (auto *eventPtr: _histogram_.getBinEventPtrList(bin.index)) {
       // gRandom->Poisson(1) -> returns an INT -> can be 0
       eventPtr->getWeights().current = (gRandom->Poisson(1) * eventPtr->getEventWeight());
       weightSum += eventPtr->getEventWeight();
+      weightSquaredSum += eventPtr->getEventWeight() * eventPtr->getEventWeight();
     }
     bin.content = weightSum;
+    bin.errorSquared = weightSquaredSum;
+    bin.error = std::sqrt( weightSquaredSum );
   }
 }
 void SampleElement::throwStatError(bool useGaussThrow_){
   /*
    * This is to convert "Asimov" histogram to toy-experiment (pseudo-data), i.e. with statistical fluctuations
    * */
+  _externalEditCount_++;
+
   int nCounts;
+  double scale;
   for( auto& bin : _histogram_.binList ){
     if( bin.content == 0 ){ continue; }
     if( not useGaussThrow_ ){
@@ -209,11 +278,14 @@ void SampleElement::throwStatError(bool useGaussThrow_){
           , 0 // if the throw is negative, cap it to 0
       );
     }
-    for (auto *eventPtr: bin.eventPtrList) {
+    scale = (double) nCounts / bin.content;
+    for (auto *eventPtr: _histogram_.getBinEventPtrList(bin.index)) {
       // make sure refill of the histogram will produce the same hist
-      eventPtr->getWeights().current = ( eventPtr->getEventWeight()*((double) nCounts / bin.content) );
+      eventPtr->getWeights().current = ( eventPtr->getEventWeight()*scale );
     }
     bin.content = nCounts;
+    bin.errorSquared *= scale * scale;
+    bin.error = std::sqrt( bin.errorSquared );
   }
 }
 
@@ -78,9 +78,16 @@ void SampleSet::clearMcContainers(){
   for( auto& sample : _sampleList_ ){
     LogInfo << "Clearing event list for \"" << sample.getName() << "\"" << std::endl;
     sample.getMcContainer().getEventList().clear();
+    sample.getMcContainer().getDoubleBaseWeightList().clear();
   }
 }
 
+size_t SampleSet::getMcExternalEditCount() const{
+  size_t out{0};
+  for( auto& sample : _sampleList_ ){ out += sample.getMcContainer().getExternalEditCount(); }
+  return out;
+}
+
 std::vector<std::string> SampleSet::fetchRequestedVariablesForIndexing() const{
   std::vector<std::string> out;
   for (auto &sample: _sampleList_) {
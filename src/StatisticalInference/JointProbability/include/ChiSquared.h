@@ -14,6 +14,9 @@ namespace JointProbability{
   public:
     [[nodiscard]] std::string getType() const override { return "ChiSquared"; }
     [[nodiscard]] double eval(const Sample& sample_, int bin_) const override;
+
+    [[nodiscard]] bool hasDerivative() const override { return true; }
+    void evalDerivative(const Sample& sample_, int bin_, double& dContent_, double& dSumW2_) const override;
   };
 
   double ChiSquared::eval(const Sample& sample_, int bin_) const {
@@ -27,6 +30,14 @@ namespace JointProbability{
     }
     return TMath::Sq(predVal - dataVal)/predVal;
   }
+  void ChiSquared::evalDerivative(const Sample& sample_, int bin_, double& dContent_, double& dSumW2_) const {
+    double predVal = sample_.getMcContainer().getHistogram().binList[bin_].content;
+    double dataVal = sample_.getDataContainer().getHistogram().binList[bin_].content;
+
+    dSumW2_ = 0;
+    if( predVal == 0 ){ dContent_ = 0; return; }
+    dContent_ = 1.0 - TMath::Sq(dataVal/predVal);
+  }
 
 }
 
@@ -29,6 +29,11 @@ namespace JointProbability{
       return out;
     }
 
+    // derivatives of the bin by bin llh with respect to the MC content and
+    // to the MC sum of squared weights of the bin. Used for the analytic gradient.
+    [[nodiscard]] virtual bool hasDerivative() const { return false; }
+    virtual void evalDerivative( const Sample &sample_, int bin_, double& dContent_, double& dSumW2_ ) const{ dContent_ = 0; dSumW2_ = 0; }
+
   };
 }
 
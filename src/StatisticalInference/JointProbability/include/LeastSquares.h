@@ -23,6 +23,9 @@ namespace JointProbability{
     [[nodiscard]] std::string getType() const override { return "PluginJointProbability"; }
     [[nodiscard]] double eval(const Sample& sample_, int bin_) const override;
 
+    [[nodiscard]] bool hasDerivative() const override { return true; }
+    void evalDerivative(const Sample& sample_, int bin_, double& dContent_, double& dSumW2_) const override;
+
     /// If true the use Poissonian approximation with the variance equal to
     /// the observed value (i.e. the data).
     bool lsqPoissonianApproximation{false};
@@ -42,6 +45,13 @@ namespace JointProbability{
     if (lsqPoissonianApproximation && dataVal > 1.0) v /= 0.5*dataVal;
     return v;
   }
+  void LeastSquares::evalDerivative(const Sample& sample_, int bin_, double& dContent_, double& dSumW2_) const {
+    double predVal = sample_.getMcContainer().getHistogram().binList[bin_].content;
+    double dataVal = sample_.getDataContainer().getHistogram().binList[bin_].content;
+    dContent_ = 2.0*(predVal - dataVal);
+    if (lsqPoissonianApproximation && dataVal > 1.0) dContent_ /= 0.5*dataVal;
+    dSumW2_ = 0;
+  }
 
 }
 
@@ -32,6 +32,17 @@ namespace JointProbability{
       // LLH calculation
       return 2.0 * (predVal - dataVal + dataVal * TMath::Log(dataVal / predVal));
     }
+
+    [[nodiscard]] bool hasDerivative() const override { return true; }
+    void evalDerivative(const Sample& sample_, int bin_, double& dContent_, double& dSumW2_) const override {
+      double predVal = sample_.getMcContainer().getHistogram().binList[bin_].content;
+      double dataVal = sample_.getDataContainer().getHistogram().binList[bin_].content;
+
+      dSumW2_ = 0;
+      if( predVal <= 0 ){ dContent_ = 0; return; } // llh = +inf, no slope to follow
+      if( dataVal <= 0 ){ dContent_ = 2.0; return; }
+      dContent_ = 2.0 * (1.0 - dataVal / predVal);
+    }
   };
 
 }
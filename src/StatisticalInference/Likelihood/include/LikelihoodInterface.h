@@ -8,6 +8,7 @@
 #include "ParameterSet.h"
 #include "JointProbability.h"
 #include "Propagator.h"
+#include "PropagatorWorker.h"
 #include "DataSetManager.h"
 
 #include "GenericToolbox.Utils.h"
@@ -73,11 +74,32 @@ public:
   [[nodiscard]] double evalPenaltyLikelihood(const ParameterSet& parSet_) const;
   [[nodiscard]] std::string getSummary() const;
 
+  // gradient
+  /// True if both the joint probability and all the dials can provide their
+  /// derivatives.
+  [[nodiscard]] bool isAnalyticGradientAvailable();
+  /// Derivatives of the last evaluated likelihood with respect to each
+  /// parameter of parList_ (eigen or original parameters).  The parameters
+  /// must not have been changed since the last propagateAndEvalLikelihood().
+  void evalLikelihoodGradient(const std::vector<Parameter*>& parList_, std::vector<double>& gradient_);
+
   // dev deprecated
   [[deprecated("use getDataSetManager().getPropagator()")]] [[nodiscard]] const Propagator& getPropagator() const { return _dataSetManager_.getPropagator(); }
   [[deprecated("use getDataSetManager().getPropagator()")]] Propagator& getPropagator(){ return _dataSetManager_.getPropagator(); }
 
 private:
+  /// Likelihood of the current parameters with the events reweighted in
+  /// double precision by a PropagatorWorker, from double precision base
+  /// weights.  The MC histograms of the propagator are left as they are.
+  double evalDoublePrecisionLikelihood();
+
+  // config
+  /// Compare each propagateAndEvalLikelihood() with the likelihood obtained
+  /// from double precision weights.  Meant to validate the float weight
+  /// storage (WITH_FLOAT_WEIGHTS): it doubles the cost of a propagation.
+  bool _validateWeightPrecision_{false};
+  double _weightPrecisionTolerance_{1E-3};
+
   // internals
   int _nbParameters_{0};
   int _nbSampleBins_{0};
@@ -89,6 +111,15 @@ private:
   std::shared_ptr<JointProbability::JointProbabilityBase> _jointProbabilityPtr_{nullptr};
 
   mutable Buffer _buffer_{};
+
+  double _maxWeightPrecisionDeviation_{0};
+  std::unique_ptr<PropagatorWorker> _doublePrecisionWorker_{nullptr};
+
+  /// Gradient buffers: derivatives of the stat likelihood wrt to each
+  /// [sample][bin], and of the total likelihood wrt each [parSet][par]
+  std::vector<std::vector<double>> _binContentDerivativeList_{};
+  std::vector<std::vector<double>> _binSumW2DerivativeList_{};
+  std::vector<std::vector<double>> _parameterDerivativeList_{};
 };
 
 #endif //  GUNDAM_LIKELIHOOD_INTERFACE_H
@@ -6,9 +6,12 @@
 #define GUNDAM_PARAMETER_SCANNER_H
 
 #include "LikelihoodInterface.h"
+#include "PropagatorWorker.h"
 #include "Parameter.h"
 #include "JsonBaseClass.h"
 
+#include "GenericToolbox.Thread.h"
+
 #include "nlohmann/json.hpp"
 #include "TDirectory.h"
 #include "TGraph.h"
@@ -33,11 +36,13 @@ protected:
 public:
   // setters
   void setNbPoints(int nbPoints_){ _nbPoints_ = nbPoints_; }
+  void setEnableParallelScan(bool enableParallelScan_){ _enableParallelScan_ = enableParallelScan_; }
   void setNbPointsLineScan(int nbPointsLineScan_){ _nbPointsLineScan_ = nbPointsLineScan_; }
   void setLikelihoodInterfacePtr(LikelihoodInterface* likelihoodInterfacePtr_){ _likelihoodInterfacePtr_ = likelihoodInterfacePtr_; }
 
   // const getters
   [[nodiscard]] bool isUseParameterLimits() const{ return _useParameterLimits_; }
+  [[nodiscard]] bool isEnableParallelScan() const{ return _enableParallelScan_; }
   [[nodiscard]] int getNbPoints() const{ return _nbPoints_; }
   [[nodiscard]] const std::pair<double, double> &getParameterSigmaRange() const{ return _parameterSigmaRange_; }
   [[nodiscard]] const JsonType &getVarsConfig() const { return _varsConfig_; };
@@ -70,8 +75,17 @@ public:
   };
 
 private:
+  /// Evaluate the scan entries at the current state of the likelihood
+  void fillScanPoint(int iPt_);
+  /// Evaluate the scan points of par_ in batches, one point per
+  /// PropagatorWorker, each worker running on its own thread.  Same output as
+  /// the sequential scan.
+  void scanPointsInParallel(Parameter& par_, const std::vector<double>& scanValues_, std::vector<double>& parPoints_);
+
   // Config
   bool _useParameterLimits_{true};
+  bool _enableParallelScan_{false};
+  int _nbParallelWorkers_{-1};
   int _nbPoints_{100};
   int _nbPointsLineScan_{_nbPoints_};
   std::pair<double, double> _parameterSigmaRange_{-3,3};
@@ -83,6 +97,10 @@ private:
   std::vector<ScanData> _scanDataDict_;
   std::vector<GraphEntry> _graphEntriesBuf_;
 
+  // Parallel scans: the workers are rebuilt for each scanned parameter
+  std::vector<PropagatorWorker> _workerList_{};
+  GenericToolbox::ParallelWorker _threadPool_{};
+
 
 };
 
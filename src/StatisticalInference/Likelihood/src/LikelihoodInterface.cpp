@@ -47,6 +47,12 @@ void LikelihoodInterface::readConfigImpl(){
   configJointProbability = GenericToolbox::Json::fetchValue(_config_, "jointProbabilityConfig", configJointProbability);
   jointProbabilityTypeStr = GenericToolbox::Json::fetchValue(configJointProbability, "type", jointProbabilityTypeStr);
 
+  _validateWeightPrecision_ = GenericToolbox::Json::fetchValue(_config_, "validateWeightPrecision", _validateWeightPrecision_);
+  _weightPrecisionTolerance_ = GenericToolbox::Json::fetchValue(_config_, "weightPrecisionTolerance", _weightPrecisionTolerance_);
+
+  // the loader has to keep the base weights before they get stored as float
+  getDataSetManager().getPropagator().setKeepDoubleBaseWeights( _validateWeightPrecision_ );
+
   LogInfo << "Using \"" << jointProbabilityTypeStr << "\" JointProbabilityType." << std::endl;
   _jointProbabilityPtr_ = std::shared_ptr<JointProbability::JointProbabilityBase>( JointProbability::makeJointProbability( jointProbabilityTypeStr ) );
   _jointProbabilityPtr_->readConfig( configJointProbability );
@@ -71,6 +77,16 @@ void LikelihoodInterface::initializeImpl() {
     _nbSampleBins_ += int(sample.getBinning().getBinList().size() );
   }
 
+  if( _validateWeightPrecision_ ){
+    if( not PropagatorWorker::isSupported( getDataSetManager().getPropagator() ) ){
+      LogAlert << "Some dials can't be evaluated outside of the propagator. Weight precision won't be validated." << std::endl;
+      _validateWeightPrecision_ = false;
+    }
+    else{
+      LogWarning << "Each likelihood evaluation will be compared with double precision weights." << std::endl;
+    }
+  }
+
   LogInfo << "Move back MC parameters to prior..." << std::endl;
   getDataSetManager().getPropagator().getParametersManager().moveParametersToPrior();
 
@@ -97,8 +113,38 @@ void LikelihoodInterface::initializeImpl() {
 }
 
 void LikelihoodInterface::propagateAndEvalLikelihood(){
-  getDataSetManager().getPropagator().propagateParameters();
+  double doublePrecisionLlh{0};
+  if( _validateWeightPrecision_ ){ doublePrecisionLlh = this->evalDoublePrecisionLikelihood(); }
+
+  // the weights of the grouped events are not needed to evaluate the likelihood
+  getDataSetManager().getPropagator().propagateParametersToHistograms();
   this->evalLikelihood();
+
+  if( _validateWeightPrecision_ ){
+    double deviation{std::abs(_buffer_.totalLikelihood - doublePrecisionLlh)};
+    if( deviation > _maxWeightPrecisionDeviation_ ){
+      _maxWeightPrecisionDeviation_ = deviation;
+      if( deviation > _weightPrecisionTolerance_ ){
+        LogAlert << "Weight precision: LLH = " << _buffer_.totalLikelihood
+                 << " while double precision weights give " << doublePrecisionLlh
+                 << " (max deviation so far: " << _maxWeightPrecisionDeviation_ << ")" << std::endl;
+      }
+    }
+  }
+}
+double LikelihoodInterface::evalDoublePrecisionLikelihood(){
+  if( _doublePrecisionWorker_ == nullptr ){
+    _doublePrecisionWorker_ = std::make_unique<PropagatorWorker>( getDataSetManager().getPropagator(), true );
+  }
+  _doublePrecisionWorker_->fetchParameterValues();
+  _doublePrecisionWorker_->propagate();
+
+  // the joint probability reads the sample histograms: the private sums of
+  // the worker are only swapped in for the evaluation
+  _doublePrecisionWorker_->swapHistograms();
+  double llh{this->evalLikelihood()};
+  _doublePrecisionWorker_->swapHistograms();
+  return llh;
 }
 
 double LikelihoodInterface::evalLikelihood() const {
@@ -126,28 +172,51 @@ double LikelihoodInterface::evalStatLikelihood(const Sample& sample_) const {
 }
 double LikelihoodInterface::evalPenaltyLikelihood(const ParameterSet& parSet_) const {
   if( not parSet_.isEnabled() ){ return 0; }
+  return parSet_.evalPenaltyChi2();
+}
+bool LikelihoodInterface::isAnalyticGradientAvailable(){
+  if( not _jointProbabilityPtr_->hasDerivative() ){ return false; }
+  return getDataSetManager().getPropagator().isStatGradientAvailable();
+}
+void LikelihoodInterface::evalLikelihoodGradient(const std::vector<Parameter*>& parList_, std::vector<double>& gradient_){
+  auto& propagator = getDataSetManager().getPropagator();
+  auto& sampleList = propagator.getSampleSet().getSampleList();
+
+  // stat part: dLLH/dBin for each bin, then chain rule through the event weights
+  _binContentDerivativeList_.resize( sampleList.size() );
+  _binSumW2DerivativeList_.resize( sampleList.size() );
+  for( size_t iSample = 0 ; iSample < sampleList.size() ; iSample++ ){
+    size_t nBins{sampleList[iSample].getBinning().getBinList().size()};
+    _binContentDerivativeList_[iSample].resize( nBins );
+    _binSumW2DerivativeList_[iSample].resize( nBins );
+    for( size_t iBin = 0 ; iBin < nBins ; iBin++ ){
+      _jointProbabilityPtr_->evalDerivative(
+          sampleList[iSample], int(iBin),
+          _binContentDerivativeList_[iSample][iBin], _binSumW2DerivativeList_[iSample][iBin]
+      );
+    }
+  }
+  propagator.evalStatGradient( _binContentDerivativeList_, _binSumW2DerivativeList_, _parameterDerivativeList_ );
 
-  double buffer = 0;
+  auto& parSetList = propagator.getParametersManager().getParameterSetsList();
+  gradient_.assign( parList_.size(), 0 );
+  for( size_t iPar = 0 ; iPar < parList_.size() ; iPar++ ){
+    auto* parPtr = parList_[iPar];
 
-  if( parSet_.getPriorCovarianceMatrix() != nullptr ){
-    if( parSet_.isEnableEigenDecomp() ){
-      for( const auto& eigenPar : parSet_.getEigenParameterList() ){
-        if( eigenPar.isFixed() ){ continue; }
-        buffer += TMath::Sq( (eigenPar.getParameterValue() - eigenPar.getPriorValue()) / eigenPar.getStdDevValue() ) ;
-      }
+    size_t iParSet{0};
+    while( iParSet < parSetList.size() and &parSetList[iParSet] != parPtr->getOwner() ){ iParSet++; }
+    LogThrowIf( iParSet == parSetList.size(), "Could not find the parameter set of " << parPtr->getFullTitle() );
+    auto& parSet = parSetList[iParSet];
+
+    if( parPtr->isEigen() ){
+      gradient_[iPar] = parSet.evalEigenDerivative( *parPtr, _parameterDerivativeList_[iParSet] );
     }
     else{
-      // make delta vector
-      parSet_.updateDeltaVector();
-
-      // compute penalty term with covariance
-      buffer =
-          (*parSet_.getDeltaVectorPtr())
-          * ( (*parSet_.getInverseStrippedCovarianceMatrix()) * (*parSet_.getDeltaVectorPtr()) );
+      gradient_[iPar] = _parameterDerivativeList_[iParSet][parPtr->getParameterIndex()];
     }
-  }
 
-  return buffer;
+    if( parSet.isEnabled() ){ gradient_[iPar] += parSet.evalPenaltyChi2Derivative( *parPtr ); }
+  }
 }
 [[nodiscard]] std::string LikelihoodInterface::getSummary() const {
   std::stringstream ss;
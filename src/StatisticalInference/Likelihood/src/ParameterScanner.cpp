@@ -5,6 +5,7 @@
 #include "ParameterScanner.h"
 #include "Propagator.h"
 #include "Parameter.h"
+#include "GundamGlobals.h"
 
 #include "GenericToolbox.Utils.h"
 #include "GenericToolbox.Json.h"
@@ -13,6 +14,7 @@
 #include "TGraph.h"
 #include <TDirectory.h>
 
+#include <algorithm>
 #include <utility>
 
 
@@ -31,6 +33,8 @@ void ParameterScanner::readConfigImpl() {
   _nbPoints_ = GenericToolbox::Json::fetchValue(_config_, "nbPoints", _nbPoints_);
   _nbPointsLineScan_ = GenericToolbox::Json::fetchValue(_config_, "nbPointsLineScan", _nbPoints_);
   _parameterSigmaRange_ = GenericToolbox::Json::fetchValue(_config_, "parameterSigmaRange", _parameterSigmaRange_);
+  _enableParallelScan_ = GenericToolbox::Json::fetchValue(_config_, "enableParallelScan", _enableParallelScan_);
+  _nbParallelWorkers_ = GenericToolbox::Json::fetchValue(_config_, "nbParallelWorkers", _nbParallelWorkers_);
 
   _varsConfig_ = GenericToolbox::Json::fetchValue(_config_, "varsConfig", JsonType());
 
@@ -101,6 +105,11 @@ void ParameterScanner::initializeImpl() {
     }
   }
   if( GenericToolbox::Json::fetchValue(_varsConfig_, "weightPerSample", false) ){
+    if( _enableParallelScan_ ){
+      // the workers don't write the event weights
+      LogAlert << "weightPerSample is sum of the event weights. Disabling the parallel scans." << std::endl;
+      _enableParallelScan_ = false;
+    }
     for( auto& sample : _likelihoodInterfacePtr_->getDataSetManager().getPropagator().getSampleSet().getSampleList() ){
       _scanDataDict_.emplace_back();
       auto& scanEntry = _scanDataDict_.back();
@@ -159,6 +168,7 @@ void ParameterScanner::scanParameter(Parameter& par_, TDirectory* saveDir_) {
     highBound = std::min(highBound, par_.getMaxValue());
   }
 
+  std::vector<double> scanValues(_nbPoints_+1,0);
   int offSet{0}; // offset help make sure the first point
   for( int iPt = 0 ; iPt < _nbPoints_+1 ; iPt++ ){
     double newVal = lowBound + double(iPt-offSet)/(_nbPoints_-1)*( highBound - lowBound );
@@ -182,16 +192,26 @@ void ParameterScanner::scanParameter(Parameter& par_, TDirectory* saveDir_) {
         << GET_VAR_NAME_VALUE(par_.getStdDevValue()) << std::endl
         );
 
-    par_.setParameterValue(newVal);
+    scanValues[iPt] = newVal;
+  }
 
-    _likelihoodInterfacePtr_->propagateAndEvalLikelihood();
-    parPoints[iPt] = par_.getParameterValue();
+  auto& propagator = _likelihoodInterfacePtr_->getDataSetManager().getPropagator();
+  if( _enableParallelScan_ and not PropagatorWorker::isSupported( propagator ) ){
+    LogAlert << "Some dials can't be evaluated outside of the propagator. Disabling the parallel scans." << std::endl;
+    _enableParallelScan_ = false;
+  }
+
+  if( _enableParallelScan_ ){
+    this->scanPointsInParallel( par_, scanValues, parPoints );
+  }
+  else{
+    for( int iPt = 0 ; iPt < _nbPoints_+1 ; iPt++ ){
+      par_.setParameterValue(scanValues[iPt]);
 
-    for( auto& scanEntry : _scanDataDict_ ){
-        double y = scanEntry.evalY();
-        if (std::isnan(y)) y = -2.0;
-        if (not std::isfinite(y)) y = -1.0;
-        scanEntry.yPoints[iPt] = y;
+      _likelihoodInterfacePtr_->propagateAndEvalLikelihood();
+      parPoints[iPt] = par_.getParameterValue();
+
+      this->fillScanPoint( iPt );
     }
   }
 
@@ -237,6 +257,67 @@ void ParameterScanner::scanParameter(Parameter& par_, TDirectory* saveDir_) {
   currentParValue[0] = par_.getParameterValue();
   GenericToolbox::writeInTFile(saveDir_, &currentParValue, ssVal.str());
 }
+void ParameterScanner::fillScanPoint(int iPt_){
+  for( auto& scanEntry : _scanDataDict_ ){
+    double y = scanEntry.evalY();
+    if (std::isnan(y)) y = -2.0;
+    if (not std::isfinite(y)) y = -1.0;
+    scanEntry.yPoints[iPt_] = y;
+  }
+}
+void ParameterScanner::scanPointsInParallel(Parameter& par_, const std::vector<double>& scanValues_, std::vector<double>& parPoints_){
+  auto& propagator = _likelihoodInterfacePtr_->getDataSetManager().getPropagator();
+
+  // the number of workers (and threads) is set by the first scan
+  size_t nbWorkers{_workerList_.size()};
+  if( nbWorkers == 0 ){
+    int nbThreads{_nbParallelWorkers_ > 0 ? _nbParallelWorkers_ : GundamGlobals::getNumberOfThreads()};
+    nbWorkers = size_t( std::max(1, std::min(nbThreads, int(scanValues_.size()))) );
+    LogInfo << "Using " << nbWorkers << " propagator workers for the parallel scans..." << std::endl;
+    _threadPool_.setNThreads( int(nbWorkers) );
+  }
+
+  // the workers take a snapshot of the static bin sums and of the dial input
+  // buffers: they are rebuilt for every scan so a toy throw, an MC stat throw
+  // or a reload since the previous scan is taken into account
+  _workerList_.clear();
+  _workerList_.reserve( nbWorkers );
+  for( size_t iWorker = 0 ; iWorker < nbWorkers ; iWorker++ ){ _workerList_.emplace_back( propagator ); }
+
+  for( size_t iFirst = 0 ; iFirst < scanValues_.size() ; iFirst += _workerList_.size() ){
+    size_t nPoints{std::min(_workerList_.size(), scanValues_.size() - iFirst)};
+
+    // the parameter sets are shared: snapshots are taken one after the other
+    for( size_t iWorker = 0 ; iWorker < nPoints ; iWorker++ ){
+      par_.setParameterValue( scanValues_[iFirst + iWorker] );
+      _workerList_[iWorker].fetchParameterValues();
+    }
+
+    // the expensive part: reweight and fill the histograms
+    if( _workerList_.size() == 1 ){ _workerList_[0].propagate(); }
+    else{
+      _threadPool_.runJob([&](int iThread){
+        if( iThread == -1 ){ for( size_t iWorker = 0 ; iWorker < nPoints ; iWorker++ ){ _workerList_[iWorker].propagate(); } }
+        else if( size_t(iThread) < nPoints ){ _workerList_[iThread].propagate(); }
+      });
+    }
+
+    // the scan entries are evaluated on the propagator samples and parameter sets
+    for( size_t iWorker = 0 ; iWorker < nPoints ; iWorker++ ){
+      par_.setParameterValue( scanValues_[iFirst + iWorker] );
+      if( propagator.isEnableEigenToOrigInPropagate() ){
+        for( auto& parSet : propagator.getParametersManager().getParameterSetsList() ){
+          if( parSet.isEnableEigenDecomp() ){ parSet.propagateEigenToOriginal(); }
+        }
+      }
+      _workerList_[iWorker].exportHistograms();
+      _likelihoodInterfacePtr_->evalLikelihood();
+      parPoints_[iFirst + iWorker] = par_.getParameterValue();
+
+      this->fillScanPoint( int(iFirst + iWorker) );
+    }
+  }
+}
 void ParameterScanner::scanSegment(TDirectory *saveDir_, const JsonType &end_, const JsonType &start_, int nSteps_) {
   if( nSteps_ == -1 ){ nSteps_ = _nbPointsLineScan_; }
   LogWarning << "Scanning along a segment with " << nSteps_ << " steps." << std::endl;
@@ -110,6 +110,38 @@ namespace {
 
     }
 
+    // The derivative of BicubicCINT with respect to x.  BicubicCINT is
+    // linear in the p values, so this is also used to propagate the
+    // derivatives of the p values.
+    DEVICE_CALLABLE_INLINE
+    DEVICE_FLOATING_POINT
+    BicubicCINTDerivative(const DEVICE_FLOATING_POINT x,
+                          const DEVICE_FLOATING_POINT x0,
+                          const DEVICE_FLOATING_POINT p0,
+                          const DEVICE_FLOATING_POINT x1,
+                          const DEVICE_FLOATING_POINT p1,
+                          const DEVICE_FLOATING_POINT x2,
+                          const DEVICE_FLOATING_POINT p2,
+                          const DEVICE_FLOATING_POINT x3,
+                          const DEVICE_FLOATING_POINT p3) {
+
+        const double step = x2-x1;
+        const double fx = (x - x1)/step;
+        double m1 = step*(p2-p0)/(x2-x0);
+        double m2 = step*(p3-p1)/(x3-x1);
+
+        // Make linear outside of region
+        if (fx < 0.0) m2 = m1;
+        if (fx > 1.0) m1 = m2;
+
+        double dv = (((3.0*(-2.0*p2 + 2.0*p1 + m2 + m1)*fx
+                       +2.0*(3*p2-3*p1-m2-2*m1))*fx
+                      + m1)/step);
+
+        return dv;
+
+    }
+
     // Interpolate one point with non-uniform knots on each axis.  Each axis
     // can have have at most 16 knots defined, and there must be at least 4
     // knots (i.e. a minimum of one square facet)..  The knots are specified
@@ -140,6 +172,8 @@ namespace {
     // The values in xx will be [-1, 0, 1] and nnx will be 3
     // The values in yy will be [-1, 0, 1] and nny will be 3
     //
+    // If gradient is not null, gradient[0] and gradient[1] are filled with
+    // the derivatives with respect to x and y (zero if the value is clamped).
     DEVICE_CALLABLE_INLINE
     DEVICE_FLOATING_POINT
     CalculateBicubicSpline(const DEVICE_FLOATING_POINT x,
@@ -151,7 +185,8 @@ namespace {
                             const DEVICE_FLOATING_POINT* xx,
                             const int nnx,
                             const DEVICE_FLOATING_POINT* yy,
-                            const int nny) {
+                            const int nny,
+                            DEVICE_FLOATING_POINT* gradient = nullptr) {
 
         // Find the indices for the lower corner of the facet used for
         // interpolation.  The point may not lie in the facet and the result
@@ -203,6 +238,7 @@ namespace {
 
         const DEVICE_FLOATING_POINT u0 = (iy > 0) ? yy[iy-1]: 2*yy[iy]-yy[iy+1];
         const DEVICE_FLOATING_POINT v0 = BicubicCINT(x,a0,b0,a1,b1,a2,b2,a3,b3);
+        const DEVICE_FLOATING_POINT dv0 = (gradient) ? BicubicCINTDerivative(x,a0,b0,a1,b1,a2,b2,a3,b3) : 0.0;
 
         // Interpolate the second band (at a fixed y value) in yy[iy].
         // Handle the corner cases.
@@ -229,6 +265,7 @@ namespace {
 
         const DEVICE_FLOATING_POINT u1 = yy[iy];
         const DEVICE_FLOATING_POINT v1 = BicubicCINT(x,a0,b0,a1,b1,a2,b2,a3,b3);
+        const DEVICE_FLOATING_POINT dv1 = (gradient) ? BicubicCINTDerivative(x,a0,b0,a1,b1,a2,b2,a3,b3) : 0.0;
 
         // Interpolate the third band (at a fixed y value) in yy[iy+1].
         // Handle the corner cases.
@@ -255,6 +292,7 @@ namespace {
 
         const DEVICE_FLOATING_POINT u2 = yy[iy+1];
         const DEVICE_FLOATING_POINT v2 = BicubicCINT(x,a0,b0,a1,b1,a2,b2,a3,b3);
+        const DEVICE_FLOATING_POINT dv2 = (gradient) ? BicubicCINTDerivative(x,a0,b0,a1,b1,a2,b2,a3,b3) : 0.0;
 
         // Interpolate the fourth band (at a fixed y value) in yy[iy+2].
         // Handle the corner cases.
@@ -287,9 +325,19 @@ namespace {
 
         const DEVICE_FLOATING_POINT u3 = (iy < nny-2) ? yy[iy+2] : 2*yy[iy+1] - yy[iy];
         const DEVICE_FLOATING_POINT v3 = BicubicCINT(x,a0,b0,a1,b1,a2,b2,a3,b3);
+        const DEVICE_FLOATING_POINT dv3 = (gradient) ? BicubicCINTDerivative(x,a0,b0,a1,b1,a2,b2,a3,b3) : 0.0;
 
         DEVICE_FLOATING_POINT val = BicubicCINT(y,u0,v0,u1,v1,u2,v2,u3,v3);
 
+        if (gradient) {
+            gradient[0] = BicubicCINT(y,u0,dv0,u1,dv1,u2,dv2,u3,dv3);
+            gradient[1] = BicubicCINTDerivative(y,u0,v0,u1,v1,u2,v2,u3,v3);
+            if (val<lowerBound || val>upperBound) {
+                gradient[0] = 0.0;
+                gradient[1] = 0.0;
+            }
+        }
+
         // Apply the clamp.  This could be done using the CUDA min/max
         // primitives, but this is not a critical section of the code, and the
         // min/max api is drawn from "C", not std::max/std::min, so I think
@@ -100,6 +100,8 @@ namespace {
     // The values in xx will be [-1, 0, 1] and nnx will be 3
     // The values in yy will be [-1, 0, 1] and nny will be 3
     //
+    // If gradient is not null, gradient[0] and gradient[1] are filled with
+    // the derivatives with respect to x and y (zero if the value is clamped).
     DEVICE_CALLABLE_INLINE
     DEVICE_FLOATING_POINT
     CalculateBilinearInterpolation(const DEVICE_FLOATING_POINT x,
@@ -111,7 +113,8 @@ namespace {
                                    const DEVICE_FLOATING_POINT* xx,
                                    const int nnx,
                                    const DEVICE_FLOATING_POINT* yy,
-                                   const int nny) {
+                                   const int nny,
+                                   DEVICE_FLOATING_POINT* gradient = nullptr) {
 
         // Find the indices for the lower corner of the facet used for
         // interpolation.  The point may not lie in the facet and the result
@@ -141,6 +144,19 @@ namespace {
 
         DEVICE_FLOATING_POINT val = BilinearCINT(y,u0,v0,u1,v1);
 
+        if (gradient) {
+            // The value is linear in v0 and v1, and each of them is linear
+            // in x.
+            const DEVICE_FLOATING_POINT dv0 = (knots[IXY(ix+1,iy)] - knots[IXY(ix,iy)])/(xx[ix+1]-xx[ix]);
+            const DEVICE_FLOATING_POINT dv1 = (knots[IXY(ix+1,iy+1)] - knots[IXY(ix,iy+1)])/(xx[ix+1]-xx[ix]);
+            gradient[0] = BilinearCINT(y,u0,dv0,u1,dv1);
+            gradient[1] = (v1-v0)/(u1-u0);
+            if (val<lowerBound || val>upperBound) {
+                gradient[0] = 0.0;
+                gradient[1] = 0.0;
+            }
+        }
+
         // Apply the clamp.  This could be done using the CUDA min/max
         // primitives, but this is not a critical section of the code, and the
         // min/max api is drawn from "C", not std::max/std::min, so I think
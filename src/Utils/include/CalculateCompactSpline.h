@@ -45,11 +45,15 @@ namespace {
     // CalculateCompactSpline, and CalculateMonotonicSpline have very similar,
     // but different calls.  In particular the dim parameter meaning is not
     // consistent.
+    //
+    // If derivative is not null, it is filled with the derivative of the
+    // spline with respect to x (zero if the value is clamped).
     DEVICE_CALLABLE_INLINE
     double CalculateCompactSpline(const double x,
                                   const double lowerBound, double upperBound,
                                   const DEVICE_FLOATING_POINT* data,
-                                  const int dim) {
+                                  const int dim,
+                                  double* derivative = nullptr) {
 
         // Interpolate between p2 and p3
         // ix-2 ix-1 ix   ix+1 ix+2 ix+3
@@ -119,6 +123,14 @@ namespace {
                      +m2)*fx
                     +p2);
 
+        if (derivative) {
+            // The slopes are per unit of fx, so divide by the step.
+            *derivative = (((3.0*(2.0*p2 - 2.0*p3 + m3 + m2)*fx
+                             + 2.0*(3.0*p3 - 3.0*p2 - m3 - 2.0*m2))*fx
+                            +m2)/step);
+            if (v < lowerBound || v > upperBound) *derivative = 0.0;
+        }
+
         if (v < lowerBound) v = lowerBound;
         if (v > upperBound) v = upperBound;
 
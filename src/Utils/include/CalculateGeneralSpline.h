@@ -46,11 +46,15 @@ namespace {
     // CalculateCompactSpline, and CalculateMonotonicSpline have very similar,
     // but different calls.  In particular the dim parameter meaning is not
     // consistent.
+    //
+    // If derivative is not null, it is filled with the derivative of the
+    // spline with respect to x (zero if the value is clamped).
     DEVICE_CALLABLE_INLINE
     double CalculateGeneralSpline(const double x,
                                   const double lowerBound, double upperBound,
                                   const DEVICE_FLOATING_POINT* data,
-                                  const int dim) {
+                                  const int dim,
+                                  double* derivative = nullptr) {
 
 #if defined(CALCULATE_GENERAL_SPLINE_LINEAR_IF)
 #warning USING CALCULATE_GENERAL_SPLINE_LINEAR_IF
@@ -153,6 +157,14 @@ namespace {
                      +m1)*fx
                     +p1);
 
+        if (derivative) {
+            // The slopes are per unit of fx, so divide by the step.
+            *derivative = (((3.0*(2.0*p1 - 2.0*p2 + m2 + m1)*fx
+                             + 2.0*(3.0*p2 - 3.0*p1 - m2 - 2.0*m1))*fx
+                            +m1)/step);
+            if (v < lowerBound || v > upperBound) *derivative = 0.0;
+        }
+
         if (v < lowerBound) v = lowerBound;
         if (v > upperBound) v = upperBound;
 
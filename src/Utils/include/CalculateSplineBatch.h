@@ -0,0 +1,93 @@
+#ifndef CALCULATE_SPLINE_BATCH_H_SEEN
+#define CALCULATE_SPLINE_BATCH_H_SEEN
+// Evaluate a batch of splines of the same type on the CPU.  These give the
+// same values as CalculateCompactSpline, CalculateUniformSpline,
+// CalculateGeneralSpline and CalculateMonotonicSpline, but the loops are
+// written so that the compiler can vectorize them: the splines are evaluated
+// "side by side" using gathered loads instead of one virtual call per
+// spline.  When compiled with GCC for x86-64, an AVX-512, an AVX2 and a
+// generic version of each loop are built, and the best one is chosen at load
+// time for the running CPU (so the binary stays portable).
+//
+// The spline data is stored in a single buffer with the same layout as used
+// by the Cache::Manager.  The spline "i" is evaluated at x[i] using the
+// spline data data[index[i]] to data[index[i+1]-1] (with the same layout as
+// the single spline function, so the index array has n+1 elements).  The
+// result is clamped between lowerBound and upperBound and written in
+// results[i].  These are only used on the host, so there is no CUDA version.
+//
+// The spline data can be in double or in single precision: the float
+// versions are used by the Cache::Manager when the weight buffers are
+// compiled with GUNDAM_FLOAT_WEIGHTS.  The calculation is always done in
+// double precision.
+
+// The number of splines that should be handed to the batch functions at a
+// time.  This is a good size for the scratch buffers kept on the stack.
+#define CALCULATE_SPLINE_BATCH_SIZE 128
+
+void CalculateCompactSplineBatch(int n, const double* x,
+                                 double lowerBound, double upperBound,
+                                 const double* data,
+                                 const int* index,
+                                 double* results);
+
+void CalculateCompactSplineBatch(int n, const double* x,
+                                 double lowerBound, double upperBound,
+                                 const float* data,
+                                 const int* index,
+                                 double* results);
+
+void CalculateUniformSplineBatch(int n, const double* x,
+                                 double lowerBound, double upperBound,
+                                 const double* data,
+                                 const int* index,
+                                 double* results);
+
+void CalculateUniformSplineBatch(int n, const double* x,
+                                 double lowerBound, double upperBound,
+                                 const float* data,
+                                 const int* index,
+                                 double* results);
+
+void CalculateGeneralSplineBatch(int n, const double* x,
+                                 double lowerBound, double upperBound,
+                                 const double* data,
+                                 const int* index,
+                                 double* results);
+
+void CalculateGeneralSplineBatch(int n, const double* x,
+                                 double lowerBound, double upperBound,
+                                 const float* data,
+                                 const int* index,
+                                 double* results);
+
+void CalculateMonotonicSplineBatch(int n, const double* x,
+                                   double lowerBound, double upperBound,
+                                   const double* data,
+                                   const int* index,
+                                   double* results);
+
+void CalculateMonotonicSplineBatch(int n, const double* x,
+                                   double lowerBound, double upperBound,
+                                   const float* data,
+                                   const int* index,
+                                   double* results);
+
+// Evaluate a batch of splines sharing the same knots.  Since the segment
+// holding the input value, and the position fx inside it, only depend on the
+// knots, they are found once for the whole batch.  Each spline is then given
+// by the four cubic coefficients of that segment, so the spline "i" is the
+// dot product of coefficients[4*i] to coefficients[4*i+3] with fxPowers
+// (1, fx, fx^2, fx^3).  The result is clamped between lowerBound and
+// upperBound and written in results[i].
+void CalculateSharedKnotSplineBatch(int n, const double* fxPowers,
+                                    double lowerBound, double upperBound,
+                                    const double* coefficients,
+                                    double* results);
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:4
+// compile-command:"$(git rev-parse --show-toplevel)/cmake/gundam-build.sh"
+// End:
+#endif
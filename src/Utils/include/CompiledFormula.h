@@ -0,0 +1,86 @@
+//
+// Selection cuts and formulas compiled into a small stack bytecode.
+//
+
+#ifndef GUNDAM_COMPILED_FORMULA_H
+#define GUNDAM_COMPILED_FORMULA_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+
+/// A formula expression compiled once into a stack bytecode.  Evaluating it
+/// doesn't allocate anything, and evalBatch() runs each instruction over a
+/// whole column of entries at a time, so the dispatch is paid once per batch
+/// instead of once per entry.
+///
+/// Only the subset of the TFormula/TTreeFormula grammar used by the selection
+/// cuts is supported: numbers, variables, arithmetic, comparisons, logical
+/// operators and a few functions.  compile() returns false for anything else,
+/// and the caller is expected to fall back to ROOT.
+class CompiledFormula {
+
+public:
+  enum class Syntax{
+    /// TFormula: the variables are written "[name]", functions are the C++ ones
+    TFormula,
+    /// TTreeFormula: the variables are the bare leaf names, and the ROOT v5
+    /// conventions are kept (a division by zero gives zero)
+    TTreeFormula
+  };
+
+  static constexpr size_t maxStackSize{64};
+  static constexpr size_t maxNbVariables{64};
+
+public:
+  CompiledFormula() = default;
+
+  /// Returns false (and the formula is left invalid) if the expression can't
+  /// be compiled.  The reason is given by getErrorMessage().
+  bool compile(const std::string& expression_, Syntax syntax_);
+
+  // const getters
+  [[nodiscard]] bool isValid() const{ return not _instructionList_.empty(); }
+  [[nodiscard]] const std::string& getExpression() const{ return _expression_; }
+  [[nodiscard]] const std::string& getErrorMessage() const{ return _errorMessage_; }
+  /// The variables in the order expected by eval() and evalBatch()
+  [[nodiscard]] const std::vector<std::string>& getVariableNameList() const{ return _variableNameList_; }
+
+  // core
+  [[nodiscard]] double eval(const double* variableList_) const;
+  /// columnList_[iVar][iEntry] -> output_[iEntry]
+  void evalBatch(const std::vector<const double*>& columnList_, size_t nEntries_, double* output_) const;
+
+  [[nodiscard]] std::string getSummary() const;
+
+private:
+  enum class OpCode : unsigned char {
+    PushConstant, PushVariable,
+    // unary
+    Negate, Not, Abs, Sqrt, Exp, Log, Log10, Sin, Cos, Tan, ASin, ACos, ATan,
+    // binary
+    Add, Subtract, Multiply, Divide, ProtectedDivide, Power, ATan2, Min, Max,
+    Less, LessEqual, Greater, GreaterEqual, Equal, NotEqual, And, Or
+  };
+  struct Instruction{
+    OpCode opCode{OpCode::PushConstant};
+    int variableIndex{-1};
+    double constant{0};
+  };
+
+  class Parser;
+
+  static double evalUnary(OpCode opCode_, double a_);
+  static double evalBinary(OpCode opCode_, double a_, double b_);
+
+  std::string _expression_{};
+  std::string _errorMessage_{};
+  size_t _stackSize_{0};
+  std::vector<std::string> _variableNameList_{};
+  std::vector<Instruction> _instructionList_{};
+
+};
+
+
+#endif //GUNDAM_COMPILED_FORMULA_H
@@ -41,6 +41,14 @@ public:
   void sortBins();
   [[nodiscard]] std::vector<std::string> buildVariableNameList() const;
 
+  // fast lookup
+  /// Must be called again whenever the bin list is edited through
+  /// getBinList(): the index refers to the bins by position.  An index
+  /// built for a different number of bins is ignored.
+  void buildBinLookupIndex();
+  [[nodiscard]] const DataBin::Edges* getLookupEdgesPtr() const;
+  [[nodiscard]] const std::vector<int>& getBinCandidateList(double value_) const;
+
 protected:
   void readTxtBinningDefinition();    // original txt
   void readBinningConfig(const JsonType& binning_); // yaml/json
@@ -50,6 +58,18 @@ private:
   std::string _filePath_;
   std::vector<DataBin> _binList_{};
 
+  /// Lookup index built on one range variable shared by all the bins.  The
+  /// sorted bin boundaries of this variable define slices, and each slice
+  /// keeps the (ordered) list of the bins overlapping with it.  The other
+  /// variables still need to be checked on the candidates.
+  struct BinLookupIndex{
+    int edgesIndex{-1}; // position of the variable in the edges list of the first bin
+    size_t nBins{0}; // size of the bin list the index has been built for
+    std::vector<double> boundaryList{};
+    std::vector<std::vector<int>> sliceBinIndexList{};
+  };
+  BinLookupIndex _binLookupIndex_{};
+
 };
 
 
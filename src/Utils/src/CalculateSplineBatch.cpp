@@ -0,0 +1,223 @@
+// The loops are compiled for the spline data type DEVICE_FLOATING_POINT.
+// CalculateSplineBatchFloat.cpp includes this file again with float data.
+#ifndef DEVICE_FLOATING_POINT
+#define DEVICE_FLOATING_POINT double
+#endif
+
+#include "CalculateSplineBatch.h"
+
+#include "CalculateGeneralSpline.h"
+
+// Build one version of each batch loop per instruction set, and let the
+// dynamic loader pick the best one for the running CPU.  This needs the GNU
+// ifunc support, so it's only done for GCC on x86-64.  Otherwise, the loops
+// are compiled for the default target (and vectorized if the build flags
+// allow it).
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) \
+    && !defined(CALCULATE_SPLINE_BATCH_NO_DISPATCH)
+#define CALCULATE_SPLINE_BATCH_TARGETS \
+    __attribute__((target_clones("avx512f","avx2","default")))
+#else
+#define CALCULATE_SPLINE_BATCH_TARGETS
+#endif
+
+// Tell the compiler that the iterations are independent.
+#if defined(__clang__)
+#define CALCULATE_SPLINE_BATCH_IVDEP _Pragma("clang loop vectorize(enable)")
+#elif defined(__GNUC__)
+#define CALCULATE_SPLINE_BATCH_IVDEP _Pragma("GCC ivdep")
+#else
+#define CALCULATE_SPLINE_BATCH_IVDEP
+#endif
+
+// NOTE: The loops for the splines with uniformly spaced knots repeat the
+// calculation done in CalculateCompactSpline, CalculateUniformSpline and
+// CalculateMonotonicSpline, but address the spline data with an index into
+// the common buffer (instead of a pointer to the spline).  This is what lets
+// the compiler use gathered loads.  The "if" statements have been replaced
+// by min and max so the loops don't have any control flow.  Any change to
+// the single spline functions needs to be mirrored here.
+
+namespace {
+    inline int ClampIndex(int i, int lo, int hi) {
+        return (i < lo) ? lo : ((i > hi) ? hi : i);
+    }
+
+    inline double ClampValue(double v, double lo, double hi) {
+        v = (v < lo) ? lo : v;
+        return (v > hi) ? hi : v;
+    }
+}
+
+CALCULATE_SPLINE_BATCH_TARGETS
+void CalculateCompactSplineBatch(int n, const double* __restrict__ x,
+                                 double lowerBound, double upperBound,
+                                 const DEVICE_FLOATING_POINT* __restrict__ data,
+                                 const int* __restrict__ index,
+                                 double* __restrict__ results) {
+    CALCULATE_SPLINE_BATCH_IVDEP
+    for (int i = 0; i < n; ++i) {
+        const int id0 = index[i];
+        const int dim = index[i+1] - id0 - 2;
+
+        const double low = data[id0];
+        const double step = data[id0+1];
+        const double xx = (x[i]-low)/step;
+        // Same as "(xx<0) ? xx-1: xx" when converted to an integer.
+        const int ix = int(xx) - (xx < 0.0 ? 1 : 0);
+
+        const int d21_0 = ClampIndex(ix-1, 0, dim-2);
+        const int d32_0 = ClampIndex(ix, 0, dim-2);
+        const int d43_0 = ClampIndex(ix+1, 0, dim-2);
+
+        const double p2 = data[id0+2+d32_0];
+        const double p3 = data[id0+3+d32_0];
+        const double fx = xx-d32_0;
+
+        const double d21 = data[id0+3+d21_0] - data[id0+2+d21_0];
+        const double d32 = p3-p2;
+        const double d43 = data[id0+3+d43_0] - data[id0+2+d43_0];
+
+        const double m2 = 0.5*(d21+d32);
+        const double m3 = 0.5*(d32+d43);
+
+        const double v = ((((2.0*p2 - 2.0*p3 + m3 + m2)*fx
+                            + 3.0*p3 - 3.0*p2 - m3 - 2.0*m2)*fx
+                           +m2)*fx
+                          +p2);
+
+        results[i] = ClampValue(v, lowerBound, upperBound);
+    }
+}
+
+CALCULATE_SPLINE_BATCH_TARGETS
+void CalculateUniformSplineBatch(int n, const double* __restrict__ x,
+                                 double lowerBound, double upperBound,
+                                 const DEVICE_FLOATING_POINT* __restrict__ data,
+                                 const int* __restrict__ index,
+                                 double* __restrict__ results) {
+    CALCULATE_SPLINE_BATCH_IVDEP
+    for (int i = 0; i < n; ++i) {
+        const int id0 = index[i];
+        const int dim = index[i+1] - id0;
+
+        const double step = data[id0+1];
+        const double xx = (x[i]-data[id0])/step;
+        int ix = xx;
+        ix = (ix < 0) ? 0 : ix;
+        ix = (2*ix+7 > dim) ? (dim-2)/2 - 2 : ix;
+
+        const double fx = xx-ix;
+
+        const double p1 = data[id0+2+2*ix];
+        const double m1 = data[id0+2+2*ix+1]*step;
+        const double p2 = data[id0+2+2*ix+2];
+        const double m2 = data[id0+2+2*ix+3]*step;
+
+        const double v = ((((2.0*p1 - 2.0*p2 + m2 + m1)*fx
+                            + 3.0*p2 - 3.0*p1 - m2 - 2.0*m1)*fx
+                           +m1)*fx
+                          +p1);
+
+        results[i] = ClampValue(v, lowerBound, upperBound);
+    }
+}
+
+// The general spline has to search for the knot, so it's left to
+// CalculateGeneralSpline.  The loop doesn't vectorize as well as the uniform
+// splines, but it still avoids the virtual calls.
+CALCULATE_SPLINE_BATCH_TARGETS
+void CalculateGeneralSplineBatch(int n, const double* __restrict__ x,
+                                 double lowerBound, double upperBound,
+                                 const DEVICE_FLOATING_POINT* __restrict__ data,
+                                 const int* __restrict__ index,
+                                 double* __restrict__ results) {
+    for (int i = 0; i < n; ++i) {
+        const int id0 = index[i];
+        const int dim = index[i+1] - id0;
+        results[i] = CalculateGeneralSpline(x[i], lowerBound, upperBound,
+                                            &data[id0], dim);
+    }
+}
+
+CALCULATE_SPLINE_BATCH_TARGETS
+void CalculateMonotonicSplineBatch(int n, const double* __restrict__ x,
+                                   double lowerBound, double upperBound,
+                                   const DEVICE_FLOATING_POINT* __restrict__ data,
+                                   const int* __restrict__ index,
+                                   double* __restrict__ results) {
+    CALCULATE_SPLINE_BATCH_IVDEP
+    for (int i = 0; i < n; ++i) {
+        const int id0 = index[i];
+        const int dim = index[i+1] - id0 - 2;
+
+        const double low = data[id0];
+        const double step = data[id0+1];
+        const double xx = (x[i]-low)/step;
+        const int ix = int(xx) - (xx < 0.0 ? 1 : 0);
+
+        const int d21_0 = ClampIndex(ix-1, 0, dim-2);
+        const int d32_0 = ClampIndex(ix, 0, dim-2);
+        const int d43_0 = ClampIndex(ix+1, 0, dim-2);
+
+        const double p2 = data[id0+2+d32_0];
+        const double p3 = data[id0+3+d32_0];
+        const double fx = xx-d32_0;
+
+        const double d21 = data[id0+3+d21_0] - data[id0+2+d21_0];
+        const double d32 = p3-p2;
+        const double d43 = data[id0+3+d43_0] - data[id0+2+d43_0];
+
+        double m2 = 0.5*(d21+d32);
+        double m3 = 0.5*(d32+d43);
+
+        // Apply the Fritsh-Carlson monotonic condition to the slopes (see
+        // CalculateMonotonicSpline).
+        m2 = (d32*d21 <= 0.0) ? 0.0 : m2;
+        m3 = (d43*d32 <= 0.0) ? 0.0 : m3;
+
+        const double ad21 = (d21<0) ? -d21: d21;
+        const double ad32 = (d32<0) ? -d32: d32;
+        const double ad43 = (d43<0) ? -d43: d43;
+
+        const double delta2 = 3.0*((ad21 < ad32) ? ad21 : ad32);
+        const double delta3 = 3.0*((ad32 < ad43) ? ad32 : ad43);
+
+        m2 = ClampValue(m2, -delta2, delta2);
+        m3 = ClampValue(m3, -delta3, delta3);
+
+        const double v = ((((2.0*p2 - 2.0*p3 + m3 + m2)*fx
+                            + 3.0*p3 - 3.0*p2 - m3 - 2.0*m2)*fx
+                           +m2)*fx
+                          +p2);
+
+        results[i] = ClampValue(v, lowerBound, upperBound);
+    }
+}
+
+// The shared-knot splines don't depend on the spline data type: only
+// compiled once.
+#ifndef CALCULATE_SPLINE_BATCH_FLOAT_DATA
+CALCULATE_SPLINE_BATCH_TARGETS
+void CalculateSharedKnotSplineBatch(int n, const double* __restrict__ fxPowers,
+                                    double lowerBound, double upperBound,
+                                    const double* __restrict__ coefficients,
+                                    double* __restrict__ results) {
+    const double f0 = fxPowers[0];
+    const double f1 = fxPowers[1];
+    const double f2 = fxPowers[2];
+    const double f3 = fxPowers[3];
+    CALCULATE_SPLINE_BATCH_IVDEP
+    for (int i = 0; i < n; ++i) {
+        const double* c = coefficients + 4*i;
+        const double v = c[0]*f0 + c[1]*f1 + c[2]*f2 + c[3]*f3;
+        results[i] = ClampValue(v, lowerBound, upperBound);
+    }
+}
+#endif
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:4
+// compile-command:"$(git rev-parse --show-toplevel)/cmake/gundam-build.sh"
+// End:
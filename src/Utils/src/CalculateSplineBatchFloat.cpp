@@ -0,0 +1,12 @@
+// Compile the batch loops of CalculateSplineBatch.cpp a second time for the
+// spline data stored in single precision (used by the Cache::Manager when
+// the weight buffers are compiled with GUNDAM_FLOAT_WEIGHTS).
+#define CALCULATE_SPLINE_BATCH_FLOAT_DATA
+#define DEVICE_FLOATING_POINT float
+#include "CalculateSplineBatch.cpp"
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:4
+// compile-command:"$(git rev-parse --show-toplevel)/cmake/gundam-build.sh"
+// End:
@@ -0,0 +1,319 @@
+//
+// Selection cuts and formulas compiled into a small stack bytecode.
+//
+
+#include "CompiledFormula.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <cstdlib>
+#include <cctype>
+#include <cmath>
+
+
+/// Recursive descent parser emitting the instructions in reverse polish order
+class CompiledFormula::Parser{
+
+public:
+  Parser(CompiledFormula& formula_, Syntax syntax_) : _formula_(formula_), _syntax_(syntax_), _str_(formula_._expression_) {}
+
+  void parse(){
+    this->parseExpression(0);
+    this->skipSpaces();
+    if( _pos_ != _str_.size() ){ this->fail("unexpected \"" + _str_.substr(_pos_) + "\""); }
+  }
+
+private:
+  struct BinaryOperator{ const char* symbol; int precedence; OpCode opCode; };
+  struct Function{ const char* name; int nArgs; OpCode opCode; bool isInTreeFormula; };
+
+  [[noreturn]] void fail(const std::string& message_){ throw std::invalid_argument(message_); }
+  void skipSpaces(){ while( _pos_ < _str_.size() and std::isspace(_str_[_pos_]) ){ _pos_++; } }
+  bool consume(const char* symbol_){
+    this->skipSpaces();
+    std::string symbol{symbol_};
+    if( _str_.compare(_pos_, symbol.size(), symbol) != 0 ){ return false; }
+    _pos_ += symbol.size();
+    return true;
+  }
+  void emit(OpCode opCode_, int variableIndex_ = -1, double constant_ = 0){
+    _formula_._instructionList_.push_back({opCode_, variableIndex_, constant_});
+  }
+  static bool isIdentifierChar(char c_){ return std::isalnum(c_) or c_ == '_' or c_ == '.' or c_ == ':'; }
+
+  // operators are tried in this order: the longest symbols first
+  const BinaryOperator* findBinaryOperator(){
+    static const std::vector<BinaryOperator> operatorList{
+        {"||", 1, OpCode::Or}, {"&&", 2, OpCode::And},
+        {"==", 3, OpCode::Equal}, {"!=", 3, OpCode::NotEqual},
+        {"<=", 4, OpCode::LessEqual}, {">=", 4, OpCode::GreaterEqual},
+        {"<", 4, OpCode::Less}, {">", 4, OpCode::Greater},
+        {"+", 5, OpCode::Add}, {"-", 5, OpCode::Subtract},
+        {"*", 6, OpCode::Multiply}, {"/", 6, OpCode::Divide}
+    };
+    this->skipSpaces();
+    for( auto& binaryOperator : operatorList ){
+      std::string symbol{binaryOperator.symbol};
+      if( _str_.compare(_pos_, symbol.size(), symbol) != 0 ){ continue; }
+      // not supported: "**", "|", "&"
+      if( _pos_ + symbol.size() < _str_.size() ){
+        char next{_str_[_pos_ + symbol.size()]};
+        if( symbol == "*" and next == '*' ){ this->fail("\"**\" is not supported"); }
+      }
+      return &binaryOperator;
+    }
+    return nullptr;
+  }
+
+  void parseExpression(int minPrecedence_){
+    this->parseUnary();
+    while( true ){
+      auto* binaryOperator = this->findBinaryOperator();
+      if( binaryOperator == nullptr or binaryOperator->precedence < minPrecedence_ ){ break; }
+      _pos_ += std::string(binaryOperator->symbol).size();
+      this->parseExpression(binaryOperator->precedence + 1); // left associative
+      if( binaryOperator->opCode == OpCode::Divide and _syntax_ == Syntax::TTreeFormula ){ this->emit(OpCode::ProtectedDivide); }
+      else{ this->emit(binaryOperator->opCode); }
+    }
+  }
+  void parseUnary(){
+    this->skipSpaces();
+    if( _str_.compare(_pos_, 2, "!=") != 0 and this->consume("!") ){ this->parseUnary(); this->emit(OpCode::Not); return; }
+    if( this->consume("-") ){ this->parseUnary(); this->emit(OpCode::Negate); return; }
+    if( this->consume("+") ){ this->parseUnary(); return; }
+    this->parsePrimary();
+  }
+  void parsePrimary(){
+    this->skipSpaces();
+    if( _pos_ >= _str_.size() ){ this->fail("unexpected end of expression"); }
+    char c{_str_[_pos_]};
+
+    if( c == '(' ){
+      _pos_++;
+      this->parseExpression(0);
+      if( not this->consume(")") ){ this->fail("missing \")\""); }
+      return;
+    }
+
+    if( std::isdigit(c) or c == '.' ){
+      const char* begin{_str_.c_str() + _pos_};
+      char* end{nullptr};
+      double value{std::strtod(begin, &end)};
+      if( end == begin ){ this->fail("invalid number"); }
+      _pos_ += size_t(end - begin);
+      if( _pos_ < _str_.size() and isIdentifierChar(_str_[_pos_]) ){ this->fail("invalid number"); }
+      this->emit(OpCode::PushConstant, -1, value);
+      return;
+    }
+
+    if( c == '[' ){
+      if( _syntax_ != Syntax::TFormula ){ this->fail("indexed leaves are not supported"); }
+      auto end = _str_.find(']', _pos_);
+      if( end == std::string::npos ){ this->fail("missing \"]\""); }
+      this->emitVariable( _str_.substr(_pos_ + 1, end - _pos_ - 1) );
+      _pos_ = end + 1;
+      return;
+    }
+
+    if( std::isalpha(c) or c == '_' ){
+      size_t begin{_pos_};
+      while( _pos_ < _str_.size() and isIdentifierChar(_str_[_pos_]) ){ _pos_++; }
+      std::string name{_str_.substr(begin, _pos_ - begin)};
+      if( this->consume("(") ){ this->parseFunction(name); return; }
+      if( _syntax_ != Syntax::TTreeFormula ){ this->fail("unknown identifier \"" + name + "\""); }
+      if( name.find(':') != std::string::npos ){ this->fail("unknown identifier \"" + name + "\""); }
+      this->skipSpaces();
+      if( _pos_ < _str_.size() and _str_[_pos_] == '[' ){ this->fail("indexed leaves are not supported"); }
+      this->emitVariable(name);
+      return;
+    }
+
+    this->fail(std::string("unexpected \"") + c + "\"");
+  }
+  void parseFunction(const std::string& name_){
+    static const std::vector<Function> functionList{
+        {"abs", 1, OpCode::Abs, true}, {"fabs", 1, OpCode::Abs, true}, {"TMath::Abs", 1, OpCode::Abs, true},
+        {"TMath::Min", 2, OpCode::Min, true}, {"TMath::Max", 2, OpCode::Max, true},
+        {"sqrt", 1, OpCode::Sqrt, false}, {"TMath::Sqrt", 1, OpCode::Sqrt, false},
+        {"exp", 1, OpCode::Exp, false}, {"TMath::Exp", 1, OpCode::Exp, false},
+        {"log", 1, OpCode::Log, false}, {"TMath::Log", 1, OpCode::Log, false},
+        {"log10", 1, OpCode::Log10, false}, {"TMath::Log10", 1, OpCode::Log10, false},
+        {"sin", 1, OpCode::Sin, false}, {"TMath::Sin", 1, OpCode::Sin, false},
+        {"cos", 1, OpCode::Cos, false}, {"TMath::Cos", 1, OpCode::Cos, false},
+        {"tan", 1, OpCode::Tan, false}, {"TMath::Tan", 1, OpCode::Tan, false},
+        {"asin", 1, OpCode::ASin, false}, {"TMath::ASin", 1, OpCode::ASin, false},
+        {"acos", 1, OpCode::ACos, false}, {"TMath::ACos", 1, OpCode::ACos, false},
+        {"atan", 1, OpCode::ATan, false}, {"TMath::ATan", 1, OpCode::ATan, false},
+        {"atan2", 2, OpCode::ATan2, false}, {"TMath::ATan2", 2, OpCode::ATan2, false},
+        {"pow", 2, OpCode::Power, false}, {"TMath::Power", 2, OpCode::Power, false}
+    };
+
+    // ROOT v5 protects some of the functions (log of a negative number...):
+    // those are left to TTreeFormula
+    auto function = std::find_if(functionList.begin(), functionList.end(), [&](const Function& f_){
+      return name_ == f_.name and ( _syntax_ == Syntax::TFormula or f_.isInTreeFormula );
+    });
+    if( function == functionList.end() ){ this->fail("unsupported function \"" + name_ + "\""); }
+
+    for( int iArg = 0 ; iArg < function->nArgs ; iArg++ ){
+      if( iArg != 0 and not this->consume(",") ){ this->fail("missing argument for \"" + name_ + "\""); }
+      this->parseExpression(0);
+    }
+    if( not this->consume(")") ){ this->fail("missing \")\" for \"" + name_ + "\""); }
+    this->emit(function->opCode);
+  }
+  void emitVariable(const std::string& name_){
+    auto& nameList = _formula_._variableNameList_;
+    auto found = std::find(nameList.begin(), nameList.end(), name_);
+    if( found == nameList.end() ){
+      if( nameList.size() >= maxNbVariables ){ this->fail("too many variables"); }
+      nameList.emplace_back(name_);
+      found = nameList.end() - 1;
+    }
+    this->emit(OpCode::PushVariable, int(std::distance(nameList.begin(), found)));
+  }
+
+  CompiledFormula& _formula_;
+  Syntax _syntax_;
+  const std::string& _str_;
+  size_t _pos_{0};
+
+};
+
+
+bool CompiledFormula::compile(const std::string& expression_, Syntax syntax_){
+  _expression_ = expression_;
+  _errorMessage_.clear();
+  _variableNameList_.clear();
+  _instructionList_.clear();
+  _stackSize_ = 0;
+
+  try{
+    Parser(*this, syntax_).parse();
+
+    size_t depth{0};
+    for( auto& instruction : _instructionList_ ){
+      if     ( instruction.opCode <= OpCode::PushVariable ){ depth++; }
+      else if( instruction.opCode >= OpCode::Add ){ depth--; }
+      _stackSize_ = std::max(_stackSize_, depth);
+    }
+    if( _stackSize_ > maxStackSize ){ throw std::invalid_argument("expression too deep"); }
+  }
+  catch( const std::invalid_argument& e ){
+    _errorMessage_ = e.what();
+    _variableNameList_.clear();
+    _instructionList_.clear();
+    return false;
+  }
+  return true;
+}
+
+double CompiledFormula::evalUnary(OpCode opCode_, double a_){
+  switch( opCode_ ){
+    case OpCode::Negate: return -a_;
+    case OpCode::Not:    return a_ == 0 ? 1 : 0;
+    case OpCode::Abs:    return std::abs(a_);
+    case OpCode::Sqrt:   return std::sqrt(a_);
+    case OpCode::Exp:    return std::exp(a_);
+    case OpCode::Log:    return std::log(a_);
+    case OpCode::Log10:  return std::log10(a_);
+    case OpCode::Sin:    return std::sin(a_);
+    case OpCode::Cos:    return std::cos(a_);
+    case OpCode::Tan:    return std::tan(a_);
+    case OpCode::ASin:   return std::asin(a_);
+    case OpCode::ACos:   return std::acos(a_);
+    case OpCode::ATan:   return std::atan(a_);
+    default:             return std::nan("");
+  }
+}
+double CompiledFormula::evalBinary(OpCode opCode_, double a_, double b_){
+  switch( opCode_ ){
+    case OpCode::Add:             return a_ + b_;
+    case OpCode::Subtract:        return a_ - b_;
+    case OpCode::Multiply:        return a_ * b_;
+    case OpCode::Divide:          return a_ / b_;
+    case OpCode::ProtectedDivide: return b_ == 0 ? 0 : a_ / b_;
+    case OpCode::Power:           return std::pow(a_, b_);
+    case OpCode::ATan2:           return std::atan2(a_, b_);
+    case OpCode::Min:             return std::min(a_, b_);
+    case OpCode::Max:             return std::max(a_, b_);
+    case OpCode::Less:            return a_ < b_ ? 1 : 0;
+    case OpCode::LessEqual:       return a_ <= b_ ? 1 : 0;
+    case OpCode::Greater:         return a_ > b_ ? 1 : 0;
+    case OpCode::GreaterEqual:    return a_ >= b_ ? 1 : 0;
+    case OpCode::Equal:           return a_ == b_ ? 1 : 0;
+    case OpCode::NotEqual:        return a_ != b_ ? 1 : 0;
+    case OpCode::And:             return (a_ != 0 and b_ != 0) ? 1 : 0;
+    case OpCode::Or:              return (a_ != 0 or b_ != 0) ? 1 : 0;
+    default:                      return std::nan("");
+  }
+}
+
+double CompiledFormula::eval(const double* variableList_) const{
+  double stack[maxStackSize];
+  int top{-1};
+  for( auto& instruction : _instructionList_ ){
+    if     ( instruction.opCode == OpCode::PushConstant ){ stack[++top] = instruction.constant; }
+    else if( instruction.opCode == OpCode::PushVariable ){ stack[++top] = variableList_[instruction.variableIndex]; }
+    else if( instruction.opCode < OpCode::Add ){ stack[top] = evalUnary(instruction.opCode, stack[top]); }
+    else{ top--; stack[top] = evalBinary(instruction.opCode, stack[top], stack[top+1]); }
+  }
+  return stack[0];
+}
+void CompiledFormula::evalBatch(const std::vector<const double*>& columnList_, size_t nEntries_, double* output_) const{
+  if( nEntries_ == 0 ){ return; }
+
+  // one column per stack slot: the switch is done once per instruction
+  std::vector<double> stack(_stackSize_ * nEntries_);
+  auto slot = [&](int index_){ return &stack[size_t(index_) * nEntries_]; };
+  int top{-1};
+  for( auto& instruction : _instructionList_ ){
+    if( instruction.opCode == OpCode::PushConstant ){
+      top++;
+      std::fill(slot(top), slot(top) + nEntries_, instruction.constant);
+    }
+    else if( instruction.opCode == OpCode::PushVariable ){
+      top++;
+      std::copy(columnList_[instruction.variableIndex], columnList_[instruction.variableIndex] + nEntries_, slot(top));
+    }
+    else if( instruction.opCode < OpCode::Add ){
+      double* a{slot(top)};
+      switch( instruction.opCode ){
+        case OpCode::Negate: for( size_t i = 0 ; i < nEntries_ ; i++ ){ a[i] = -a[i]; } break;
+        case OpCode::Not:    for( size_t i = 0 ; i < nEntries_ ; i++ ){ a[i] = a[i] == 0 ? 1 : 0; } break;
+        case OpCode::Abs:    for( size_t i = 0 ; i < nEntries_ ; i++ ){ a[i] = std::abs(a[i]); } break;
+        default:             for( size_t i = 0 ; i < nEntries_ ; i++ ){ a[i] = evalUnary(instruction.opCode, a[i]); } break;
+      }
+    }
+    else{
+      top--;
+      double* a{slot(top)};
+      const double* b{slot(top+1)};
+      switch( instruction.opCode ){
+        case OpCode::Add:          for( size_t i = 0 ; i < nEntries_ ; i++ ){ a[i] = a[i] + b[i]; } break;
+        case OpCode::Subtract:     for( size_t i = 0 ; i < nEntries_ ; i++ ){ a[i] = a[i] - b[i]; } break;
+        case OpCode::Multiply:     for( size_t i = 0 ; i < nEntries_ ; i++ ){ a[i] = a[i] * b[i]; } break;
+        case OpCode::Divide:       for( size_t i = 0 ; i < nEntries_ ; i++ ){ a[i] = a[i] / b[i]; } break;
+        case OpCode::Less:         for( size_t i = 0 ; i < nEntries_ ; i++ ){ a[i] = a[i] < b[i] ? 1 : 0; } break;
+        case OpCode::LessEqual:    for( size_t i = 0 ; i < nEntries_ ; i++ ){ a[i] = a[i] <= b[i] ? 1 : 0; } break;
+        case OpCode::Greater:      for( size_t i = 0 ; i < nEntries_ ; i++ ){ a[i] = a[i] > b[i] ? 1 : 0; } break;
+        case OpCode::GreaterEqual: for( size_t i = 0 ; i < nEntries_ ; i++ ){ a[i] = a[i] >= b[i] ? 1 : 0; } break;
+        case OpCode::Equal:        for( size_t i = 0 ; i < nEntries_ ; i++ ){ a[i] = a[i] == b[i] ? 1 : 0; } break;
+        case OpCode::NotEqual:     for( size_t i = 0 ; i < nEntries_ ; i++ ){ a[i] = a[i] != b[i] ? 1 : 0; } break;
+        case OpCode::And:          for( size_t i = 0 ; i < nEntries_ ; i++ ){ a[i] = (a[i] != 0 and b[i] != 0) ? 1 : 0; } break;
+        case OpCode::Or:           for( size_t i = 0 ; i < nEntries_ ; i++ ){ a[i] = (a[i] != 0 or b[i] != 0) ? 1 : 0; } break;
+        default:                   for( size_t i = 0 ; i < nEntries_ ; i++ ){ a[i] = evalBinary(instruction.opCode, a[i], b[i]); } break;
+      }
+    }
+  }
+  std::copy(slot(0), slot(0) + nEntries_, output_);
+}
+
+std::string CompiledFormula::getSummary() const{
+  std::stringstream ss;
+  ss << "\"" << _expression_ << "\"";
+  if( not this->isValid() ){ ss << " (not compiled: " << _errorMessage_ << ")"; return ss.str(); }
+  ss << " (" << _instructionList_.size() << " instructions, " << _variableNameList_.size() << " variables)";
+  return ss.str();
+}
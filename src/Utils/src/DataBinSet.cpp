@@ -8,6 +8,7 @@
 #include "GenericToolbox.Json.h"
 #include "Logger.h"
 
+#include <algorithm>
 #include <string>
 #include <sstream>
 #include <stdexcept>
@@ -42,6 +43,7 @@ void DataBinSet::readBinningDefinition(const JsonType& binning_) {
 
   this->sortBinEdges();
   this->checkBinning();
+  this->buildBinLookupIndex();
 }
 
 void DataBinSet::checkBinning(){
@@ -122,6 +124,68 @@ void DataBinSet::sortBinEdges(){
     for( int iEdges = 0 ; iEdges < int(bin.getEdgesList().size()) ; iEdges++ ){ bin.getEdgesList()[iEdges].index = iEdges; }
   }
 }
+void DataBinSet::buildBinLookupIndex(){
+  _binLookupIndex_ = BinLookupIndex();
+  if( _binList_.size() < 2 ){ return; }
+
+  // pick the range variable which leaves the fewer candidates per slice
+  size_t bestNbCandidates{_binList_.size()};
+  for( auto& varName : this->buildVariableNameList() ){
+
+    BinLookupIndex lookup;
+    bool isValid{true};
+    for( auto& bin : _binList_ ){
+      auto* edgesPtr = bin.getVarEdgesPtr(varName);
+      // condition variables and missing variables are handled by the regular scan
+      if( edgesPtr == nullptr or edgesPtr->isConditionVar or not (edgesPtr->min < edgesPtr->max) ){ isValid = false; break; }
+      lookup.boundaryList.emplace_back( edgesPtr->min );
+      lookup.boundaryList.emplace_back( edgesPtr->max );
+    }
+    if( not isValid ){ continue; }
+
+    std::sort( lookup.boundaryList.begin(), lookup.boundaryList.end() );
+    lookup.boundaryList.erase( std::unique(lookup.boundaryList.begin(), lookup.boundaryList.end()), lookup.boundaryList.end() );
+
+    // slice iSlice is [ boundaryList[iSlice], boundaryList[iSlice+1] [
+    lookup.sliceBinIndexList.resize( lookup.boundaryList.size() - 1 );
+    for( int iBin = 0 ; iBin < int(_binList_.size()) ; iBin++ ){
+      auto* edgesPtr = _binList_[iBin].getVarEdgesPtr(varName);
+      auto iSliceBegin = std::lower_bound(lookup.boundaryList.begin(), lookup.boundaryList.end(), edgesPtr->min) - lookup.boundaryList.begin();
+      auto iSliceEnd = std::lower_bound(lookup.boundaryList.begin(), lookup.boundaryList.end(), edgesPtr->max) - lookup.boundaryList.begin();
+      for( auto iSlice = iSliceBegin ; iSlice < iSliceEnd ; iSlice++ ){
+        lookup.sliceBinIndexList[iSlice].emplace_back( iBin );
+      }
+    }
+
+    size_t nbCandidates{0};
+    for( auto& slice : lookup.sliceBinIndexList ){ nbCandidates = std::max(nbCandidates, slice.size()); }
+    if( nbCandidates >= bestNbCandidates ){ continue; }
+
+    bestNbCandidates = nbCandidates;
+    lookup.edgesIndex = _binList_[0].getVarEdgesPtr(varName)->index;
+    lookup.nBins = _binList_.size();
+    _binLookupIndex_ = std::move(lookup);
+  }
+
+  if( _binLookupIndex_.edgesIndex != -1 ){
+    LogDebug << "Bin lookup index for " << _name_ << ": using \""
+             << _binList_[0].getEdgesList()[_binLookupIndex_.edgesIndex].varName << "\" with at most "
+             << bestNbCandidates << " candidate bins per slice." << std::endl;
+  }
+}
+const DataBin::Edges* DataBinSet::getLookupEdgesPtr() const{
+  if( _binLookupIndex_.edgesIndex == -1 ){ return nullptr; }
+  if( _binLookupIndex_.nBins != _binList_.size() ){ return nullptr; } // outdated: fall back to the scan
+  return &_binList_[0].getEdgesList()[_binLookupIndex_.edgesIndex];
+}
+const std::vector<int>& DataBinSet::getBinCandidateList(double value_) const{
+  static const std::vector<int> emptyList{};
+  // first boundary strictly above the value
+  auto iSlice = std::upper_bound(_binLookupIndex_.boundaryList.begin(), _binLookupIndex_.boundaryList.end(), value_) - _binLookupIndex_.boundaryList.begin() - 1;
+  if( iSlice < 0 or iSlice >= int(_binLookupIndex_.sliceBinIndexList.size()) ){ return emptyList; }
+  return _binLookupIndex_.sliceBinIndexList[iSlice];
+}
+
 std::vector<std::string> DataBinSet::buildVariableNameList() const{
   std::vector<std::string> out;
   for( auto& bin : _binList_ ){
@@ -0,0 +1,69 @@
+//
+// Synthetic inputs shared by the GUNDAM micro-benchmarks.
+//
+
+#ifndef GUNDAM_BENCHMARK_UTILS_H
+#define GUNDAM_BENCHMARK_UTILS_H
+
+#include <TRandom3.h>
+#include <TGraph.h>
+#include <TH2D.h>
+
+#include <vector>
+#include <string>
+#include <memory>
+
+// The generators are seeded with a fixed value so the benchmarks always run
+// on the same dials and events: results can be compared across releases.
+namespace BenchmarkUtils {
+    const unsigned int defaultSeed{20240517};
+
+    inline TRandom3& GetRandom() {
+        static TRandom3 rng(defaultSeed);
+        return rng;
+    }
+
+    /// A smooth positive response with uniformly spaced knots over
+    /// [xMin, xMax] (valid for every spline and graph dial type).
+    inline TGraph MakeResponseGraph(int knots,
+                                    double xMin = -3.0, double xMax = 3.0) {
+        auto& rng = GetRandom();
+        const double slope = rng.Gaus(0.0, 0.1);
+        const double curvature = rng.Gaus(0.0, 0.02);
+        TGraph graph(knots);
+        for (int k = 0; k < knots; ++k) {
+            const double x = xMin + k*(xMax-xMin)/(knots-1);
+            double y = 1.0 + slope*x + curvature*x*x + rng.Gaus(0.0, 0.01);
+            if (y < 0.05) y = 0.05;
+            graph.SetPoint(k, x, y);
+        }
+        return graph;
+    }
+
+    /// A positive response surface for the 2D dials.
+    inline TH2D MakeResponseSurface(int nx, int ny, const std::string& name,
+                                    double min = -3.0, double max = 3.0) {
+        auto& rng = GetRandom();
+        TH2D hist(name.c_str(), name.c_str(), nx, min, max, ny, min, max);
+        hist.SetDirectory(nullptr);
+        for (int i = 1; i <= nx; ++i) {
+            for (int j = 1; j <= ny; ++j) {
+                hist.SetBinContent(i, j, rng.Uniform(0.5, 1.5));
+            }
+        }
+        return hist;
+    }
+
+    /// Parameter values the dials are evaluated at.  Some of them are outside
+    /// of the knots so the clamping is exercised too.
+    inline std::vector<double> MakeInputList(std::size_t n,
+                                             double min = -3.5,
+                                             double max = 3.5) {
+        auto& rng = GetRandom();
+        std::vector<double> out(n);
+        for (auto& value : out) value = rng.Uniform(min, max);
+        return out;
+    }
+}
+
+#endif //GUNDAM_BENCHMARK_UTILS_H
@@ -0,0 +1,118 @@
+//
+// Cost of the Cache::Manager kernels (host version).
+//
+
+#include "benchmarkUtils.h"
+
+#include "CacheParameters.h"
+#include "CacheWeights.h"
+#include "CacheIndexedSums.h"
+#include "CacheRecursiveSums.h"
+#include "WeightCompactSpline.h"
+#include "CompactSpline.h"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+#include <memory>
+
+// Same shape as the reweight benchmarks: the first argument is the number of
+// events (one result per event), the second the number of CompactSpline
+// dials per event (one parameter per dial).  The kernels are run with
+// HEMI_CUDA_DISABLE, so this times the CPU fallback of the Cache::Manager.
+namespace {
+    void CompactSplineWeights(benchmark::State& state) {
+        const int events = state.range(0);
+        const int dialsPerEvent = state.range(1);
+
+        std::vector<CompactSpline> dialList(events*dialsPerEvent);
+        std::size_t points{0};
+        for (auto& dial : dialList) {
+            dial.setAllowExtrapolation(false);
+            dial.buildDial(BenchmarkUtils::MakeResponseGraph(7));
+            points += dial.getDialData().size();
+        }
+
+        Cache::Parameters parameters(dialsPerEvent);
+        Cache::Weights weights(events);
+        Cache::Weight::CompactSpline splines(
+            weights.GetWeights(), parameters.GetParameters(),
+            parameters.GetLowerClamps(), parameters.GetUpperClamps(),
+            dialList.size(), points, "points");
+        weights.AddWeightCalculator(&splines);
+        for (int iEvent = 0; iEvent < events; ++iEvent) {
+            for (int iPar = 0; iPar < dialsPerEvent; ++iPar) {
+                splines.AddSpline(
+                    iEvent, iPar,
+                    dialList[iEvent*dialsPerEvent+iPar].getDialData());
+            }
+        }
+
+        const auto values = BenchmarkUtils::MakeInputList(1000, -3.0, 3.0);
+        std::size_t offset{0};
+        for (auto _ : state) {
+            for (int iPar = 0; iPar < dialsPerEvent; ++iPar) {
+                parameters.SetParameter(iPar,
+                                        values[(offset+iPar)%values.size()]);
+            }
+            ++offset;
+            weights.Apply();
+            benchmark::DoNotOptimize(weights.GetWeights().hostPtr());
+            benchmark::ClobberMemory();
+        }
+
+        state.SetItemsProcessed(state.iterations()*events);
+        state.counters["time/event"] = benchmark::Counter(
+            events, benchmark::Counter::kIsIterationInvariantRate
+            | benchmark::Counter::kInvert);
+    }
+
+    // The histogram sums.  Both sum the same weights in 100 bins.
+    template<typename SumsType>
+    void HistogramSums(benchmark::State& state) {
+        const int events = state.range(0);
+        const int bins = 100;
+
+        hemi::Array<double> weights(events);
+        for (int iEvent = 0; iEvent < events; ++iEvent) {
+            weights.hostPtr()[iEvent] =
+                BenchmarkUtils::GetRandom().Uniform(0.5, 1.5);
+        }
+
+        SumsType sums(weights, bins);
+        for (int iEvent = 0; iEvent < events; ++iEvent) {
+            sums.SetEventIndex(
+                iEvent, int(BenchmarkUtils::GetRandom().Integer(bins)));
+        }
+        sums.Initialize();
+
+        for (auto _ : state) {
+            sums.Reset();
+            sums.Apply();
+            benchmark::DoNotOptimize(sums.GetSum(0));
+        }
+
+        state.SetItemsProcessed(state.iterations()*events);
+        state.counters["time/event"] = benchmark::Counter(
+            events, benchmark::Counter::kIsIterationInvariantRate
+            | benchmark::Counter::kInvert);
+    }
+
+    void KernelArguments(benchmark::internal::Benchmark* bench) {
+        bench->ArgNames({"events", "dials"});
+        for (int events : {10000, 100000}) {
+            for (int dials : {1, 5}) bench->Args({events, dials});
+        }
+        bench->Unit(benchmark::kMicrosecond);
+    }
+
+    void SumsArguments(benchmark::internal::Benchmark* bench) {
+        bench->ArgNames({"events"});
+        for (int events : {10000, 100000}) bench->Args({events});
+        bench->Unit(benchmark::kMicrosecond);
+    }
+}
+
+BENCHMARK(CompactSplineWeights)->Apply(KernelArguments);
+BENCHMARK_TEMPLATE(HistogramSums, Cache::IndexedSums)->Apply(SumsArguments);
+BENCHMARK_TEMPLATE(HistogramSums, Cache::RecursiveSums)->Apply(SumsArguments);
@@ -0,0 +1,227 @@
+//
+// Cost of one dial evaluation for each of the DialBase implementations.
+//
+
+#include "benchmarkUtils.h"
+
+#include "DialBase.h"
+#include "DialInputBuffer.h"
+#include "Norm.h"
+#include "Shift.h"
+#include "Polynomial.h"
+#include "Graph.h"
+#include "LightGraph.h"
+#include "Spline.h"
+#include "SimpleSpline.h"
+#include "CompactSpline.h"
+#include "UniformSpline.h"
+#include "GeneralSpline.h"
+#include "MonotonicSpline.h"
+#include "Bilinear.h"
+#include "Bicubic.h"
+#include "Tabulated.h"
+#include "RootFormula.h"
+
+#include "CalculateSplineBatch.h"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include <algorithm>
+
+// Every benchmark evaluates a list of dials (of the same type) at a list of
+// inputs, one dial after the other as in the reweight loop, so the
+// per-iteration time divided by the number of dials is the cost of a single
+// evalResponse().  The first benchmark argument is the number of dials, the
+// second is the number of knots (or bins) of each dial.
+namespace {
+    using DialList = std::vector<std::unique_ptr<DialBase>>;
+    using DialFactory = std::function<DialList(int dials, int knots)>;
+
+    // Make the dials from a graph.  All the spline types use the same
+    // (uniformly spaced) graphs.
+    template<typename DialType>
+    DialList MakeGraphDials(int dials, int knots) {
+        DialList out;
+        out.reserve(dials);
+        for (int i = 0; i < dials; ++i) {
+            auto dial = std::make_unique<DialType>();
+            dial->setAllowExtrapolation(false);
+            dial->buildDial(BenchmarkUtils::MakeResponseGraph(knots));
+            out.emplace_back(std::move(dial));
+        }
+        return out;
+    }
+
+    // Make the two dimensional dials (knots x knots bins).
+    template<typename DialType>
+    DialList MakeSurfaceDials(int dials, int knots) {
+        DialList out;
+        out.reserve(dials);
+        for (int i = 0; i < dials; ++i) {
+            auto dial = std::make_unique<DialType>();
+            dial->setAllowExtrapolation(false);
+            dial->buildDial(BenchmarkUtils::MakeResponseSurface(
+                                knots, knots, "surface"));
+            out.emplace_back(std::move(dial));
+        }
+        return out;
+    }
+
+    DialList MakeNormDials(int dials, int) {
+        DialList out;
+        for (int i = 0; i < dials; ++i) out.emplace_back(std::make_unique<Norm>());
+        return out;
+    }
+
+    DialList MakeShiftDials(int dials, int) {
+        DialList out;
+        for (int i = 0; i < dials; ++i) {
+            auto dial = std::make_unique<Shift>();
+            dial->buildDial(BenchmarkUtils::GetRandom().Uniform(0.5, 1.5));
+            out.emplace_back(std::move(dial));
+        }
+        return out;
+    }
+
+    DialList MakePolynomialDials(int dials, int knots) {
+        DialList out;
+        for (int i = 0; i < dials; ++i) {
+            auto dial = std::make_unique<Polynomial>();
+            std::vector<double> coefficients{1.0};
+            for (int k = 1; k < knots; ++k) {
+                coefficients.push_back(
+                    BenchmarkUtils::GetRandom().Gaus(0.0, 0.1/k));
+            }
+            dial->setCoefficientList(coefficients);
+            dial->setSplineBounds({-3.0, 3.0});
+            dial->setAllowExtrapolation(false);
+            out.emplace_back(std::move(dial));
+        }
+        return out;
+    }
+
+    // The tabulated dials all look into the same table, as when they are
+    // filled by a TabulatedDialFactory.
+    DialList MakeTabulatedDials(int dials, int knots) {
+        static std::vector<double> table;
+        table = BenchmarkUtils::MakeInputList(knots+1, 0.5, 1.5);
+        DialList out;
+        for (int i = 0; i < dials; ++i) {
+            out.emplace_back(std::make_unique<Tabulated>(
+                                 &table, i%knots,
+                                 BenchmarkUtils::GetRandom().Uniform()));
+        }
+        return out;
+    }
+
+    DialList MakeRootFormulaDials(int dials, int) {
+        DialList out;
+        for (int i = 0; i < dials; ++i) {
+            auto dial = std::make_unique<RootFormula>();
+            dial->setFormulaStr("1 + 0.1*x + 0.01*x*x");
+            out.emplace_back(std::move(dial));
+        }
+        return out;
+    }
+
+    void DialEval(benchmark::State& state, const DialFactory& factory) {
+        const int dials = state.range(0);
+        const int knots = state.range(1);
+        const DialList dialList = factory(dials, knots);
+
+        // Two inputs per dial so the 2D dials can use the same loop.
+        const auto inputs = BenchmarkUtils::MakeInputList(2*dials);
+        DialInputBuffer buffer;
+        buffer.getInputBuffer().resize(2);
+
+        for (auto _ : state) {
+            double sum{0};
+            for (int i = 0; i < dials; ++i) {
+                buffer.getInputBuffer()[0] = inputs[2*i];
+                buffer.getInputBuffer()[1] = inputs[2*i+1];
+                sum += dialList[i]->evalResponse(buffer);
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+
+        state.SetItemsProcessed(state.iterations()*dials);
+        state.counters["time/eval"] = benchmark::Counter(
+            dials, benchmark::Counter::kIsIterationInvariantRate
+            | benchmark::Counter::kInvert);
+    }
+
+    // The same splines evaluated by the batch functions used in
+    // EventDialCache (one CALCULATE_SPLINE_BATCH_SIZE block at a time).
+    template<typename DialType>
+    void SplineBatchEval(benchmark::State& state,
+                         void (*batchFunction)(int, const double*,
+                                               double, double,
+                                               const double*,
+                                               const int*, double*)) {
+        const int dials = state.range(0);
+        const int knots = state.range(1);
+        const DialList dialList = MakeGraphDials<DialType>(dials, knots);
+
+        std::vector<double> data;
+        std::vector<int> index{0};
+        for (const auto& dial : dialList) {
+            const auto& dialData = dial->getDialData();
+            data.insert(data.end(), dialData.begin(), dialData.end());
+            index.emplace_back(int(data.size()));
+        }
+
+        const auto inputs = BenchmarkUtils::MakeInputList(dials);
+        std::vector<double> results(dials);
+
+        for (auto _ : state) {
+            for (int i = 0; i < dials; i += CALCULATE_SPLINE_BATCH_SIZE) {
+                const int n = std::min(CALCULATE_SPLINE_BATCH_SIZE, dials-i);
+                batchFunction(n, &inputs[i], -1E20, 1E20,
+                              data.data(), &index[i], &results[i]);
+            }
+            benchmark::DoNotOptimize(results.data());
+            benchmark::ClobberMemory();
+        }
+
+        state.SetItemsProcessed(state.iterations()*dials);
+        state.counters["time/eval"] = benchmark::Counter(
+            dials, benchmark::Counter::kIsIterationInvariantRate
+            | benchmark::Counter::kInvert);
+    }
+
+    // A "large" fit has a few hundred thousand dials per sample set, so 10k
+    // dials do not fit in L1 but mostly fit in L2.
+    void GraphArguments(benchmark::internal::Benchmark* bench) {
+        bench->ArgNames({"dials", "knots"});
+        for (int knots : {3, 7, 15}) bench->Args({10000, knots});
+    }
+
+    void SimpleArguments(benchmark::internal::Benchmark* bench) {
+        bench->ArgNames({"dials", "knots"});
+        bench->Args({10000, 3});
+    }
+}
+
+BENCHMARK_CAPTURE(DialEval, Norm, MakeNormDials)->Apply(SimpleArguments);
+BENCHMARK_CAPTURE(DialEval, Shift, MakeShiftDials)->Apply(SimpleArguments);
+BENCHMARK_CAPTURE(DialEval, Polynomial, MakePolynomialDials)->Apply(GraphArguments);
+BENCHMARK_CAPTURE(DialEval, Tabulated, MakeTabulatedDials)->Apply(GraphArguments);
+BENCHMARK_CAPTURE(DialEval, RootFormula, MakeRootFormulaDials)->Apply(SimpleArguments);
+BENCHMARK_CAPTURE(DialEval, Graph, MakeGraphDials<Graph>)->Apply(GraphArguments);
+BENCHMARK_CAPTURE(DialEval, LightGraph, MakeGraphDials<LightGraph>)->Apply(GraphArguments);
+BENCHMARK_CAPTURE(DialEval, Spline, MakeGraphDials<Spline>)->Apply(GraphArguments);
+BENCHMARK_CAPTURE(DialEval, SimpleSpline, MakeGraphDials<SimpleSpline>)->Apply(GraphArguments);
+BENCHMARK_CAPTURE(DialEval, CompactSpline, MakeGraphDials<CompactSpline>)->Apply(GraphArguments);
+BENCHMARK_CAPTURE(DialEval, UniformSpline, MakeGraphDials<UniformSpline>)->Apply(GraphArguments);
+BENCHMARK_CAPTURE(DialEval, GeneralSpline, MakeGraphDials<GeneralSpline>)->Apply(GraphArguments);
+BENCHMARK_CAPTURE(DialEval, MonotonicSpline, MakeGraphDials<MonotonicSpline>)->Apply(GraphArguments);
+BENCHMARK_CAPTURE(DialEval, Bilinear, MakeSurfaceDials<Bilinear>)->Apply(GraphArguments);
+BENCHMARK_CAPTURE(DialEval, Bicubic, MakeSurfaceDials<Bicubic>)->Apply(GraphArguments);
+
+BENCHMARK_CAPTURE(SplineBatchEval<CompactSpline>, CompactSpline, CalculateCompactSplineBatch)->Apply(GraphArguments);
+BENCHMARK_CAPTURE(SplineBatchEval<UniformSpline>, UniformSpline, CalculateUniformSplineBatch)->Apply(GraphArguments);
+BENCHMARK_CAPTURE(SplineBatchEval<GeneralSpline>, GeneralSpline, CalculateGeneralSplineBatch)->Apply(GraphArguments);
+BENCHMARK_CAPTURE(SplineBatchEval<MonotonicSpline>, MonotonicSpline, CalculateMonotonicSplineBatch)->Apply(GraphArguments);
@@ -0,0 +1,211 @@
+//
+// Cost of the event reweighting and of the histogram refill.
+//
+
+#include "benchmarkUtils.h"
+
+#include "EventDialCache.h"
+#include "DialCollection.h"
+#include "DialInterface.h"
+#include "DialInputBuffer.h"
+#include "DialResponseSupervisor.h"
+#include "CompactSpline.h"
+#include "ParameterSet.h"
+#include "SampleSet.h"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+#include <memory>
+
+// The benchmarks run on a synthetic sample: each event has one (event by
+// event) CompactSpline dial per parameter, and falls in a random bin of a
+// single sample.  The first benchmark argument is the number of events, the
+// second the number of dials per event.  EventDialCache::reweightEntry() is
+// private, so the reweight loop is timed through reweightEvents() which only
+// adds a loop over the entries.
+namespace {
+    class ReweightFixture {
+    public:
+        ReweightFixture(int events, int dialsPerEvent, int bins = 100) {
+            auto& rng = BenchmarkUtils::GetRandom();
+
+            // One parameter per dial of the event.
+            parSetList.emplace_back();
+            auto& parSet = parSetList.back();
+            for (int iPar = 0; iPar < dialsPerEvent; ++iPar) {
+                parSet.getParameterList().emplace_back(&parSet);
+                auto& par = parSet.getParameterList().back();
+                par.setParameterIndex(iPar);
+                par.setIsEnabled(true);
+                par.setPriorValue(0);
+                par.setStdDevValue(1);
+                par.setParameterValue(0);
+            }
+
+            // The sample with the events in random bins.
+            sampleSet.getSampleList().emplace_back();
+            auto& sample = sampleSet.getSampleList().back();
+            sample.setIndex(0);
+            for (int iBin = 0; iBin < bins; ++iBin) {
+                sample.getBinning().getBinList().emplace_back(iBin);
+            }
+            auto& container = sample.getMcContainer();
+            container.buildHistogram(sample.getBinning());
+            container.getEventList().resize(events);
+            for (int iEvent = 0; iEvent < events; ++iEvent) {
+                auto& event = container.getEventList()[iEvent];
+                event.getIndices().dataset = 0;
+                event.getIndices().entry = iEvent;
+                event.getIndices().sample = 0;
+                event.getIndices().bin = int(rng.Integer(bins));
+                event.getWeights().base = rng.Uniform(0.5, 1.5);
+                event.getWeights().resetCurrentWeight();
+            }
+
+            // One collection per parameter.  The vector must not be
+            // reallocated: the interfaces point into the collections.
+            supervisor.setMinResponse(0);
+            dialCollectionList.reserve(dialsPerEvent);
+            for (int iPar = 0; iPar < dialsPerEvent; ++iPar) {
+                dialCollectionList.emplace_back(&parSetList);
+                auto& collection = dialCollectionList.back();
+
+                collection.getDialInputBufferList().emplace_back();
+                auto& inputBuffer = collection.getDialInputBufferList().back();
+                inputBuffer.setParSetRef(&parSetList);
+                inputBuffer.addParameterReference({0, iPar});
+                inputBuffer.initialise();
+
+                collection.getDialBaseList().reserve(events);
+                collection.getDialInterfaceList().resize(events);
+                for (int iEvent = 0; iEvent < events; ++iEvent) {
+                    auto dial = std::make_shared<CompactSpline>();
+                    dial->setAllowExtrapolation(false);
+                    dial->buildDial(BenchmarkUtils::MakeResponseGraph(7));
+                    collection.getDialBaseList().emplace_back(dial);
+
+                    auto& dialInterface = collection.getDialInterfaceList()[iEvent];
+                    dialInterface.setDialBaseRef(dial.get());
+                    dialInterface.setInputBufferRef(&inputBuffer);
+                    dialInterface.setResponseSupervisorRef(&supervisor);
+                }
+            }
+
+            // Index the dials of each event as the DataDispenser does.
+            eventDialCache.allocateCacheEntries(events, dialsPerEvent);
+            for (int iEvent = 0; iEvent < events; ++iEvent) {
+                auto* entry = eventDialCache.fetchNextCacheEntry();
+                entry->event.sampleIndex = 0;
+                entry->event.eventIndex = iEvent;
+                for (int iPar = 0; iPar < dialsPerEvent; ++iPar) {
+                    entry->dials[iPar].collectionIndex = iPar;
+                    entry->dials[iPar].interfaceIndex = iEvent;
+                }
+            }
+            eventDialCache.buildReferenceCache(sampleSet, dialCollectionList);
+
+            // The events might have been sorted by the cache.
+            container.updateBinEventList();
+
+            // Start with the nominal responses.
+            propagate();
+        }
+
+        /// Move every parameter to a new value.
+        void moveParameters(const std::vector<double>& values, size_t offset) {
+            auto& parList = parSetList.front().getParameterList();
+            for (size_t iPar = 0; iPar < parList.size(); ++iPar) {
+                parList[iPar].setParameterValue(
+                    values[(offset+iPar)%values.size()]);
+            }
+        }
+
+        /// Same steps as the Propagator::reweightEvents() with one thread.
+        void propagate() {
+            for (auto& collection : dialCollectionList) {
+                for (auto& inputBuffer : collection.getDialInputBufferList()) {
+                    inputBuffer.update();
+                }
+            }
+            eventDialCache.updateDialResponses(-1, 0);
+            eventDialCache.prepareReweight();
+            eventDialCache.reweightEvents(-1, 0);
+        }
+
+        std::vector<ParameterSet> parSetList;
+        SampleSet sampleSet;
+        DialResponseSupervisor supervisor;
+        std::vector<DialCollection> dialCollectionList;
+        EventDialCache eventDialCache;
+    };
+
+    // Reweight every event with the cached dial responses (the dials are
+    // not evaluated).
+    void ReweightEvents(benchmark::State& state) {
+        const int events = state.range(0);
+        ReweightFixture fixture(events, state.range(1));
+
+        for (auto _ : state) {
+            fixture.eventDialCache.requestFullReweight();
+            fixture.eventDialCache.prepareReweight();
+            fixture.eventDialCache.reweightEvents(-1, 0);
+            benchmark::ClobberMemory();
+        }
+
+        state.SetItemsProcessed(state.iterations()*events);
+        state.counters["time/event"] = benchmark::Counter(
+            events, benchmark::Counter::kIsIterationInvariantRate
+            | benchmark::Counter::kInvert);
+    }
+
+    // Move all the parameters, then evaluate the dials and reweight: this is
+    // what a likelihood evaluation costs before the histograms are filled.
+    void UpdateAndReweight(benchmark::State& state) {
+        const int events = state.range(0);
+        ReweightFixture fixture(events, state.range(1));
+        const auto values = BenchmarkUtils::MakeInputList(1000, -3.0, 3.0);
+
+        size_t offset{0};
+        for (auto _ : state) {
+            fixture.moveParameters(values, offset++);
+            fixture.propagate();
+            benchmark::ClobberMemory();
+        }
+
+        state.SetItemsProcessed(state.iterations()*events);
+        state.counters["time/event"] = benchmark::Counter(
+            events, benchmark::Counter::kIsIterationInvariantRate
+            | benchmark::Counter::kInvert);
+    }
+
+    // Sum the event weights in the bins of the sample.
+    void RefillHistogram(benchmark::State& state) {
+        const int events = state.range(0);
+        ReweightFixture fixture(events, state.range(1));
+        auto& container =
+            fixture.sampleSet.getSampleList().front().getMcContainer();
+
+        for (auto _ : state) {
+            container.refillHistogram(-1);
+            benchmark::ClobberMemory();
+        }
+
+        state.SetItemsProcessed(state.iterations()*events);
+        state.counters["time/event"] = benchmark::Counter(
+            events, benchmark::Counter::kIsIterationInvariantRate
+            | benchmark::Counter::kInvert);
+    }
+
+    void ReweightArguments(benchmark::internal::Benchmark* bench) {
+        bench->ArgNames({"events", "dials"});
+        for (int events : {10000, 100000}) {
+            for (int dials : {1, 5}) bench->Args({events, dials});
+        }
+        bench->Unit(benchmark::kMicrosecond);
+    }
+}
+
+BENCHMARK(ReweightEvents)->Apply(ReweightArguments);
+BENCHMARK(UpdateAndReweight)->Apply(ReweightArguments);
+BENCHMARK(RefillHistogram)->Apply(ReweightArguments);
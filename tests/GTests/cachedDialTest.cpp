@@ -0,0 +1,122 @@
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cmath>
+
+#include "CachedDial.h"
+#include "CompactSpline.h"
+#include "DialInputBuffer.h"
+#include "ParameterSet.h"
+
+#include "gtest/gtest.h"
+
+// Check the response cache of the CachedDial: several threads evaluate the
+// same dial with their own input buffer, each restamped at every step, so
+// the cached response keeps being overwritten by the other threads.  A
+// cached response must always be the one of the buffer it is read for.
+namespace {
+    class CachedDialFixture {
+    public:
+        explicit CachedDialFixture(int buffers = 4) {
+            parSetList.emplace_back();
+            auto& parSet = parSetList.back();
+            for (int iPar = 0; iPar < buffers; ++iPar) {
+                parSet.getParameterList().emplace_back(&parSet);
+                auto& par = parSet.getParameterList().back();
+                par.setParameterIndex(iPar);
+                par.setIsEnabled(true);
+                par.setPriorValue(1);
+                par.setStdDevValue(1);
+                par.setParameterValue(1);
+            }
+
+            // One buffer per thread: a buffer is only updated by its own
+            // thread.
+            inputBufferList.resize(buffers);
+            for (int iPar = 0; iPar < buffers; ++iPar) {
+                auto& inputBuffer = inputBufferList[iPar];
+                inputBuffer.setParSetRef(&parSetList);
+                inputBuffer.addParameterReference({0, iPar});
+                inputBuffer.initialise();
+            }
+
+            std::vector<double> knots{-1.0, 0.0, 1.0, 2.0, 3.0};
+            std::vector<double> y;
+            std::vector<double> slopes;
+            for (double x : knots) {
+                y.push_back(1.0 + 0.3*std::sin(x));
+                slopes.push_back(0.3*std::cos(x));
+            }
+            dial.buildDial(knots, y, slopes);
+        }
+
+        std::vector<ParameterSet> parSetList;
+        std::vector<DialInputBuffer> inputBufferList;
+        CompactSplineCache dial;
+    };
+}
+
+TEST(cachedDialTest, ConcurrentEvaluation) {
+    const int nThreads = 4;
+    const int nSteps = 20000;
+    CachedDialFixture fixture(nThreads);
+
+    std::atomic<int> nMismatches{0};
+    std::atomic<int> nUnchangedEpochs{0};
+    std::vector<std::thread> threadList;
+    for (int iThread = 0; iThread < nThreads; ++iThread) {
+        threadList.emplace_back([&, iThread]() {
+            auto& inputBuffer = fixture.inputBufferList[iThread];
+            std::vector<std::vector<double>> parameterValueList(1, std::vector<double>(nThreads, 1.0));
+            for (int iStep = 0; iStep < nSteps; ++iStep) {
+                // a different value at each step, and for each thread
+                parameterValueList[0][iThread] = -0.9 + 3.8*double((iStep*7 + iThread*13) % 101)/100.;
+                const uint64_t previousEpoch = inputBuffer.getEpoch();
+                inputBuffer.update(parameterValueList);
+                if (inputBuffer.getEpoch() == previousEpoch) { ++nUnchangedEpochs; }
+
+                // the first call might fill the cache, the second might read it
+                const double expected = fixture.dial.evalUncachedResponse(inputBuffer);
+                for (int iEval = 0; iEval < 2; ++iEval) {
+                    if (fixture.dial.evalResponse(inputBuffer) != expected) { ++nMismatches; }
+                }
+            }
+        });
+    }
+    for (auto& thread : threadList) { thread.join(); }
+
+    EXPECT_EQ(nMismatches.load(), 0);
+    EXPECT_EQ(nUnchangedEpochs.load(), 0);
+}
+
+TEST(cachedDialTest, InvalidateEpoch) {
+    CachedDialFixture fixture(1);
+    auto& inputBuffer = fixture.inputBufferList.front();
+
+    fixture.parSetList.front().getParameterList().front().setParameterValue(1.5);
+    inputBuffer.update();
+    const uint64_t epoch = inputBuffer.getEpoch();
+    EXPECT_NE(epoch, 0u);
+    const double response = fixture.dial.evalResponse(inputBuffer);
+    EXPECT_TRUE(fixture.dial.isCacheValid(inputBuffer));
+    EXPECT_EQ(response, fixture.dial.evalUncachedResponse(inputBuffer));
+
+    // Edit the buffer by hand, as for the individual spline evaluations.
+    inputBuffer.invalidateEpoch();
+    inputBuffer.getInputBuffer()[0] = 0.25;
+    EXPECT_EQ(inputBuffer.getEpoch(), 0u);
+    EXPECT_FALSE(fixture.dial.isCacheValid(inputBuffer));
+    const double editedResponse = fixture.dial.evalResponse(inputBuffer);
+    EXPECT_EQ(editedResponse, fixture.dial.evalUncachedResponse(inputBuffer));
+    EXPECT_NE(editedResponse, response);
+
+    // The next update restamps the buffer with a new epoch, even if the
+    // parameter didn't move, so the response of the edited values can't be
+    // taken for the one of the parameter.
+    inputBuffer.update();
+    EXPECT_NE(inputBuffer.getEpoch(), 0u);
+    EXPECT_NE(inputBuffer.getEpoch(), epoch);
+    EXPECT_EQ(inputBuffer.getInputBuffer()[0], 1.5);
+    EXPECT_EQ(fixture.dial.evalResponse(inputBuffer), response);
+    EXPECT_TRUE(fixture.dial.isCacheValid(inputBuffer));
+}
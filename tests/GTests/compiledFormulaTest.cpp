@@ -0,0 +1,129 @@
+#include <vector>
+#include <string>
+#include <cmath>
+
+#include <TFormula.h>
+#include <TRandom.h>
+
+#include "CompiledFormula.h"
+
+#include "gtest/gtest.h"
+
+// Check that the compiled formulas give the same values as TFormula, and
+// that evalBatch() gives the same values as eval().
+namespace {
+    const std::vector<std::string> formulas{
+        "[a] > 0 && [b] < 0.5",
+        "([a] >= -0.5 && [a] < 0.5) || [c] == 1",
+        "!([a] > [b]) || [c] != 0",
+        "-[a]*[b] + 2.5e-1/[c] - -[a]",
+        "sqrt(abs([a])) * exp([b]) - TMath::Log10(1 + [c]*[c])",
+        "pow([a], 2) + TMath::Power([b], 3) - atan2([a], [b])",
+        "TMath::Max([a], [b]) - TMath::Min([b], [c])",
+    };
+
+    std::vector<std::vector<double>> MakeColumns(int entries) {
+        std::vector<std::vector<double>> columns(3);
+        for (int i = 0; i < entries; ++i) {
+            columns[0].push_back(gRandom->Uniform(-1.0, 1.0));
+            columns[1].push_back(gRandom->Uniform(-1.0, 1.0));
+            // Some exact zeros and ones for the comparisons.
+            columns[2].push_back(gRandom->Integer(3));
+        }
+        return columns;
+    }
+}
+
+TEST(compiledFormulaTest, SameAsTFormula) {
+    const int entries = 1000;
+    auto columns = MakeColumns(entries);
+
+    for (const auto& expression : formulas) {
+        CompiledFormula compiled;
+        ASSERT_TRUE(compiled.compile(expression,
+                                     CompiledFormula::Syntax::TFormula))
+            << expression << ": " << compiled.getErrorMessage();
+
+        TFormula formula("compiledFormulaTest", expression.c_str());
+        ASSERT_TRUE(formula.IsValid()) << expression;
+
+        std::vector<double> parameters(formula.GetNpar());
+        std::vector<double> variables(compiled.getVariableNameList().size());
+        for (int i = 0; i < entries; ++i) {
+            for (int iPar = 0; iPar < formula.GetNpar(); ++iPar) {
+                std::string name = formula.GetParName(iPar);
+                parameters[iPar] = columns[name[0]-'a'][i];
+            }
+            for (size_t iVar = 0; iVar < variables.size(); ++iVar) {
+                const std::string& name = compiled.getVariableNameList()[iVar];
+                variables[iVar] = columns[name[0]-'a'][i];
+            }
+            const double expected = formula.EvalPar(nullptr,
+                                                    parameters.data());
+            const double value = compiled.eval(variables.data());
+            if (std::isnan(expected)) {
+                EXPECT_TRUE(std::isnan(value)) << expression;
+                continue;
+            }
+            EXPECT_NEAR(value, expected, 1E-12*(1.0 + std::abs(expected)))
+                << expression << " for entry " << i;
+        }
+    }
+}
+
+TEST(compiledFormulaTest, BatchSameAsSingle) {
+    const int entries = 1000;
+    auto columns = MakeColumns(entries);
+
+    for (const auto& expression : formulas) {
+        CompiledFormula compiled;
+        ASSERT_TRUE(compiled.compile(expression,
+                                     CompiledFormula::Syntax::TFormula));
+
+        std::vector<const double*> columnList;
+        for (const auto& name : compiled.getVariableNameList()) {
+            columnList.push_back(columns[name[0]-'a'].data());
+        }
+        std::vector<double> results(entries);
+        compiled.evalBatch(columnList, entries, results.data());
+
+        std::vector<double> variables(columnList.size());
+        for (int i = 0; i < entries; ++i) {
+            for (size_t iVar = 0; iVar < columnList.size(); ++iVar) {
+                variables[iVar] = columnList[iVar][i];
+            }
+            const double expected = compiled.eval(variables.data());
+            if (std::isnan(expected)) {
+                EXPECT_TRUE(std::isnan(results[i])) << expression;
+                continue;
+            }
+            EXPECT_EQ(results[i], expected) << expression;
+        }
+    }
+}
+
+TEST(compiledFormulaTest, TreeFormulaSyntax) {
+    CompiledFormula compiled;
+    ASSERT_TRUE(compiled.compile("nu.E > 0.5 && abs(mode) != 2 || flag/0",
+                                 CompiledFormula::Syntax::TTreeFormula));
+    ASSERT_EQ(compiled.getVariableNameList().size(), 3);
+    EXPECT_EQ(compiled.getVariableNameList()[0], "nu.E");
+
+    // Same convention as ROOT v5: a division by zero gives zero.
+    double variables[3] = {1.0, -2.0, 1.0};
+    EXPECT_EQ(compiled.eval(variables), 0.0);
+    variables[1] = 1.0;
+    EXPECT_EQ(compiled.eval(variables), 1.0);
+
+    // Left to TTreeFormula.
+    const std::vector<std::string> unsupported{
+        "a[0] > 1", "Entry$ < 10", "a**2", "a % 2", "a & 1", "log(a)",
+        "[a] > 1", "a > 1 ?",
+    };
+    for (const auto& expression : unsupported) {
+        EXPECT_FALSE(compiled.compile(expression,
+                                      CompiledFormula::Syntax::TTreeFormula))
+            << expression;
+        EXPECT_FALSE(compiled.isValid());
+    }
+}
@@ -0,0 +1,81 @@
+#include <vector>
+#include <string>
+
+#include "DataBinSet.h"
+
+#include "gtest/gtest.h"
+
+// Check that the bin lookup index of DataBinSet gives the same bin as a
+// linear scan of the bin list, including after bins have been removed.
+namespace {
+    // Bins [i, i+1[ in x, and two bins in y for each of them.
+    void FillBins(DataBinSet& binSet) {
+        int iBin{0};
+        for (int ix = 0; ix < 10; ++ix) {
+            for (int iy = 0; iy < 2; ++iy) {
+                binSet.getBinList().emplace_back(iBin++);
+                binSet.getBinList().back().addBinEdge("x", ix, ix+1);
+                binSet.getBinList().back().addBinEdge("y", iy, iy+1);
+            }
+        }
+        binSet.sortBinEdges();
+    }
+
+    bool IsInBin(const DataBin& bin, double x, double y) {
+        return bin.isBetweenEdges("x", x) and bin.isBetweenEdges("y", y);
+    }
+
+    int ScanBins(const DataBinSet& binSet, double x, double y) {
+        auto& binList = binSet.getBinList();
+        for (int iBin = 0; iBin < int(binList.size()); ++iBin) {
+            if (IsInBin(binList[iBin], x, y)) return iBin;
+        }
+        return -1;
+    }
+
+    // Same logic as Variables::findBinIndex(const DataBinSet&).
+    int LookupBin(const DataBinSet& binSet, double x, double y) {
+        auto* edgesPtr = binSet.getLookupEdgesPtr();
+        if (edgesPtr == nullptr) return ScanBins(binSet, x, y);
+        const double value = (edgesPtr->varName == "x") ? x : y;
+        for (int iBin : binSet.getBinCandidateList(value)) {
+            if (IsInBin(binSet.getBinList()[iBin], x, y)) return iBin;
+        }
+        return -1;
+    }
+
+    void CheckLookup(const DataBinSet& binSet) {
+        for (double x = -0.75; x < 11; x += 0.5) {
+            for (double y = -0.25; y < 2.5; y += 0.5) {
+                EXPECT_EQ(LookupBin(binSet, x, y), ScanBins(binSet, x, y))
+                    << "x=" << x << ", y=" << y;
+            }
+        }
+    }
+}
+
+TEST(dataBinSetTest, LookupIndex) {
+    DataBinSet binSet;
+    FillBins(binSet);
+    binSet.buildBinLookupIndex();
+    ASSERT_NE(binSet.getLookupEdgesPtr(), nullptr);
+    CheckLookup(binSet);
+}
+
+TEST(dataBinSetTest, LookupIndexAfterBinRemoval) {
+    DataBinSet binSet;
+    FillBins(binSet);
+    binSet.buildBinLookupIndex();
+
+    // As DialCollection does for the bins without a valid dial.
+    binSet.getBinList().erase(binSet.getBinList().begin() + 7);
+    binSet.getBinList().erase(binSet.getBinList().begin() + 3);
+
+    // The outdated index must not be used.
+    EXPECT_EQ(binSet.getLookupEdgesPtr(), nullptr);
+    CheckLookup(binSet);
+
+    binSet.buildBinLookupIndex();
+    ASSERT_NE(binSet.getLookupEdgesPtr(), nullptr);
+    CheckLookup(binSet);
+}
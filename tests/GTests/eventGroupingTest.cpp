@@ -0,0 +1,245 @@
+#include <vector>
+#include <memory>
+#include <cmath>
+
+#include "EventDialCache.h"
+#include "DialCollection.h"
+#include "DialInterface.h"
+#include "DialInputBuffer.h"
+#include "DialResponseSupervisor.h"
+#include "Norm.h"
+#include "CompactSpline.h"
+#include "ParameterSet.h"
+#include "SampleSet.h"
+
+#include "gtest/gtest.h"
+
+// Check that grouping the events into super-events gives the same
+// histograms and the same event weights as reweighting every event.  Each
+// event has a norm and a spline shared with other events, and one event out
+// of five also gets its own spline, so it can't be grouped.
+namespace {
+    class GroupingFixture {
+    public:
+        explicit GroupingFixture(bool enableEventGrouping, int events = 1000, int norms = 8, int bins = 10) {
+            // The norms, then the parameter of the splines.
+            parSetList.emplace_back();
+            auto& parSet = parSetList.back();
+            for (int iPar = 0; iPar <= norms; ++iPar) {
+                parSet.getParameterList().emplace_back(&parSet);
+                auto& par = parSet.getParameterList().back();
+                par.setParameterIndex(iPar);
+                par.setIsEnabled(true);
+                par.setPriorValue(1);
+                par.setStdDevValue(1);
+                par.setParameterValue(1);
+            }
+
+            sampleSet.getSampleList().emplace_back();
+            auto& sample = sampleSet.getSampleList().back();
+            sample.setIndex(0);
+            for (int iBin = 0; iBin < bins; ++iBin) {
+                sample.getBinning().getBinList().emplace_back(iBin);
+            }
+            auto& container = sample.getMcContainer();
+            container.buildHistogram(sample.getBinning());
+            container.getEventList().resize(events);
+            for (int iEvent = 0; iEvent < events; ++iEvent) {
+                auto& event = container.getEventList()[iEvent];
+                event.getIndices().dataset = 0;
+                event.getIndices().entry = iEvent;
+                event.getIndices().sample = 0;
+                event.getIndices().bin = iEvent % bins;
+                event.getWeights().base = 0.5 + double(iEvent % 7) / 7.;
+                event.getWeights().resetCurrentWeight();
+            }
+
+            // The interfaces point into the collections: no reallocation.
+            dialCollectionList.reserve(norms + 2);
+            for (int iPar = 0; iPar < norms; ++iPar) {
+                auto& collection = addCollection(iPar);
+                addDial(collection, std::make_shared<Norm>());
+            }
+
+            // Three spline shapes shared by all the events, and one spline
+            // per event.
+            auto& sharedCollection = addCollection(norms);
+            for (int iShape = 0; iShape < 3; ++iShape) {
+                addDial(sharedCollection, makeSpline(0.1*(iShape+1), iShape));
+            }
+            auto& eventCollection = addCollection(norms);
+            for (int iEvent = 0; iEvent < events; ++iEvent) {
+                addDial(eventCollection, makeSpline(0.05, 0.01*iEvent));
+            }
+
+            eventDialCache.setEnableEventGrouping(enableEventGrouping);
+            eventDialCache.allocateCacheEntries(events, 3);
+            for (int iEvent = 0; iEvent < events; ++iEvent) {
+                auto* entry = eventDialCache.fetchNextCacheEntry();
+                entry->event.sampleIndex = 0;
+                entry->event.eventIndex = iEvent;
+                entry->dials[0].collectionIndex = iEvent % norms;
+                entry->dials[0].interfaceIndex = 0;
+                entry->dials[1].collectionIndex = norms;
+                entry->dials[1].interfaceIndex = (iEvent / bins) % 3;
+                if (iEvent % 5 == 0) {
+                    entry->dials[2].collectionIndex = norms + 1;
+                    entry->dials[2].interfaceIndex = iEvent;
+                }
+            }
+            eventDialCache.buildReferenceCache(sampleSet, dialCollectionList);
+            container.updateBinEventList();
+        }
+
+        void setParameter(int iPar, double value) {
+            parSetList.front().getParameterList()[iPar].setParameterValue(value);
+        }
+
+        /// Same steps as the Propagator::propagateParameters() with nThreads
+        /// threads for the histograms and the grouped event weights.
+        void propagate(int nThreads = 2) {
+            for (auto& collection : dialCollectionList) {
+                for (auto& inputBuffer : collection.getDialInputBufferList()) {
+                    inputBuffer.update();
+                }
+            }
+            eventDialCache.updateDialResponses(-1, 0);
+            eventDialCache.prepareReweight();
+            eventDialCache.reweightEvents(-1, 0);
+
+            if (eventDialCache.isEventGrouped()) {
+                for (int iThread = 0; iThread < nThreads; ++iThread) {
+                    eventDialCache.fillHistograms(sampleSet, iThread, nThreads);
+                }
+                for (int iThread = 0; iThread < nThreads; ++iThread) {
+                    eventDialCache.updateGroupedEventWeights(iThread, nThreads);
+                }
+            }
+            else {
+                sampleSet.getSampleList().front().getMcContainer().refillHistogram();
+            }
+        }
+
+        /// The current event weights, indexed by entry (the events might
+        /// have been sorted by the cache).
+        std::vector<double> getEventWeightList() {
+            auto& eventList = sampleSet.getSampleList().front().getMcContainer().getEventList();
+            std::vector<double> weightList(eventList.size(), std::nan("unset"));
+            for (auto& event : eventList) {
+                weightList[event.getIndices().entry] = event.getEventWeight();
+            }
+            return weightList;
+        }
+
+        std::vector<ParameterSet> parSetList;
+        SampleSet sampleSet;
+        DialResponseSupervisor supervisor;
+        std::vector<DialCollection> dialCollectionList;
+        EventDialCache eventDialCache;
+
+    private:
+        DialCollection& addCollection(int iPar) {
+            dialCollectionList.emplace_back(&parSetList);
+            auto& collection = dialCollectionList.back();
+            collection.getDialInputBufferList().emplace_back();
+            auto& inputBuffer = collection.getDialInputBufferList().back();
+            inputBuffer.setParSetRef(&parSetList);
+            inputBuffer.addParameterReference({0, iPar});
+            inputBuffer.initialise();
+            return collection;
+        }
+
+        void addDial(DialCollection& collection, const std::shared_ptr<DialBase>& dial) {
+            collection.getDialBaseList().emplace_back(dial);
+            collection.getDialInterfaceList().emplace_back();
+            auto& dialInterface = collection.getDialInterfaceList().back();
+            dialInterface.setDialBaseRef(dial.get());
+            dialInterface.setInputBufferRef(&collection.getDialInputBufferList().back());
+            dialInterface.setResponseSupervisorRef(&supervisor);
+        }
+
+        static std::shared_ptr<DialBase> makeSpline(double amplitude, double phase) {
+            std::vector<double> knots{-1.0, 0.0, 1.0, 2.0, 3.0};
+            std::vector<double> y;
+            std::vector<double> slopes;
+            for (double x : knots) {
+                y.push_back(1.0 + amplitude*std::sin(x + phase));
+                slopes.push_back(amplitude*std::cos(x + phase));
+            }
+            auto dial = std::make_shared<CompactSpline>();
+            dial->buildDial(knots, y, slopes);
+            return dial;
+        }
+    };
+
+    void CheckSameResults(GroupingFixture& grouped, GroupingFixture& reference) {
+        auto& binList = grouped.sampleSet.getSampleList().front().getMcContainer().getHistogram().binList;
+        auto& referenceBinList = reference.sampleSet.getSampleList().front().getMcContainer().getHistogram().binList;
+        ASSERT_EQ(binList.size(), referenceBinList.size());
+        for (size_t iBin = 0; iBin < binList.size(); ++iBin) {
+            EXPECT_NEAR(binList[iBin].content, referenceBinList[iBin].content,
+                        1E-9*std::abs(referenceBinList[iBin].content))
+                << "Bin " << iBin;
+            EXPECT_NEAR(binList[iBin].errorSquared, referenceBinList[iBin].errorSquared,
+                        1E-9*std::abs(referenceBinList[iBin].errorSquared))
+                << "Bin " << iBin;
+        }
+
+        const auto weightList = grouped.getEventWeightList();
+        const auto referenceWeightList = reference.getEventWeightList();
+        ASSERT_EQ(weightList.size(), referenceWeightList.size());
+        for (size_t iEvent = 0; iEvent < weightList.size(); ++iEvent) {
+            EXPECT_NEAR(weightList[iEvent], referenceWeightList[iEvent],
+                        1E-9*std::abs(referenceWeightList[iEvent]))
+                << "Event " << iEvent;
+        }
+    }
+}
+
+TEST(eventGroupingTest, Grouping) {
+    GroupingFixture grouped(true);
+    GroupingFixture reference(false);
+    EXPECT_TRUE(grouped.eventDialCache.isEventGrouped());
+    EXPECT_FALSE(reference.eventDialCache.isEventGrouped());
+    EXPECT_LT(grouped.eventDialCache.getNbEntries(), reference.eventDialCache.getNbEntries());
+}
+
+TEST(eventGroupingTest, MoveParameters) {
+    GroupingFixture grouped(true);
+    GroupingFixture reference(false);
+    grouped.propagate();
+    reference.propagate();
+    CheckSameResults(grouped, reference);
+
+    // One norm (incremental reweight), the shared spline parameter, then
+    // everything at once.
+    const std::vector<std::vector<std::pair<int, double>>> stepList{
+        {{0, 1.2}},
+        {{8, 1.7}},
+        {{1, 0.8}, {3, 1.1}, {5, 0.0}, {8, -0.4}},
+        {{0, 1.0}, {1, 1.0}, {2, 1.3}, {3, 0.6}, {4, 1.4}, {5, 0.9}, {6, 1.1}, {7, 0.7}, {8, 2.5}}
+    };
+    for (auto& step : stepList) {
+        for (auto& parValue : step) {
+            grouped.setParameter(parValue.first, parValue.second);
+            reference.setParameter(parValue.first, parValue.second);
+        }
+        grouped.propagate();
+        reference.propagate();
+        CheckSameResults(grouped, reference);
+    }
+}
+
+TEST(eventGroupingTest, ReweightCap) {
+    GroupingFixture grouped(true);
+    GroupingFixture reference(false);
+    for (auto* fixture : {&grouped, &reference}) {
+        auto& cap = fixture->eventDialCache.getGlobalEventReweightCap();
+        cap.isEnabled = true;
+        cap.maxReweight = 1.5;
+        fixture->setParameter(2, 1.6);
+        fixture->setParameter(8, 1.2);
+        fixture->propagate();
+    }
+    CheckSameResults(grouped, reference);
+}
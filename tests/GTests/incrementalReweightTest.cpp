@@ -0,0 +1,275 @@
+#include <vector>
+#include <memory>
+#include <cmath>
+
+#include "EventDialCache.h"
+#include "DialCollection.h"
+#include "DialInterface.h"
+#include "DialInputBuffer.h"
+#include "DialResponseSupervisor.h"
+#include "Norm.h"
+#include "ParameterSet.h"
+#include "SampleSet.h"
+
+#include "gtest/gtest.h"
+
+// Check that the incremental reweight gives the same event weights as a
+// full reweight, and that the incremental histogram update gives the same
+// bins as a refill, including after the MC weights have been thrown
+// outside of the propagation.  Each event has a single norm dial, shared
+// with the other events using the same parameter, so moving one parameter
+// only touches a fraction of the events.
+namespace {
+    class ReweightFixture {
+    public:
+        explicit ReweightFixture(int events = 1000, int parameters = 10, int bins = 20) {
+            parSetList.emplace_back();
+            auto& parSet = parSetList.back();
+            for (int iPar = 0; iPar < parameters; ++iPar) {
+                parSet.getParameterList().emplace_back(&parSet);
+                auto& par = parSet.getParameterList().back();
+                par.setParameterIndex(iPar);
+                par.setIsEnabled(true);
+                par.setPriorValue(1);
+                par.setStdDevValue(1);
+                par.setParameterValue(1);
+            }
+
+            sampleSet.getSampleList().emplace_back();
+            auto& sample = sampleSet.getSampleList().back();
+            sample.setIndex(0);
+            for (int iBin = 0; iBin < bins; ++iBin) {
+                sample.getBinning().getBinList().emplace_back(iBin);
+            }
+            auto& container = sample.getMcContainer();
+            container.buildHistogram(sample.getBinning());
+            container.getEventList().resize(events);
+            for (int iEvent = 0; iEvent < events; ++iEvent) {
+                auto& event = container.getEventList()[iEvent];
+                event.getIndices().dataset = 0;
+                event.getIndices().entry = iEvent;
+                event.getIndices().sample = 0;
+                event.getIndices().bin = iEvent % bins;
+                event.getWeights().base = 0.5 + double(iEvent % 7) / 7.;
+                event.getWeights().resetCurrentWeight();
+            }
+
+            // One collection with a single norm dial per parameter.  The
+            // vector must not be reallocated: the interfaces point into it.
+            dialCollectionList.reserve(parameters);
+            for (int iPar = 0; iPar < parameters; ++iPar) {
+                dialCollectionList.emplace_back(&parSetList);
+                auto& collection = dialCollectionList.back();
+
+                collection.getDialInputBufferList().emplace_back();
+                auto& inputBuffer = collection.getDialInputBufferList().back();
+                inputBuffer.setParSetRef(&parSetList);
+                inputBuffer.addParameterReference({0, iPar});
+                inputBuffer.initialise();
+
+                auto dial = std::make_shared<Norm>();
+                collection.getDialBaseList().emplace_back(dial);
+                collection.getDialInterfaceList().resize(1);
+                auto& dialInterface = collection.getDialInterfaceList().back();
+                dialInterface.setDialBaseRef(dial.get());
+                dialInterface.setInputBufferRef(&inputBuffer);
+                dialInterface.setResponseSupervisorRef(&supervisor);
+            }
+
+            eventDialCache.allocateCacheEntries(events, 1);
+            for (int iEvent = 0; iEvent < events; ++iEvent) {
+                auto* entry = eventDialCache.fetchNextCacheEntry();
+                entry->event.sampleIndex = 0;
+                entry->event.eventIndex = iEvent;
+                entry->dials[0].collectionIndex = iEvent % parameters;
+                entry->dials[0].interfaceIndex = 0;
+            }
+            eventDialCache.buildReferenceCache(sampleSet, dialCollectionList);
+
+            // The events might have been sorted by the cache.
+            container.updateBinEventList();
+        }
+
+        void setParameter(int iPar, double value) {
+            parSetList.front().getParameterList()[iPar].setParameterValue(value);
+        }
+
+        /// Same steps as the Propagator::reweightEvents() with one thread,
+        /// followed by the Propagator::refillMcHistograms() with nThreads
+        /// threads for the histogram.
+        void propagate(int nThreads = 1) {
+            auto& container = sampleSet.getSampleList().front().getMcContainer();
+            // The throws edit the histogram outside of the propagation.
+            const bool isInSync = (container.getExternalEditCount() == externalEditCount);
+            externalEditCount = container.getExternalEditCount();
+
+            for (auto& collection : dialCollectionList) {
+                for (auto& inputBuffer : collection.getDialInputBufferList()) {
+                    inputBuffer.update();
+                }
+            }
+            eventDialCache.updateDialResponses(-1, 0);
+            eventDialCache.prepareReweight();
+            eventDialCache.reweightEvents(-1, 0);
+
+            isHistogramUpdated = isInSync and eventDialCache.prepareHistogramUpdate(nThreads);
+            if (isHistogramUpdated) {
+                for (int iThread = 0; iThread < nThreads; ++iThread) {
+                    eventDialCache.updateHistograms(sampleSet, iThread);
+                }
+            }
+            else {
+                eventDialCache.resetHistogramUpdateCount();
+                container.refillHistogram();
+            }
+        }
+
+        /// Compare each bin of the histogram with a refill from the event
+        /// weights.
+        void checkAgainstRefill() {
+            auto& container = sampleSet.getSampleList().front().getMcContainer();
+            const auto binList = container.getHistogram().binList;
+            container.refillHistogram();
+
+            auto& refillList = container.getHistogram().binList;
+            ASSERT_EQ(binList.size(), refillList.size());
+            for (size_t iBin = 0; iBin < binList.size(); ++iBin) {
+                EXPECT_NEAR(binList[iBin].content, refillList[iBin].content,
+                            1E-6*std::abs(refillList[iBin].content) + 1E-9)
+                    << "Bin " << iBin;
+                EXPECT_NEAR(binList[iBin].errorSquared, refillList[iBin].errorSquared,
+                            1E-6*std::abs(refillList[iBin].errorSquared) + 1E-9)
+                    << "Bin " << iBin;
+                EXPECT_NEAR(binList[iBin].error, refillList[iBin].error,
+                            1E-6*std::abs(refillList[iBin].error) + 1E-9)
+                    << "Bin " << iBin;
+            }
+        }
+
+        /// Compare the event weights with a full reweight.
+        void checkAgainstFullReweight() {
+            auto& eventList = sampleSet.getSampleList().front().getMcContainer().getEventList();
+            std::vector<double> weights;
+            for (auto& event : eventList) weights.push_back(event.getEventWeight());
+
+            eventDialCache.requestFullReweight();
+            eventDialCache.prepareReweight();
+            eventDialCache.reweightEvents(-1, 0);
+
+            const int parameters = int(parSetList.front().getParameterList().size());
+            for (size_t i = 0; i < eventList.size(); ++i) {
+                auto& event = eventList[i];
+                const double expected = event.getWeights().base
+                    * parSetList.front().getParameterList()[
+                        event.getIndices().entry % parameters].getParameterValue();
+                EXPECT_NEAR(event.getEventWeight(), expected, 1E-6*expected)
+                    << "Event " << event.getIndices().entry;
+                EXPECT_NEAR(weights[i], event.getEventWeight(), 1E-6*expected)
+                    << "Event " << event.getIndices().entry;
+            }
+        }
+
+        bool isHistogramUpdated{false};
+        size_t externalEditCount{0};
+        std::vector<ParameterSet> parSetList;
+        SampleSet sampleSet;
+        DialResponseSupervisor supervisor;
+        std::vector<DialCollection> dialCollectionList;
+        EventDialCache eventDialCache;
+    };
+}
+
+TEST(incrementalReweightTest, MoveOneParameter) {
+    ReweightFixture fixture;
+    fixture.propagate();
+    EXPECT_FALSE(fixture.eventDialCache.isIncrementalReweight());
+
+    fixture.setParameter(0, 1.2);
+    fixture.propagate();
+    EXPECT_TRUE(fixture.eventDialCache.isIncrementalReweight());
+    fixture.checkAgainstFullReweight();
+}
+
+TEST(incrementalReweightTest, ThrowThenPropagate) {
+    ReweightFixture fixture;
+    auto& container = fixture.sampleSet.getSampleList().front().getMcContainer();
+    fixture.propagate();
+
+    // The throw rewrites the weights of every event: the next reweight has
+    // to reset all of them, not only the ones using the moved parameter.
+    container.throwEventMcError();
+    container.throwStatError();
+    fixture.setParameter(1, 0.8);
+    fixture.propagate();
+    EXPECT_FALSE(fixture.eventDialCache.isIncrementalReweight());
+    fixture.checkAgainstFullReweight();
+
+    // Back to the incremental mode once the weights are in sync.
+    fixture.setParameter(2, 1.1);
+    fixture.propagate();
+    EXPECT_TRUE(fixture.eventDialCache.isIncrementalReweight());
+    fixture.checkAgainstFullReweight();
+}
+
+TEST(incrementalReweightTest, HistogramUpdate) {
+    for (int nThreads : {1, 3}) {
+        ReweightFixture fixture;
+        fixture.propagate(nThreads);
+        EXPECT_FALSE(fixture.isHistogramUpdated);
+
+        // Several steps in a row, moving one or two parameters each time.
+        for (int iStep = 0; iStep < 8; ++iStep) {
+            fixture.setParameter(iStep % 10, 1.0 + 0.1*(iStep+1));
+            if (iStep % 3 == 0) fixture.setParameter((iStep+5) % 10, 0.9 - 0.05*iStep);
+            fixture.propagate(nThreads);
+            EXPECT_TRUE(fixture.isHistogramUpdated) << "Step " << iStep;
+            fixture.checkAgainstRefill();
+        }
+        fixture.checkAgainstFullReweight();
+    }
+}
+
+TEST(incrementalReweightTest, HistogramResum) {
+    ReweightFixture fixture;
+    fixture.eventDialCache.setHistogramResumPeriod(3);
+    fixture.propagate();
+
+    // Two incremental updates, then a refill, and the count starts over.
+    std::vector<bool> expected{true, true, false, true, true, false};
+    for (size_t iStep = 0; iStep < expected.size(); ++iStep) {
+        fixture.setParameter(int(iStep), 1.3);
+        fixture.propagate(2);
+        EXPECT_EQ(fixture.isHistogramUpdated, expected[iStep]) << "Step " << iStep;
+        fixture.checkAgainstRefill();
+    }
+}
+
+TEST(incrementalReweightTest, HistogramAfterThrows) {
+    ReweightFixture fixture;
+    auto& container = fixture.sampleSet.getSampleList().front().getMcContainer();
+    fixture.propagate();
+    fixture.setParameter(3, 1.4);
+    fixture.propagate(2);
+    EXPECT_TRUE(fixture.isHistogramUpdated);
+
+    // The throws set the bins and the weights together.
+    container.throwEventMcError();
+    fixture.checkAgainstRefill();
+    container.throwStatError();
+    fixture.checkAgainstRefill();
+
+    // The first propagation after the throws refills the histogram, the
+    // following ones are incremental again.
+    fixture.setParameter(4, 0.7);
+    fixture.propagate(2);
+    EXPECT_FALSE(fixture.isHistogramUpdated);
+    fixture.checkAgainstRefill();
+
+    for (int iStep = 0; iStep < 4; ++iStep) {
+        fixture.setParameter(5 + iStep, 1.2 + 0.1*iStep);
+        fixture.propagate(2);
+        EXPECT_TRUE(fixture.isHistogramUpdated) << "Step " << iStep;
+        fixture.checkAgainstRefill();
+    }
+    fixture.checkAgainstFullReweight();
+}
@@ -0,0 +1,429 @@
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstdio>
+#include <cmath>
+
+#include <TFile.h>
+#include <TMatrixDSym.h>
+
+#include "EventDialCache.h"
+#include "DialCollection.h"
+#include "DialInterface.h"
+#include "DialInputBuffer.h"
+#include "DialResponseSupervisor.h"
+#include "Norm.h"
+#include "CompactSpline.h"
+#include "GeneralSpline.h"
+#include "ParameterSet.h"
+#include "SampleSet.h"
+#include "JointProbability.h"
+
+#include "gtest/gtest.h"
+
+// Check the analytic gradient of the likelihood against a central
+// difference.  The steps are the ones of LikelihoodInterface::
+// evalLikelihoodGradient(): derivatives of the joint probability with respect
+// to the bins, chain rule through the event weights with the EventDialCache,
+// then through the eigen vectors, plus the derivative of the penalty.  The
+// parameter set has four correlated parameters: two norms, one compact
+// spline with a mirrored input and one general spline.
+namespace {
+    const std::vector<JointProbabilityType> jointProbabilityTypeList{
+        JointProbabilityType::PoissonLLH,
+        JointProbabilityType::Chi2,
+        JointProbabilityType::LeastSquares
+    };
+
+    std::unique_ptr<JointProbability::JointProbabilityBase> buildJointProbability(JointProbabilityType type) {
+        return std::unique_ptr<JointProbability::JointProbabilityBase>(
+            JointProbability::makeJointProbability(type));
+    }
+
+    class GradientFixture {
+    public:
+        explicit GradientFixture(bool useEigen, int events = 600, int bins = 7) {
+            // The covariance matrix has to come from a file.
+            const char* covFilePath{"likelihoodGradientTest.root"};
+            const double sigma[4]{0.2, 0.3, 0.5, 0.4};
+            TMatrixDSym cov(4);
+            for (int i = 0; i < 4; ++i) {
+                for (int j = 0; j < 4; ++j) {
+                    cov[i][j] = sigma[i]*sigma[j]*(i == j ? 1.0 : 0.3/std::abs(i-j));
+                }
+            }
+            std::unique_ptr<TFile> covFile(TFile::Open(covFilePath, "RECREATE"));
+            covFile->WriteObject(&cov, "cov");
+            covFile->Close();
+
+            JsonType config;
+            config["name"] = "gradientTest";
+            config["isEnabled"] = true;
+            config["parameterDefinitionFilePath"] = covFilePath;
+            config["covarianceMatrix"] = "cov";
+            config["enableEigenDecomp"] = useEigen;
+            parSetList.emplace_back();
+            parSetList.back().readConfig(config);
+            parSetList.back().initialize();
+            std::remove(covFilePath);
+
+            sampleSet.getSampleList().emplace_back();
+            auto& sample = sampleSet.getSampleList().back();
+            sample.setIndex(0);
+            for (int iBin = 0; iBin < bins; ++iBin) {
+                sample.getBinning().getBinList().emplace_back(iBin);
+            }
+            auto& container = sample.getMcContainer();
+            container.buildHistogram(sample.getBinning());
+            container.getEventList().resize(events);
+            for (int iEvent = 0; iEvent < events; ++iEvent) {
+                auto& event = container.getEventList()[iEvent];
+                event.getIndices().dataset = 0;
+                event.getIndices().entry = iEvent;
+                event.getIndices().sample = 0;
+                event.getIndices().bin = iEvent % bins;
+                event.getWeights().base = 0.5 + double(iEvent % 5) / 5.;
+                event.getWeights().resetCurrentWeight();
+            }
+
+            // One bin without data for the x*log(x) limit of the Poisson
+            // likelihood.
+            auto& dataContainer = sample.getDataContainer();
+            dataContainer.buildHistogram(sample.getBinning());
+            for (int iBin = 0; iBin < bins; ++iBin) {
+                dataContainer.getHistogram().binList[iBin].content = (iBin == 3 ? 0. : 60. + 10.*iBin);
+            }
+
+            // The interfaces point into the collections: no reallocation.
+            dialCollectionList.reserve(4);
+            for (int iPar = 0; iPar < 2; ++iPar) {
+                auto& collection = addCollection(iPar);
+                auto dial = std::make_shared<Norm>();
+                addDial(collection, dial);
+            }
+
+            // The compact spline input is mirrored on [0, 2].
+            auto& compactCollection = addCollection(2, 0., 2.);
+            for (int iShape = 0; iShape < 3; ++iShape) {
+                std::vector<double> knots{0.0, 0.5, 1.0, 1.5, 2.0};
+                std::vector<double> y;
+                std::vector<double> slopes;
+                for (double x : knots) {
+                    y.push_back(1.0 + 0.1*(iShape+1)*std::sin(1.3*x + iShape));
+                    slopes.push_back(0.13*(iShape+1)*std::cos(1.3*x + iShape));
+                }
+                auto dial = std::make_shared<CompactSpline>();
+                dial->buildDial(knots, y, slopes);
+                addDial(compactCollection, dial);
+            }
+
+            auto& generalCollection = addCollection(3);
+            for (int iShape = 0; iShape < 2; ++iShape) {
+                std::vector<double> knots{-0.5, 0.2, 0.8, 1.5, 2.5};
+                std::vector<double> y;
+                std::vector<double> slopes;
+                for (double x : knots) {
+                    y.push_back(1.0 + 0.15*(iShape+1)*std::cos(x + iShape));
+                    slopes.push_back(-0.15*(iShape+1)*std::sin(x + iShape));
+                }
+                auto dial = std::make_shared<GeneralSpline>();
+                dial->buildDial(knots, y, slopes);
+                addDial(generalCollection, dial);
+            }
+
+            // Each bin gets events from both norms.
+            eventDialCache.allocateCacheEntries(events, 4);
+            for (int iEvent = 0; iEvent < events; ++iEvent) {
+                auto* entry = eventDialCache.fetchNextCacheEntry();
+                entry->event.sampleIndex = 0;
+                entry->event.eventIndex = iEvent;
+                entry->dials[0].collectionIndex = iEvent % 2;
+                entry->dials[0].interfaceIndex = 0;
+                entry->dials[1].collectionIndex = 2;
+                entry->dials[1].interfaceIndex = iEvent % 3;
+                entry->dials[2].collectionIndex = 3;
+                entry->dials[2].interfaceIndex = (iEvent / 2) % 2;
+            }
+            eventDialCache.buildReferenceCache(sampleSet, dialCollectionList);
+            container.updateBinEventList();
+
+            isDerivativeCacheBuilt = eventDialCache.buildDerivativeCache({0});
+        }
+
+        ParameterSet& getParSet() { return parSetList.front(); }
+
+        /// Set the original parameters, and the eigen parameters matching
+        /// them.
+        void setValues(const std::vector<double>& values) {
+            auto& parList = getParSet().getParameterList();
+            for (size_t iPar = 0; iPar < values.size(); ++iPar) {
+                parList[iPar].setParameterValue(values[iPar]);
+            }
+            if (getParSet().isEnableEigenDecomp()) getParSet().propagateOriginalToEigen();
+        }
+
+        /// Move one of the fitted parameters (the eigen ones if the
+        /// decomposition is enabled).
+        void setEffectiveValue(size_t iPar, double value) {
+            getParSet().getEffectiveParameterList()[iPar].setParameterValue(value);
+            if (getParSet().isEnableEigenDecomp()) getParSet().propagateEigenToOriginal();
+        }
+
+        /// Same steps as the Propagator::propagateParameters() with one
+        /// thread.
+        void propagate() {
+            for (auto& collection : dialCollectionList) {
+                for (auto& inputBuffer : collection.getDialInputBufferList()) {
+                    inputBuffer.update();
+                }
+            }
+            eventDialCache.updateDialResponses(-1, 0);
+            eventDialCache.prepareReweight();
+            eventDialCache.reweightEvents(-1, 0);
+            sampleSet.getSampleList().front().getMcContainer().refillHistogram();
+        }
+
+        double evalLikelihood(const JointProbability::JointProbabilityBase& jointProbability) {
+            propagate();
+            return jointProbability.eval(sampleSet.getSampleList().front()) + getParSet().evalPenaltyChi2();
+        }
+
+        /// Same chain as LikelihoodInterface::evalLikelihoodGradient().
+        std::vector<double> evalGradient(const JointProbability::JointProbabilityBase& jointProbability) {
+            propagate();
+
+            auto& sample = sampleSet.getSampleList().front();
+            const size_t nBins = sample.getBinning().getBinList().size();
+            std::vector<std::vector<double>> contentDerivativeList(1, std::vector<double>(nBins));
+            std::vector<std::vector<double>> sumW2DerivativeList(1, std::vector<double>(nBins));
+            for (size_t iBin = 0; iBin < nBins; ++iBin) {
+                jointProbability.evalDerivative(sample, int(iBin),
+                                                contentDerivativeList[0][iBin],
+                                                sumW2DerivativeList[0][iBin]);
+            }
+
+            std::vector<double> parDerivativeList(getParSet().getParameterList().size(), 0);
+            eventDialCache.updateDialDerivatives(-1, 0);
+            eventDialCache.accumulateGradient(-1, 0, contentDerivativeList, sumW2DerivativeList, parDerivativeList);
+
+            // The penalty derivative uses the cache of evalPenaltyChi2().
+            (void) getParSet().evalPenaltyChi2();
+            std::vector<double> gradient;
+            for (auto& par : getParSet().getEffectiveParameterList()) {
+                double derivative = par.isEigen()
+                    ? getParSet().evalEigenDerivative(par, parDerivativeList)
+                    : parDerivativeList[par.getParameterIndex()];
+                derivative += getParSet().evalPenaltyChi2Derivative(par);
+                gradient.push_back(derivative);
+            }
+            return gradient;
+        }
+
+        std::vector<double> evalNumericalGradient(const JointProbability::JointProbabilityBase& jointProbability,
+                                                  double step = 1E-5) {
+            std::vector<double> gradient;
+            auto& parList = getParSet().getEffectiveParameterList();
+            for (size_t iPar = 0; iPar < parList.size(); ++iPar) {
+                const double value = parList[iPar].getParameterValue();
+                setEffectiveValue(iPar, value + step);
+                const double llhUp = evalLikelihood(jointProbability);
+                setEffectiveValue(iPar, value - step);
+                const double llhDown = evalLikelihood(jointProbability);
+                setEffectiveValue(iPar, value);
+                gradient.push_back((llhUp - llhDown)/(2*step));
+            }
+            return gradient;
+        }
+
+        void checkGradient(JointProbabilityType type) {
+            ASSERT_TRUE(isDerivativeCacheBuilt);
+            auto jointProbability = buildJointProbability(type);
+            ASSERT_TRUE(jointProbability->hasDerivative());
+
+            const auto numerical = evalNumericalGradient(*jointProbability);
+            const auto analytic = evalGradient(*jointProbability);
+            ASSERT_EQ(analytic.size(), numerical.size());
+            for (size_t iPar = 0; iPar < analytic.size(); ++iPar) {
+                EXPECT_NEAR(analytic[iPar], numerical[iPar], 1E-4*(1 + std::abs(numerical[iPar])))
+                    << jointProbability->getType() << ": parameter " << iPar;
+            }
+        }
+
+        /// Cap the event reweight in the middle of the widest gap between
+        /// the current reweight factors, so the central difference doesn't
+        /// cross it.  Returns the number of events above the cap.
+        int setReweightCap() {
+            propagate();
+            std::vector<double> reweightList;
+            for (auto& event : sampleSet.getSampleList().front().getMcContainer().getEventList()) {
+                reweightList.push_back(event.getEventWeight()/event.getWeights().base);
+            }
+            std::sort(reweightList.begin(), reweightList.end());
+
+            size_t iGap = reweightList.size()/4;
+            for (size_t i = reweightList.size()/4; i < 3*reweightList.size()/4; ++i) {
+                if (reweightList[i+1]-reweightList[i] > reweightList[iGap+1]-reweightList[iGap]) iGap = i;
+            }
+            EXPECT_GT(reweightList[iGap+1]-reweightList[iGap], 1E-3);
+
+            auto& cap = eventDialCache.getGlobalEventReweightCap();
+            cap.isEnabled = true;
+            cap.maxReweight = 0.5*(reweightList[iGap] + reweightList[iGap+1]);
+            eventDialCache.requestFullReweight();
+            return int(reweightList.size() - iGap - 1);
+        }
+
+        bool isDerivativeCacheBuilt{false};
+        std::vector<ParameterSet> parSetList;
+        SampleSet sampleSet;
+        DialResponseSupervisor supervisor;
+        std::vector<DialCollection> dialCollectionList;
+        EventDialCache eventDialCache;
+
+    private:
+        DialCollection& addCollection(int iPar,
+                                      double mirrorMin = std::nan("unset"),
+                                      double mirrorRange = std::nan("unset")) {
+            dialCollectionList.emplace_back(&parSetList);
+            auto& collection = dialCollectionList.back();
+
+            DialInputBuffer::ParameterReference parReference{0, iPar};
+            parReference.mirrorEdges.minValue = mirrorMin;
+            parReference.mirrorEdges.range = mirrorRange;
+
+            collection.getDialInputBufferList().emplace_back();
+            auto& inputBuffer = collection.getDialInputBufferList().back();
+            inputBuffer.setParSetRef(&parSetList);
+            inputBuffer.addParameterReference(parReference);
+            inputBuffer.initialise();
+            return collection;
+        }
+
+        void addDial(DialCollection& collection, const std::shared_ptr<DialBase>& dial) {
+            collection.getDialBaseList().emplace_back(dial);
+            collection.getDialInterfaceList().emplace_back();
+            auto& dialInterface = collection.getDialInterfaceList().back();
+            dialInterface.setDialBaseRef(dial.get());
+            dialInterface.setInputBufferRef(&collection.getDialInputBufferList().back());
+            dialInterface.setResponseSupervisorRef(&supervisor);
+        }
+    };
+}
+
+TEST(likelihoodGradientTest, JointProbabilityDerivative) {
+    GradientFixture fixture(false);
+    fixture.setValues({1.1, 0.9, 1.3, 0.7});
+    fixture.propagate();
+
+    auto& sample = fixture.sampleSet.getSampleList().front();
+    auto& binList = sample.getMcContainer().getHistogram().binList;
+    for (auto type : jointProbabilityTypeList) {
+        auto jointProbability = buildJointProbability(type);
+        ASSERT_TRUE(jointProbability->hasDerivative());
+
+        for (size_t iBin = 0; iBin < binList.size(); ++iBin) {
+            double dContent, dSumW2;
+            jointProbability->evalDerivative(sample, int(iBin), dContent, dSumW2);
+
+            const double step = 1E-4*binList[iBin].content;
+            const double content = binList[iBin].content;
+            binList[iBin].content = content + step;
+            const double llhUp = jointProbability->eval(sample, int(iBin));
+            binList[iBin].content = content - step;
+            const double llhDown = jointProbability->eval(sample, int(iBin));
+            binList[iBin].content = content;
+            EXPECT_NEAR(dContent, (llhUp - llhDown)/(2*step), 1E-6*(1 + std::abs(dContent)))
+                << jointProbability->getType() << ": bin " << iBin;
+
+            const double sumW2 = binList[iBin].errorSquared;
+            binList[iBin].errorSquared = sumW2 + step;
+            const double llhSumW2Up = jointProbability->eval(sample, int(iBin));
+            binList[iBin].errorSquared = sumW2 - step;
+            const double llhSumW2Down = jointProbability->eval(sample, int(iBin));
+            binList[iBin].errorSquared = sumW2;
+            EXPECT_NEAR(dSumW2, (llhSumW2Up - llhSumW2Down)/(2*step), 1E-6*(1 + std::abs(dSumW2)))
+                << jointProbability->getType() << ": bin " << iBin;
+        }
+    }
+}
+
+TEST(likelihoodGradientTest, PenaltyDerivative) {
+    for (bool useEigen : {false, true}) {
+        GradientFixture fixture(useEigen);
+        auto& parSet = fixture.getParSet();
+        auto& parList = parSet.getEffectiveParameterList();
+        ASSERT_EQ(parList.size(), size_t(4));
+
+        // Move the parameters one at a time to go through the incremental
+        // update of the penalty cache.
+        const std::vector<std::vector<double>> pointList{
+            {1.1, 1.0, 1.0, 1.0}, {1.1, 0.8, 1.0, 1.0}, {1.1, 0.8, 1.4, 0.6}, {0.7, 1.2, 0.9, 1.3}
+        };
+        const double step = 1E-5;
+        for (auto& point : pointList) {
+            fixture.setValues(point);
+            for (size_t iPar = 0; iPar < parList.size(); ++iPar) {
+                (void) parSet.evalPenaltyChi2();
+                const double derivative = parSet.evalPenaltyChi2Derivative(parList[iPar]);
+
+                const double value = parList[iPar].getParameterValue();
+                fixture.setEffectiveValue(iPar, value + step);
+                const double penaltyUp = parSet.evalPenaltyChi2();
+                fixture.setEffectiveValue(iPar, value - step);
+                const double penaltyDown = parSet.evalPenaltyChi2();
+                fixture.setEffectiveValue(iPar, value);
+
+                EXPECT_NEAR(derivative, (penaltyUp - penaltyDown)/(2*step), 1E-5*(1 + std::abs(derivative)))
+                    << (useEigen ? "Eigen" : "Original") << " parameter " << iPar;
+            }
+        }
+    }
+}
+
+TEST(likelihoodGradientTest, Gradient) {
+    for (bool useEigen : {false, true}) {
+        GradientFixture fixture(useEigen);
+        fixture.setValues({1.1, 0.9, 1.3, 0.7});
+        for (auto type : jointProbabilityTypeList) {
+            fixture.checkGradient(type);
+        }
+    }
+}
+
+// The compact spline is evaluated at 2.4 -> 1.6 and -0.3 -> 0.3: the input
+// decreases when the parameter increases.
+TEST(likelihoodGradientTest, MirroredInput) {
+    for (bool useEigen : {false, true}) {
+        for (double value : {2.4, -0.3}) {
+            GradientFixture fixture(useEigen);
+            fixture.setValues({1.1, 0.9, value, 0.7});
+            fixture.propagate();
+            EXPECT_EQ(fixture.dialCollectionList[2].getDialInputBufferList().front().getInputDerivative(0), -1.0);
+            for (auto type : jointProbabilityTypeList) {
+                fixture.checkGradient(type);
+            }
+        }
+    }
+}
+
+// A norm at zero: half of the events have a null weight, but their
+// derivative with respect to the norm is not null.
+TEST(likelihoodGradientTest, NullResponse) {
+    GradientFixture fixture(false);
+    fixture.setValues({0.0, 0.9, 1.3, 0.7});
+    for (auto type : jointProbabilityTypeList) {
+        fixture.checkGradient(type);
+    }
+}
+
+// The events above the cap have a flat weight.
+TEST(likelihoodGradientTest, ReweightCap) {
+    for (bool useEigen : {false, true}) {
+        GradientFixture fixture(useEigen);
+        fixture.setValues({1.1, 0.9, 1.3, 0.7});
+        EXPECT_GT(fixture.setReweightCap(), 0);
+        for (auto type : jointProbabilityTypeList) {
+            fixture.checkGradient(type);
+        }
+    }
+}
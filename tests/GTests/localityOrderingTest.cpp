@@ -0,0 +1,257 @@
+#include <vector>
+#include <memory>
+#include <cmath>
+
+#include "EventDialCache.h"
+#include "DialCollection.h"
+#include "DialInterface.h"
+#include "DialInputBuffer.h"
+#include "DialResponseSupervisor.h"
+#include "Norm.h"
+#include "CompactSpline.h"
+#include "ParameterSet.h"
+#include "SampleSet.h"
+
+#include "gtest/gtest.h"
+
+// Check the event ordering applied by the cache: the events are only
+// permuted (within their dataset), and clustering them by dials and bins
+// gives the same histograms and the same event weights as keeping them in
+// the dataset order.  Each event has a norm and a shared spline, and one
+// event out of five also gets its own spline.
+namespace {
+    class OrderingFixture {
+    public:
+        explicit OrderingFixture(bool enableLocalityOrdering, int events = 1000, int norms = 8, int bins = 10) {
+            // The norms, then the parameter of the splines.
+            parSetList.emplace_back();
+            auto& parSet = parSetList.back();
+            for (int iPar = 0; iPar <= norms; ++iPar) {
+                parSet.getParameterList().emplace_back(&parSet);
+                auto& par = parSet.getParameterList().back();
+                par.setParameterIndex(iPar);
+                par.setIsEnabled(true);
+                par.setPriorValue(1);
+                par.setStdDevValue(1);
+                par.setParameterValue(1);
+            }
+
+            // The events of the two datasets are interleaved, and the bins
+            // don't follow the entries.
+            sampleSet.getSampleList().emplace_back();
+            auto& sample = sampleSet.getSampleList().back();
+            sample.setIndex(0);
+            for (int iBin = 0; iBin < bins; ++iBin) {
+                sample.getBinning().getBinList().emplace_back(iBin);
+            }
+            auto& container = sample.getMcContainer();
+            container.buildHistogram(sample.getBinning());
+            container.getEventList().resize(events);
+            for (int iEvent = 0; iEvent < events; ++iEvent) {
+                auto& event = container.getEventList()[iEvent];
+                event.getIndices().dataset = iEvent % 2;
+                event.getIndices().entry = iEvent;
+                event.getIndices().sample = 0;
+                event.getIndices().bin = (3*iEvent) % bins;
+                event.getWeights().base = 0.5 + double(iEvent % 7) / 7.;
+                event.getWeights().resetCurrentWeight();
+            }
+
+            // The interfaces point into the collections: no reallocation.
+            dialCollectionList.reserve(norms + 2);
+            for (int iPar = 0; iPar < norms; ++iPar) {
+                auto& collection = addCollection(iPar);
+                addDial(collection, std::make_shared<Norm>());
+            }
+            auto& sharedCollection = addCollection(norms);
+            for (int iShape = 0; iShape < 3; ++iShape) {
+                addDial(sharedCollection, makeSpline(0.1*(iShape+1), iShape));
+            }
+            auto& eventCollection = addCollection(norms);
+            for (int iEvent = 0; iEvent < events; ++iEvent) {
+                addDial(eventCollection, makeSpline(0.05, 0.01*iEvent));
+            }
+
+            eventDialCache.setEnableLocalityOrdering(enableLocalityOrdering);
+            eventDialCache.allocateCacheEntries(events, 3);
+            for (int iEvent = 0; iEvent < events; ++iEvent) {
+                auto* entry = eventDialCache.fetchNextCacheEntry();
+                entry->event.sampleIndex = 0;
+                entry->event.eventIndex = iEvent;
+                entry->dials[0].collectionIndex = iEvent % norms;
+                entry->dials[0].interfaceIndex = 0;
+                entry->dials[1].collectionIndex = norms;
+                entry->dials[1].interfaceIndex = (iEvent / 7) % 3;
+                if (iEvent % 5 == 0) {
+                    entry->dials[2].collectionIndex = norms + 1;
+                    entry->dials[2].interfaceIndex = iEvent;
+                }
+            }
+            eventDialCache.buildReferenceCache(sampleSet, dialCollectionList);
+            container.updateBinEventList();
+        }
+
+        void setParameter(int iPar, double value) {
+            parSetList.front().getParameterList()[iPar].setParameterValue(value);
+        }
+
+        /// Same steps as the Propagator::propagateParameters().
+        void propagate() {
+            for (auto& collection : dialCollectionList) {
+                for (auto& inputBuffer : collection.getDialInputBufferList()) {
+                    inputBuffer.update();
+                }
+            }
+            eventDialCache.updateDialResponses(-1, 0);
+            eventDialCache.prepareReweight();
+            eventDialCache.reweightEvents(-1, 0);
+            sampleSet.getSampleList().front().getMcContainer().refillHistogram();
+        }
+
+        std::vector<Event>& getEventList() {
+            return sampleSet.getSampleList().front().getMcContainer().getEventList();
+        }
+
+        /// The current event weights, indexed by entry.
+        std::vector<double> getEventWeightList() {
+            std::vector<double> weightList(getEventList().size(), std::nan("unset"));
+            for (auto& event : getEventList()) {
+                weightList[event.getIndices().entry] = event.getEventWeight();
+            }
+            return weightList;
+        }
+
+        std::vector<ParameterSet> parSetList;
+        SampleSet sampleSet;
+        DialResponseSupervisor supervisor;
+        std::vector<DialCollection> dialCollectionList;
+        EventDialCache eventDialCache;
+
+    private:
+        DialCollection& addCollection(int iPar) {
+            dialCollectionList.emplace_back(&parSetList);
+            auto& collection = dialCollectionList.back();
+            collection.getDialInputBufferList().emplace_back();
+            auto& inputBuffer = collection.getDialInputBufferList().back();
+            inputBuffer.setParSetRef(&parSetList);
+            inputBuffer.addParameterReference({0, iPar});
+            inputBuffer.initialise();
+            return collection;
+        }
+
+        void addDial(DialCollection& collection, const std::shared_ptr<DialBase>& dial) {
+            collection.getDialBaseList().emplace_back(dial);
+            collection.getDialInterfaceList().emplace_back();
+            auto& dialInterface = collection.getDialInterfaceList().back();
+            dialInterface.setDialBaseRef(dial.get());
+            dialInterface.setInputBufferRef(&collection.getDialInputBufferList().back());
+            dialInterface.setResponseSupervisorRef(&supervisor);
+        }
+
+        static std::shared_ptr<DialBase> makeSpline(double amplitude, double phase) {
+            std::vector<double> knots{-1.0, 0.0, 1.0, 2.0, 3.0};
+            std::vector<double> y;
+            std::vector<double> slopes;
+            for (double x : knots) {
+                y.push_back(1.0 + amplitude*std::sin(x + phase));
+                slopes.push_back(amplitude*std::cos(x + phase));
+            }
+            auto dial = std::make_shared<CompactSpline>();
+            dial->buildDial(knots, y, slopes);
+            return dial;
+        }
+    };
+
+    /// Every entry is found once, and the datasets are contiguous blocks.
+    void CheckPermutation(OrderingFixture& fixture) {
+        auto& eventList = fixture.getEventList();
+        std::vector<int> nFoundList(eventList.size(), 0);
+        for (size_t iEvent = 0; iEvent < eventList.size(); ++iEvent) {
+            auto& indices = eventList[iEvent].getIndices();
+            ASSERT_GE(indices.entry, 0);
+            ASSERT_LT(size_t(indices.entry), eventList.size());
+            nFoundList[indices.entry]++;
+            if (iEvent > 0) {
+                EXPECT_LE(eventList[iEvent-1].getIndices().dataset, indices.dataset) << "Event " << iEvent;
+            }
+        }
+        for (size_t iEntry = 0; iEntry < nFoundList.size(); ++iEntry) {
+            EXPECT_EQ(nFoundList[iEntry], 1) << "Entry " << iEntry;
+        }
+    }
+
+    void CheckSameResults(OrderingFixture& ordered, OrderingFixture& reference) {
+        auto& binList = ordered.sampleSet.getSampleList().front().getMcContainer().getHistogram().binList;
+        auto& referenceBinList = reference.sampleSet.getSampleList().front().getMcContainer().getHistogram().binList;
+        ASSERT_EQ(binList.size(), referenceBinList.size());
+        for (size_t iBin = 0; iBin < binList.size(); ++iBin) {
+            EXPECT_NEAR(binList[iBin].content, referenceBinList[iBin].content,
+                        1E-9*std::abs(referenceBinList[iBin].content))
+                << "Bin " << iBin;
+            EXPECT_NEAR(binList[iBin].errorSquared, referenceBinList[iBin].errorSquared,
+                        1E-9*std::abs(referenceBinList[iBin].errorSquared))
+                << "Bin " << iBin;
+        }
+
+        const auto weightList = ordered.getEventWeightList();
+        const auto referenceWeightList = reference.getEventWeightList();
+        ASSERT_EQ(weightList.size(), referenceWeightList.size());
+        for (size_t iEvent = 0; iEvent < weightList.size(); ++iEvent) {
+            EXPECT_NEAR(weightList[iEvent], referenceWeightList[iEvent],
+                        1E-9*std::abs(referenceWeightList[iEvent]))
+                << "Event " << iEvent;
+        }
+    }
+}
+
+TEST(localityOrderingTest, Permutation) {
+    OrderingFixture ordered(true);
+    OrderingFixture reference(false);
+    CheckPermutation(ordered);
+    CheckPermutation(reference);
+
+    // Without the locality ordering, the events follow the dataset entries.
+    // With it, the events are clustered by dials: the order has to change.
+    auto& referenceEventList = reference.getEventList();
+    auto& orderedEventList = ordered.getEventList();
+    for (size_t iEvent = 1; iEvent < referenceEventList.size(); ++iEvent) {
+        auto& previous = referenceEventList[iEvent-1].getIndices();
+        auto& current = referenceEventList[iEvent].getIndices();
+        if (previous.dataset == current.dataset) {
+            EXPECT_LT(previous.entry, current.entry) << "Event " << iEvent;
+        }
+    }
+    bool isReordered = false;
+    for (size_t iEvent = 0; iEvent < orderedEventList.size(); ++iEvent) {
+        if (orderedEventList[iEvent].getIndices().entry != referenceEventList[iEvent].getIndices().entry) {
+            isReordered = true;
+        }
+    }
+    EXPECT_TRUE(isReordered);
+}
+
+TEST(localityOrderingTest, SameResults) {
+    OrderingFixture ordered(true);
+    OrderingFixture reference(false);
+    ordered.propagate();
+    reference.propagate();
+    CheckSameResults(ordered, reference);
+
+    // One norm (incremental reweight), the shared spline parameter, then
+    // everything at once.
+    const std::vector<std::vector<std::pair<int, double>>> stepList{
+        {{0, 1.2}},
+        {{8, 1.7}},
+        {{1, 0.8}, {3, 1.1}, {5, 0.0}, {8, -0.4}},
+        {{0, 1.0}, {1, 1.0}, {2, 1.3}, {3, 0.6}, {4, 1.4}, {5, 0.9}, {6, 1.1}, {7, 0.7}, {8, 2.5}}
+    };
+    for (auto& step : stepList) {
+        for (auto& parValue : step) {
+            ordered.setParameter(parValue.first, parValue.second);
+            reference.setParameter(parValue.first, parValue.second);
+        }
+        ordered.propagate();
+        reference.propagate();
+        CheckSameResults(ordered, reference);
+    }
+}
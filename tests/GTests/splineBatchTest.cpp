@@ -0,0 +1,353 @@
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cmath>
+
+#include <TRandom.h>
+
+#include "EventDialCache.h"
+#include "DialCollection.h"
+#include "DialInterface.h"
+#include "DialInputBuffer.h"
+#include "DialResponseSupervisor.h"
+#include "CompactSpline.h"
+#include "UniformSpline.h"
+#include "GeneralSpline.h"
+#include "MonotonicSpline.h"
+#include "ParameterSet.h"
+#include "SampleSet.h"
+
+#include "CalculateSplineBatch.h"
+#include "CalculateCompactSpline.h"
+#include "CalculateUniformSpline.h"
+#include "CalculateGeneralSpline.h"
+#include "CalculateMonotonicSpline.h"
+
+#include "gtest/gtest.h"
+
+// Check that the batch functions give the same values as the single spline
+// functions.  The splines get between 3 and 8 knots, and the points are
+// chosen to include extrapolation on both sides.
+namespace {
+    enum class SplineType {kCompact, kUniform, kGeneral, kMonotonic};
+
+    void CheckSplineBatch(SplineType type) {
+        const int splines = 1000;
+        std::vector<double> data;
+        std::vector<int> index{0};
+        std::vector<double> x;
+        std::vector<double> expected;
+
+        for (int i = 0; i < splines; ++i) {
+            const int knots = 3 + i%6;
+            const double low = gRandom->Uniform(-3.0, -1.0);
+            const double step = gRandom->Uniform(0.2, 2.0);
+            const int start = data.size();
+            data.push_back(low);
+            if (type == SplineType::kGeneral) data.push_back(low+(knots-1)*step);
+            else data.push_back(step);
+            for (int k = 0; k < knots; ++k) {
+                data.push_back(gRandom->Uniform(0.0, 2.0));
+                if (type == SplineType::kUniform) {
+                    data.push_back(gRandom->Uniform(-1.0, 1.0));
+                }
+                if (type == SplineType::kGeneral) {
+                    data.push_back(gRandom->Uniform(-1.0, 1.0));
+                    data.push_back(low + k*step);
+                }
+            }
+            index.push_back(data.size());
+
+            const double v = gRandom->Uniform(low-step, low+knots*step);
+            x.push_back(v);
+            const int dim = index.back()-start;
+            switch (type) {
+            case SplineType::kCompact:
+                expected.push_back(
+                    CalculateCompactSpline(v, 0.1, 1.9, &data[start], dim-2));
+                break;
+            case SplineType::kUniform:
+                expected.push_back(
+                    CalculateUniformSpline(v, 0.1, 1.9, &data[start], dim));
+                break;
+            case SplineType::kGeneral:
+                expected.push_back(
+                    CalculateGeneralSpline(v, 0.1, 1.9, &data[start], dim));
+                break;
+            case SplineType::kMonotonic:
+                expected.push_back(
+                    CalculateMonotonicSpline(v, 0.1, 1.9, &data[start], dim-2));
+                break;
+            }
+        }
+
+        std::vector<double> results(splines);
+        switch (type) {
+        case SplineType::kCompact:
+            CalculateCompactSplineBatch(splines, x.data(), 0.1, 1.9,
+                                        data.data(), index.data(),
+                                        results.data());
+            break;
+        case SplineType::kUniform:
+            CalculateUniformSplineBatch(splines, x.data(), 0.1, 1.9,
+                                        data.data(), index.data(),
+                                        results.data());
+            break;
+        case SplineType::kGeneral:
+            CalculateGeneralSplineBatch(splines, x.data(), 0.1, 1.9,
+                                        data.data(), index.data(),
+                                        results.data());
+            break;
+        case SplineType::kMonotonic:
+            CalculateMonotonicSplineBatch(splines, x.data(), 0.1, 1.9,
+                                          data.data(), index.data(),
+                                          results.data());
+            break;
+        }
+
+        // The batch loops may use fused multiply-add, so allow for rounding.
+        for (int i = 0; i < splines; ++i) {
+            EXPECT_NEAR(results[i], expected[i], 1E-12)
+                << "Spline " << i << " evaluated at " << x[i];
+        }
+    }
+}
+
+TEST(splineBatchTest, CompactSpline) {
+    CheckSplineBatch(SplineType::kCompact);
+}
+
+TEST(splineBatchTest, UniformSpline) {
+    CheckSplineBatch(SplineType::kUniform);
+}
+
+TEST(splineBatchTest, GeneralSpline) {
+    CheckSplineBatch(SplineType::kGeneral);
+}
+
+TEST(splineBatchTest, MonotonicSpline) {
+    CheckSplineBatch(SplineType::kMonotonic);
+}
+
+// Splines sharing the same uniformly spaced knots: the segment and fx are
+// found once, and each spline is reduced to the cubic coefficients of that
+// segment (from the same point and slope values as CalculateUniformSpline).
+TEST(splineBatchTest, SharedKnotSpline) {
+    const int splines = 1000;
+    const int knots = 7;
+    const double low = -3.0;
+    const double step = 1.0;
+
+    std::vector<std::vector<double>> dataList;
+    for (int i = 0; i < splines; ++i) {
+        std::vector<double> data{low, step};
+        for (int k = 0; k < knots; ++k) {
+            data.push_back(gRandom->Uniform(0.0, 2.0));
+            data.push_back(gRandom->Uniform(-1.0, 1.0));
+        }
+        dataList.push_back(data);
+    }
+
+    for (double x : {-3.0, -2.5, -0.1, 0.0, 1.7, 2.99, 3.0}) {
+        const double xx = (x-low)/step;
+        int ix = xx;
+        if (ix > knots-2) ix = knots-2;
+        const double fx = xx-ix;
+        const double fxPowers[4]{1.0, fx, fx*fx, fx*fx*fx};
+
+        std::vector<double> coefficients;
+        for (const auto& data : dataList) {
+            const double p1 = data[2+2*ix];
+            const double m1 = data[2+2*ix+1]*step;
+            const double p2 = data[2+2*ix+2];
+            const double m2 = data[2+2*ix+3]*step;
+            coefficients.push_back(p1);
+            coefficients.push_back(m1);
+            coefficients.push_back(3.0*p2 - 3.0*p1 - m2 - 2.0*m1);
+            coefficients.push_back(2.0*p1 - 2.0*p2 + m2 + m1);
+        }
+
+        std::vector<double> results(splines);
+        CalculateSharedKnotSplineBatch(splines, fxPowers, 0.1, 1.9,
+                                       coefficients.data(), results.data());
+
+        for (int i = 0; i < splines; ++i) {
+            const double expected = CalculateUniformSpline(
+                x, 0.1, 1.9, dataList[i].data(), dataList[i].size());
+            EXPECT_NEAR(results[i], expected, 1E-12)
+                << "Spline " << i << " evaluated at " << x;
+        }
+    }
+}
+
+// Same check through the EventDialCache, for each spline type: the splines
+// of a collection share their knots and their input, so they end up in a
+// single shared-knot batch.  The points are inside the knots, on the knots,
+// and on both sides of them, with and without extrapolation.
+namespace {
+    double CalculateSpline(SplineType type, double x, const DialDataView& data) {
+        switch (type) {
+        case SplineType::kCompact:
+            return CalculateCompactSpline(x, -1E20, 1E20, data.data(), int(data.size())-2);
+        case SplineType::kUniform:
+            return CalculateUniformSpline(x, -1E20, 1E20, data.data(), int(data.size()));
+        case SplineType::kGeneral:
+            return CalculateGeneralSpline(x, -1E20, 1E20, data.data(), int(data.size()));
+        case SplineType::kMonotonic:
+            return CalculateMonotonicSpline(x, -1E20, 1E20, data.data(), int(data.size())-2);
+        }
+        return std::nan("unset");
+    }
+
+    // Each event is reweighted by its own spline, and has a base weight of
+    // one: the event weight is the spline response.
+    class SharedKnotFixture {
+    public:
+        SharedKnotFixture(SplineType type, bool allowExtrapolation, int splines = 100) {
+            parSetList.emplace_back();
+            auto& parSet = parSetList.back();
+            parSet.getParameterList().emplace_back(&parSet);
+            auto& par = parSet.getParameterList().back();
+            par.setParameterIndex(0);
+            par.setIsEnabled(true);
+            par.setPriorValue(0);
+            par.setStdDevValue(1);
+            par.setParameterValue(0);
+
+            sampleSet.getSampleList().emplace_back();
+            auto& sample = sampleSet.getSampleList().back();
+            sample.setIndex(0);
+            sample.getBinning().getBinList().emplace_back(0);
+            auto& container = sample.getMcContainer();
+            container.buildHistogram(sample.getBinning());
+            container.getEventList().resize(splines);
+            for (int iEvent = 0; iEvent < splines; ++iEvent) {
+                auto& event = container.getEventList()[iEvent];
+                event.getIndices().dataset = 0;
+                event.getIndices().entry = iEvent;
+                event.getIndices().sample = 0;
+                event.getIndices().bin = 0;
+                event.getWeights().base = 1.0;
+                event.getWeights().resetCurrentWeight();
+            }
+
+            // The general splines get non-uniformly spaced knots.
+            knots = {-3.0, -2.0, -1.0, 0.0, 1.0, 2.0, 3.0};
+            if (type == SplineType::kGeneral) knots = {-3.0, -2.2, -1.0, -0.4, 0.5, 1.7, 3.0};
+
+            // The interfaces point into the collection: no reallocation.
+            dialCollectionList.reserve(1);
+            dialCollectionList.emplace_back(&parSetList);
+            auto& collection = dialCollectionList.back();
+
+            collection.getDialInputBufferList().emplace_back();
+            auto& inputBuffer = collection.getDialInputBufferList().back();
+            inputBuffer.setParSetRef(&parSetList);
+            inputBuffer.addParameterReference({0, 0});
+            inputBuffer.initialise();
+
+            collection.getDialInterfaceList().resize(splines);
+            for (int iSpline = 0; iSpline < splines; ++iSpline) {
+                std::vector<double> y;
+                std::vector<double> slopes;
+                for (size_t k = 0; k < knots.size(); ++k) {
+                    y.push_back(gRandom->Uniform(0.0, 2.0));
+                    slopes.push_back(gRandom->Uniform(-1.0, 1.0));
+                }
+
+                std::shared_ptr<DialBase> dial;
+                switch (type) {
+                case SplineType::kCompact: dial = std::make_shared<CompactSpline>(); break;
+                case SplineType::kUniform: dial = std::make_shared<UniformSpline>(); break;
+                case SplineType::kGeneral: dial = std::make_shared<GeneralSpline>(); break;
+                case SplineType::kMonotonic: dial = std::make_shared<MonotonicSpline>(); break;
+                }
+                dial->buildDial(knots, y, slopes);
+                dial->setAllowExtrapolation(allowExtrapolation);
+                collection.getDialBaseList().emplace_back(dial);
+
+                auto& dialInterface = collection.getDialInterfaceList()[iSpline];
+                dialInterface.setDialBaseRef(dial.get());
+                dialInterface.setInputBufferRef(&inputBuffer);
+                dialInterface.setResponseSupervisorRef(&supervisor);
+            }
+
+            eventDialCache.allocateCacheEntries(splines, 1);
+            for (int iEvent = 0; iEvent < splines; ++iEvent) {
+                auto* entry = eventDialCache.fetchNextCacheEntry();
+                entry->event.sampleIndex = 0;
+                entry->event.eventIndex = iEvent;
+                entry->dials[0].collectionIndex = 0;
+                entry->dials[0].interfaceIndex = iEvent;
+            }
+            eventDialCache.buildReferenceCache(sampleSet, dialCollectionList);
+
+            // The events might have been sorted by the cache.
+            container.updateBinEventList();
+        }
+
+        /// Reweight the events with the parameter at x, and compare each
+        /// event weight with the CalculateXXXSpline response of its spline.
+        void checkResponses(SplineType type, bool allowExtrapolation, double x) {
+            parSetList.front().getParameterList()[0].setParameterValue(x);
+            for (auto& inputBuffer : dialCollectionList.front().getDialInputBufferList()) {
+                inputBuffer.update();
+            }
+            eventDialCache.updateDialResponses(-1, 0);
+            eventDialCache.prepareReweight();
+            eventDialCache.reweightEvents(-1, 0);
+
+            // Same clamping as the evalResponse() of the splines.
+            double input = x;
+            if (not allowExtrapolation) input = std::min(std::max(x, knots.front()), knots.back());
+
+            auto& dialBaseList = dialCollectionList.front().getDialBaseList();
+            auto& eventList = sampleSet.getSampleList().front().getMcContainer().getEventList();
+            for (auto& event : eventList) {
+                const DialDataView data = dialBaseList[event.getIndices().entry]->getDialData();
+                const double expected = CalculateSpline(type, input, data);
+                EXPECT_NEAR(event.getEventWeight(), expected, 1E-6*std::abs(expected) + 1E-9)
+                    << "Spline " << event.getIndices().entry << " evaluated at " << x;
+            }
+        }
+
+        std::vector<double> knots;
+        std::vector<ParameterSet> parSetList;
+        SampleSet sampleSet;
+        DialResponseSupervisor supervisor;
+        std::vector<DialCollection> dialCollectionList;
+        EventDialCache eventDialCache;
+    };
+
+    void CheckSharedKnotBatch(SplineType type, bool allowExtrapolation) {
+        SharedKnotFixture fixture(type, allowExtrapolation);
+
+        auto& batchList = fixture.eventDialCache.getSplineBatchList();
+        ASSERT_EQ(batchList.size(), size_t(1));
+        ASSERT_TRUE(batchList.front().isSharedKnot());
+
+        for (double x : {-4.6, -3.4, -3.0, -2.5, -0.1, 0.0, 1.7, 2.99, 3.0, 3.3, 4.8}) {
+            fixture.checkResponses(type, allowExtrapolation, x);
+        }
+    }
+}
+
+TEST(splineBatchTest, SharedKnotCompactSpline) {
+    CheckSharedKnotBatch(SplineType::kCompact, true);
+    CheckSharedKnotBatch(SplineType::kCompact, false);
+}
+
+TEST(splineBatchTest, SharedKnotUniformSpline) {
+    CheckSharedKnotBatch(SplineType::kUniform, true);
+    CheckSharedKnotBatch(SplineType::kUniform, false);
+}
+
+TEST(splineBatchTest, SharedKnotGeneralSpline) {
+    CheckSharedKnotBatch(SplineType::kGeneral, true);
+    CheckSharedKnotBatch(SplineType::kGeneral, false);
+}
+
+TEST(splineBatchTest, SharedKnotMonotonicSpline) {
+    CheckSharedKnotBatch(SplineType::kMonotonic, true);
+    CheckSharedKnotBatch(SplineType::kMonotonic, false);
+}